@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/atomic.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+#include "utility/vertex_state.h"
+
+// Betweenness centrality (Brandes) of a batch of K sources on edge-cut
+// fragments. For each vertex and source k the app keeps the BFS level
+// dist[k], the number of shortest paths sigma[k] and the dependency delta[k]:
+//   forward, level l: a vertex not reached yet gets dist = l and
+//     sigma = sum of sigma of its in-neighbors at level l - 1,
+//   backward, level l: a vertex at level l gets
+//     delta = sum over out-neighbors w at level l + 1 of
+//             sigma / sigma(w) * (1 + delta(w)),
+//     which is added to its centrality.
+// All fragments process the same phase and level in a superstep. The state
+// of a fragment is kept in VertexState, so that it survives the release of
+// the fragment and may be spilled to disk. Rows of border vertexes are
+// mirrored into arrays indexed by border vertex, where other fragments read
+// them.
+template <typename GRAPH_T, typename CONTEXT_T>
+class BCAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+
+ public:
+  // Rows of K lanes: dist, sigma and delta of the fragment by local id, their
+  // mirrors by border index, and the centrality of all vertexes by global id.
+  struct BCState {
+    size_t num_lanes = 0;
+    VDATA_T* dist = nullptr;
+    double* sigma = nullptr;
+    double* delta = nullptr;
+    VDATA_T* border_dist = nullptr;
+    double* border_sigma = nullptr;
+    double* border_delta = nullptr;
+    const VID_T* border_index = nullptr;
+    double* bc = nullptr;
+  };
+
+  BCAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  // @brief: rows of vertex globalid, from the fragment or from the mirrors.
+  static void GetRows(GRAPH_T* graph, const BCState* state,
+                      const VID_T globalid, VDATA_T** dist, double** sigma,
+                      double** delta) {
+    size_t offset = 0;
+    if (graph->IsInGraph(globalid)) {
+      offset = state->num_lanes * graph->globalid2localid(globalid);
+      *dist = state->dist + offset;
+      *sigma = state->sigma + offset;
+      *delta = state->delta + offset;
+    } else {
+      offset = state->num_lanes * state->border_index[globalid];
+      *dist = state->border_dist + offset;
+      *sigma = state->border_sigma + offset;
+      *delta = state->border_delta + offset;
+    }
+  }
+
+  // @brief: copy the rows of local vertex i to its mirrors, if it is a border
+  // vertex.
+  static void Mirror(GRAPH_T* graph, const BCState* state, const VID_T i) {
+    VID_T index = state->border_index[graph->localid2globalid(i)];
+    if (index == VID_MAX) return;
+    size_t size = state->num_lanes;
+    memcpy(state->border_dist + size * index, state->dist + size * i,
+           sizeof(VDATA_T) * size);
+    memcpy(state->border_sigma + size * index, state->sigma + size * i,
+           sizeof(double) * size);
+    memcpy(state->border_delta + size * index, state->delta + size * i,
+           sizeof(double) * size);
+  }
+
+  static void kernel_border(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, size_t* num_border_edges) {
+    size_t local_num_border_edges = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.indegree; j++)
+        if (!graph->IsInGraph(u.in_edges[j])) ++local_num_border_edges;
+      for (size_t j = 0; j < u.outdegree; j++)
+        if (!graph->IsInGraph(u.out_edges[j])) ++local_num_border_edges;
+    }
+    write_add(num_border_edges, local_num_border_edges);
+    return;
+  }
+
+  static void kernel_forward(GRAPH_T* graph, const size_t tid,
+                             Bitmap* visited, const size_t step,
+                             const BCState* state, const VDATA_T level,
+                             size_t* num_reached) {
+    size_t num_lanes = state->num_lanes;
+    std::vector<double> sum(num_lanes);
+    size_t local_num_reached = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VDATA_T* dist = state->dist + num_lanes * i;
+      double* sigma = state->sigma + num_lanes * i;
+      if (std::find(dist, dist + num_lanes, VDATA_MAX) == dist + num_lanes)
+        continue;
+      std::fill(sum.begin(), sum.end(), 0);
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.indegree; j++) {
+        VDATA_T* nbr_dist;
+        double *nbr_sigma, *nbr_delta;
+        GetRows(graph, state, u.in_edges[j], &nbr_dist, &nbr_sigma,
+                &nbr_delta);
+        for (size_t k = 0; k < num_lanes; k++)
+          if (nbr_dist[k] == level - 1) sum[k] += nbr_sigma[k];
+      }
+      size_t num_lanes_reached = 0;
+      for (size_t k = 0; k < num_lanes; k++) {
+        if (dist[k] != VDATA_MAX || sum[k] == 0) continue;
+        dist[k] = level;
+        sigma[k] = sum[k];
+        ++num_lanes_reached;
+      }
+      if (num_lanes_reached == 0) continue;
+      local_num_reached += num_lanes_reached;
+      Mirror(graph, state, i);
+    }
+    write_add(num_reached, local_num_reached);
+    return;
+  }
+
+  static void kernel_backward(GRAPH_T* graph, const size_t tid,
+                              Bitmap* visited, const size_t step,
+                              const BCState* state, const VDATA_T level) {
+    size_t num_lanes = state->num_lanes;
+    std::vector<double> sum(num_lanes);
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VDATA_T* dist = state->dist + num_lanes * i;
+      double* sigma = state->sigma + num_lanes * i;
+      double* delta = state->delta + num_lanes * i;
+      if (std::find(dist, dist + num_lanes, level) == dist + num_lanes)
+        continue;
+      std::fill(sum.begin(), sum.end(), 0);
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.outdegree; j++) {
+        VDATA_T* nbr_dist;
+        double *nbr_sigma, *nbr_delta;
+        GetRows(graph, state, u.out_edges[j], &nbr_dist, &nbr_sigma,
+                &nbr_delta);
+        for (size_t k = 0; k < num_lanes; k++)
+          if (dist[k] == level && nbr_dist[k] == level + 1)
+            sum[k] += sigma[k] / nbr_sigma[k] * (1 + nbr_delta[k]);
+      }
+      double bc = 0;
+      for (size_t k = 0; k < num_lanes; k++) {
+        if (dist[k] != level) continue;
+        delta[k] = sum[k];
+        bc += sum[k];
+      }
+      state->bc[graph->localid2globalid(i)] += bc;
+      Mirror(graph, state, i);
+    }
+    return;
+  }
+};
+
+// Supersteps of all fragments:
+//   0: set the lanes of sources owned by the fragment.
+//   forward, level 1, 2, ...: until a level reaches no vertex, so that the
+//     deepest level D is known.
+//   backward, level D - 1, ..., 1.
+// A fragment without border edges runs both phases at once in PEval.
+template <typename GRAPH_T, typename CONTEXT_T>
+class BCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using BCAutoMap_T = BCAutoMap<GRAPH_T, CONTEXT_T>;
+  using BCState = typename BCAutoMap_T::BCState;
+
+  enum Phase { kInit, kForward, kBackward, kDone };
+
+  struct RoundInfo {
+    bool has_phase = false;
+    Phase phase = kInit;
+    VDATA_T level = 0;
+    size_t num_reached = 0;
+  };
+
+ public:
+  BCPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+        const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context),
+        dist_state_("bc_dist", context.sources.size(), VDATA_MAX,
+                    context.state_root),
+        path_state_("bc_path", 2 * context.sources.size(), 0,
+                    context.state_root) {}
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    std::call_once(alloc_once_, [this]() {
+      size_t num_vertexes = this->msg_mngr_->get_max_vid() + 1;
+      size_t num_lanes = this->context_.sources.size();
+      Bitmap* global_border_vid_map = this->msg_mngr_->GetGlobalBorderVidMap();
+      border_index_.resize(num_vertexes, VID_MAX);
+      VID_T num_border_vertexes = 0;
+      for (size_t i = 0; i < num_vertexes; i++)
+        if (global_border_vid_map->get_bit(i))
+          border_index_[i] = num_border_vertexes++;
+      border_dist_.resize(num_lanes * num_border_vertexes, VDATA_MAX);
+      border_sigma_.resize(num_lanes * num_border_vertexes, 0);
+      border_delta_.resize(num_lanes * num_border_vertexes, 0);
+      bc_.resize(num_vertexes, 0);
+    });
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_,
+             " #sources: ", this->context_.sources.size());
+    BCState state = Acquire(graph);
+    for (size_t k = 0; k < this->context_.sources.size(); k++) {
+      VID_T source = this->context_.sources[k];
+      if (!graph.IsInGraph(source)) continue;
+      VID_T localid = graph.globalid2localid(source);
+      state.dist[state.num_lanes * localid + k] = 0;
+      state.sigma[state.num_lanes * localid + k] = 1;
+      BCAutoMap_T::Mirror(&graph, &state, localid);
+    }
+
+    size_t num_border_edges = 0;
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               BCAutoMap_T::kernel_border, &num_border_edges);
+    if (num_border_edges == 0) {
+      VDATA_T level = 1;
+      while (Forward(graph, task_runner, &state, level) > 0) ++level;
+      for (level -= 1; level > 1; level--)
+        Backward(graph, task_runner, &state, level - 1);
+      std::lock_guard<std::mutex> lck(mtx_);
+      finished_.insert(graph.get_gid());
+    }
+    Report(graph, 0, 0);
+    Release(graph);
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    size_t round = 0;
+    RoundInfo current;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      round = ++num_rounds_[graph.get_gid()];
+      if (!rounds_[round].has_phase)
+        NextRound(rounds_[round - 1], rounds_[round]);
+      current = rounds_[round];
+      if (current.phase == kDone) return false;
+      if (finished_.count(graph.get_gid())) return true;
+    }
+    LOG_INFO("IncEval() - Processing gid: ", graph.gid_,
+             current.phase == kForward ? " forward" : " backward",
+             " level: ", current.level);
+    BCState state = Acquire(graph);
+    size_t num_reached = 0;
+    if (current.phase == kForward)
+      num_reached = Forward(graph, task_runner, &state, current.level);
+    else
+      Backward(graph, task_runner, &state, current.level);
+    Report(graph, round, num_reached);
+    Release(graph);
+    return true;
+  }
+
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    return false;
+  }
+
+  // @brief: centrality of each vertex by global id, summed over the sources.
+  const std::vector<double>& GetCentrality() const { return bc_; }
+
+ private:
+  // @brief: phase and level of a round, given the one before.
+  void NextRound(const RoundInfo& prev, RoundInfo& current) {
+    current.has_phase = true;
+    if (prev.phase == kInit) {
+      current.phase = kForward;
+      current.level = 1;
+    } else if (prev.phase == kForward && prev.num_reached > 0) {
+      current.phase = kForward;
+      current.level = prev.level + 1;
+    } else if (prev.phase == kForward && prev.level > 2) {
+      current.phase = kBackward;
+      current.level = prev.level - 2;
+    } else if (prev.phase == kBackward && prev.level > 1) {
+      current.phase = kBackward;
+      current.level = prev.level - 1;
+    } else {
+      current.phase = kDone;
+    }
+  }
+
+  BCState Acquire(GRAPH_T& graph) {
+    BCState state;
+    state.num_lanes = this->context_.sources.size();
+    size_t num_vertexes = graph.get_num_vertexes();
+    state.dist = dist_state_.Acquire(graph.get_gid(), num_vertexes);
+    state.sigma = path_state_.Acquire(graph.get_gid(), num_vertexes);
+    if (state.dist == nullptr || state.sigma == nullptr)
+      LOG_FATAL("Acquire state of fragment ", graph.get_gid(), " failed");
+    state.delta = state.sigma + state.num_lanes * num_vertexes;
+    state.border_dist = border_dist_.data();
+    state.border_sigma = border_sigma_.data();
+    state.border_delta = border_delta_.data();
+    state.border_index = border_index_.data();
+    state.bc = bc_.data();
+    return state;
+  }
+
+  void Release(GRAPH_T& graph) {
+    dist_state_.Release(graph.get_gid(), graph.get_num_vertexes());
+    path_state_.Release(graph.get_gid(), graph.get_num_vertexes());
+  }
+
+  // @return: number of (vertex, source) pairs reached at level.
+  size_t Forward(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner,
+                 const BCState* state, const VDATA_T level) {
+    size_t num_reached = 0;
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               BCAutoMap_T::kernel_forward, state, level,
+                               &num_reached);
+    return num_reached;
+  }
+
+  void Backward(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner,
+                const BCState* state, const VDATA_T level) {
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               BCAutoMap_T::kernel_backward, state, level);
+  }
+
+  void Report(GRAPH_T& graph, const size_t round, const size_t num_reached) {
+    auto si = this->msg_mngr_->GetStatisticInfo();
+    if (si != nullptr) {
+      si[graph.get_gid()].inc_type = round > 0;
+      si[graph.get_gid()].num_iters = round;
+      si[graph.get_gid()].num_active_vertexes = num_reached;
+    }
+    std::lock_guard<std::mutex> lck(mtx_);
+    rounds_[round].num_reached += num_reached;
+  }
+
+  minigraph::utility::VertexState<GID_T, VDATA_T> dist_state_;
+  minigraph::utility::VertexState<GID_T, double> path_state_;
+
+  std::once_flag alloc_once_;
+  std::vector<VID_T> border_index_;
+  std::vector<VDATA_T> border_dist_;
+  std::vector<double> border_sigma_;
+  std::vector<double> border_delta_;
+  std::vector<double> bc_;
+
+  std::mutex mtx_;
+  std::unordered_set<GID_T> finished_;
+  std::unordered_map<GID_T, size_t> num_rounds_;
+  std::unordered_map<size_t, RoundInfo> rounds_;
+};
+
+struct Context {
+  std::vector<vid_t> sources;
+  std::string state_root;
+};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using BCPIE_T = BCPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  std::ifstream sources_file(FLAGS_sources);
+  vid_t source;
+  while (sources_file >> source) context.sources.push_back(source);
+  if (context.sources.empty()) context.sources.push_back(FLAGS_root);
+  context.state_root = FLAGS_state_dir;
+  auto bc_auto_map = new BCAutoMap<CSR_T, Context>();
+  auto bc_pie = new BCPIE<CSR_T, Context>(bc_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<BCPIE<CSR_T, Context>, CSR_T>(bc_pie);
+
+  minigraph::MiniGraphSys<CSR_T, BCPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+
+  auto& bc = bc_pie->GetCentrality();
+  auto max_bc = std::max_element(bc.begin(), bc.end());
+  if (max_bc != bc.end())
+    LOG_INFO("max centrality: ", *max_bc, " vid: ", max_bc - bc.begin());
+  if (!FLAGS_o.empty()) {
+    std::ofstream out_file(FLAGS_o, std::ios::out | std::ios::trunc);
+    if (!out_file) XLOG(ERR, "Open file failed: ", FLAGS_o);
+    for (size_t i = 0; i < bc.size(); i++)
+      out_file << i << "," << bc[i] << std::endl;
+  }
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/bitmap.h"
+#include "utility/lanes.h"
+#include "utility/logging.h"
+
+// Hop distances from a batch of K sources on edge-cut fragments. As in
+// ppr_batch_vc, the distances of a vertex to all sources are a row of K lanes
+// indexed by global id, and a vertex lowers its row to the rows of its
+// in-neighbors plus one in a single SIMD min per edge, so that a fragment load
+// advances all K traversals.
+template <typename GRAPH_T, typename CONTEXT_T>
+class BFSBatchAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+  using Lanes = minigraph::utility::LanesArray<VDATA_T>;
+
+ public:
+  BFSBatchAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  // @brief: lower the rows of vertexes in in_visited, and put their local
+  // out-neighbors into out_visited if any lane is lowered.
+  static void kernel_pull(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, Bitmap* in_visited,
+                          Bitmap* out_visited, VID_T* vid_map, Lanes* dist,
+                          bool* changed) {
+    size_t stride = dist->get_stride();
+    bool local_changed = false;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (!in_visited->get_bit(i)) continue;
+      auto u = graph->GetVertexByIndex(i);
+      VDATA_T* row = (*dist)[graph->localid2globalid(i)];
+      bool lowered = false;
+      for (size_t j = 0; j < u.indegree; j++)
+        lowered |= minigraph::utility::LaneMinPlus(row, (*dist)[u.in_edges[j]],
+                                                   1, stride);
+      if (!lowered) continue;
+      local_changed = true;
+      for (size_t j = 0; j < u.outdegree; j++)
+        if (graph->IsInGraph(u.out_edges[j]))
+          out_visited->set_bit(vid_map[u.out_edges[j]]);
+    }
+    if (local_changed) *changed = true;
+    return;
+  }
+};
+
+template <typename GRAPH_T, typename CONTEXT_T>
+class BFSBatchPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using BFSBatchAutoMap_T = BFSBatchAutoMap<GRAPH_T, CONTEXT_T>;
+  using Lanes = minigraph::utility::LanesArray<VDATA_T>;
+
+ public:
+  BFSBatchPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+              const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    std::call_once(alloc_once_, [this]() {
+      dist_ = std::make_unique<Lanes>(this->msg_mngr_->get_max_vid() + 1,
+                                      this->context_.sources.size(),
+                                      VDATA_MAX);
+    });
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_,
+             " #queries: ", this->context_.sources.size());
+    for (size_t k = 0; k < this->context_.sources.size(); k++)
+      if (graph.IsInGraph(this->context_.sources[k]))
+        (*dist_)[this->context_.sources[k]][k] = 0;
+    Pull(graph, task_runner);
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("IncEval() - Processing gid: ", graph.gid_);
+    return Pull(graph, task_runner);
+  }
+
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    return false;
+  }
+
+  Lanes* GetDistances() { return dist_.get(); }
+
+ private:
+  // @return: whether any distance is lowered.
+  bool Pull(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner) {
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    in_visited->fill();
+    out_visited->clear();
+
+    bool changed = false;
+    while (!in_visited->empty()) {
+      this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                                 BFSBatchAutoMap_T::kernel_pull, in_visited,
+                                 out_visited, this->msg_mngr_->GetVidMap(),
+                                 dist_.get(), &changed);
+      std::swap(in_visited, out_visited);
+      out_visited->clear();
+    }
+
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    return changed;
+  }
+
+  std::once_flag alloc_once_;
+  std::unique_ptr<Lanes> dist_;
+};
+
+struct Context {
+  std::vector<vid_t> sources;
+};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using BFSBatchPIE_T = BFSBatchPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  std::ifstream sources_file(FLAGS_sources);
+  vid_t source;
+  while (sources_file >> source) context.sources.push_back(source);
+  if (context.sources.empty()) context.sources.push_back(FLAGS_root);
+  auto bfs_auto_map = new BFSBatchAutoMap<CSR_T, Context>();
+  auto bfs_pie = new BFSBatchPIE<CSR_T, Context>(bfs_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<BFSBatchPIE<CSR_T, Context>, CSR_T>(bfs_pie);
+
+  minigraph::MiniGraphSys<CSR_T, BFSBatchPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+
+  auto dist = bfs_pie->GetDistances();
+  for (size_t k = 0; k < context.sources.size(); k++) {
+    size_t num_reached = 0;
+    vdata_t depth = 0;
+    for (size_t i = 0; i < dist->get_num_vertexes(); i++) {
+      if (dist->operator[](i)[k] == VDATA_MAX) continue;
+      num_reached++;
+      depth = std::max(depth, dist->operator[](i)[k]);
+    }
+    LOG_INFO("source: ", context.sources[k], " #reached: ", num_reached,
+             " depth: ", depth);
+  }
+  if (!FLAGS_o.empty()) dist->Write(FLAGS_o);
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
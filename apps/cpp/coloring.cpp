@@ -77,6 +77,8 @@ class ColoringPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
               const CONTEXT_T& context)
       : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
 
+  bool IsCheckpointable() const override { return true; }
+
   bool Init(GRAPH_T& graph,
             minigraph::executors::TaskRunner* task_runner) override {
     LOG_INFO("Init()", graph.get_gid());
@@ -100,19 +102,21 @@ class ColoringPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
              " num_vertexes: ", graph.get_num_vertexes());
 
     auto start_time = std::chrono::system_clock::now();
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap visited(graph.get_num_vertexes());
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
     in_visited->fill();
     out_visited->clear();
-    visited.clear();
+    visited->clear();
 
     typename GRAPH_T::vid_t local_upper_bound = 0;
     size_t count = 0;
     while (!in_visited->empty()) {
       in_visited->fill();
       this->auto_map_->ActiveMap(
-          graph, task_runner, &visited,
+          graph, task_runner, visited,
           ColoringAutoMap<GRAPH_T, CONTEXT_T>::kernel_update,
           this->msg_mngr_->GetGlobalVdata(), out_visited, local_upper_bound,
           this->context_.upper_bound);
@@ -133,26 +137,29 @@ class ColoringPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
                                                                    start_time)
                      .count() /
                  (double)CLOCKS_PER_SEC);
-    delete in_visited;
-    delete out_visited;
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
   bool IncEval(GRAPH_T& graph,
                minigraph::executors::TaskRunner* task_runner) override {
     LOG_INFO("IncEval: ", graph.get_gid());
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap visited(graph.get_num_vertexes());
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
     in_visited->fill();
     out_visited->clear();
-    visited.clear();
+    visited->clear();
 
     typename GRAPH_T::vid_t local_upper_bound = 0;
     while (!in_visited->empty()) {
       LOG_INFO(in_visited->get_num_bit());
       this->auto_map_->ActiveMap(
-          graph, task_runner, &visited,
+          graph, task_runner, visited,
           ColoringAutoMap<GRAPH_T, CONTEXT_T>::kernel_update,
           this->msg_mngr_->GetGlobalVdata(), out_visited, local_upper_bound,
           this->context_.upper_bound);
@@ -168,9 +175,11 @@ class ColoringPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
       this->context_.inc_vote = 0;
       this->context_.sync_bound = 0;
     }
-    delete in_visited;
-    delete out_visited;
-    return !visited.empty();
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    bool is_active = !visited->empty();
+    scratch_arena->ReleaseBitmap(visited);
+    return is_active;
   }
 
   bool Aggregate(void* a, void* b,
@@ -212,6 +221,8 @@ int main(int argc, char* argv[]) {
   minigraph::MiniGraphSys<CSR_T, ColoringPIE_T> minigraph_sys(
       work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
       buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
   minigraph_sys.RunSys();
   gflags::ShutDownCommandLineFlags();
   exit(0);
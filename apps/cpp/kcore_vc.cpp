@@ -0,0 +1,373 @@
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+
+// k-core decomposition on edge-cut fragments by peeling. Edges are taken as
+// undirected. At level k, vertexes whose remaining degree is at most k are
+// removed with coreness k, which lowers the degree of their neighbors and may
+// remove them in turn. All fragments peel the same level: removals of
+// neighbors owned by other fragments are sent to their owners as degree
+// decrements, combined by sum in the message manager, and the level only
+// advances after a superstep in which no decrement was sent. Empty levels are
+// skipped by jumping to the minimum remaining degree.
+// A vertex that is not removed yet has VDATA_MAX in the global vdata and its
+// remaining degree in vdata, afterwards both hold its coreness.
+template <typename GRAPH_T, typename CONTEXT_T>
+class KCoreAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+  using MSG_MNGR_T = minigraph::message::DefaultMessageManager<GRAPH_T>;
+
+ public:
+  KCoreAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  // @brief: call f on each undirected neighbor of u, i.e. the union of its
+  // sorted in_edges and out_edges without self loops.
+  template <typename FUNC_T>
+  static void ForEachNbr(const VertexInfo& u, const VID_T globalid,
+                         FUNC_T&& f) {
+    size_t i = 0, j = 0;
+    VID_T last = VID_MAX;
+    while (i < u.indegree || j < u.outdegree) {
+      VID_T nbr;
+      if (j == u.outdegree ||
+          (i < u.indegree && u.in_edges[i] < u.out_edges[j]))
+        nbr = u.in_edges[i++];
+      else
+        nbr = u.out_edges[j++];
+      if (nbr == last || nbr == globalid) continue;
+      last = nbr;
+      f(nbr);
+    }
+  }
+
+  static void kernel_init(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step)
+      graph->vdata_[i] = 0;
+    return;
+  }
+
+  static void kernel_degree(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, size_t* num_border_edges) {
+    size_t local_num_border_edges = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      VDATA_T degree = 0;
+      ForEachNbr(u, graph->localid2globalid(i), [&](VID_T nbr) {
+        ++degree;
+        if (!graph->IsInGraph(nbr)) ++local_num_border_edges;
+      });
+      graph->vdata_[i] = degree;
+    }
+    write_add(num_border_edges, local_num_border_edges);
+    return;
+  }
+
+  // @brief: apply decrements sent by other fragments to border vertexes.
+  static void kernel_receive(GRAPH_T* graph, const size_t tid,
+                             Bitmap* visited, const size_t step,
+                             VDATA_T* global_vdata, MSG_MNGR_T* msg_mngr) {
+    Bitmap* global_border_vid_map = msg_mngr->GetGlobalBorderVidMap();
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VID_T globalid = graph->localid2globalid(i);
+      if (!global_border_vid_map->get_bit(globalid)) continue;
+      VDATA_T delta = msg_mngr->TakeBorderMessage(globalid);
+      if (delta == 0 || global_vdata[globalid] != VDATA_MAX) continue;
+      graph->vdata_[i] =
+          graph->vdata_[i] > delta ? graph->vdata_[i] - delta : 0;
+    }
+    return;
+  }
+
+  static void kernel_collect(GRAPH_T* graph, const size_t tid,
+                             Bitmap* visited, const size_t step,
+                             const VDATA_T level, VDATA_T* global_vdata,
+                             std::vector<VID_T>* frontier) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (global_vdata[graph->localid2globalid(i)] != VDATA_MAX) continue;
+      if (graph->vdata_[i] <= level) frontier[tid].push_back(i);
+    }
+    return;
+  }
+
+  // @brief: remove vertexes of frontier with coreness level. Local neighbors
+  // whose degree drops to level go to next[tid], remote ones get a message.
+  static void kernel_peel(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, const VID_T* frontier,
+                          const size_t frontier_size, const VDATA_T level,
+                          VDATA_T* global_vdata, MSG_MNGR_T* msg_mngr,
+                          std::vector<VID_T>* next, size_t* num_messages) {
+    size_t local_num_messages = 0;
+    for (size_t k = tid; k < frontier_size; k += step) {
+      auto u = graph->GetVertexByIndex(frontier[k]);
+      VID_T globalid = graph->localid2globalid(frontier[k]);
+      global_vdata[globalid] = level;
+      ForEachNbr(u, globalid, [&](VID_T nbr) {
+        if (global_vdata[nbr] != VDATA_MAX) return;
+        if (graph->IsInGraph(nbr)) {
+          VID_T j = graph->globalid2localid(nbr);
+          if (__sync_fetch_and_sub(graph->vdata_ + j, 1) == level + 1)
+            next[tid].push_back(j);
+        } else {
+          msg_mngr->AddBorderMessage(nbr, 1);
+          ++local_num_messages;
+        }
+      });
+    }
+    write_add(num_messages, local_num_messages);
+    return;
+  }
+
+  // @brief: store the coreness of removed vertexes in vdata, and count the
+  // remaining ones and their minimum degree.
+  static void kernel_finalize(GRAPH_T* graph, const size_t tid,
+                              Bitmap* visited, const size_t step,
+                              VDATA_T* global_vdata, size_t* num_remaining,
+                              VDATA_T* min_degree) {
+    size_t local_num_remaining = 0;
+    VDATA_T local_min_degree = VDATA_MAX;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VDATA_T coreness = global_vdata[graph->localid2globalid(i)];
+      if (coreness != VDATA_MAX) {
+        graph->vdata_[i] = coreness;
+      } else {
+        ++local_num_remaining;
+        local_min_degree = std::min(local_min_degree, graph->vdata_[i]);
+      }
+    }
+    write_add(num_remaining, local_num_remaining);
+    write_min(min_degree, local_min_degree);
+    return;
+  }
+};
+
+// Supersteps of a fragment:
+//   PEval: compute degrees and remove isolated vertexes. A fragment without
+//     border vertexes peels all levels at once.
+//   IncEval: apply decrements received, then peel the current level.
+// All fragments return true until a superstep ends with no vertex left and
+// no decrement sent, so that every fragment takes part in every superstep.
+template <typename GRAPH_T, typename CONTEXT_T>
+class KCorePIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using KCoreAutoMap_T = KCoreAutoMap<GRAPH_T, CONTEXT_T>;
+
+  // Progress of peeling in a fragment or, summed up, in a superstep.
+  struct PeelInfo {
+    size_t num_peeled = 0;
+    size_t num_messages = 0;
+    size_t num_remaining = 0;
+    VDATA_T min_degree = VDATA_MAX;
+  };
+
+  struct RoundInfo {
+    bool has_level = false;
+    VDATA_T level = 0;
+    PeelInfo peel_info;
+  };
+
+ public:
+  KCorePIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+           const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    if (!graph.IsSorted()) graph.Sort(task_runner->GetParallelism());
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               KCoreAutoMap_T::kernel_init);
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_,
+             " num_vertexes: ", graph.get_num_vertexes());
+    size_t num_border_edges = 0;
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               KCoreAutoMap_T::kernel_degree,
+                               &num_border_edges);
+
+    VDATA_T level = 0;
+    PeelInfo peel_info = Peel(graph, task_runner, level);
+    while (num_border_edges == 0 && peel_info.num_remaining > 0) {
+      Report(graph, 0, level, peel_info);
+      level = std::max((VDATA_T)(level + 1), peel_info.min_degree);
+      peel_info = Peel(graph, task_runner, level);
+    }
+    Report(graph, 0, level, peel_info);
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    size_t round = 0;
+    VDATA_T level = 0;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      round = ++num_rounds_[graph.get_gid()];
+      auto& prev = rounds_[round - 1];
+      if (prev.peel_info.num_remaining == 0 && prev.peel_info.num_messages == 0)
+        return false;
+      auto& current = rounds_[round];
+      if (!current.has_level) {
+        current.level = prev.level;
+        if (prev.peel_info.num_messages == 0)
+          current.level = std::max((VDATA_T)(prev.level + 1),
+                                   prev.peel_info.min_degree);
+        current.has_level = true;
+      }
+      level = current.level;
+      if (num_remaining_[graph.get_gid()] == 0) return true;
+    }
+
+    auto global_vdata = this->msg_mngr_->GetGlobalVdata();
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               KCoreAutoMap_T::kernel_receive, global_vdata,
+                               this->msg_mngr_);
+    Report(graph, round, level, Peel(graph, task_runner, level));
+    return true;
+  }
+
+  // @brief: keep the maximum of the corenesses a and b in a.
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    if (a == nullptr || b == nullptr) return false;
+    write_max((VDATA_T*)a, *(VDATA_T*)b);
+    return true;
+  }
+
+  VDATA_T GetMaxCoreness() const { return max_coreness_; }
+
+ private:
+  // @brief: remove vertexes of the fragment at level until all remaining
+  // ones have a degree higher than level.
+  PeelInfo Peel(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner,
+                const VDATA_T level) {
+    auto global_vdata = this->msg_mngr_->GetGlobalVdata();
+    std::vector<std::vector<VID_T>> next(task_runner->GetParallelism());
+    std::vector<VID_T> frontier;
+    PeelInfo peel_info;
+
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               KCoreAutoMap_T::kernel_collect, level,
+                               global_vdata, next.data());
+    Gather(next, frontier);
+    while (!frontier.empty()) {
+      peel_info.num_peeled += frontier.size();
+      this->auto_map_->ActiveMap(
+          graph, task_runner, nullptr, KCoreAutoMap_T::kernel_peel,
+          frontier.data(), frontier.size(), level, global_vdata,
+          this->msg_mngr_, next.data(), &peel_info.num_messages);
+      Gather(next, frontier);
+    }
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               KCoreAutoMap_T::kernel_finalize, global_vdata,
+                               &peel_info.num_remaining,
+                               &peel_info.min_degree);
+    if (peel_info.num_peeled > 0) {
+      VDATA_T coreness = level;
+      Aggregate(&max_coreness_, &coreness, task_runner);
+    }
+    return peel_info;
+  }
+
+  void Gather(std::vector<std::vector<VID_T>>& next,
+              std::vector<VID_T>& frontier) {
+    frontier.clear();
+    for (auto& vertexes : next) {
+      frontier.insert(frontier.end(), vertexes.begin(), vertexes.end());
+      vertexes.clear();
+    }
+  }
+
+  // @brief: add the progress of a fragment to its superstep, and to the
+  // statistic information of the fragment.
+  void Report(GRAPH_T& graph, const size_t round, const VDATA_T level,
+              const PeelInfo& peel_info) {
+    LOG_INFO("GID: ", graph.get_gid(), " level: ", level,
+             " #peeled: ", peel_info.num_peeled,
+             " #remaining: ", peel_info.num_remaining);
+    auto si = this->msg_mngr_->GetStatisticInfo();
+    if (si != nullptr) {
+      si[graph.get_gid()].inc_type = round > 0;
+      si[graph.get_gid()].num_iters = round;
+      si[graph.get_gid()].current_iter = level;
+      si[graph.get_gid()].num_active_vertexes = peel_info.num_remaining;
+    }
+
+    std::lock_guard<std::mutex> lck(mtx_);
+    num_remaining_[graph.get_gid()] = peel_info.num_remaining;
+    auto& total = rounds_[round].peel_info;
+    total.num_peeled += peel_info.num_peeled;
+    total.num_messages += peel_info.num_messages;
+    total.num_remaining += peel_info.num_remaining;
+    total.min_degree = std::min(total.min_degree, peel_info.min_degree);
+  }
+
+  VDATA_T max_coreness_ = 0;
+
+  std::mutex mtx_;
+  std::unordered_map<GID_T, size_t> num_rounds_;
+  std::unordered_map<GID_T, size_t> num_remaining_;
+  std::unordered_map<size_t, RoundInfo> rounds_;
+};
+
+struct Context {};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using KCorePIE_T = KCorePIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  auto kcore_auto_map = new KCoreAutoMap<CSR_T, Context>();
+  auto kcore_pie = new KCorePIE<CSR_T, Context>(kcore_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<KCorePIE<CSR_T, Context>, CSR_T>(kcore_pie);
+
+  minigraph::MiniGraphSys<CSR_T, KCorePIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+  LOG_INFO("max coreness: ", kcore_pie->GetMaxCoreness());
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/atomic.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+
+// @brief: LabelCounter counts labels with open addressing and linear probing.
+// It is reused across vertexes: Reset() only clears the slots used by the
+// previous vertex, and the table only grows.
+template <typename T>
+class LabelCounter {
+ public:
+  // @brief: prepare for at most n labels.
+  void Reset(const size_t n) {
+    size_t capacity = 16;
+    while (capacity < 2 * n) capacity <<= 1;
+    if (capacity > keys_.size()) {
+      keys_.assign(capacity, kEmpty);
+      counts_.assign(capacity, 0);
+    } else {
+      for (auto slot : used_) {
+        keys_[slot] = kEmpty;
+        counts_[slot] = 0;
+      }
+    }
+    used_.clear();
+    mask_ = keys_.size() - 1;
+  }
+
+  // @return: count of label after adding it once.
+  size_t Add(const T label) {
+    size_t slot = Find(label);
+    if (keys_[slot] == kEmpty) {
+      keys_[slot] = label;
+      used_.push_back(slot);
+    }
+    return ++counts_[slot];
+  }
+
+  size_t Count(const T label) const { return counts_[Find(label)]; }
+
+ private:
+  size_t Find(const T label) const {
+    size_t slot = ((uint64_t)label * 0x9E3779B97F4A7C15ULL >> 32) & mask_;
+    while (keys_[slot] != kEmpty && keys_[slot] != label)
+      slot = (slot + 1) & mask_;
+    return slot;
+  }
+
+  static constexpr T kEmpty = (T)-1;
+
+  std::vector<T> keys_;
+  std::vector<size_t> counts_;
+  std::vector<size_t> used_;
+  size_t mask_ = 0;
+};
+
+// Label propagation (LPA) community detection on edge-cut fragments. Every
+// vertex starts with its global id as label, then repeatedly takes the label
+// most frequent among its neighbors, edges taken as undirected. Ties keep the
+// current label if it is among the most frequent, otherwise they go to the
+// smallest label. Labels of all vertexes are read from arrays by global id,
+// so labels of border vertexes owned by other fragments come from there:
+//   async: labels are updated in place in the global vdata, and a fragment
+//     sweeps its vertexes until they are stable or up to inner_niters times.
+//   sync: labels of a superstep are computed from those of the superstep
+//     before, kept in two arrays that swap every superstep, and all
+//     fragments sweep once per superstep.
+template <typename GRAPH_T, typename CONTEXT_T>
+class LPAAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+
+ public:
+  LPAAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  static void kernel_border(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, size_t* num_border_edges) {
+    size_t local_num_border_edges = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.indegree; j++)
+        if (!graph->IsInGraph(u.in_edges[j])) ++local_num_border_edges;
+      for (size_t j = 0; j < u.outdegree; j++)
+        if (!graph->IsInGraph(u.out_edges[j])) ++local_num_border_edges;
+    }
+    write_add(num_border_edges, local_num_border_edges);
+    return;
+  }
+
+  static void kernel_init(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, VDATA_T* global_vdata) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VID_T globalid = graph->localid2globalid(i);
+      graph->vdata_[i] = globalid;
+      global_vdata[globalid] = globalid;
+    }
+    return;
+  }
+
+  // @brief: relabel all vertexes of the fragment once from in_labels into
+  // out_labels, vdata and the global vdata. Labels VDATA_MAX are not set yet
+  // and ignored.
+  static void kernel_sweep(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                           const size_t step, const VDATA_T* in_labels,
+                           VDATA_T* out_labels, VDATA_T* global_vdata,
+                           size_t* num_changed) {
+    LabelCounter<VDATA_T> counter;
+    size_t local_num_changed = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      VID_T globalid = graph->localid2globalid(i);
+      VDATA_T label = in_labels[globalid];
+      VDATA_T best = VDATA_MAX;
+      size_t best_count = 0;
+      counter.Reset(u.indegree + u.outdegree);
+      auto count = [&](const VID_T nbr) {
+        if (nbr == globalid || in_labels[nbr] == VDATA_MAX) return;
+        VDATA_T nbr_label = in_labels[nbr];
+        size_t c = counter.Add(nbr_label);
+        if (c > best_count || (c == best_count && nbr_label < best)) {
+          best = nbr_label;
+          best_count = c;
+        }
+      };
+      for (size_t j = 0; j < u.indegree; j++) count(u.in_edges[j]);
+      for (size_t j = 0; j < u.outdegree; j++) count(u.out_edges[j]);
+      if (best_count > 0 && counter.Count(label) < best_count) {
+        label = best;
+        ++local_num_changed;
+      }
+      out_labels[globalid] = label;
+      global_vdata[globalid] = label;
+      graph->vdata_[i] = label;
+    }
+    write_add(num_changed, local_num_changed);
+    return;
+  }
+};
+
+// Supersteps of a fragment:
+//   async: PEval labels its vertexes and sweeps them, IncEval sweeps them
+//     again, both until no label changes or up to inner_niters sweeps. A
+//     fragment returns whether any of its labels changed.
+//   sync: one sweep per superstep. All fragments return true until a
+//     superstep in which no label changed, so that every fragment takes part
+//     in every superstep.
+// A fragment without border edges sweeps in PEval until its labels are
+// stable, or up to max_iter sweeps since synchronous labels may oscillate.
+template <typename GRAPH_T, typename CONTEXT_T>
+class LPAPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using LPAAutoMap_T = LPAAutoMap<GRAPH_T, CONTEXT_T>;
+
+ public:
+  LPAPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+         const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    if (!this->context_.sync) return true;
+    std::call_once(alloc_once_, [this]() {
+      size_t num_vertexes = this->msg_mngr_->get_max_vid() + 1;
+      for (auto& labels : labels_) {
+        labels.resize(num_vertexes);
+        for (size_t i = 0; i < num_vertexes; i++) labels[i] = i;
+      }
+    });
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_);
+    size_t num_border_edges = 0;
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               LPAAutoMap_T::kernel_border, &num_border_edges);
+    size_t num_changed = 0;
+    if (this->context_.sync) {
+      num_changed = Sweep(graph, task_runner, 0);
+      for (size_t round = 1; num_border_edges == 0 && num_changed > 0 &&
+                             round < this->context_.max_iter;
+           round++)
+        num_changed = Sweep(graph, task_runner, round);
+    } else {
+      this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                                 LPAAutoMap_T::kernel_init,
+                                 this->msg_mngr_->GetGlobalVdata());
+      num_changed = SweepInPlace(graph, task_runner,
+                                 num_border_edges == 0
+                                     ? this->context_.max_iter
+                                     : this->context_.num_iter);
+    }
+    if (num_border_edges == 0) {
+      std::lock_guard<std::mutex> lck(mtx_);
+      finished_.insert(graph.get_gid());
+      num_changed = 0;
+    }
+    Report(graph, 0, num_changed);
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    size_t round = 0;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      round = ++num_rounds_[graph.get_gid()];
+      if (this->context_.sync && num_changed_[round - 1] == 0) return false;
+      if (finished_.count(graph.get_gid())) return this->context_.sync;
+    }
+    LOG_INFO("IncEval() - Processing gid: ", graph.gid_, " round: ", round);
+    size_t num_changed =
+        this->context_.sync
+            ? Sweep(graph, task_runner, round)
+            : SweepInPlace(graph, task_runner, this->context_.num_iter);
+    Report(graph, round, num_changed);
+    return this->context_.sync || num_changed > 0;
+  }
+
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    return false;
+  }
+
+ private:
+  // @return: number of labels changed by the sweep of round.
+  size_t Sweep(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner,
+               const size_t round) {
+    size_t num_changed = 0;
+    this->auto_map_->ActiveMap(
+        graph, task_runner, nullptr, LPAAutoMap_T::kernel_sweep,
+        labels_[round % 2].data(), labels_[(round + 1) % 2].data(),
+        this->msg_mngr_->GetGlobalVdata(), &num_changed);
+    return num_changed;
+  }
+
+  // @return: number of labels changed by all sweeps.
+  size_t SweepInPlace(GRAPH_T& graph,
+                      minigraph::executors::TaskRunner* task_runner,
+                      const size_t num_iter) {
+    auto global_vdata = this->msg_mngr_->GetGlobalVdata();
+    size_t num_changed = 0;
+    for (size_t iter = 0; iter < num_iter; iter++) {
+      size_t num_changed_iter = 0;
+      this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                                 LPAAutoMap_T::kernel_sweep, global_vdata,
+                                 global_vdata, global_vdata,
+                                 &num_changed_iter);
+      num_changed += num_changed_iter;
+      if (num_changed_iter == 0) break;
+    }
+    return num_changed;
+  }
+
+  // @brief: report the labels changed by a fragment in a superstep, together
+  // with those changed so far by all fragments in the superstep.
+  void Report(GRAPH_T& graph, const size_t round, const size_t num_changed) {
+    auto si = this->msg_mngr_->GetStatisticInfo();
+    if (si != nullptr) {
+      si[graph.get_gid()].inc_type = round > 0;
+      si[graph.get_gid()].num_iters = round;
+      si[graph.get_gid()].num_active_vertexes = num_changed;
+    }
+    std::lock_guard<std::mutex> lck(mtx_);
+    num_changed_[round] += num_changed;
+    LOG_INFO("GID: ", graph.get_gid(), " round: ", round,
+             " #changed: ", num_changed,
+             " #changed in round: ", num_changed_[round]);
+  }
+
+  std::once_flag alloc_once_;
+  std::vector<VDATA_T> labels_[2];
+
+  std::mutex mtx_;
+  std::unordered_set<GID_T> finished_;
+  std::unordered_map<GID_T, size_t> num_rounds_;
+  std::unordered_map<size_t, size_t> num_changed_;
+};
+
+struct Context {
+  bool sync = false;
+  size_t num_iter = 4;
+  size_t max_iter = 50;
+};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using LPAPIE_T = LPAPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  context.sync = FLAGS_sync;
+  context.num_iter = FLAGS_inner_niters;
+  context.max_iter = FLAGS_niters;
+  auto lpa_auto_map = new LPAAutoMap<CSR_T, Context>();
+  auto lpa_pie = new LPAPIE<CSR_T, Context>(lpa_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<LPAPIE<CSR_T, Context>, CSR_T>(lpa_pie);
+
+  minigraph::MiniGraphSys<CSR_T, LPAPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+
+  auto global_vdata = lpa_pie->msg_mngr_->GetGlobalVdata();
+  std::unordered_set<vdata_t> communities;
+  for (size_t i = 0; i <= lpa_pie->msg_mngr_->get_max_vid(); i++)
+    if (global_vdata[i] != VDATA_MAX) communities.insert(global_vdata[i]);
+  LOG_INFO("#communities: ", communities.size());
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/atomic.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+
+// Bit-parallel multi-source BFS (MS-BFS) on edge-cut fragments. Bit k of the
+// mask of a vertex stands for the k-th of K sources, and masks are rows of
+// ceil(K / 64) words indexed by global id:
+//   seen: sources that have reached the vertex,
+//   frontier[0], frontier[1]: sources that reach the vertex at the current
+//     and at the next level, swapped every level.
+// Expanding a vertex ORs its new bits into the next frontier of its
+// out-neighbors, local or owned by other fragments alike, so that one pass
+// over the edges advances all K traversals by one level. All fragments
+// expand the same level in a superstep, thus the level at which a bit is
+// first seen is the distance from its source.
+template <typename GRAPH_T, typename CONTEXT_T>
+class MSBFSAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+
+ public:
+  MSBFSAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  static void kernel_border(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, size_t* num_border_edges) {
+    size_t local_num_border_edges = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.indegree; j++)
+        if (!graph->IsInGraph(u.in_edges[j])) ++local_num_border_edges;
+      for (size_t j = 0; j < u.outdegree; j++)
+        if (!graph->IsInGraph(u.out_edges[j])) ++local_num_border_edges;
+    }
+    write_add(num_border_edges, local_num_border_edges);
+    return;
+  }
+
+  // @brief: expand the vertexes of the fragment at level. Bits of in that
+  // are not seen yet are marked as seen, counted into the distance sums of
+  // their sources and ORed into out of the out-neighbors. in is cleared.
+  static void kernel_expand(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, const size_t num_words,
+                            uint64_t* seen, uint64_t* in, uint64_t* out,
+                            const size_t level, size_t* num_reached,
+                            size_t* sum_distances, size_t* num_visited,
+                            size_t* num_writes) {
+    std::vector<uint64_t> bits(num_words);
+    std::vector<size_t> local_num_reached(num_words * 64, 0);
+    size_t local_num_visited = 0;
+    size_t local_num_writes = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VID_T globalid = graph->localid2globalid(i);
+      uint64_t* in_row = in + num_words * globalid;
+      uint64_t* seen_row = seen + num_words * globalid;
+      uint64_t any = 0;
+      for (size_t j = 0; j < num_words; j++) {
+        bits[j] = in_row[j] & ~seen_row[j];
+        seen_row[j] |= bits[j];
+        in_row[j] = 0;
+        any |= bits[j];
+      }
+      if (any == 0) continue;
+
+      for (size_t j = 0; j < num_words; j++) {
+        for (uint64_t w = bits[j]; w != 0; w &= w - 1)
+          ++local_num_reached[j * 64 + __builtin_ctzll(w)];
+        local_num_visited += __builtin_popcountll(bits[j]);
+      }
+
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t e = 0; e < u.outdegree; e++) {
+        uint64_t* nbr_seen = seen + num_words * u.out_edges[e];
+        uint64_t* nbr_out = out + num_words * u.out_edges[e];
+        for (size_t j = 0; j < num_words; j++) {
+          uint64_t delta = bits[j] & ~nbr_seen[j];
+          if ((nbr_out[j] & delta) == delta) continue;
+          __sync_fetch_and_or(nbr_out + j, delta);
+          ++local_num_writes;
+        }
+      }
+    }
+    for (size_t k = 0; k < local_num_reached.size(); k++) {
+      if (local_num_reached[k] == 0) continue;
+      write_add(num_reached + k, local_num_reached[k]);
+      write_add(sum_distances + k, local_num_reached[k] * level);
+    }
+    write_add(num_visited, local_num_visited);
+    write_add(num_writes, local_num_writes);
+    return;
+  }
+};
+
+// Supersteps of a fragment:
+//   PEval: set the bits of its sources and expand level 0. A fragment
+//     without border edges expands all levels at once.
+//   IncEval: expand the level of the superstep.
+// All fragments return true until a superstep in which no bit is written,
+// so that every fragment takes part in every superstep.
+template <typename GRAPH_T, typename CONTEXT_T>
+class MSBFSPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using MSBFSAutoMap_T = MSBFSAutoMap<GRAPH_T, CONTEXT_T>;
+
+ public:
+  MSBFSPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+           const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {
+    num_words_ = (context.sources.size() + 63) / 64;
+    num_reached_.resize(context.sources.size(), 0);
+    sum_distances_.resize(context.sources.size(), 0);
+  }
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    std::call_once(alloc_once_, [this]() {
+      size_t size = num_words_ * (this->msg_mngr_->get_max_vid() + 1);
+      seen_.resize(size, 0);
+      frontier_[0].resize(size, 0);
+      frontier_[1].resize(size, 0);
+    });
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_,
+             " #sources: ", this->context_.sources.size());
+    for (size_t k = 0; k < this->context_.sources.size(); k++) {
+      VID_T source = this->context_.sources[k];
+      if (graph.IsInGraph(source))
+        frontier_[0][num_words_ * source + k / 64] |= (uint64_t)1 << (k % 64);
+    }
+    size_t num_border_edges = 0;
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               MSBFSAutoMap_T::kernel_border,
+                               &num_border_edges);
+
+    size_t level = 0;
+    size_t num_writes = Expand(graph, task_runner, level);
+    while (num_border_edges == 0 && num_writes > 0)
+      num_writes = Expand(graph, task_runner, ++level);
+    Report(graph, 0, num_writes);
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    size_t round = 0;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      round = ++num_rounds_[graph.get_gid()];
+      if (num_writes_[round - 1] == 0) return false;
+    }
+    LOG_INFO("IncEval() - Processing gid: ", graph.gid_, " level: ", round);
+    Report(graph, round, Expand(graph, task_runner, round));
+    return true;
+  }
+
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    return false;
+  }
+
+  // @brief: number of vertexes reached from each source, the source included.
+  const std::vector<size_t>& GetNumReached() const { return num_reached_; }
+
+  // @brief: sum of distances from each source to the vertexes it reaches.
+  const std::vector<size_t>& GetSumDistances() const {
+    return sum_distances_;
+  }
+
+  // @brief: number of (source, vertex) pairs at each distance.
+  const std::map<size_t, size_t>& GetHopCounts() const { return hop_counts_; }
+
+ private:
+  // @return: number of words written to the next frontier.
+  size_t Expand(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner,
+                const size_t level) {
+    size_t num_visited = 0, num_writes = 0;
+    this->auto_map_->ActiveMap(
+        graph, task_runner, nullptr, MSBFSAutoMap_T::kernel_expand,
+        num_words_, seen_.data(), frontier_[level % 2].data(),
+        frontier_[(level + 1) % 2].data(), level, num_reached_.data(),
+        sum_distances_.data(), &num_visited, &num_writes);
+    if (num_visited > 0) {
+      std::lock_guard<std::mutex> lck(mtx_);
+      hop_counts_[level] += num_visited;
+    }
+    return num_writes;
+  }
+
+  void Report(GRAPH_T& graph, const size_t round, const size_t num_writes) {
+    auto si = this->msg_mngr_->GetStatisticInfo();
+    if (si != nullptr) {
+      si[graph.get_gid()].inc_type = round > 0;
+      si[graph.get_gid()].num_iters = round;
+      si[graph.get_gid()].num_active_vertexes = num_writes;
+    }
+    std::lock_guard<std::mutex> lck(mtx_);
+    num_writes_[round] += num_writes;
+  }
+
+  size_t num_words_ = 0;
+
+  std::once_flag alloc_once_;
+  std::vector<uint64_t> seen_;
+  std::vector<uint64_t> frontier_[2];
+
+  std::vector<size_t> num_reached_;
+  std::vector<size_t> sum_distances_;
+
+  std::mutex mtx_;
+  std::map<size_t, size_t> hop_counts_;
+  std::unordered_map<GID_T, size_t> num_rounds_;
+  std::unordered_map<size_t, size_t> num_writes_;
+};
+
+struct Context {
+  std::vector<vid_t> sources;
+};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using MSBFSPIE_T = MSBFSPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  std::ifstream sources_file(FLAGS_sources);
+  vid_t source;
+  while (sources_file >> source) context.sources.push_back(source);
+  if (context.sources.empty()) context.sources.push_back(FLAGS_root);
+  auto msbfs_auto_map = new MSBFSAutoMap<CSR_T, Context>();
+  auto msbfs_pie = new MSBFSPIE<CSR_T, Context>(msbfs_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<MSBFSPIE<CSR_T, Context>, CSR_T>(msbfs_pie);
+
+  minigraph::MiniGraphSys<CSR_T, MSBFSPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+
+  for (auto& iter : msbfs_pie->GetHopCounts())
+    LOG_INFO("distance: ", iter.first, " #pairs: ", iter.second);
+  if (!FLAGS_o.empty()) {
+    std::ofstream out_file(FLAGS_o, std::ios::out | std::ios::trunc);
+    if (!out_file) XLOG(ERR, "Open file failed: ", FLAGS_o);
+    auto& num_reached = msbfs_pie->GetNumReached();
+    auto& sum_distances = msbfs_pie->GetSumDistances();
+    for (size_t k = 0; k < context.sources.size(); k++) {
+      double closeness =
+          sum_distances[k] == 0
+              ? 0
+              : (double)(num_reached[k] - 1) / sum_distances[k];
+      out_file << context.sources[k] << "," << num_reached[k] << ","
+               << sum_distances[k] << "," << closeness << std::endl;
+    }
+  }
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/atomic.h"
+#include "utility/bitmap.h"
+#include "utility/lanes.h"
+#include "utility/logging.h"
+
+// Personalized PageRank of a batch of K sources on edge-cut fragments. The
+// scores of a vertex for all sources are a row of K lanes, so that a fragment
+// load and each pass over its edges serve the whole batch, and rows are
+// combined with SIMD. Vertexes pull the scores of their in-neighbors:
+//   x(v) = alpha * [v == s] + (1 - alpha) * sum_{u -> v} x(u) / outdeg(u),
+// where scores and out-degrees of vertexes of other fragments are read from
+// arrays indexed by global id. Scores of vertexes without out-edges are not
+// redistributed.
+template <typename GRAPH_T, typename CONTEXT_T>
+class PPRBatchAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+  using Lanes = minigraph::utility::LanesArray<float>;
+
+ public:
+  PPRBatchAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  static void kernel_outdegree(GRAPH_T* graph, const size_t tid,
+                               Bitmap* visited, const size_t step,
+                               VID_T* outdegree) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step)
+      outdegree[graph->localid2globalid(i)] =
+          graph->GetVertexByIndex(i).outdegree;
+    return;
+  }
+
+  // @brief: recompute the scores of all vertexes of the fragment once.
+  // seeds holds (source, lane) pairs sorted by source.
+  static void kernel_pull(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, Lanes* scores,
+                          const VID_T* outdegree,
+                          const std::pair<VID_T, size_t>* seeds,
+                          const size_t num_seeds, const float alpha,
+                          float* max_change) {
+    size_t stride = scores->get_stride();
+    std::vector<float> next(stride);
+    float local_max_change = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      VID_T globalid = graph->localid2globalid(i);
+      std::fill(next.begin(), next.end(), 0);
+      for (size_t j = 0; j < u.indegree; j++) {
+        VID_T nbr = u.in_edges[j];
+        if (outdegree[nbr] == 0) continue;
+        minigraph::utility::LaneAxpy(next.data(), 1.0f / outdegree[nbr],
+                                     (*scores)[nbr], stride);
+      }
+      minigraph::utility::LaneScale(next.data(), 1 - alpha, next.data(),
+                                    stride);
+      auto seed = std::lower_bound(
+          seeds, seeds + num_seeds, std::make_pair(globalid, (size_t)0));
+      for (; seed != seeds + num_seeds && seed->first == globalid; ++seed)
+        next[seed->second] += alpha;
+      local_max_change = std::max(
+          local_max_change, minigraph::utility::LaneMaxAbsDiff(
+                                next.data(), (*scores)[globalid], stride));
+      memcpy((*scores)[globalid], next.data(), sizeof(float) * stride);
+    }
+    write_max(max_change, local_max_change);
+    return;
+  }
+};
+
+// Supersteps of a fragment run up to num_iter passes over its vertexes, and
+// stop early once no score changes by more than epsilon.
+template <typename GRAPH_T, typename CONTEXT_T>
+class PPRBatchPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using PPRBatchAutoMap_T = PPRBatchAutoMap<GRAPH_T, CONTEXT_T>;
+  using Lanes = minigraph::utility::LanesArray<float>;
+
+ public:
+  PPRBatchPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+              const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {
+    for (size_t k = 0; k < context.sources.size(); k++)
+      seeds_.push_back(std::make_pair((VID_T)context.sources[k], k));
+    std::sort(seeds_.begin(), seeds_.end());
+  }
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    std::call_once(alloc_once_, [this]() {
+      size_t num_vertexes = this->msg_mngr_->get_max_vid() + 1;
+      scores_ = std::make_unique<Lanes>(num_vertexes,
+                                        this->context_.sources.size(), 0);
+      outdegree_.resize(num_vertexes, 0);
+    });
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               PPRBatchAutoMap_T::kernel_outdegree,
+                               outdegree_.data());
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_,
+             " #queries: ", this->context_.sources.size());
+    Pull(graph, task_runner);
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("IncEval() - Processing gid: ", graph.gid_);
+    return Pull(graph, task_runner);
+  }
+
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    return false;
+  }
+
+  Lanes* GetScores() { return scores_.get(); }
+
+ private:
+  // @return: whether any score changed by more than epsilon.
+  bool Pull(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner) {
+    bool changed = false;
+    for (size_t iter = 0; iter < this->context_.num_iter; iter++) {
+      float max_change = 0;
+      this->auto_map_->ActiveMap(
+          graph, task_runner, nullptr, PPRBatchAutoMap_T::kernel_pull,
+          scores_.get(), outdegree_.data(), seeds_.data(), seeds_.size(),
+          this->context_.alpha, &max_change);
+      if (max_change <= this->context_.epsilon) break;
+      changed = true;
+    }
+    return changed;
+  }
+
+  std::vector<std::pair<VID_T, size_t>> seeds_;
+
+  std::once_flag alloc_once_;
+  std::unique_ptr<Lanes> scores_;
+  std::vector<VID_T> outdegree_;
+};
+
+struct Context {
+  std::vector<vid_t> sources;
+  float alpha = 0.15;
+  float epsilon = 1e-6;
+  size_t num_iter = 4;
+};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using PPRBatchPIE_T = PPRBatchPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  std::ifstream sources_file(FLAGS_sources);
+  vid_t source;
+  while (sources_file >> source) context.sources.push_back(source);
+  if (context.sources.empty()) context.sources.push_back(FLAGS_root);
+  context.alpha = FLAGS_alpha;
+  context.epsilon = FLAGS_epsilon;
+  context.num_iter = FLAGS_inner_niters;
+  auto ppr_auto_map = new PPRBatchAutoMap<CSR_T, Context>();
+  auto ppr_pie = new PPRBatchPIE<CSR_T, Context>(ppr_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<PPRBatchPIE<CSR_T, Context>, CSR_T>(ppr_pie);
+
+  minigraph::MiniGraphSys<CSR_T, PPRBatchPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+  if (!FLAGS_o.empty()) ppr_pie->GetScores()->Write(FLAGS_o);
+  LOG_INFO("#queries: ", context.sources.size());
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
@@ -174,16 +174,19 @@ class PRPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
         const CONTEXT_T& context)
       : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
 
+  bool IsCheckpointable() const override { return true; }
+
   using Frontier = folly::DMPMCQueue<VertexInfo, false>;
 
   bool Init(GRAPH_T& graph,
             minigraph::executors::TaskRunner* task_runner) override {
     LOG_INFO("Init() - Processing gid: ", graph.gid_);
-    Bitmap* visited = new Bitmap(graph.max_vid_);
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.max_vid_);
     visited->fill();
     this->auto_map_->ActiveMap(graph, task_runner, visited,
                                PRAutoMap<GRAPH_T, CONTEXT_T>::kernel_init);
-    delete visited;
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
@@ -192,20 +195,22 @@ class PRPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     LOG_INFO("PEval() - Processing gid: ", graph.gid_);
     auto start_time = std::chrono::system_clock::now();
     auto vid_map = this->msg_mngr_->GetVidMap();
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
     in_visited->fill();
     out_visited->clear();
-    Bitmap visited(graph.get_num_vertexes());
-    visited.clear();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    visited->clear();
     size_t num_iter = 0;
     while (num_iter++ < this->context_.num_iter) {
       this->auto_map_->ActiveVMap(in_visited, out_visited, graph, task_runner,
-                                  vid_map, &visited);
+                                  vid_map, visited);
       std::swap(in_visited, out_visited);
     }
     this->auto_map_->ActiveMap(
-        graph, task_runner, &visited,
+        graph, task_runner, visited,
         PRAutoMap<GRAPH_T, CONTEXT_T>::kernel_push_border_vertexes,
         this->msg_mngr_->GetGlobalBorderVidMap(),
         this->msg_mngr_->GetGlobalVdata());
@@ -217,8 +222,9 @@ class PRPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
                          .count() /
                      (double)CLOCKS_PER_SEC
               << std::endl;
-    delete in_visited;
-    delete out_visited;
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
@@ -226,9 +232,11 @@ class PRPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
                minigraph::executors::TaskRunner* task_runner) override {
     LOG_INFO("IncEval() - Processing gid: ", graph.gid_);
     auto start_time = std::chrono::system_clock::now();
-    Bitmap* visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
     visited->clear();
     in_visited->fill();
     out_visited->clear();
@@ -267,9 +275,11 @@ class PRPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
                          .count() /
                      (double)CLOCKS_PER_SEC
               << std::endl;
-    delete in_visited;
-    delete out_visited;
-    return !visited->empty();
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    bool is_active = !visited->empty();
+    scratch_arena->ReleaseBitmap(visited);
+    return is_active;
   }
 
   bool Aggregate(void* a, void* b,
@@ -306,6 +316,8 @@ int main(int argc, char* argv[]) {
   minigraph::MiniGraphSys<CSR_T, PRPIE_T> minigraph_sys(
       work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
       buffer_size, app_wrapper, FLAGS_mode, num_iter);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
   minigraph_sys.RunSys();
   // minigraph_sys.ShowResult(30);
   gflags::ShutDownCommandLineFlags();
@@ -0,0 +1,361 @@
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+
+// Random walks (DeepWalk, or node2vec if p or q is not 1) on edge-cut
+// fragments, along out-edges. Walkers are processed in batches by fragment:
+// a fragment moves all walkers it holds until they finish or step onto a
+// vertex of another fragment. Such walkers are buffered for the owner of
+// that vertex and continue when it is processed, within the same superstep if
+// it is processed later, so a fragment is loaded once per superstep for all
+// walkers that reached it.
+// node2vec needs the out-neighbors of the previous vertex, which are shared
+// by the message manager for border vertexes. Out-edges must be sorted.
+// The corpus is a sequence of walks, each written as its number of vertexes
+// followed by their global ids, all of type VID_T. Walks end early at
+// vertexes without out-edges.
+template <typename VID_T>
+struct Walker {
+  uint64_t state = 0;
+  std::vector<VID_T> path;
+};
+
+template <typename GRAPH_T, typename CONTEXT_T>
+class RandomWalkAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+  using MSG_MNGR_T = minigraph::message::DefaultMessageManager<GRAPH_T>;
+  using Walker_T = Walker<VID_T>;
+
+ public:
+  RandomWalkAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  // @brief: splitmix64, each walker carries its own state so that walks only
+  // depend on the seed.
+  static uint64_t NextRandom(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // @brief: whether there is an edge from x to y.
+  static bool IsOutNbr(GRAPH_T* graph, MSG_MNGR_T* msg_mngr, const VID_T x,
+                       const VID_T y) {
+    if (graph->IsInGraph(x)) {
+      auto u = graph->GetVertexByVid(graph->globalid2localid(x));
+      return std::binary_search(u.out_edges, u.out_edges + u.outdegree, y);
+    }
+    auto adj = msg_mngr->GetBorderAdjacency(x);
+    if (adj.first == nullptr) return false;
+    return std::binary_search(adj.first, adj.first + adj.second, y);
+  }
+
+  static void kernel_publish(GRAPH_T* graph, const size_t tid,
+                             Bitmap* visited, const size_t step,
+                             MSG_MNGR_T* msg_mngr) {
+    Bitmap* global_border_vid_map = msg_mngr->GetGlobalBorderVidMap();
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VID_T globalid = graph->localid2globalid(i);
+      if (!global_border_vid_map->get_bit(globalid)) continue;
+      auto u = graph->GetVertexByIndex(i);
+      msg_mngr->SetBorderAdjacency(globalid, u.out_edges, u.outdegree);
+    }
+    return;
+  }
+
+  // @brief: move walkers until they finish or leave the fragment. Finished
+  // walks are appended to corpus[tid], walkers that left go to crossed[tid].
+  // Next vertexes of node2vec are drawn by rejection sampling.
+  static void kernel_walk(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, Walker_T* walkers,
+                          const size_t num_walkers, const size_t walk_length,
+                          const double p, const double q,
+                          MSG_MNGR_T* msg_mngr,
+                          std::vector<Walker_T>* crossed,
+                          std::vector<VID_T>* corpus, size_t* num_finished) {
+    size_t local_num_finished = 0;
+    bool node2vec = p != 1.0 || q != 1.0;
+    double max_bias = std::max(std::max(1.0 / p, 1.0), 1.0 / q);
+    for (size_t k = tid; k < num_walkers; k += step) {
+      auto& walker = walkers[k];
+      while (walker.path.size() < walk_length) {
+        VID_T current = walker.path.back();
+        if (!graph->IsInGraph(current)) break;
+        auto u = graph->GetVertexByVid(graph->globalid2localid(current));
+        if (u.outdegree == 0) break;
+        VID_T next = VID_MAX;
+        while (true) {
+          next = u.out_edges[NextRandom(&walker.state) % u.outdegree];
+          if (!node2vec || walker.path.size() < 2) break;
+          VID_T prev = walker.path[walker.path.size() - 2];
+          double bias = 1.0 / q;
+          if (next == prev)
+            bias = 1.0 / p;
+          else if (IsOutNbr(graph, msg_mngr, prev, next))
+            bias = 1.0;
+          double r = (NextRandom(&walker.state) >> 11) * 0x1.0p-53;
+          if (r * max_bias < bias) break;
+        }
+        walker.path.push_back(next);
+      }
+      if (walker.path.size() < walk_length &&
+          !graph->IsInGraph(walker.path.back())) {
+        crossed[tid].push_back(std::move(walker));
+      } else {
+        corpus[tid].push_back(walker.path.size());
+        corpus[tid].insert(corpus[tid].end(), walker.path.begin(),
+                           walker.path.end());
+        ++local_num_finished;
+      }
+    }
+    write_add(num_finished, local_num_finished);
+    return;
+  }
+};
+
+// Supersteps of a fragment:
+//   PEval: start walks_per_source walkers at each of its vertexes.
+//   IncEval: continue the walkers buffered for it.
+// A fragment returns true while walkers remain anywhere.
+template <typename GRAPH_T, typename CONTEXT_T>
+class RandomWalkPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using RandomWalkAutoMap_T = RandomWalkAutoMap<GRAPH_T, CONTEXT_T>;
+  using Walker_T = Walker<VID_T>;
+
+ public:
+  RandomWalkPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+                const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    if (IsNode2Vec() && !graph.IsSorted())
+      graph.Sort(task_runner->GetParallelism());
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_,
+             " num_vertexes: ", graph.get_num_vertexes());
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      if (owner_.empty())
+        owner_.resize(this->msg_mngr_->get_max_vid() + 1, GID_MAX);
+      for (size_t i = 0; i < graph.get_num_vertexes(); i++)
+        owner_[graph.localid2globalid(i)] = graph.get_gid();
+    }
+    if (IsNode2Vec())
+      this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                                 RandomWalkAutoMap_T::kernel_publish,
+                                 this->msg_mngr_);
+
+    // Walkers are started kBatchSize at a time, so that only those of a
+    // batch and those that left the fragment hold a path.
+    size_t walks_per_source = this->context_.walks_per_source;
+    size_t num_walkers = graph.get_num_vertexes() * walks_per_source;
+    write_add(&num_walking_, num_walkers);
+    std::vector<Walker_T> walkers;
+    for (size_t from = 0; from < num_walkers; from += kBatchSize) {
+      walkers.resize(std::min(kBatchSize, num_walkers - from));
+      for (size_t j = 0; j < walkers.size(); j++) {
+        VID_T globalid =
+            graph.localid2globalid((from + j) / walks_per_source);
+        auto& walker = walkers[j];
+        walker.state = this->context_.seed ^
+                       (globalid * walks_per_source +
+                        (from + j) % walks_per_source);
+        RandomWalkAutoMap_T::NextRandom(&walker.state);
+        walker.path.clear();
+        walker.path.reserve(this->context_.walk_length);
+        walker.path.push_back(globalid);
+      }
+      Walk(graph, task_runner, walkers);
+    }
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    std::vector<Walker_T> walkers;
+    while (true) {
+      {
+        std::lock_guard<std::mutex> lck(mtx_);
+        Route();
+        auto iter = buffers_.find(graph.get_gid());
+        if (iter == buffers_.end() || iter->second.empty()) break;
+        walkers.swap(iter->second);
+        SetNumWalkers(graph.get_gid(), 0);
+      }
+      LOG_INFO("IncEval() - Processing gid: ", graph.gid_,
+               " #walkers: ", walkers.size());
+      Walk(graph, task_runner, walkers);
+      walkers.clear();
+    }
+    return num_walking_ > 0;
+  }
+
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    return false;
+  }
+
+  size_t GetNumWalks() const { return num_walks_; }
+
+  // @brief: flush the corpus to disk.
+  void Close() {
+    std::lock_guard<std::mutex> lck(corpus_mtx_);
+    if (corpus_.is_open()) corpus_.close();
+  }
+
+ private:
+  bool IsNode2Vec() const {
+    return this->context_.p != 1.0 || this->context_.q != 1.0;
+  }
+
+  void Walk(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner,
+            std::vector<Walker_T>& walkers) {
+    size_t parallelism = task_runner->GetParallelism();
+    std::vector<std::vector<Walker_T>> crossed(parallelism);
+    std::vector<std::vector<VID_T>> corpus(parallelism);
+    size_t num_finished = 0;
+    this->auto_map_->ActiveMap(
+        graph, task_runner, nullptr, RandomWalkAutoMap_T::kernel_walk,
+        walkers.data(), walkers.size(), this->context_.walk_length,
+        this->context_.p, this->context_.q, this->msg_mngr_, crossed.data(),
+        corpus.data(), &num_finished);
+
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      for (auto& batch : crossed)
+        for (auto& walker : batch) Push(std::move(walker));
+    }
+    {
+      std::lock_guard<std::mutex> lck(corpus_mtx_);
+      if (!this->context_.out_pt.empty()) {
+        if (!corpus_.is_open())
+          corpus_.open(this->context_.out_pt,
+                       std::ios::binary | std::ios::out | std::ios::trunc);
+        for (auto& batch : corpus)
+          corpus_.write((char*)batch.data(), sizeof(VID_T) * batch.size());
+      }
+      num_walks_ += num_finished;
+    }
+    __sync_fetch_and_sub(&num_walking_, num_finished);
+  }
+
+  // @brief: buffer a walker for the owner of its current vertex, or until
+  // the owner is known if not all fragments have run PEval yet.
+  void Push(Walker_T&& walker) {
+    GID_T gid = owner_[walker.path.back()];
+    if (gid == GID_MAX) {
+      transit_.push_back(std::move(walker));
+      return;
+    }
+    auto& buffer = buffers_[gid];
+    buffer.push_back(std::move(walker));
+    SetNumWalkers(gid, buffer.size());
+  }
+
+  void Route() {
+    std::vector<Walker_T> transit;
+    transit.swap(transit_);
+    for (auto& walker : transit) Push(std::move(walker));
+  }
+
+  // @brief: the number of walkers buffered for a fragment is its number of
+  // active vertexes, e.g. for the large_first scheduler.
+  void SetNumWalkers(const GID_T gid, const size_t num_walkers) {
+    auto si = this->msg_mngr_->GetStatisticInfo();
+    if (si != nullptr) si[gid].num_active_vertexes = num_walkers;
+  }
+
+  // Walkers started at once by PEval.
+  static constexpr size_t kBatchSize = 1 << 20;
+
+  size_t num_walking_ = 0;
+  size_t num_walks_ = 0;
+
+  std::mutex mtx_;
+  std::vector<GID_T> owner_;
+  std::unordered_map<GID_T, std::vector<Walker_T>> buffers_;
+  std::vector<Walker_T> transit_;
+
+  std::mutex corpus_mtx_;
+  std::ofstream corpus_;
+};
+
+struct Context {
+  size_t walks_per_source = 5;
+  size_t walk_length = 80;
+  double p = 1.0;
+  double q = 1.0;
+  size_t seed = 0;
+  std::string out_pt;
+};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using RandomWalkPIE_T = RandomWalkPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  context.walks_per_source = FLAGS_walks_per_source;
+  context.walk_length = FLAGS_walk_length;
+  context.p = FLAGS_walk_p;
+  context.q = FLAGS_walk_q;
+  context.seed = FLAGS_seed;
+  context.out_pt = FLAGS_o;
+  auto rw_auto_map = new RandomWalkAutoMap<CSR_T, Context>();
+  auto rw_pie = new RandomWalkPIE<CSR_T, Context>(rw_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<RandomWalkPIE<CSR_T, Context>, CSR_T>(rw_pie);
+
+  minigraph::MiniGraphSys<CSR_T, RandomWalkPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+  rw_pie->Close();
+  LOG_INFO("#walks: ", rw_pie->GetNumWalks());
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
@@ -0,0 +1,522 @@
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/atomic.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+
+// Strongly connected components on edge-cut fragments. The id of the SCC of
+// a vertex is kept in the global vdata, VDATA_MAX while it is not assigned,
+// and all phases work on the subgraph of vertexes not assigned yet:
+//   trim: a vertex without in-neighbors or without out-neighbors is an SCC
+//     by itself.
+//   forward, backward: the vertexes reached forward from a pivot of high
+//     degree, and among them those reaching it backward, form the SCC of the
+//     pivot, usually the giant one. This phase runs once.
+//   color, root: every vertex takes the maximum id of the vertexes reaching
+//     it as color. A vertex whose color is its own id is a root, and the
+//     vertexes of its color reaching it backward form its SCC. Every root is
+//     a pivot, so a pass finds many SCCs at once.
+// trim, color and root repeat until all vertexes are assigned. Marks and
+// colors live in arrays by global id, where a fragment reads and updates
+// those of border vertexes owned by other fragments.
+template <typename GRAPH_T, typename CONTEXT_T>
+class SCCAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+
+ public:
+  SCCAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  // @brief: color of vertex globalid in epoch. Colors are packed with the
+  // epoch of the color pass that set them, older ones stand for the id.
+  static VID_T GetColor(const uint64_t* colors, const uint64_t epoch,
+                        const VID_T globalid) {
+    return colors[globalid] >> 32 == epoch ? (VID_T)colors[globalid]
+                                           : globalid;
+  }
+
+  // @brief: put local out-neighbors of u into out_visited.
+  static void ActivateOut(GRAPH_T* graph, const VertexInfo& u,
+                          Bitmap* out_visited) {
+    for (size_t j = 0; j < u.outdegree; j++)
+      if (graph->IsInGraph(u.out_edges[j]))
+        out_visited->set_bit(graph->globalid2localid(u.out_edges[j]));
+  }
+
+  // @brief: put local in-neighbors of u into out_visited.
+  static void ActivateIn(GRAPH_T* graph, const VertexInfo& u,
+                         Bitmap* out_visited) {
+    for (size_t j = 0; j < u.indegree; j++)
+      if (graph->IsInGraph(u.in_edges[j]))
+        out_visited->set_bit(graph->globalid2localid(u.in_edges[j]));
+  }
+
+  static void kernel_border(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, size_t* num_border_edges) {
+    size_t local_num_border_edges = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.indegree; j++)
+        if (!graph->IsInGraph(u.in_edges[j])) ++local_num_border_edges;
+      for (size_t j = 0; j < u.outdegree; j++)
+        if (!graph->IsInGraph(u.out_edges[j])) ++local_num_border_edges;
+    }
+    write_add(num_border_edges, local_num_border_edges);
+    return;
+  }
+
+  static void kernel_trim(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, Bitmap* in_visited,
+                          Bitmap* out_visited, VDATA_T* scc,
+                          size_t* num_changed) {
+    size_t local_num_changed = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (!in_visited->get_bit(i)) continue;
+      VID_T globalid = graph->localid2globalid(i);
+      if (scc[globalid] != VDATA_MAX) continue;
+      auto u = graph->GetVertexByIndex(i);
+      bool has_in = false, has_out = false;
+      for (size_t j = 0; j < u.indegree && !has_in; j++)
+        has_in = u.in_edges[j] != globalid && scc[u.in_edges[j]] == VDATA_MAX;
+      for (size_t j = 0; j < u.outdegree && !has_out; j++)
+        has_out =
+            u.out_edges[j] != globalid && scc[u.out_edges[j]] == VDATA_MAX;
+      if (has_in && has_out) continue;
+      scc[globalid] = globalid;
+      ++local_num_changed;
+      ActivateIn(graph, u, out_visited);
+      ActivateOut(graph, u, out_visited);
+    }
+    write_add(num_changed, local_num_changed);
+    return;
+  }
+
+  static void kernel_forward(GRAPH_T* graph, const size_t tid,
+                             Bitmap* visited, const size_t step,
+                             Bitmap* in_visited, Bitmap* out_visited,
+                             uint8_t* forward, VDATA_T* scc,
+                             size_t* num_changed) {
+    size_t local_num_changed = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (!in_visited->get_bit(i)) continue;
+      VID_T globalid = graph->localid2globalid(i);
+      if (scc[globalid] != VDATA_MAX || !forward[globalid]) continue;
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.outdegree; j++) {
+        VID_T nbr = u.out_edges[j];
+        if (scc[nbr] != VDATA_MAX || forward[nbr]) continue;
+        forward[nbr] = 1;
+        ++local_num_changed;
+        if (graph->IsInGraph(nbr))
+          out_visited->set_bit(graph->globalid2localid(nbr));
+      }
+    }
+    write_add(num_changed, local_num_changed);
+    return;
+  }
+
+  static void kernel_backward(GRAPH_T* graph, const size_t tid,
+                              Bitmap* visited, const size_t step,
+                              Bitmap* in_visited, Bitmap* out_visited,
+                              const uint8_t* forward, VDATA_T* scc,
+                              const VID_T pivot, size_t* num_changed) {
+    size_t local_num_changed = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (!in_visited->get_bit(i)) continue;
+      VID_T globalid = graph->localid2globalid(i);
+      if (scc[globalid] != VDATA_MAX || !forward[globalid]) continue;
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.outdegree; j++) {
+        if (scc[u.out_edges[j]] != pivot) continue;
+        scc[globalid] = pivot;
+        ++local_num_changed;
+        ActivateIn(graph, u, out_visited);
+        break;
+      }
+    }
+    write_add(num_changed, local_num_changed);
+    return;
+  }
+
+  static void kernel_color(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                           const size_t step, Bitmap* in_visited,
+                           Bitmap* out_visited, uint64_t* colors,
+                           const uint64_t epoch, VDATA_T* scc,
+                           size_t* num_changed) {
+    size_t local_num_changed = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (!in_visited->get_bit(i)) continue;
+      VID_T globalid = graph->localid2globalid(i);
+      if (scc[globalid] != VDATA_MAX) continue;
+      VID_T color = GetColor(colors, epoch, globalid);
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.outdegree; j++) {
+        VID_T nbr = u.out_edges[j];
+        if (scc[nbr] != VDATA_MAX || GetColor(colors, epoch, nbr) >= color)
+          continue;
+        if (!write_max(colors + nbr, epoch << 32 | color)) continue;
+        ++local_num_changed;
+        if (graph->IsInGraph(nbr))
+          out_visited->set_bit(graph->globalid2localid(nbr));
+      }
+    }
+    write_add(num_changed, local_num_changed);
+    return;
+  }
+
+  static void kernel_root(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, const uint64_t* colors,
+                          const uint64_t epoch, VDATA_T* scc,
+                          size_t* num_changed) {
+    size_t local_num_changed = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VID_T globalid = graph->localid2globalid(i);
+      if (scc[globalid] != VDATA_MAX ||
+          GetColor(colors, epoch, globalid) != globalid)
+        continue;
+      scc[globalid] = globalid;
+      ++local_num_changed;
+    }
+    write_add(num_changed, local_num_changed);
+    return;
+  }
+
+  static void kernel_root_backward(GRAPH_T* graph, const size_t tid,
+                                   Bitmap* visited, const size_t step,
+                                   Bitmap* in_visited, Bitmap* out_visited,
+                                   const uint64_t* colors,
+                                   const uint64_t epoch, VDATA_T* scc,
+                                   size_t* num_changed) {
+    size_t local_num_changed = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (!in_visited->get_bit(i)) continue;
+      VID_T globalid = graph->localid2globalid(i);
+      if (scc[globalid] != VDATA_MAX) continue;
+      VID_T color = GetColor(colors, epoch, globalid);
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.outdegree; j++) {
+        if (scc[u.out_edges[j]] != color) continue;
+        scc[globalid] = color;
+        ++local_num_changed;
+        ActivateIn(graph, u, out_visited);
+        break;
+      }
+    }
+    write_add(num_changed, local_num_changed);
+    return;
+  }
+
+  // @brief: store SCC ids in vdata, count the vertexes not assigned yet and
+  // find the one with the largest product of degrees as pivot candidate,
+  // packed with its degrees ahead of its id.
+  static void kernel_finalize(GRAPH_T* graph, const size_t tid,
+                              Bitmap* visited, const size_t step,
+                              const VDATA_T* scc, size_t* num_remaining,
+                              uint64_t* candidate) {
+    size_t local_num_remaining = 0;
+    uint64_t local_candidate = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VID_T globalid = graph->localid2globalid(i);
+      graph->vdata_[i] = scc[globalid];
+      if (scc[globalid] != VDATA_MAX) continue;
+      ++local_num_remaining;
+      auto u = graph->GetVertexByIndex(i);
+      uint64_t score = std::min((uint64_t)u.indegree * u.outdegree,
+                                (uint64_t)0xFFFFFFFF);
+      local_candidate = std::max(local_candidate, score << 32 | globalid);
+    }
+    write_add(num_remaining, local_num_remaining);
+    write_max(candidate, local_candidate);
+    return;
+  }
+};
+
+// Supersteps of all fragments run the same phase. A fragment runs it until
+// its own vertexes are stable, and a phase ends after a superstep in which no
+// fragment changed anything, so that marks and colors pushed across fragments
+// are settled. All fragments return true until all vertexes are assigned. A
+// fragment without border edges runs all phases at once in PEval.
+template <typename GRAPH_T, typename CONTEXT_T>
+class SCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using SCCAutoMap_T = SCCAutoMap<GRAPH_T, CONTEXT_T>;
+
+  enum Phase { kTrim, kForward, kBackward, kColor, kRoot, kDone };
+
+  struct RoundInfo {
+    bool has_phase = false;
+    Phase phase = kTrim;
+    size_t phase_step = 0;
+    uint64_t epoch = 0;
+    VID_T pivot = VID_MAX;
+    bool has_pivot = false;
+    size_t num_changed = 0;
+    size_t num_remaining = 0;
+    uint64_t candidate = 0;
+  };
+
+ public:
+  SCCPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+         const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    std::call_once(alloc_once_, [this]() {
+      size_t num_vertexes = this->msg_mngr_->get_max_vid() + 1;
+      forward_.resize(num_vertexes, 0);
+      colors_.resize(num_vertexes, 0);
+    });
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_);
+    size_t num_border_edges = 0;
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               SCCAutoMap_T::kernel_border, &num_border_edges);
+    RoundInfo info;
+    info.has_phase = true;
+    Run(graph, task_runner, info);
+    if (num_border_edges == 0) {
+      while (true) {
+        RoundInfo next;
+        NextRound(info, next);
+        if (next.phase == kDone) break;
+        Run(graph, task_runner, next);
+        info = next;
+      }
+      std::lock_guard<std::mutex> lck(mtx_);
+      finished_.insert(graph.get_gid());
+      info.num_changed = 0;
+      info.num_remaining = 0;
+      info.candidate = 0;
+    }
+    Report(graph, 0, info);
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    size_t round = 0;
+    RoundInfo info;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      round = ++num_rounds_[graph.get_gid()];
+      if (!rounds_[round].has_phase)
+        NextRound(rounds_[round - 1], rounds_[round]);
+      info = rounds_[round];
+      if (info.phase == kDone) return false;
+      if (finished_.count(graph.get_gid())) return true;
+    }
+    info.num_changed = 0;
+    info.num_remaining = 0;
+    info.candidate = 0;
+    Run(graph, task_runner, info);
+    Report(graph, round, info);
+    return true;
+  }
+
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    return false;
+  }
+
+ private:
+  // @brief: phase of a round, given the one before.
+  void NextRound(const RoundInfo& prev, RoundInfo& current) {
+    current.has_phase = true;
+    current.epoch = prev.epoch;
+    current.pivot = prev.pivot;
+    current.has_pivot = prev.has_pivot;
+    current.phase_step = 0;
+    if (prev.num_remaining == 0) {
+      current.phase = kDone;
+    } else if (prev.num_changed > 0) {
+      current.phase = prev.phase;
+      current.phase_step = prev.phase_step + 1;
+    } else if (prev.phase == kTrim && !this->context_.multi_pivot &&
+               !prev.has_pivot) {
+      current.phase = kForward;
+      current.pivot = (VID_T)prev.candidate;
+      current.has_pivot = true;
+    } else if (prev.phase == kTrim) {
+      current.phase = kColor;
+      current.epoch = prev.epoch + 1;
+    } else if (prev.phase == kForward) {
+      current.phase = kBackward;
+    } else if (prev.phase == kColor) {
+      current.phase = kRoot;
+    } else {
+      current.phase = kTrim;
+    }
+  }
+
+  // @brief: run a step of the phase of info on the fragment until its
+  // vertexes are stable, and fill the progress of info.
+  void Run(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner,
+           RoundInfo& info) {
+    VDATA_T* scc = this->msg_mngr_->GetGlobalVdata();
+    bool first = info.phase_step == 0;
+    if (info.phase == kTrim) {
+      info.num_changed +=
+          Fixpoint(graph, task_runner, SCCAutoMap_T::kernel_trim, scc);
+    } else if (info.phase == kForward) {
+      if (first && graph.IsInGraph(info.pivot)) {
+        forward_[info.pivot] = 1;
+        ++info.num_changed;
+      }
+      info.num_changed += Fixpoint(graph, task_runner,
+                                   SCCAutoMap_T::kernel_forward,
+                                   forward_.data(), scc);
+    } else if (info.phase == kBackward) {
+      if (first && graph.IsInGraph(info.pivot)) {
+        scc[info.pivot] = info.pivot;
+        ++info.num_changed;
+      }
+      info.num_changed += Fixpoint(
+          graph, task_runner, SCCAutoMap_T::kernel_backward,
+          (const uint8_t*)forward_.data(), scc, info.pivot);
+    } else if (info.phase == kColor) {
+      info.num_changed +=
+          Fixpoint(graph, task_runner, SCCAutoMap_T::kernel_color,
+                   colors_.data(), info.epoch, scc);
+    } else if (info.phase == kRoot) {
+      if (first)
+        this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                                   SCCAutoMap_T::kernel_root,
+                                   (const uint64_t*)colors_.data(),
+                                   info.epoch, scc, &info.num_changed);
+      info.num_changed += Fixpoint(
+          graph, task_runner, SCCAutoMap_T::kernel_root_backward,
+          (const uint64_t*)colors_.data(), info.epoch, scc);
+    }
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               SCCAutoMap_T::kernel_finalize,
+                               (const VDATA_T*)scc, &info.num_remaining,
+                               &info.candidate);
+    LOG_INFO("GID: ", graph.get_gid(), " phase: ", info.phase,
+             " step: ", info.phase_step, " #changed: ", info.num_changed,
+             " #remaining: ", info.num_remaining);
+  }
+
+  // @brief: run kernel on all vertexes of the fragment, then on those it
+  // activates, until it activates none.
+  // @return: number of changes made by the kernel.
+  template <typename KERNEL_T, typename... Args>
+  size_t Fixpoint(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner,
+                  KERNEL_T kernel, Args... args) {
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    in_visited->fill();
+    out_visited->clear();
+    size_t num_changed = 0;
+    while (!in_visited->empty()) {
+      this->auto_map_->ActiveMap(graph, task_runner, nullptr, kernel,
+                                 in_visited, out_visited, args...,
+                                 &num_changed);
+      std::swap(in_visited, out_visited);
+      out_visited->clear();
+    }
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    return num_changed;
+  }
+
+  void Report(GRAPH_T& graph, const size_t round, const RoundInfo& info) {
+    auto si = this->msg_mngr_->GetStatisticInfo();
+    if (si != nullptr) {
+      si[graph.get_gid()].inc_type = round > 0;
+      si[graph.get_gid()].num_iters = round;
+      si[graph.get_gid()].num_active_vertexes = info.num_remaining;
+    }
+    std::lock_guard<std::mutex> lck(mtx_);
+    auto& total = rounds_[round];
+    if (!total.has_phase) total = info;
+    else {
+      total.num_changed += info.num_changed;
+      total.num_remaining += info.num_remaining;
+      total.candidate = std::max(total.candidate, info.candidate);
+    }
+  }
+
+  std::once_flag alloc_once_;
+  std::vector<uint8_t> forward_;
+  std::vector<uint64_t> colors_;
+
+  std::mutex mtx_;
+  std::unordered_set<GID_T> finished_;
+  std::unordered_map<GID_T, size_t> num_rounds_;
+  std::unordered_map<size_t, RoundInfo> rounds_;
+};
+
+struct Context {
+  bool multi_pivot = false;
+};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using SCCPIE_T = SCCPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  context.multi_pivot = FLAGS_multi_pivot;
+  auto scc_auto_map = new SCCAutoMap<CSR_T, Context>();
+  auto scc_pie = new SCCPIE<CSR_T, Context>(scc_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<SCCPIE<CSR_T, Context>, CSR_T>(scc_pie);
+
+  minigraph::MiniGraphSys<CSR_T, SCCPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+
+  auto scc = scc_pie->msg_mngr_->GetGlobalVdata();
+  std::unordered_map<vdata_t, size_t> size_by_scc;
+  for (size_t i = 0; i <= scc_pie->msg_mngr_->get_max_vid(); i++)
+    if (scc[i] != VDATA_MAX) ++size_by_scc[scc[i]];
+  size_t max_size = 0;
+  for (auto& iter : size_by_scc) max_size = std::max(max_size, iter.second);
+  LOG_INFO("#SCCs: ", size_by_scc.size(), " largest: ", max_size);
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
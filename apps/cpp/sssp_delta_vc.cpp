@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+
+// Weighted single source shortest paths by delta-stepping (Meyer & Sanders,
+// J. Algorithms'03). Tentative distances are kept in the global vdata, and
+// vertexes of a fragment are bucketed by distance / delta. The lowest bucket
+// is drained by relaxing light edges (weight <= delta) until it is stable,
+// then heavy edges of all vertexes it settled are relaxed once.
+// Edges are read from VertexInfo::out_edata, so fragments must be in memory.
+// Unweighted fragments are treated as having unit weights.
+template <typename GRAPH_T, typename CONTEXT_T>
+class SSSPDeltaAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+
+ public:
+  SSSPDeltaAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  static void kernel_init(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step)
+      graph->vdata_[i] = VDATA_MAX;
+    return;
+  }
+
+  // @brief: collect vertexes whose distance was lowered since they were last
+  // relaxed, e.g. by other fragments.
+  static void kernel_collect(GRAPH_T* graph, const size_t tid,
+                             Bitmap* visited, const size_t step,
+                             VDATA_T* global_vdata,
+                             std::vector<VID_T>* reached) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (global_vdata[graph->localid2globalid(i)] < graph->vdata_[i])
+        reached[tid].push_back(i);
+    }
+    return;
+  }
+
+  // @brief: relax light (if light is true) or heavy out-edges of vertexes in
+  // frontier. Local vertexes whose distance is lowered go to reached[tid].
+  static void kernel_relax(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                           const size_t step, const VID_T* frontier,
+                           const size_t frontier_size, const bool light,
+                           const EDATA_T delta, VDATA_T* global_vdata,
+                           std::vector<VID_T>* reached, size_t* num_updates) {
+    size_t local_num_updates = 0;
+    bool weighted = graph->IsWeighted();
+    for (size_t k = tid; k < frontier_size; k += step) {
+      auto u = graph->GetVertexByIndex(frontier[k]);
+      VDATA_T dist = global_vdata[graph->localid2globalid(frontier[k])];
+      if (light) graph->vdata_[frontier[k]] = dist;
+      for (size_t j = 0; j < u.outdegree; ++j) {
+        EDATA_T weight = weighted ? u.out_edata[j] : 1;
+        if ((weight <= delta) != light) continue;
+        if (write_min(&global_vdata[u.out_edges[j]], dist + weight)) {
+          ++local_num_updates;
+          if (graph->IsInGraph(u.out_edges[j]))
+            reached[tid].push_back(graph->globalid2localid(u.out_edges[j]));
+        }
+      }
+    }
+    write_add(num_updates, local_num_updates);
+    return;
+  }
+};
+
+template <typename GRAPH_T, typename CONTEXT_T>
+class SSSPDeltaPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using SSSPDeltaAutoMap_T = SSSPDeltaAutoMap<GRAPH_T, CONTEXT_T>;
+  // Local indexes of vertexes by bucket id, i.e. distance / delta.
+  using Buckets = std::map<size_t, std::vector<VID_T>>;
+
+ public:
+  SSSPDeltaPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+               const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
+
+  bool IsCheckpointable() const override { return true; }
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("Init() - Processing gid: ", graph.gid_);
+    // The global vdata is initialized to VDATA_MAX by the message manager,
+    // only the last relaxed distance of each local vertex is reset here.
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               SSSPDeltaAutoMap_T::kernel_init);
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_);
+    if (!graph.IsInGraph(this->context_.root_id)) return false;
+
+    auto global_vdata = this->msg_mngr_->GetGlobalVdata();
+    global_vdata[this->context_.root_id] = 0;
+    Buckets buckets;
+    buckets[0].push_back(graph.globalid2localid(this->context_.root_id));
+    DeltaStepping(graph, task_runner, buckets);
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("IncEval() - Processing gid: ", graph.gid_);
+    auto global_vdata = this->msg_mngr_->GetGlobalVdata();
+    std::vector<std::vector<VID_T>> reached(task_runner->GetParallelism());
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               SSSPDeltaAutoMap_T::kernel_collect,
+                               global_vdata, reached.data());
+    Buckets buckets;
+    EDATA_T delta = GetDelta(graph);
+    Push(graph, global_vdata, delta, reached, buckets);
+    if (buckets.empty()) return false;
+    return DeltaStepping(graph, task_runner, buckets) != 0;
+  }
+
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    return false;
+  }
+
+ private:
+  // @brief: drain buckets in ascending order.
+  // @return: the number of distances lowered.
+  size_t DeltaStepping(GRAPH_T& graph,
+                       minigraph::executors::TaskRunner* task_runner,
+                       Buckets& buckets) {
+    auto global_vdata = this->msg_mngr_->GetGlobalVdata();
+    EDATA_T delta = GetDelta(graph);
+    std::vector<std::vector<VID_T>> reached(task_runner->GetParallelism());
+    std::vector<VID_T> frontier, settled;
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_frontier =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    in_frontier->clear();
+    size_t num_updates = 0;
+
+    while (!buckets.empty()) {
+      size_t bucket_id = buckets.begin()->first;
+      settled.clear();
+
+      // Light edges may refill the current bucket.
+      auto iter = buckets.begin();
+      while (iter != buckets.end() && iter->first == bucket_id) {
+        frontier.clear();
+        for (auto i : iter->second) {
+          VDATA_T dist = global_vdata[graph.localid2globalid(i)];
+          // Skip stale entries and vertexes already relaxed at this distance.
+          if (dist / delta > bucket_id || graph.vdata_[i] <= dist) continue;
+          if (in_frontier->get_bit(i)) continue;
+          in_frontier->set_bit(i);
+          frontier.push_back(i);
+        }
+        buckets.erase(iter);
+        for (auto i : frontier) in_frontier->rm_bit(i);
+
+        this->auto_map_->ActiveMap(
+            graph, task_runner, nullptr, SSSPDeltaAutoMap_T::kernel_relax,
+            frontier.data(), frontier.size(), true, delta, global_vdata,
+            reached.data(), &num_updates);
+        settled.insert(settled.end(), frontier.begin(), frontier.end());
+        Push(graph, global_vdata, delta, reached, buckets);
+        iter = buckets.begin();
+      }
+
+      // Heavy edges of settled vertexes are relaxed once.
+      frontier.clear();
+      for (auto i : settled) {
+        if (in_frontier->get_bit(i)) continue;
+        in_frontier->set_bit(i);
+        frontier.push_back(i);
+      }
+      for (auto i : frontier) in_frontier->rm_bit(i);
+      this->auto_map_->ActiveMap(
+          graph, task_runner, nullptr, SSSPDeltaAutoMap_T::kernel_relax,
+          frontier.data(), frontier.size(), false, delta, global_vdata,
+          reached.data(), &num_updates);
+      Push(graph, global_vdata, delta, reached, buckets);
+    }
+
+    scratch_arena->ReleaseBitmap(in_frontier);
+    return num_updates;
+  }
+
+  // @brief: move vertexes of reached into buckets by their current distance.
+  void Push(GRAPH_T& graph, VDATA_T* global_vdata, const EDATA_T delta,
+            std::vector<std::vector<VID_T>>& reached, Buckets& buckets) {
+    for (auto& vertexes : reached) {
+      for (auto i : vertexes)
+        buckets[global_vdata[graph.localid2globalid(i)] / delta].push_back(i);
+      vertexes.clear();
+    }
+  }
+
+  // @brief: delta is set by -delta, or the average out-edge weight of the
+  // fragment otherwise.
+  EDATA_T GetDelta(GRAPH_T& graph) {
+    if (this->context_.delta > 0) return this->context_.delta;
+    std::lock_guard<std::mutex> lck(mtx_);
+    auto iter = delta_by_gid_.find(graph.get_gid());
+    if (iter != delta_by_gid_.end()) return iter->second;
+    EDATA_T delta = 1;
+    if (graph.IsWeighted() && graph.get_num_out_edges() > 0) {
+      size_t sum = 0;
+      for (size_t i = 0; i < graph.get_num_vertexes(); i++) {
+        auto u = graph.GetVertexByIndex(i);
+        for (size_t j = 0; j < u.outdegree; j++) sum += u.out_edata[j];
+      }
+      delta = std::max((size_t)1, sum / graph.get_num_out_edges());
+    }
+    delta_by_gid_.insert(std::make_pair(graph.get_gid(), delta));
+    return delta;
+  }
+
+  std::mutex mtx_;
+  std::unordered_map<GID_T, EDATA_T> delta_by_gid_;
+};
+
+struct Context {
+  size_t root_id = 0;
+  size_t delta = 0;
+};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using SSSPDeltaPIE_T = SSSPDeltaPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  context.root_id = FLAGS_root;
+  context.delta = FLAGS_delta;
+  auto sssp_auto_map = new SSSPDeltaAutoMap<CSR_T, Context>();
+  auto sssp_pie = new SSSPDeltaPIE<CSR_T, Context>(sssp_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<SSSPDeltaPIE<CSR_T, Context>, CSR_T>(sssp_pie);
+
+  minigraph::MiniGraphSys<CSR_T, SSSPDeltaPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
@@ -80,17 +80,20 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
           const CONTEXT_T& context)
       : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
 
+  bool IsCheckpointable() const override { return true; }
+
   using Frontier = folly::DMPMCQueue<VertexInfo, false>;
 
   bool Init(GRAPH_T& graph,
             minigraph::executors::TaskRunner* task_runner) override {
     LOG_INFO("Init() - Processing gid: ", graph.gid_);
-    Bitmap* visited = new Bitmap(graph.max_vid_);
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.max_vid_);
     visited->fill();
     this->auto_map_->ActiveMap(graph, task_runner, visited,
                                SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_init,
                                this->msg_mngr_->GetGlobalVdata());
-    delete visited;
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
@@ -100,12 +103,14 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     if (!graph.IsInGraph(this->context_.root_id)) return false;
 
     auto vid_map = this->msg_mngr_->GetVidMap();
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
     in_visited->clear();
     out_visited->clear();
-    Bitmap visited(graph.get_num_vertexes());
-    visited.clear();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    visited->clear();
 
     auto u = graph.GetVertexByVid(vid_map[this->context_.root_id]);
     u.vdata[0] = 0;
@@ -114,10 +119,10 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
 
     size_t num_active_vertices = 0;
     in_visited->set_bit(vid_map[this->context_.root_id]);
-    visited.set_bit(vid_map[this->context_.root_id]);
+    visited->set_bit(vid_map[this->context_.root_id]);
     while (!in_visited->empty()) {
       this->auto_map_->ActiveMap(
-          graph, task_runner, &visited,
+          graph, task_runner, visited,
           SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_update, in_visited,
           out_visited, this->msg_mngr_->GetVidMap(),
           this->msg_mngr_->GetGlobalVdata(), &num_active_vertices);
@@ -125,26 +130,29 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
       out_visited->clear();
     }
 
-    delete in_visited;
-    delete out_visited;
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
   bool IncEval(GRAPH_T& graph,
                minigraph::executors::TaskRunner* task_runner) override {
     LOG_INFO("IncEval() - Processing gid: ", graph.gid_);
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
     in_visited->clear();
     out_visited->clear();
-    Bitmap visited(graph.get_num_vertexes());
-    visited.clear();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    visited->clear();
     in_visited->fill();
 
     size_t num_active_vertices = 0;
     while (!in_visited->empty()) {
       this->auto_map_->ActiveMap(
-          graph, task_runner, &visited,
+          graph, task_runner, visited,
           SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_update, in_visited,
           out_visited, this->msg_mngr_->GetVidMap(),
           this->msg_mngr_->GetGlobalVdata(), &num_active_vertices);
@@ -152,8 +160,9 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
       out_visited->clear();
     }
 
-    delete in_visited;
-    delete out_visited;
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    scratch_arena->ReleaseBitmap(visited);
     return num_active_vertices != 0;
   }
 
@@ -189,6 +198,8 @@ int main(int argc, char* argv[]) {
   minigraph::MiniGraphSys<CSR_T, SSSPPIE_T> minigraph_sys(
       work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
       buffer_size, app_wrapper, FLAGS_mode);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
   minigraph_sys.RunSys();
   gflags::ShutDownCommandLineFlags();
   exit(0);
@@ -7,6 +7,9 @@
 #include "utility/bitmap.h"
 #include "utility/logging.h"
 #include <folly/concurrency/DynamicBoundedQueue.h>
+#include <map>
+#include <utility>
+#include <vector>
 
 template <typename GRAPH_T, typename CONTEXT_T>
 class SSSPAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
@@ -47,15 +50,56 @@ class SSSPAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
     return true;
   }
 
+  // @brief: move the vertexes of graph marked in active_map, i.e. whose
+  // distances changed since graph was last processed, into in_visited.
+  static void kernel_take_frontier(GRAPH_T* graph, const size_t tid,
+                                   Bitmap* visited, const size_t step,
+                                   Bitmap* in_visited, Bitmap* active_map) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto globalid = graph->localid2globalid(i);
+      if (!active_map->get_bit(globalid)) continue;
+      active_map->rm_bit(globalid);
+      in_visited->set_bit(i);
+    }
+    return;
+  }
+
+  // @brief: vertexes of in_visited whose distances have been reset pull them
+  // again from their in-neighbors.
+  static void kernel_pull(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, Bitmap* in_visited, Bitmap* reset,
+                          VDATA_T* global_border_vdata) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (!in_visited->get_bit(i)) continue;
+      auto globalid = graph->localid2globalid(i);
+      if (!reset->get_bit(globalid)) continue;
+      reset->rm_bit(globalid);
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.indegree; ++j) {
+        if (global_border_vdata[u.in_edges[j]] == VDATA_MAX) continue;
+        write_min(&global_border_vdata[globalid],
+                  global_border_vdata[u.in_edges[j]] + 1);
+      }
+    }
+    return;
+  }
+
   static void kernel_update(GRAPH_T* graph, const size_t tid, Bitmap* visited,
-                            const size_t step, Bitmap* out_visited,
+                            const size_t step, Bitmap* in_visited,
+                            Bitmap* out_visited, VID_T* vid_map,
+                            Bitmap* active_map,
                             VDATA_T* global_border_vdata) {
     for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (!in_visited->get_bit(i)) continue;
+      auto dist = global_border_vdata[graph->localid2globalid(i)];
+      if (dist == VDATA_MAX) continue;
       auto u = graph->GetVertexByIndex(i);
       for (size_t j = 0; j < u.outdegree; ++j) {
-        if (write_min(&global_border_vdata[u.out_edges[j]],
-                      global_border_vdata[graph->localid2globalid(i)] + 1)) {
-          out_visited->set_bit(u.out_edges[j]);
+        if (write_min(&global_border_vdata[u.out_edges[j]], dist + 1)) {
+          if (graph->IsInGraph(u.out_edges[j]))
+            out_visited->set_bit(vid_map[u.out_edges[j]]);
+          else
+            active_map->set_bit(u.out_edges[j]);
           visited->set_bit(i);
         }
       }
@@ -75,12 +119,15 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
           const CONTEXT_T& context)
       : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
 
+  bool IsCheckpointable() const override { return true; }
+
   using Frontier = folly::DMPMCQueue<VertexInfo, false>;
 
   bool Init(GRAPH_T& graph,
             minigraph::executors::TaskRunner* task_runner) override {
     LOG_INFO("Init() - Processing gid: ", graph.gid_);
-    Bitmap* visited = new Bitmap(graph.max_vid_);
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.max_vid_);
     visited->fill();
     this->auto_map_->ActiveMap(graph, task_runner, visited,
                                SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_init,
@@ -96,7 +143,7 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
           task_runner, SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_init_vdata,
           this->msg_mngr_->get_max_vid(), this->msg_mngr_->GetGlobalVdata());
     }
-    delete visited;
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
@@ -106,28 +153,33 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     LOG_INFO("PEval() - Processing gid: ", graph.gid_);
     auto vid_map = this->msg_mngr_->GetVidMap();
 
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
     in_visited->clear();
     out_visited->clear();
-    Bitmap visited(graph.get_num_vertexes());
-    visited.clear();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    visited->clear();
 
     auto u = graph.GetVertexByVid(vid_map[this->context_.root_id]);
     u.vdata[0] = 0;
+    this->msg_mngr_->GetGlobalVdata()[this->context_.root_id] = 0;
     in_visited->set_bit(vid_map[this->context_.root_id]);
-    visited.set_bit(vid_map[this->context_.root_id]);
+    visited->set_bit(vid_map[this->context_.root_id]);
     while (!in_visited->empty()) {
-      this->auto_map_->ActiveMap(graph, task_runner, &visited,
-                                 SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_update,
-                                 out_visited,
-                                 this->msg_mngr_->GetGlobalVdata());
+      this->auto_map_->ActiveMap(
+          graph, task_runner, visited,
+          SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_update, in_visited,
+          out_visited, vid_map, this->msg_mngr_->GetGlobalActiveVidMap(),
+          this->msg_mngr_->GetGlobalVdata());
       std::swap(in_visited, out_visited);
       out_visited->clear();
     }
 
-    delete in_visited;
-    delete out_visited;
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
@@ -137,25 +189,41 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
 
     auto vid_map = this->msg_mngr_->GetVidMap();
 
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
-    in_visited->fill();
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    in_visited->clear();
     out_visited->clear();
-    Bitmap visited(graph.get_num_vertexes());
-    visited.clear();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    visited->clear();
 
-    while (!in_visited->empty()) {
-      this->auto_map_->ActiveMap(graph, task_runner, &visited,
-                                 SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_update,
-                                 out_visited,
+    // Start from the vertexes whose distances changed since, rather than all.
+    this->auto_map_->ActiveMap(
+        graph, task_runner, visited,
+        SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_take_frontier, in_visited,
+        this->msg_mngr_->GetGlobalActiveVidMap());
+    if (this->context_.reset != nullptr)
+      this->auto_map_->ActiveMap(graph, task_runner, visited,
+                                 SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_pull,
+                                 in_visited, this->context_.reset,
                                  this->msg_mngr_->GetGlobalVdata());
+
+    while (!in_visited->empty()) {
+      this->auto_map_->ActiveMap(
+          graph, task_runner, visited,
+          SSSPAutoMap<GRAPH_T, CONTEXT_T>::kernel_update, in_visited,
+          out_visited, vid_map, this->msg_mngr_->GetGlobalActiveVidMap(),
+          this->msg_mngr_->GetGlobalVdata());
       std::swap(in_visited, out_visited);
       out_visited->clear();
     }
 
-    delete in_visited;
-    delete out_visited;
-    return !visited.empty();
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    bool is_active = !visited->empty();
+    scratch_arena->ReleaseBitmap(visited);
+    return is_active;
   }
 
   bool Aggregate(void* a, void* b,
@@ -167,10 +235,82 @@ class SSSPPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
 struct Context {
   size_t root_id = 12;
   unsigned t = 0;
+  // Vertexes whose distances have been reset by edge deletions, to pull
+  // from their in-neighbors in an incremental run.
+  Bitmap* reset = nullptr;
 };
 
 using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
 using SSSPPIE_T = SSSPPIE<CSR_T, Context>;
+using DeltaStore_T = minigraph::utility::io::DeltaStore<CSR_T>;
+using MiniGraphSys_T = minigraph::MiniGraphSys<CSR_T, SSSPPIE_T>;
+
+// @brief: seed an incremental run from the edge updates of batch, of which
+// the last one of each edge holds. The vertexes whose distances may hang on
+// a deleted edge, i.e. the subtrees of the shortest path DAG under it, are
+// found by visiting only the fragments they're in, then reset to pull their
+// distances again from their in-neighbors. An insertion relaxes its dst.
+void Seed(MiniGraphSys_T* minigraph_sys, SSSPPIE_T* sssp_pie,
+          const std::vector<DeltaStore_T::DeltaEdge>& batch) {
+  auto msg_mngr = sssp_pie->msg_mngr_;
+  auto dist = msg_mngr->GetGlobalVdata();
+  auto active_map = msg_mngr->GetGlobalActiveVidMap();
+  auto vid_map = msg_mngr->GetVidMap();
+  auto root_id = sssp_pie->context_.root_id;
+  std::map<std::pair<vid_t, vid_t>, uint8_t> op_by_edge;
+  for (auto& e : batch) op_by_edge[std::make_pair(e.vid, e.nbr)] = e.op;
+
+  Bitmap* reset = new Bitmap(msg_mngr->get_max_vid());
+  Bitmap frontier(msg_mngr->get_max_vid());
+  reset->clear();
+  frontier.clear();
+  auto is_child = [&](const vid_t parent, const vid_t child) {
+    return child != root_id && dist[parent] != VDATA_MAX &&
+           dist[child] == dist[parent] + 1 && !reset->get_bit(child);
+  };
+  for (auto& iter : op_by_edge) {
+    auto src = iter.first.first, dst = iter.first.second;
+    if (iter.second != DeltaStore_T::kDelete || !is_child(src, dst)) continue;
+    reset->set_bit(dst);
+    frontier.set_bit(dst);
+  }
+  // Distances are kept until the subtrees are complete, as is_child() tells
+  // children by them.
+  size_t num_reads = minigraph_sys->VisitFragments(
+      &frontier, [&](CSR_T* graph, const std::vector<vid_t>& vids) {
+        std::vector<vid_t> local_vids(vids);
+        while (!local_vids.empty()) {
+          auto u = graph->GetVertexByIndex(local_vids.back());
+          auto globalid = graph->localid2globalid(local_vids.back());
+          local_vids.pop_back();
+          for (size_t j = 0; j < u.outdegree; ++j) {
+            if (!is_child(globalid, u.out_edges[j])) continue;
+            reset->set_bit(u.out_edges[j]);
+            if (graph->IsInGraph(u.out_edges[j]))
+              local_vids.push_back(vid_map[u.out_edges[j]]);
+            else
+              frontier.set_bit(u.out_edges[j]);
+          }
+        }
+      });
+  size_t num_reset = 0;
+  for (vid_t vid = 0; vid < msg_mngr->get_aligned_max_vid(); vid++) {
+    if (!reset->get_bit(vid)) continue;
+    dist[vid] = VDATA_MAX;
+    active_map->set_bit(vid);
+    num_reset++;
+  }
+  sssp_pie->context_.reset = reset;
+
+  for (auto& iter : op_by_edge) {
+    auto src = iter.first.first, dst = iter.first.second;
+    if (iter.second == DeltaStore_T::kInsert && dist[src] != VDATA_MAX &&
+        write_min(&dist[dst], dist[src] + 1))
+      active_map->set_bit(dst);
+  }
+  LOG_INFO("Seed: ", op_by_edge.size(), " edges updated, ", num_reset,
+           " distances reset, ", num_reads, " fragments visited.");
+}
 
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
@@ -188,10 +328,20 @@ int main(int argc, char* argv[]) {
   auto app_wrapper =
       new minigraph::AppWrapper<SSSPPIE<CSR_T, Context>, CSR_T>(sssp_pie);
 
-  minigraph::MiniGraphSys<CSR_T, SSSPPIE_T> minigraph_sys(
+  MiniGraphSys_T minigraph_sys(
       work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
       buffer_size, app_wrapper, FLAGS_mode);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.SetCompaction(FLAGS_compact_threshold);
+  std::vector<DeltaStore_T::DeltaEdge> batch;
+  if (minigraph_sys.SetStreamResult("sssp_" + std::to_string(FLAGS_root),
+                                    FLAGS_incremental, &batch)) {
+    Seed(&minigraph_sys, sssp_pie, batch);
+    minigraph_sys.SetIncremental();
+  }
   minigraph_sys.RunSys();
+  delete sssp_pie->context_.reset;
   // minigraph_sys.ShowResult(3);
   gflags::ShutDownCommandLineFlags();
   exit(0);
@@ -0,0 +1,569 @@
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/atomic.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+#include "utility/spill_queue.h"
+
+// Number of partial matches a thread buffers for a fragment before it pushes
+// them to the queue of the fragment, and pops from its own queue at once.
+#define MATCH_BATCH_SIZE 4096
+
+// The query graph compiled into a matching order. Position 0 is the pattern
+// vertex of highest degree and each next position is the unmatched pattern
+// vertex with the most edges to matched ones, so that candidates are pruned
+// early. Candidates at position i > 0 are the out- or in-neighbors of the
+// vertex matched at parent[i], and the other pattern edges between i and
+// earlier positions are checked on the adjacency of the candidate.
+struct MatchPlan {
+  // Pattern vertex at each position, pattern vertexes are numbered by
+  // ascending id in the query file.
+  std::vector<size_t> order;
+  // Position of each pattern vertex.
+  std::vector<size_t> position;
+  std::vector<size_t> parent;
+  // Whether candidates at a position are out-neighbors of the parent.
+  std::vector<bool> parent_out;
+  // (earlier position j, whether the edge goes from j) to check for each
+  // position.
+  std::vector<std::vector<std::pair<size_t, bool>>> checks;
+  std::vector<size_t> indegree;
+  std::vector<size_t> outdegree;
+
+  size_t size() const { return order.size(); }
+
+  // @brief: compile the pattern given by its edges.
+  // @return: false if the pattern is empty or not connected.
+  bool Build(const std::vector<std::pair<vid_t, vid_t>>& edges) {
+    std::vector<vid_t> ids;
+    for (auto& e : edges) {
+      ids.push_back(e.first);
+      ids.push_back(e.second);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    size_t k = ids.size();
+    if (k == 0) {
+      XLOG(ERR, "Empty pattern");
+      return false;
+    }
+    std::vector<std::set<size_t>> out(k), in(k);
+    for (auto& e : edges) {
+      size_t x = std::lower_bound(ids.begin(), ids.end(), e.first) -
+                 ids.begin();
+      size_t y = std::lower_bound(ids.begin(), ids.end(), e.second) -
+                 ids.begin();
+      out[x].insert(y);
+      in[y].insert(x);
+    }
+
+    position.assign(k, k);
+    for (size_t i = 0; i < k; i++) {
+      size_t best = k, best_links = 0, best_degree = 0;
+      for (size_t x = 0; x < k; x++) {
+        if (position[x] < k) continue;
+        size_t links = 0;
+        for (auto y : out[x]) links += position[y] < k;
+        for (auto y : in[x]) links += position[y] < k;
+        size_t degree = out[x].size() + in[x].size();
+        if (i > 0 && links == 0) continue;
+        if (best == k || links > best_links ||
+            (links == best_links && degree > best_degree)) {
+          best = x;
+          best_links = links;
+          best_degree = degree;
+        }
+      }
+      if (best == k) {
+        XLOG(ERR, "Pattern is not connected");
+        return false;
+      }
+      position[best] = i;
+      order.push_back(best);
+    }
+
+    parent.assign(k, 0);
+    parent_out.assign(k, false);
+    checks.assign(k, {});
+    indegree.assign(k, 0);
+    outdegree.assign(k, 0);
+    for (size_t i = 0; i < k; i++) {
+      size_t x = order[i];
+      indegree[i] = in[x].size();
+      outdegree[i] = out[x].size();
+      if (i > 0) {
+        parent[i] = i;
+        for (auto y : out[x]) parent[i] = std::min(parent[i], position[y]);
+        for (auto y : in[x]) parent[i] = std::min(parent[i], position[y]);
+        parent_out[i] = out[order[parent[i]]].count(x);
+      }
+      for (size_t j = 0; j <= i; j++) {
+        bool generated = i > 0 && j == parent[i];
+        if (in[x].count(order[j]) && !(generated && parent_out[i]))
+          checks[i].push_back(std::make_pair(j, true));
+        if (j < i && out[x].count(order[j]) && !(generated && !parent_out[i]))
+          checks[i].push_back(std::make_pair(j, false));
+      }
+    }
+    return true;
+  }
+};
+
+// State shared by all fragments: the owner of each vertex, the queues of
+// partial matches shipped to each fragment, one per superstep parity, and the
+// output file.
+template <typename GID_T, typename VID_T>
+struct MatchState {
+  using SpillQueue_T = minigraph::utility::SpillQueue<VID_T>;
+
+  MatchPlan plan;
+  bool homomorphism = false;
+  size_t capacity = 0;
+  std::string spill_root;
+  std::vector<GID_T> owner;
+
+  std::mutex mtx;
+  std::unordered_map<GID_T, SpillQueue_T*> queues[2];
+  std::mutex out_mtx;
+  std::ofstream out;
+
+  ~MatchState() {
+    for (auto& queue_by_gid : queues)
+      for (auto& iter : queue_by_gid) delete iter.second;
+  }
+
+  // A partial match is shipped as a header, the number of matched positions
+  // shifted left by one with the lowest bit set if the last one is yet to be
+  // checked, followed by the matched vertexes.
+  size_t GetRecordSize() const { return plan.size() + 1; }
+
+  SpillQueue_T* GetQueue(const size_t parity, const GID_T gid) {
+    std::lock_guard<std::mutex> lck(mtx);
+    auto& queue = queues[parity][gid];
+    if (queue == nullptr) {
+      std::string path;
+      if (!spill_root.empty())
+        path = spill_root + "/match_" + std::to_string(gid) + "_" +
+               std::to_string(parity) + ".spill";
+      queue = new SpillQueue_T(GetRecordSize(), capacity, path);
+    }
+    return queue;
+  }
+
+  // @brief: whether a queue failed to spill or read back partial matches.
+  bool Failed() {
+    std::lock_guard<std::mutex> lck(mtx);
+    for (auto& queue_by_gid : queues)
+      for (auto& iter : queue_by_gid)
+        if (iter.second->failed()) return true;
+    return false;
+  }
+
+  void Write(const std::string& buf) {
+    std::lock_guard<std::mutex> lck(out_mtx);
+    out << buf;
+  }
+};
+
+// Depth-first extension of partial matches by a thread of a fragment. The
+// vertex whose adjacency is needed next, the parent to expand or the
+// candidate to check, anchors a partial match: if it is owned by another
+// fragment the match is shipped to it, otherwise the extension goes on.
+template <typename GRAPH_T>
+class Matcher {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+
+ public:
+  Matcher(GRAPH_T* graph, MatchState<GID_T, VID_T>* state,
+          const size_t parity)
+      : graph_(graph), state_(state), plan_(state->plan), parity_(parity) {
+    match_.resize(plan_.size());
+  }
+
+  ~Matcher() { Flush(); }
+
+  // @brief: match position 0 to the local vertex globalid.
+  void Seed(const VID_T globalid) {
+    match_[0] = globalid;
+    if (Check(0)) Extend(1);
+  }
+
+  // @brief: go on with a partial match shipped by another fragment.
+  void Resume(const VID_T* record) {
+    size_t num_matched = record[0] >> 1;
+    std::copy(record + 1, record + 1 + num_matched, match_.begin());
+    if (!(record[0] & 1))
+      Expand(num_matched);
+    else if (Check(num_matched - 1))
+      Extend(num_matched);
+  }
+
+  // @brief: push buffered partial matches to their queues and buffered
+  // matches to the output file.
+  void Flush() {
+    for (auto& iter : outbox_) {
+      if (iter.second.empty()) continue;
+      state_->GetQueue(parity_, iter.first)
+          ->Push(iter.second.data(),
+                 iter.second.size() / state_->GetRecordSize());
+      iter.second.clear();
+    }
+    if (!out_buf_.empty()) {
+      state_->Write(out_buf_);
+      out_buf_.clear();
+    }
+  }
+
+  size_t get_num_matches() const { return num_matches_; }
+
+  size_t get_num_sent() const { return num_sent_; }
+
+ private:
+  // @brief: whether the local vertex matched at position i has the pattern
+  // edges to earlier positions.
+  bool Check(const size_t i) {
+    auto u = graph_->GetVertexByIndex(graph_->globalid2localid(match_[i]));
+    if (!state_->homomorphism && (u.indegree < plan_.indegree[i] ||
+                                  u.outdegree < plan_.outdegree[i]))
+      return false;
+    for (auto& check : plan_.checks[i]) {
+      VID_T x = match_[check.first];
+      bool found = check.second
+                       ? std::binary_search(u.in_edges,
+                                            u.in_edges + u.indegree, x)
+                       : std::binary_search(u.out_edges,
+                                            u.out_edges + u.outdegree, x);
+      if (!found) return false;
+    }
+    return true;
+  }
+
+  void Extend(const size_t num_matched) {
+    if (num_matched == plan_.size()) {
+      Emit();
+      return;
+    }
+    VID_T anchor = match_[plan_.parent[num_matched]];
+    if (graph_->IsInGraph(anchor))
+      Expand(num_matched);
+    else
+      Ship(anchor, num_matched, false);
+  }
+
+  // @brief: try the neighbors of the local parent of position i.
+  void Expand(const size_t i) {
+    auto u = graph_->GetVertexByIndex(
+        graph_->globalid2localid(match_[plan_.parent[i]]));
+    VID_T* nbrs = plan_.parent_out[i] ? u.out_edges : u.in_edges;
+    size_t degree = plan_.parent_out[i] ? u.outdegree : u.indegree;
+    for (size_t k = 0; k < degree; k++) {
+      if (!state_->homomorphism &&
+          std::find(match_.begin(), match_.begin() + i, nbrs[k]) !=
+              match_.begin() + i)
+        continue;
+      match_[i] = nbrs[k];
+      if (!graph_->IsInGraph(nbrs[k]))
+        Ship(nbrs[k], i + 1, true);
+      else if (Check(i))
+        Extend(i + 1);
+    }
+  }
+
+  void Ship(const VID_T anchor, const size_t num_matched, const bool check) {
+    GID_T gid = state_->owner[anchor];
+    auto& box = outbox_[gid];
+    box.push_back(num_matched << 1 | check);
+    box.insert(box.end(), match_.begin(), match_.begin() + num_matched);
+    box.resize(box.size() + plan_.size() - num_matched, VID_MAX);
+    ++num_sent_;
+    if (box.size() >= MATCH_BATCH_SIZE * state_->GetRecordSize()) {
+      state_->GetQueue(parity_, gid)->Push(box.data(), MATCH_BATCH_SIZE);
+      box.clear();
+    }
+  }
+
+  // @brief: write the vertexes matched to the pattern vertexes in ascending
+  // order of their ids.
+  void Emit() {
+    ++num_matches_;
+    if (!state_->out.is_open()) return;
+    for (size_t x = 0; x < plan_.size(); x++) {
+      if (x > 0) out_buf_ += ",";
+      out_buf_ += std::to_string(match_[plan_.position[x]]);
+    }
+    out_buf_ += "\n";
+    if (out_buf_.size() >= 1 << 16) {
+      state_->Write(out_buf_);
+      out_buf_.clear();
+    }
+  }
+
+  GRAPH_T* graph_ = nullptr;
+  MatchState<GID_T, VID_T>* state_ = nullptr;
+  const MatchPlan& plan_;
+  size_t parity_ = 0;
+
+  std::vector<VID_T> match_;
+  std::unordered_map<GID_T, std::vector<VID_T>> outbox_;
+  std::string out_buf_;
+  size_t num_matches_ = 0;
+  size_t num_sent_ = 0;
+};
+
+template <typename GRAPH_T, typename CONTEXT_T>
+class SubgraphMatchingAutoMap
+    : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+  using MatchState_T = MatchState<GID_T, VID_T>;
+
+ public:
+  SubgraphMatchingAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  static void kernel_border(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, MatchState_T* state,
+                            size_t* num_border_edges) {
+    size_t local_num_border_edges = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      state->owner[graph->localid2globalid(i)] = graph->get_gid();
+      for (size_t j = 0; j < u.indegree; j++)
+        if (!graph->IsInGraph(u.in_edges[j])) ++local_num_border_edges;
+      for (size_t j = 0; j < u.outdegree; j++)
+        if (!graph->IsInGraph(u.out_edges[j])) ++local_num_border_edges;
+    }
+    write_add(num_border_edges, local_num_border_edges);
+    return;
+  }
+
+  static void kernel_seed(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, MatchState_T* state,
+                          const size_t parity, size_t* num_matches,
+                          size_t* num_sent) {
+    Matcher<GRAPH_T> matcher(graph, state, parity);
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step)
+      matcher.Seed(graph->localid2globalid(i));
+    matcher.Flush();
+    write_add(num_matches, matcher.get_num_matches());
+    write_add(num_sent, matcher.get_num_sent());
+    return;
+  }
+
+  static void kernel_resume(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, MatchState_T* state,
+                            minigraph::utility::SpillQueue<VID_T>* queue,
+                            const size_t parity, size_t* num_matches,
+                            size_t* num_sent) {
+    Matcher<GRAPH_T> matcher(graph, state, parity);
+    size_t record_size = state->GetRecordSize();
+    std::vector<VID_T> records(MATCH_BATCH_SIZE * record_size);
+    size_t n = 0;
+    while ((n = queue->Pop(records.data(), MATCH_BATCH_SIZE)) > 0)
+      for (size_t k = 0; k < n; k++)
+        matcher.Resume(records.data() + k * record_size);
+    matcher.Flush();
+    write_add(num_matches, matcher.get_num_matches());
+    write_add(num_sent, matcher.get_num_sent());
+    return;
+  }
+};
+
+// Supersteps of a fragment:
+//   PEval: record the owner of its vertexes. A fragment without border edges
+//     finds all its matches here.
+//   IncEval #1: extend partial matches from every vertex.
+//   IncEval #k: go on with the partial matches shipped to it in #k-1.
+// All fragments return false once no partial match was shipped in the last
+// superstep.
+template <typename GRAPH_T, typename CONTEXT_T>
+class SubgraphMatchingPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using SubgraphMatchingAutoMap_T = SubgraphMatchingAutoMap<GRAPH_T, CONTEXT_T>;
+
+ public:
+  SubgraphMatchingPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+                      const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {
+    state_.plan = context.plan;
+    state_.homomorphism = context.homomorphism;
+    state_.capacity = context.capacity;
+    state_.spill_root = context.spill_root;
+    if (!context.output.empty()) state_.out.open(context.output);
+  }
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    std::call_once(alloc_once_, [this]() {
+      state_.owner.resize(this->msg_mngr_->get_max_vid() + 1, 0);
+    });
+    if (!graph.IsSorted()) graph.Sort(task_runner->GetParallelism());
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_);
+    size_t num_border_edges = 0;
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               SubgraphMatchingAutoMap_T::kernel_border,
+                               &state_, &num_border_edges);
+    if (num_border_edges > 0) return true;
+    size_t num_matches = 0, num_sent = 0;
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               SubgraphMatchingAutoMap_T::kernel_seed, &state_,
+                               0, &num_matches, &num_sent);
+    LOG_INFO("GID: ", graph.get_gid(), " #matches: ", num_matches);
+    std::lock_guard<std::mutex> lck(mtx_);
+    finished_.insert(graph.get_gid());
+    num_matches_ += num_matches;
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    size_t round = 0;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      round = ++num_rounds_[graph.get_gid()];
+      if (round > 1 && num_sent_[round - 1] == 0) return false;
+      if (finished_.count(graph.get_gid())) return true;
+    }
+    if (!graph.IsSorted()) graph.Sort(task_runner->GetParallelism());
+
+    size_t num_matches = 0, num_sent = 0;
+    if (round == 1) {
+      this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                                 SubgraphMatchingAutoMap_T::kernel_seed,
+                                 &state_, round % 2, &num_matches, &num_sent);
+    } else {
+      auto queue = state_.GetQueue((round - 1) % 2, graph.get_gid());
+      this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                                 SubgraphMatchingAutoMap_T::kernel_resume,
+                                 &state_, queue, round % 2, &num_matches,
+                                 &num_sent);
+    }
+    LOG_INFO("GID: ", graph.get_gid(), " round: ", round,
+             " #matches: ", num_matches, " #shipped: ", num_sent);
+    if (state_.Failed())
+      LOG_FATAL("Partial matches are lost, spilling them to ",
+                state_.spill_root, " failed.");
+
+    auto si = this->msg_mngr_->GetStatisticInfo();
+    if (si != nullptr) {
+      si[graph.get_gid()].inc_type = 1;
+      si[graph.get_gid()].num_iters = round;
+      si[graph.get_gid()].num_active_vertexes = num_sent;
+    }
+    std::lock_guard<std::mutex> lck(mtx_);
+    num_sent_[round] += num_sent;
+    num_matches_ += num_matches;
+    return true;
+  }
+
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    return false;
+  }
+
+  size_t GetNumMatches() const { return num_matches_; }
+
+  // @brief: flush the output file.
+  void Close() {
+    if (state_.out.is_open()) state_.out.close();
+  }
+
+ private:
+  MatchState<GID_T, VID_T> state_;
+  std::once_flag alloc_once_;
+
+  std::mutex mtx_;
+  size_t num_matches_ = 0;
+  std::unordered_set<GID_T> finished_;
+  std::unordered_map<GID_T, size_t> num_rounds_;
+  std::unordered_map<size_t, size_t> num_sent_;
+};
+
+struct Context {
+  MatchPlan plan;
+  bool homomorphism = false;
+  size_t capacity = 0;
+  std::string spill_root;
+  std::string output;
+};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using SubgraphMatchingPIE_T = SubgraphMatchingPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  std::vector<std::pair<vid_t, vid_t>> pattern_edges;
+  std::ifstream pattern_file(FLAGS_pattern);
+  std::string line;
+  char sep[] = ",";
+  while (std::getline(pattern_file, line))
+    if (!line.empty() && line[0] != '#')
+      pattern_edges.push_back(SplitEdge(line, sep));
+
+  Context context;
+  if (!context.plan.Build(pattern_edges)) {
+    XLOG(ERR, "Invalid pattern: ", FLAGS_pattern);
+    return -1;
+  }
+  context.homomorphism = FLAGS_homomorphism;
+  context.capacity = FLAGS_max_buffered_matches;
+  context.spill_root = FLAGS_state_dir;
+  context.output = FLAGS_o;
+  auto sm_auto_map = new SubgraphMatchingAutoMap<CSR_T, Context>();
+  auto sm_pie = new SubgraphMatchingPIE<CSR_T, Context>(sm_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<SubgraphMatchingPIE<CSR_T, Context>, CSR_T>(
+          sm_pie);
+
+  minigraph::MiniGraphSys<CSR_T, SubgraphMatchingPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+  sm_pie->Close();
+  LOG_INFO("#matches: ", sm_pie->GetNumMatches());
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
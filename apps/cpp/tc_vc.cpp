@@ -0,0 +1,336 @@
+#include <mutex>
+#include <unordered_map>
+
+#include "2d_pie/auto_app_base.h"
+#include "executors/task_runner.h"
+#include "graphs/graph.h"
+#include "minigraph_sys.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+#include "utility/set_intersection.h"
+
+// Triangle counting on edge-cut fragments. Edges are taken as undirected and
+// oriented from the lower to the higher rank vertex, where vertexes are
+// ranked by (degree, global id). Each triangle is then counted exactly once,
+// at its lowest ranked vertex u, as |N+(u) ∩ N+(v)| for every v in N+(u).
+// Since |N+(u)| is bounded by sqrt(2|E|), hubs do not dominate the work.
+template <typename GRAPH_T, typename CONTEXT_T>
+class TCAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+  using MSG_MNGR_T = minigraph::message::DefaultMessageManager<GRAPH_T>;
+
+ public:
+  TCAutoMap() : minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>() {}
+
+  bool F(const VertexInfo& u, VertexInfo& v,
+         GRAPH_T* graph = nullptr) override {
+    return false;
+  }
+
+  bool F(VertexInfo& u, GRAPH_T* graph = nullptr,
+         VID_T* vid_map = nullptr) override {
+    return false;
+  }
+
+  // @brief: merge sorted in_edges and out_edges of u into out, dropping
+  // duplicates and self loops.
+  // @return: the number of undirected neighbors of u.
+  static size_t GetNbrs(const VertexInfo& u, const VID_T globalid,
+                        VID_T* out = nullptr) {
+    size_t i = 0, j = 0, count = 0;
+    VID_T last = VID_MAX;
+    while (i < u.indegree || j < u.outdegree) {
+      VID_T nbr;
+      if (j == u.outdegree ||
+          (i < u.indegree && u.in_edges[i] < u.out_edges[j]))
+        nbr = u.in_edges[i++];
+      else
+        nbr = u.out_edges[j++];
+      if (nbr == last || nbr == globalid) continue;
+      last = nbr;
+      if (out != nullptr) out[count] = nbr;
+      ++count;
+    }
+    return count;
+  }
+
+  // @brief: whether y is ranked higher than x.
+  static bool IsHigher(const VID_T x, const VID_T y, const VDATA_T* degree) {
+    return degree[x] < degree[y] || (degree[x] == degree[y] && x < y);
+  }
+
+  static void kernel_init(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step)
+      graph->vdata_[i] = 0;
+    return;
+  }
+
+  static void kernel_degree(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, VDATA_T* degree) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      VID_T globalid = graph->localid2globalid(i);
+      degree[globalid] = GetNbrs(u, globalid);
+    }
+    return;
+  }
+
+  static void kernel_border(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                            const size_t step, size_t* num_border_edges) {
+    size_t local_num_border_edges = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.indegree; j++)
+        if (!graph->IsInGraph(u.in_edges[j])) ++local_num_border_edges;
+      for (size_t j = 0; j < u.outdegree; j++)
+        if (!graph->IsInGraph(u.out_edges[j])) ++local_num_border_edges;
+    }
+    write_add(num_border_edges, local_num_border_edges);
+    return;
+  }
+
+  // @brief: offset[i + 1] = |N+(i)|, the caller turns it into offsets.
+  static void kernel_count_higher(GRAPH_T* graph, const size_t tid,
+                                  Bitmap* visited, const size_t step,
+                                  VDATA_T* degree, size_t* offset) {
+    VID_T* nbrs = (VID_T*)malloc(sizeof(VID_T) * GetMaxDegree(graph));
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      VID_T globalid = graph->localid2globalid(i);
+      size_t n = GetNbrs(u, globalid, nbrs);
+      size_t count = 0;
+      for (size_t k = 0; k < n; k++)
+        if (IsHigher(globalid, nbrs[k], degree)) ++count;
+      offset[i + 1] = count;
+    }
+    free(nbrs);
+    return;
+  }
+
+  static void kernel_fill_higher(GRAPH_T* graph, const size_t tid,
+                                 Bitmap* visited, const size_t step,
+                                 VDATA_T* degree, size_t* offset,
+                                 VID_T* higher) {
+    VID_T* nbrs = (VID_T*)malloc(sizeof(VID_T) * GetMaxDegree(graph));
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto u = graph->GetVertexByIndex(i);
+      VID_T globalid = graph->localid2globalid(i);
+      size_t n = GetNbrs(u, globalid, nbrs);
+      size_t count = offset[i];
+      for (size_t k = 0; k < n; k++)
+        if (IsHigher(globalid, nbrs[k], degree)) higher[count++] = nbrs[k];
+    }
+    free(nbrs);
+    return;
+  }
+
+  static void kernel_publish(GRAPH_T* graph, const size_t tid,
+                             Bitmap* visited, const size_t step,
+                             size_t* offset, VID_T* higher,
+                             MSG_MNGR_T* msg_mngr) {
+    Bitmap* global_border_vid_map = msg_mngr->GetGlobalBorderVidMap();
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VID_T globalid = graph->localid2globalid(i);
+      if (!global_border_vid_map->get_bit(globalid)) continue;
+      msg_mngr->SetBorderAdjacency(globalid, higher + offset[i],
+                                   offset[i + 1] - offset[i]);
+    }
+    return;
+  }
+
+  static void kernel_triangle(GRAPH_T* graph, const size_t tid,
+                              Bitmap* visited, const size_t step,
+                              size_t* offset, VID_T* higher,
+                              MSG_MNGR_T* msg_mngr, size_t* num_triangles) {
+    size_t local_num_triangles = 0;
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      VID_T* u_higher = higher + offset[i];
+      size_t u_size = offset[i + 1] - offset[i];
+      size_t count = 0;
+      for (size_t k = 0; k < u_size; k++) {
+        VID_T* v_higher = nullptr;
+        size_t v_size = 0;
+        if (graph->IsInGraph(u_higher[k])) {
+          VID_T j = graph->globalid2localid(u_higher[k]);
+          v_higher = higher + offset[j];
+          v_size = offset[j + 1] - offset[j];
+        } else {
+          auto adj = msg_mngr->GetBorderAdjacency(u_higher[k]);
+          v_higher = adj.first;
+          v_size = adj.second;
+        }
+        count += minigraph::utility::Intersect(u_higher, u_size, v_higher,
+                                               v_size);
+      }
+      graph->vdata_[i] = count;
+      local_num_triangles += count;
+    }
+    write_add(num_triangles, local_num_triangles);
+    return;
+  }
+
+ private:
+  static size_t GetMaxDegree(GRAPH_T* graph) {
+    size_t max_degree = 1;
+    for (size_t i = 0; i < graph->get_num_vertexes(); i++) {
+      size_t degree = graph->indegree_[i] + graph->outdegree_[i];
+      if (degree > max_degree) max_degree = degree;
+    }
+    return max_degree;
+  }
+};
+
+// Supersteps of a fragment:
+//   PEval: publish the degree of its vertexes to the global vdata. A
+//     fragment without border edges counts its triangles at once, as it may
+//     not get any IncEval.
+//   IncEval #1: publish N+ of its border vertexes via the message manager.
+//   IncEval #2: count triangles whose lowest ranked vertex it owns.
+template <typename GRAPH_T, typename CONTEXT_T>
+class TCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using VertexInfo = minigraph::graphs::VertexInfo<typename GRAPH_T::vid_t,
+                                                   typename GRAPH_T::vdata_t,
+                                                   typename GRAPH_T::edata_t>;
+  using TCAutoMap_T = TCAutoMap<GRAPH_T, CONTEXT_T>;
+
+ public:
+  TCPIE(minigraph::AutoMapBase<GRAPH_T, CONTEXT_T>* auto_map,
+        const CONTEXT_T& context)
+      : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
+
+  bool Init(GRAPH_T& graph,
+            minigraph::executors::TaskRunner* task_runner) override {
+    if (!graph.IsSorted()) graph.Sort(task_runner->GetParallelism());
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               TCAutoMap_T::kernel_init);
+    return true;
+  }
+
+  bool PEval(GRAPH_T& graph,
+             minigraph::executors::TaskRunner* task_runner) override {
+    LOG_INFO("PEval() - Processing gid: ", graph.gid_,
+             " num_vertexes: ", graph.get_num_vertexes());
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               TCAutoMap_T::kernel_degree,
+                               this->msg_mngr_->GetGlobalVdata());
+    size_t num_border_edges = 0;
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               TCAutoMap_T::kernel_border, &num_border_edges);
+    if (num_border_edges == 0) {
+      {
+        std::lock_guard<std::mutex> lck(mtx_);
+        num_inc_evals_[graph.get_gid()] = 2;
+      }
+      Eval(graph, task_runner, false);
+    }
+    return true;
+  }
+
+  bool IncEval(GRAPH_T& graph,
+               minigraph::executors::TaskRunner* task_runner) override {
+    size_t round = 0;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      round = num_inc_evals_[graph.get_gid()]++;
+    }
+    if (round > 1) return false;
+    if (!graph.IsSorted()) graph.Sort(task_runner->GetParallelism());
+    Eval(graph, task_runner, round == 0);
+    return round == 0;
+  }
+
+  // @brief: add the partial count b to the global count a.
+  bool Aggregate(void* a, void* b,
+                 minigraph::executors::TaskRunner* task_runner) override {
+    if (a == nullptr || b == nullptr) return false;
+    write_add((size_t*)a, *(size_t*)b);
+    return true;
+  }
+
+  size_t GetNumTriangles() const { return num_triangles_; }
+
+ private:
+  size_t num_triangles_ = 0;
+
+  std::mutex mtx_;
+  std::unordered_map<GID_T, size_t> num_inc_evals_;
+
+  // @brief: build N+ of all vertexes of the fragment, then either publish
+  // those of its border vertexes or count its triangles.
+  void Eval(GRAPH_T& graph, minigraph::executors::TaskRunner* task_runner,
+            const bool publish) {
+    auto scratch_arena = this->GetScratchArena();
+    size_t num_vertexes = graph.get_num_vertexes();
+    size_t* offset =
+        scratch_arena->template AcquireArray<size_t>(num_vertexes + 1, true);
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               TCAutoMap_T::kernel_count_higher,
+                               this->msg_mngr_->GetGlobalVdata(), offset);
+    for (size_t i = 0; i < num_vertexes; i++) offset[i + 1] += offset[i];
+    VID_T* higher = scratch_arena->template AcquireArray<VID_T>(
+        offset[num_vertexes] + 1);
+    this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                               TCAutoMap_T::kernel_fill_higher,
+                               this->msg_mngr_->GetGlobalVdata(), offset,
+                               higher);
+
+    if (publish) {
+      this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                                 TCAutoMap_T::kernel_publish, offset, higher,
+                                 this->msg_mngr_);
+    } else {
+      size_t num_triangles = 0;
+      this->auto_map_->ActiveMap(graph, task_runner, nullptr,
+                                 TCAutoMap_T::kernel_triangle, offset, higher,
+                                 this->msg_mngr_, &num_triangles);
+      LOG_INFO("GID: ", graph.get_gid(), " #triangles: ", num_triangles);
+      Aggregate(&num_triangles_, &num_triangles, task_runner);
+    }
+
+    scratch_arena->ReleaseArray(offset);
+    scratch_arena->ReleaseArray(higher);
+  }
+};
+
+struct Context {};
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+using TCPIE_T = TCPIE<CSR_T, Context>;
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::string work_space = FLAGS_i;
+  size_t num_workers_lc = FLAGS_lc;
+  size_t num_workers_cc = FLAGS_cc;
+  size_t num_workers_dc = FLAGS_dc;
+  size_t num_cores = FLAGS_cores;
+  size_t buffer_size = FLAGS_buffer_size;
+
+  Context context;
+  auto tc_auto_map = new TCAutoMap<CSR_T, Context>();
+  auto tc_pie = new TCPIE<CSR_T, Context>(tc_auto_map, context);
+  auto app_wrapper =
+      new minigraph::AppWrapper<TCPIE<CSR_T, Context>, CSR_T>(tc_pie);
+
+  minigraph::MiniGraphSys<CSR_T, TCPIE_T> minigraph_sys(
+      work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.RunSys();
+  LOG_INFO("#triangles: ", tc_pie->GetNumTriangles());
+  gflags::ShutDownCommandLineFlags();
+  exit(0);
+}
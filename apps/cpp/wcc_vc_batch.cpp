@@ -65,13 +65,14 @@ class WCCAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
 
   static bool kernel_pull_border_vertexes(GRAPH_T* graph, const size_t tid,
                                           Bitmap* visited, const size_t step,
+                                          const size_t begin, const size_t end,
                                           Bitmap* in_visited,
                                           Bitmap* global_border_vid_map,
                                           VDATA_T* global_border_vdata,
                                           StatisticInfo* si) {
     size_t local_num_border_vertexes = 0;
     if (global_border_vid_map->size_ == 0) return true;
-    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+    for (size_t i = begin + tid; i < end; i += step) {
       auto u = graph->GetVertexByIndex(i);
       if (u.vdata[0] > global_border_vdata[graph->localid2globalid(u.vid)]) {
         if (write_min(u.vdata,
@@ -106,13 +107,17 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
          const CONTEXT_T& context)
       : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
 
+  bool IsCheckpointable() const override { return true; }
+  bool IsEdgeStreamable() const override { return true; }
+
   bool Init(GRAPH_T& graph,
             minigraph::executors::TaskRunner* task_runner) override {
-    Bitmap* visited = new Bitmap(graph.max_vid_);
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.max_vid_);
     visited->fill();
     this->auto_map_->ActiveMap(graph, task_runner, visited,
                                WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_init);
-    delete visited;
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
@@ -126,20 +131,22 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     auto start_time = std::chrono::system_clock::now();
 
     StatisticInfo global_si(0, 1);
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
     in_visited->fill();
     out_visited->clear();
 
-    Bitmap visited(graph.get_num_vertexes());
-    visited.clear();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    visited->clear();
     bool run = true;
     size_t count = 0;
     std::vector<StatisticInfo> vec_si;
     while (run) {
       auto iter_start_time = std::chrono::system_clock::now();
       run = this->auto_map_->ActiveEMap(in_visited, out_visited, graph,
-                                        task_runner, vid_map, &visited,
+                                        task_runner, vid_map, visited,
                                         &global_si);
       auto iter_end_time = std::chrono::system_clock::now();
       //LOG_INFO("#", count++, " ", out_visited->get_num_bit());
@@ -148,7 +155,7 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     }
 
     //this->auto_map_->ActiveMap(
-    //    graph, task_runner, &visited,
+    //    graph, task_runner, visited,
     //    WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_push_border_vertexes,
     //    this->msg_mngr_->GetGlobalBorderVidMap(),
     //    this->msg_mngr_->GetGlobalVdata(), &global_si);
@@ -162,7 +169,7 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     global_si.num_iters = count;
 
     // for (size_t i = 0; i < graph.get_num_vertexes(); i++) {
-    //   if (visited.get_bit(i)) {
+    //   if (visited->get_bit(i)) {
     //     auto u = graph.GetVertexByIndex(i);
     //     global_si.sum_out_degree += u.outdegree;
     //     global_si.sum_in_degree += u.indegree;
@@ -170,7 +177,7 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     // }
 
     // global_si.num_vertexes = graph.get_num_vertexes();
-    // global_si.num_active_vertexes = visited.get_num_bit();
+    // global_si.num_active_vertexes = visited->get_num_bit();
     // global_si.num_edges = graph.get_num_edges();
     // global_si.ShowInfo();
 
@@ -180,8 +187,9 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
                      .count() /
                  (double)CLOCKS_PER_SEC);
 
-    delete in_visited;
-    delete out_visited;
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
@@ -190,18 +198,21 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     auto start_time = std::chrono::system_clock::now();
 
     StatisticInfo global_si(1, 1);
-    Bitmap visited(graph.get_num_vertexes());
-    Bitmap output_visited(graph.get_num_vertexes());
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
-    output_visited.clear();
-    visited.clear();
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* output_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    output_visited->clear();
+    visited->clear();
     in_visited->clear();
 
     auto vid_map = this->msg_mngr_->GetVidMap();
 
-    this->auto_map_->ActiveMap(
-        graph, task_runner, &visited,
+    this->auto_map_->ActiveBlockMap(
+        graph, task_runner, visited,
         WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_pull_border_vertexes, in_visited,
         this->msg_mngr_->GetGlobalBorderVidMap(),
         this->msg_mngr_->GetGlobalVdata(), &global_si);
@@ -211,7 +222,7 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     std::vector<StatisticInfo> vec_si;
     while (run) {
       run = this->auto_map_->ActiveEMap(in_visited, out_visited, graph,
-                                        task_runner, vid_map, &visited,
+                                        task_runner, vid_map, visited,
                                         &global_si);
       std::swap(in_visited, out_visited);
       count_iters++;
@@ -223,16 +234,16 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
     }
 
     this->auto_map_->ActiveMap(
-        graph, task_runner, &output_visited,
+        graph, task_runner, output_visited,
         WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_push_border_vertexes,
         this->msg_mngr_->GetGlobalBorderVidMap(),
         this->msg_mngr_->GetGlobalVdata(), &global_si);
 
-    delete in_visited;
-    delete out_visited;
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
     auto end_time = std::chrono::system_clock::now();
     global_si.num_vertexes = graph.get_num_vertexes();
-    global_si.num_active_vertexes = output_visited.get_num_bit();
+    global_si.num_active_vertexes = output_visited->get_num_bit();
     global_si.num_edges = graph.get_num_edges();
     global_si.num_iters = count_iters;
     global_si.elapsed_time =
@@ -241,7 +252,7 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
             .count() /
         (double)CLOCKS_PER_SEC;
     for (size_t i = 0; i < graph.get_num_vertexes(); i++) {
-      if (visited.get_bit(i)) {
+      if (visited->get_bit(i)) {
         auto u = graph.GetVertexByIndex(i);
         global_si.sum_out_degree += u.outdegree;
         global_si.sum_in_degree += u.indegree;
@@ -250,6 +261,8 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
 
     global_si.ShowInfo();
 
+    scratch_arena->ReleaseBitmap(visited);
+    scratch_arena->ReleaseBitmap(output_visited);
     return !(global_si.num_active_vertexes <= graph.get_num_vertexes() / 10000);
   }
 
@@ -281,7 +294,10 @@ int main(int argc, char* argv[]) {
 
   minigraph::MiniGraphSys<CSR_T, WCCPIE_T> minigraph_sys(
       work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
-      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+      buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler,
+      FLAGS_edge_block_size);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
   minigraph_sys.RunSys();
   gflags::ShutDownCommandLineFlags();
   exit(0);
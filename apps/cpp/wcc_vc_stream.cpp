@@ -6,6 +6,10 @@
 #include "portability/sys_types.h"
 #include "utility/bitmap.h"
 #include "utility/logging.h"
+#include <map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 template <typename GRAPH_T, typename CONTEXT_T>
 class WCCAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
@@ -31,11 +35,45 @@ class WCCAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
   }
 
   static void kernel_init(GRAPH_T* graph, const size_t tid, Bitmap* visited,
-                          const size_t step, VDATA_T* vdata) {
+                          const size_t step, VDATA_T* vdata,
+                          Bitmap* active_map) {
     for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
       auto u = graph->GetVertexByIndex(i);
       graph->vdata_[i] = graph->localid2globalid(u.vid);
       write_min(&vdata[graph->localid2globalid(i)], graph->localid2globalid(i));
+      active_map->set_bit(graph->localid2globalid(i));
+    }
+    return;
+  }
+
+  // @brief: move the vertexes of graph marked in active_map, i.e. whose
+  // labels changed since graph was last processed, into in_visited.
+  static void kernel_take_frontier(GRAPH_T* graph, const size_t tid,
+                                   Bitmap* visited, const size_t step,
+                                   Bitmap* in_visited, Bitmap* active_map) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      auto globalid = graph->localid2globalid(i);
+      if (!active_map->get_bit(globalid)) continue;
+      active_map->rm_bit(globalid);
+      in_visited->set_bit(i);
+    }
+    return;
+  }
+
+  // @brief: vertexes of in_visited whose labels have been reset pull them
+  // again from their in-neighbors.
+  static void kernel_pull(GRAPH_T* graph, const size_t tid, Bitmap* visited,
+                          const size_t step, Bitmap* in_visited, Bitmap* reset,
+                          VDATA_T* global_border_vdata) {
+    for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
+      if (!in_visited->get_bit(i)) continue;
+      auto globalid = graph->localid2globalid(i);
+      if (!reset->get_bit(globalid)) continue;
+      reset->rm_bit(globalid);
+      auto u = graph->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.indegree; ++j)
+        write_min(&global_border_vdata[globalid],
+                  global_border_vdata[u.in_edges[j]]);
     }
     return;
   }
@@ -43,7 +81,7 @@ class WCCAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
   static void kernel_update(GRAPH_T* graph, const size_t tid, Bitmap* visited,
                             const size_t step, Bitmap* in_visited,
                             Bitmap* out_visited, VID_T* vid_map,
-                            VDATA_T* global_border_vdata,
+                            Bitmap* active_map, VDATA_T* global_border_vdata,
                             size_t* num_active_vertices) {
     for (size_t i = tid; i < graph->get_num_vertexes(); i += step) {
       if (!in_visited->get_bit(i)) continue;
@@ -62,6 +100,8 @@ class WCCAutoMap : public minigraph::AutoMapBase<GRAPH_T, CONTEXT_T> {
                       global_border_vdata[graph->localid2globalid(i)])) {
           if (graph->IsInGraph(u.out_edges[j])) {
             out_visited->set_bit(vid_map[u.out_edges[j]]);
+          } else {
+            active_map->set_bit(u.out_edges[j]);
           }
           write_add(num_active_vertices, (size_t)1);
         }
@@ -82,14 +122,18 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
          const CONTEXT_T& context)
       : minigraph::AutoAppBase<GRAPH_T, CONTEXT_T>(auto_map, context) {}
 
+  bool IsCheckpointable() const override { return true; }
+
   bool Init(GRAPH_T& graph,
             minigraph::executors::TaskRunner* task_runner) override {
-    Bitmap* visited = new Bitmap(graph.max_vid_);
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.max_vid_);
     visited->fill();
     this->auto_map_->ActiveMap(graph, task_runner, visited,
                                WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_init,
-                               this->msg_mngr_->GetGlobalVdata());
-    delete visited;
+                               this->msg_mngr_->GetGlobalVdata(),
+                               this->msg_mngr_->GetGlobalActiveVidMap());
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
@@ -99,21 +143,29 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
              " num_vertexes: ", graph.get_num_vertexes());
     if (!graph.IsInGraph(0)) return true;
     auto start_time = std::chrono::system_clock::now();
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    visited->clear();
+    // All vertexes are processed here, so their marks are dropped.
+    this->auto_map_->ActiveMap(
+        graph, task_runner, visited,
+        WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_take_frontier, in_visited,
+        this->msg_mngr_->GetGlobalActiveVidMap());
     in_visited->fill();
     out_visited->clear();
-    Bitmap visited(graph.get_num_vertexes());
-    visited.clear();
 
     size_t num_active_vertices = 0;
 
     size_t count = 0;
     while (!in_visited->empty()) {
       this->auto_map_->ActiveMap(
-          graph, task_runner, &visited,
+          graph, task_runner, visited,
           WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_update, in_visited,
           out_visited, this->msg_mngr_->GetVidMap(),
+          this->msg_mngr_->GetGlobalActiveVidMap(),
           this->msg_mngr_->GetGlobalVdata(), &num_active_vertices);
       LOG_INFO("#", count++);
       std::swap(in_visited, out_visited);
@@ -128,35 +180,54 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
                      .count() /
                  (double)CLOCKS_PER_SEC);
 
-    delete in_visited;
-    delete out_visited;
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    scratch_arena->ReleaseBitmap(visited);
     return true;
   }
 
   bool IncEval(GRAPH_T& graph,
                minigraph::executors::TaskRunner* task_runner) override {
     auto start_time = std::chrono::system_clock::now();
-    Bitmap visited(graph.get_num_vertexes());
-    Bitmap output_visited(graph.get_num_vertexes());
-    Bitmap* in_visited = new Bitmap(graph.get_num_vertexes());
-    Bitmap* out_visited = new Bitmap(graph.get_num_vertexes());
-    output_visited.clear();
-    visited.clear();
-    in_visited->fill();
+    auto scratch_arena = this->GetScratchArena();
+    Bitmap* visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* output_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* in_visited = scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    Bitmap* out_visited =
+        scratch_arena->AcquireBitmap(graph.get_num_vertexes());
+    output_visited->clear();
+    visited->clear();
+    in_visited->clear();
+    out_visited->clear();
+
+    // Start from the vertexes whose labels changed since, rather than all.
+    this->auto_map_->ActiveMap(
+        graph, task_runner, visited,
+        WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_take_frontier, in_visited,
+        this->msg_mngr_->GetGlobalActiveVidMap());
+    if (this->context_.reset != nullptr)
+      this->auto_map_->ActiveMap(graph, task_runner, visited,
+                                 WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_pull,
+                                 in_visited, this->context_.reset,
+                                 this->msg_mngr_->GetGlobalVdata());
 
     size_t num_active_vertices = 0;
     while (!in_visited->empty()) {
       this->auto_map_->ActiveMap(
-          graph, task_runner, &visited,
+          graph, task_runner, visited,
           WCCAutoMap<GRAPH_T, CONTEXT_T>::kernel_update, in_visited,
           out_visited, this->msg_mngr_->GetVidMap(),
+          this->msg_mngr_->GetGlobalActiveVidMap(),
           this->msg_mngr_->GetGlobalVdata(), &num_active_vertices);
       std::swap(in_visited, out_visited);
       out_visited->clear();
     }
 
-    delete in_visited;
-    delete out_visited;
+    scratch_arena->ReleaseBitmap(in_visited);
+    scratch_arena->ReleaseBitmap(out_visited);
+    scratch_arena->ReleaseBitmap(visited);
+    scratch_arena->ReleaseBitmap(output_visited);
     return num_active_vertices != 0;
   }
 
@@ -166,10 +237,55 @@ class WCCPIE : public minigraph::AutoAppBase<GRAPH_T, CONTEXT_T> {
   }
 };
 
-struct Context {};
+struct Context {
+  // Vertexes whose labels have been reset by edge deletions, to pull from
+  // their in-neighbors in an incremental run.
+  Bitmap* reset = nullptr;
+};
 
 using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
 using WCCPIE_T = WCCPIE<CSR_T, Context>;
+using DeltaStore_T = minigraph::utility::io::DeltaStore<CSR_T>;
+
+// @brief: seed an incremental run from the edge updates of batch, of which
+// the last one of each edge holds. A deletion inside a component resets the
+// labels of all its vertexes, which then pull them again from their
+// in-neighbors, while an insertion pushes the label of src to dst.
+void Seed(WCCPIE_T* wcc_pie,
+          const std::vector<DeltaStore_T::DeltaEdge>& batch) {
+  auto msg_mngr = wcc_pie->msg_mngr_;
+  auto label = msg_mngr->GetGlobalVdata();
+  auto active_map = msg_mngr->GetGlobalActiveVidMap();
+  std::map<std::pair<vid_t, vid_t>, uint8_t> op_by_edge;
+  for (auto& e : batch) op_by_edge[std::make_pair(e.vid, e.nbr)] = e.op;
+
+  std::unordered_set<vdata_t> reset_labels;
+  for (auto& iter : op_by_edge) {
+    auto src = iter.first.first, dst = iter.first.second;
+    if (iter.second == DeltaStore_T::kDelete && label[src] == label[dst])
+      reset_labels.insert(label[src]);
+  }
+  size_t num_reset = 0;
+  if (!reset_labels.empty()) {
+    wcc_pie->context_.reset = new Bitmap(msg_mngr->get_max_vid());
+    wcc_pie->context_.reset->clear();
+    for (vid_t vid = 0; vid < msg_mngr->get_aligned_max_vid(); vid++) {
+      if (!reset_labels.count(label[vid])) continue;
+      label[vid] = vid;
+      active_map->set_bit(vid);
+      wcc_pie->context_.reset->set_bit(vid);
+      num_reset++;
+    }
+  }
+  for (auto& iter : op_by_edge) {
+    auto src = iter.first.first, dst = iter.first.second;
+    if (iter.second == DeltaStore_T::kInsert &&
+        write_min(&label[dst], label[src]))
+      active_map->set_bit(dst);
+  }
+  LOG_INFO("Seed: ", op_by_edge.size(), " edges updated, ", num_reset,
+           " labels reset.");
+}
 
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
@@ -189,7 +305,16 @@ int main(int argc, char* argv[]) {
   minigraph::MiniGraphSys<CSR_T, WCCPIE_T> minigraph_sys(
       work_space, num_workers_lc, num_workers_cc, num_workers_dc, num_cores,
       buffer_size, app_wrapper, FLAGS_mode, FLAGS_niters, FLAGS_scheduler);
+  minigraph_sys.SetCheckpoint(FLAGS_checkpoint_interval, FLAGS_resume);
+  minigraph_sys.SetRunCost(FLAGS_run_cost);
+  minigraph_sys.SetCompaction(FLAGS_compact_threshold);
+  std::vector<DeltaStore_T::DeltaEdge> batch;
+  if (minigraph_sys.SetStreamResult("wcc", FLAGS_incremental, &batch)) {
+    Seed(wcc_pie, batch);
+    minigraph_sys.SetIncremental();
+  }
   minigraph_sys.RunSys();
+  delete wcc_pie->context_.reset;
   gflags::ShutDownCommandLineFlags();
   exit(0);
 }
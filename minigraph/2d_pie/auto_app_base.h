@@ -62,6 +62,24 @@ class AutoAppBase {
   virtual bool Aggregate(void* partial_result_a, void* partial_result_b,
                          executors::TaskRunner* task_runner) = 0;
 
+  // @brief: whether the whole state of the app lives in vdata and global
+  // border vdata, the only state checkpoints save and restore. Apps keeping
+  // state of their own leave it false, so MiniGraphSys::SetCheckpoint()
+  // refuses them.
+  virtual bool IsCheckpointable() const { return false; }
+
+  // @brief: whether every kernel of the app touching edges runs through
+  // ActiveEMap, ActiveVMap or ActiveBlockMap and only reads the edges of
+  // vertexes of the current block. In streaming mode, see -edge_block_size,
+  // the edges of other vertexes aren't resident, so MiniGraphSys refuses
+  // apps that leave it false.
+  virtual bool IsEdgeStreamable() const { return false; }
+
+  // @brief: scratch arena of the calling worker. Frontier bitmaps acquired
+  // from it should be released back at the end of Init, PEval and IncEval.
+  utility::ScratchArena* GetScratchArena() {
+    return auto_map_->GetScratchArena();
+  }
 
   AutoMap_T* auto_map_ = nullptr;
   CONTEXT_T context_;
@@ -18,6 +18,9 @@
 #include "portability/sys_types.h"
 #include "utility/atomic.h"
 #include "utility/bitmap.h"
+#include "utility/io/edge_block_reader.h"
+#include "utility/scratch_arena.h"
+#include "utility/set_intersection.h"
 #include "utility/thread_pool.h"
 
 namespace minigraph {
@@ -51,17 +54,20 @@ class AutoMapBase {
       LOG_INFO("Segmentation fault: ", "visited is nullptr.");
     }
     out_visited->clear();
-    std::vector<std::function<void()>> tasks;
     bool global_visited = false;
 
-    for (size_t tid = 0; tid < task_runner->GetParallelism(); ++tid) {
-      auto task = std::bind(&AutoMapBase<GRAPH_T, CONTEXT_T>::ActiveEReduce,
-                            this, &graph, in_visited, out_visited, tid,
-                            task_runner->GetParallelism(), &global_visited,
-                            vid_map, visited, si);
-      tasks.push_back(task);
-    }
-    task_runner->Run(tasks, false);
+    auto run_block = [&](size_t begin, size_t end) {
+      std::vector<std::function<void()>> tasks;
+      for (size_t tid = 0; tid < task_runner->GetParallelism(); ++tid) {
+        auto task = std::bind(&AutoMapBase<GRAPH_T, CONTEXT_T>::ActiveEReduce,
+                              this, &graph, in_visited, out_visited, tid,
+                              task_runner->GetParallelism(), begin, end,
+                              &global_visited, vid_map, visited, si);
+        tasks.push_back(task);
+      }
+      task_runner->Run(tasks, false);
+    };
+    ForEachEdgeBlock(graph, run_block);
     return global_visited;
   };
 
@@ -73,18 +79,22 @@ class AutoMapBase {
       LOG_INFO("Segmentation fault: ", "visited is nullptr.");
     }
     out_visited->clear();
-    std::vector<std::function<void()>> tasks;
     bool global_visited = false;
     size_t active_vertices = 0;
-    for (size_t tid = 0; tid < task_runner->GetParallelism(); ++tid) {
-      auto task = std::bind(&AutoMapBase<GRAPH_T, CONTEXT_T>::ActiveVReduce,
-                            this, &graph, in_visited, out_visited, tid,
-                            task_runner->GetParallelism(), &global_visited,
-                            &active_vertices, vid_map, visited);
-      tasks.push_back(task);
-    }
-    // LOG_INFO("AutoMap ActiveVMap Run");
-    task_runner->Run(tasks, false);
+    auto run_block = [&](size_t begin, size_t end) {
+      std::vector<std::function<void()>> tasks;
+      for (size_t tid = 0; tid < task_runner->GetParallelism(); ++tid) {
+        auto task = std::bind(&AutoMapBase<GRAPH_T, CONTEXT_T>::ActiveVReduce,
+                              this, &graph, in_visited, out_visited, tid,
+                              task_runner->GetParallelism(), begin, end,
+                              &global_visited, &active_vertices, vid_map,
+                              visited);
+        tasks.push_back(task);
+      }
+      // LOG_INFO("AutoMap ActiveVMap Run");
+      task_runner->Run(tasks, false);
+    };
+    ForEachEdgeBlock(graph, run_block);
     // LOG_INFO("# ", active_vertices);
     return global_visited;
   };
@@ -105,6 +115,35 @@ class AutoMapBase {
     return;
   };
 
+  // @brief: ActiveBlockMap is ActiveMap for kernels that touch edges, so
+  // that they also run on fragments whose edges are streamed from disk. The
+  // kernel is invoked as f(graph, tid, visited, step, begin, end, args...)
+  // and only vertexes in [begin, end) have their edges resident.
+  template <class F, class... Args>
+  auto ActiveBlockMap(GRAPH_T& graph, executors::TaskRunner* task_runner,
+                      Bitmap* visited, F&& f, Args&&... args) -> void {
+    assert(task_runner != nullptr);
+    auto run_block = [&](size_t begin, size_t end) {
+      std::vector<std::function<void()>> tasks;
+      for (size_t tid = 0; tid < task_runner->GetParallelism(); ++tid) {
+        auto task = std::bind(f, &graph, tid, visited,
+                              task_runner->GetParallelism(), begin, end,
+                              args...);
+        tasks.push_back(task);
+      }
+      task_runner->Run(tasks, false);
+    };
+    ForEachEdgeBlock(graph, run_block);
+    return;
+  };
+
+  // @brief: scratch arena of the calling worker, from which frontiers and
+  // temporaries of Init, PEval and IncEval are acquired.
+  utility::ScratchArena* GetScratchArena() {
+    static thread_local utility::ScratchArena scratch_arena;
+    return &scratch_arena;
+  }
+
   template <class F, class... Args>
   auto ParallelDo(executors::TaskRunner* task_runner, F&& f, Args&&... args)
       -> void {
@@ -120,8 +159,23 @@ class AutoMapBase {
   };
 
  private:
+  // @brief: invoke run_block(begin, end) on every range of vertexes whose
+  // edges are resident. That is a single range for in-memory fragments, and
+  // one range per edge block for fragments in streaming mode.
+  template <class BLOCK_F>
+  void ForEachEdgeBlock(GRAPH_T& graph, BLOCK_F& run_block) {
+    if (!graph.IsEdgeStreaming()) {
+      run_block(0, graph.get_num_vertexes());
+      return;
+    }
+    utility::io::EdgeBlockReader<GRAPH_T> edge_block_reader(&graph);
+    size_t begin = 0, end = 0;
+    while (edge_block_reader.Next(&begin, &end)) run_block(begin, end);
+  }
+
   void ActiveEReduce(GRAPH_T* graph, Bitmap* in_visited, Bitmap* out_visited,
-                     const size_t tid, const size_t step, bool* global_visited,
+                     const size_t tid, const size_t step, const size_t begin,
+                     const size_t end, bool* global_visited,
                      VID_T* vid_map = nullptr, Bitmap* visited = nullptr,
                      StatisticInfo* si = nullptr) {
     size_t local_active_vertices = 0;
@@ -132,7 +186,7 @@ class AutoMapBase {
     size_t local_sum_dlv_times_dgv = 0;
     size_t local_sum_dlv = 0;
     size_t local_sum_dgv = 0;
-    for (size_t index = tid; index < graph->get_num_vertexes(); index += step) {
+    for (size_t index = begin + tid; index < end; index += step) {
       if (in_visited->get_bit(index) == 0) continue;
       VertexInfo&& u = graph->GetVertexByIndex(index);
       // u.ShowVertexInfo();
@@ -178,11 +232,12 @@ class AutoMapBase {
   }
 
   void ActiveVReduce(GRAPH_T* graph, Bitmap* in_visited, Bitmap* out_visited,
-                     const size_t tid, const size_t step, bool* global_visited,
+                     const size_t tid, const size_t step, const size_t begin,
+                     const size_t end, bool* global_visited,
                      size_t* active_vertices, VID_T* vid_map,
                      Bitmap* visited = nullptr) {
     size_t local_active_vertices = 0;
-    for (size_t index = tid; index < graph->get_num_vertexes(); index += step) {
+    for (size_t index = begin + tid; index < end; index += step) {
       if (!in_visited->get_bit(index)) continue;
       if (!graph->IsInGraph(index)) continue;
       VertexInfo&& u = graph->GetVertexByIndex(index);
@@ -1,6 +1,7 @@
 #ifndef MINIGRAPH_COMPUTING_COMPONENT_H
 #define MINIGRAPH_COMPUTING_COMPONENT_H
 
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 
@@ -104,6 +105,7 @@ class ComputingComponent : public ComponentBase<typename GRAPH_T::gid_t> {
     GRAPH_T* graph = (GRAPH_T*)data_mngr_->GetGraph(gid);
     executors::TaskRunner* task_runner =
         scheduled_executor_->RequestTaskRunner({1, (unsigned)p_[gid]});
+    auto start_time = std::chrono::system_clock::now();
     if (this->get_superstep_via_gid(gid) == 0) {
       app_wrapper_->auto_app_->Init(*graph, task_runner);
       app_wrapper_->auto_app_->PEval(*graph, task_runner);
@@ -113,6 +115,10 @@ class ComputingComponent : public ComponentBase<typename GRAPH_T::gid_t> {
           ? this->state_machine_->ProcessEvent(gid, CHANGED)
           : this->state_machine_->ProcessEvent(gid, NOTHINGCHANGED);
     }
+    app_wrapper_->msg_mngr_->UpdateRunCost(
+        gid, std::chrono::duration<float>(std::chrono::system_clock::now() -
+                                          start_time)
+                 .count());
     scheduled_executor_->RecycleTaskRunner(task_runner);
     this->add_superstep_via_gid(gid);
     partial_result_queue_->push(gid);
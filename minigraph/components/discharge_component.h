@@ -5,6 +5,7 @@
 
 #include "components/component_base.h"
 #include "portability/sys_data_structure.h"
+#include "utility/io/checkpoint_mngr.h"
 #include "utility/io/csr_io_adapter.h"
 #include "utility/thread_pool.h"
 
@@ -42,7 +43,8 @@ class DischargeComponent : public ComponentBase<typename GRAPH_T::gid_t> {
       std::atomic<bool>* system_switch,
       std::unique_lock<std::mutex>* system_switch_lck,
       std::condition_variable* system_switch_cv, const size_t num_iter,
-      std::string mode = "Default")
+      std::string mode = "Default",
+      utility::io::CheckpointMngr<GRAPH_T>* checkpoint_mngr = nullptr)
       : ComponentBase<GID_T>(thread_pool, superstep_by_gid, global_superstep,
                              state_machine) {
     task_queue_ = task_queue;
@@ -63,6 +65,7 @@ class DischargeComponent : public ComponentBase<typename GRAPH_T::gid_t> {
     mode_ = mode;
     communication_matrix_ = this->msg_mngr_->GetCommunicationMatrix();
     num_iter_ = num_iter;
+    checkpoint_mngr_ = checkpoint_mngr;
     XLOG(INFO, "Init DischargeComponent: Finish.");
   }
 
@@ -95,6 +98,7 @@ class DischargeComponent : public ComponentBase<typename GRAPH_T::gid_t> {
           LOG_INFO("step: ", this->get_global_superstep(), " ", num_iter_);
           if (this->state_machine_->IsTerminated() ||
               this->get_global_superstep() > num_iter_) {
+            if (checkpoint_mngr_ != nullptr) checkpoint_mngr_->Wait();
             system_switch_cv_->wait(*system_switch_lck_,
                                     [&] { return system_switch_->load(); });
             system_switch_->store(false);
@@ -136,6 +140,16 @@ class DischargeComponent : public ComponentBase<typename GRAPH_T::gid_t> {
                                 this->state_machine_->GetState(tmp_gid));
     }
 
+    // No fragment holds a border neighbor list here.
+    msg_mngr_->PublishBorderAdjacency();
+
+    // Checkpoint before fragments are triggered, as long as no one updates
+    // vdata, global_border_vdata or the superstep counters.
+    if (checkpoint_mngr_ != nullptr &&
+        checkpoint_mngr_->IsDue(this->get_global_superstep()))
+      checkpoint_mngr_->Take(this->get_global_superstep(),
+                             this->superstep_by_gid_, msg_mngr_, pt_by_gid_);
+
     auto out_rc_ = this->state_machine_->GetAllinStateX(RC);
     auto out_rt_ = this->state_machine_->GetAllinStateX(RT);
     auto out_rts_ = this->state_machine_->GetAllinStateX(RTS);
@@ -201,6 +215,8 @@ class DischargeComponent : public ComponentBase<typename GRAPH_T::gid_t> {
   bool* communication_matrix_;
 
   size_t num_iter_ = 0;
+
+  utility::io::CheckpointMngr<GRAPH_T>* checkpoint_mngr_ = nullptr;
 };
 
 }  // namespace components
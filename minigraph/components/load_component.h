@@ -5,6 +5,7 @@
 #include <memory>
 #include <queue>
 #include <string>
+#include <vector>
 
 #include <folly/ProducerConsumerQueue.h>
 #include <folly/synchronization/NativeSemaphore.h>
@@ -115,6 +116,15 @@ class LoadComponent : public ComponentBase<typename GRAPH_T::gid_t> {
 
   void Stop() override { switch_ = false; }
 
+  // @brief: in global superstep superstep, read the fragments marked in
+  // active regardless of their dependencies, e.g. the fragments touched by
+  // the edge updates of an incremental run.
+  void SetActiveFragments(std::vector<char>&& active,
+                          const size_t superstep) {
+    active_ = std::move(active);
+    active_superstep_ = superstep;
+  }
+
  private:
   void ProcessGraph(GID_T gid, folly::NativeSemaphore& sem,
                     std::string mode = "default") {
@@ -122,6 +132,9 @@ class LoadComponent : public ComponentBase<typename GRAPH_T::gid_t> {
     auto read = false;
     if (this->get_global_superstep() == 0) {
       read = true;
+    } else if (this->get_global_superstep() == active_superstep_ &&
+               gid < active_.size() && active_[gid]) {
+      read = true;
     } else {
       for (GID_T y = 0; y < pt_by_gid_->size(); y++) {
         if (this->msg_mngr_->CheckDependenes(gid, y)) {
@@ -185,6 +198,9 @@ class LoadComponent : public ComponentBase<typename GRAPH_T::gid_t> {
 
   std::string mode_ = "default";
 
+  std::vector<char> active_;
+  size_t active_superstep_ = 0;
+
   minigraph::scheduler::SubGraphsSchedulerBase<GID_T>* scheduler_ = nullptr;
 };
 
@@ -0,0 +1,227 @@
+#ifndef MINIGRAPH_GRAPHS_CSR_BUILDER_H
+#define MINIGRAPH_GRAPHS_CSR_BUILDER_H
+
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "graphs/edgelist.h"
+#include "graphs/immutable_csr.h"
+#include "portability/sys_types.h"
+#include "utility/bitmap.h"
+#include "utility/logging.h"
+#include "utility/memory.h"
+#include "utility/thread_pool.h"
+
+namespace minigraph {
+namespace graphs {
+
+// CSRBuilder constructs ImmutableCSRs straight from an array of edges. It
+// counts degrees by global id, assigns local ids and edge offsets by
+// parallel prefix sums, and scatters each edge once into the edge arrays of
+// the fragments, so that no VertexInfo is allocated per vertex and edges are
+// not copied a second time. A fragment holds the in- and out-edges of its
+// vertexes; local ids follow global ids as in the ImmutableCSR constructor.
+template <typename GID_T, typename VID_T, typename VDATA_T, typename EDATA_T>
+class CSRBuilder {
+  using CSR_T = ImmutableCSR<GID_T, VID_T, VDATA_T, EDATA_T>;
+  using EDGE_LIST_T = EdgeList<GID_T, VID_T, VDATA_T, EDATA_T>;
+
+ public:
+  // @param: sort the edges of each vertex by global id, see
+  // ImmutableCSR::Sort(), and whether to drop self loops.
+  CSRBuilder(const size_t cores = 1, const bool sort = false,
+             const bool skip_self_loops = false) {
+    cores_ = std::max((size_t)1, cores);
+    sort_ = sort;
+    skip_self_loops_ = skip_self_loops;
+    thread_pool_ = std::make_unique<utility::CPUThreadPool>(cores_, 1);
+  }
+  ~CSRBuilder() = default;
+
+  // @brief: build the fragments out of num_edges pairs of vids in edges,
+  // weighted by edata unless it is nullptr. Vertex vid goes to fragment
+  // gid_of(vid) < num_fragments, or to none if it is GID_MAX, and vertexes
+  // without edges are left out.
+  // @param: max_vid bounds the vids in edges. vid_map, if not nullptr, is
+  // set to the local id of each vertex by global id.
+  // @return: the fragments by gid, nullptr for those without vertexes.
+  template <typename GID_OF_T>
+  std::vector<CSR_T*> Build(const VID_T* edges, const EDATA_T* edata,
+                            const size_t num_edges, const VID_T max_vid,
+                            GID_OF_T gid_of, const size_t num_fragments,
+                            VID_T* vid_map = nullptr) {
+    size_t num_ids = (size_t)max_vid + 1;
+    size_t k = num_fragments;
+    std::vector<size_t> indegree(num_ids, 0), outdegree(num_ids, 0);
+    thread_pool_->ParallelFor(num_edges, [&](size_t tid, size_t j) {
+      VID_T src = edges[2 * j], dst = edges[2 * j + 1];
+      if (skip_self_loops_ && src == dst) return;
+      if (gid_of(src) != GID_MAX) __sync_fetch_and_add(&outdegree[src], 1);
+      if (gid_of(dst) != GID_MAX) __sync_fetch_and_add(&indegree[dst], 1);
+    });
+
+    // Each thread takes a block of global ids, hence a block of local ids of
+    // every fragment, starting where the blocks of the previous threads end.
+    std::vector<size_t> num_vertexes(cores_ * k, 0);
+    std::vector<size_t> sum_in_edges(cores_ * k, 0);
+    std::vector<size_t> sum_out_edges(cores_ * k, 0);
+    std::vector<VID_T> max_vids(cores_ * k, 0);
+    thread_pool_->ParallelFor(num_ids, [&](size_t tid, size_t vid) {
+      if (indegree[vid] + outdegree[vid] == 0) return;
+      size_t i = tid * k + gid_of(vid);
+      ++num_vertexes[i];
+      sum_in_edges[i] += indegree[vid];
+      sum_out_edges[i] += outdegree[vid];
+      max_vids[i] = vid;
+    });
+    std::vector<CSR_T*> graphs(k, nullptr);
+    for (size_t gid = 0; gid < k; gid++) {
+      size_t n = 0, sum_in = 0, sum_out = 0;
+      VID_T fragment_max_vid = 0;
+      for (size_t tid = 0; tid < cores_; tid++) {
+        size_t i = tid * k + gid;
+        std::swap(n, num_vertexes[i]);
+        n += num_vertexes[i];
+        std::swap(sum_in, sum_in_edges[i]);
+        sum_in += sum_in_edges[i];
+        std::swap(sum_out, sum_out_edges[i]);
+        sum_out += sum_out_edges[i];
+        fragment_max_vid = std::max(fragment_max_vid, max_vids[i]);
+      }
+      if (n == 0) continue;
+      graphs[gid] = Allocate(gid, n, sum_in, sum_out, fragment_max_vid + 1,
+                             edata != nullptr);
+    }
+
+    // Set the vertex arrays and turn degrees into cursors of edge offsets.
+    thread_pool_->ParallelFor(num_ids, [&](size_t tid, size_t vid) {
+      if (indegree[vid] + outdegree[vid] == 0) return;
+      GID_T gid = gid_of(vid);
+      size_t i = tid * k + gid;
+      auto graph = graphs[gid];
+      VID_T local_id = num_vertexes[i]++;
+      graph->globalid_by_index_[local_id] = vid;
+      graph->localid_by_globalid_[vid] = local_id;
+      graph->bitmap_->set_bit(vid);
+      if (vid_map != nullptr) vid_map[vid] = local_id;
+      graph->indegree_[local_id] = indegree[vid];
+      graph->outdegree_[local_id] = outdegree[vid];
+      graph->in_offset_[local_id] = sum_in_edges[i];
+      graph->out_offset_[local_id] = sum_out_edges[i];
+      sum_in_edges[i] += indegree[vid];
+      sum_out_edges[i] += outdegree[vid];
+      indegree[vid] = graph->in_offset_[local_id];
+      outdegree[vid] = graph->out_offset_[local_id];
+    });
+
+    thread_pool_->ParallelFor(num_edges, [&](size_t tid, size_t j) {
+      VID_T src = edges[2 * j], dst = edges[2 * j + 1];
+      if (skip_self_loops_ && src == dst) return;
+      GID_T src_gid = gid_of(src), dst_gid = gid_of(dst);
+      if (src_gid != GID_MAX) {
+        auto graph = graphs[src_gid];
+        size_t offset = __sync_fetch_and_add(&outdegree[src], 1);
+        graph->out_edges_[offset] = dst;
+        if (edata != nullptr)
+          graph->edata_[graph->sum_in_edges_ + offset] = edata[j];
+      }
+      if (dst_gid != GID_MAX) {
+        auto graph = graphs[dst_gid];
+        size_t offset = __sync_fetch_and_add(&indegree[dst], 1);
+        graph->in_edges_[offset] = src;
+        if (edata != nullptr) graph->edata_[offset] = edata[j];
+      }
+    });
+
+    if (sort_)
+      for (auto graph : graphs)
+        if (graph != nullptr) graph->Sort(cores_);
+    return graphs;
+  }
+
+  // @brief: build a CSR of all vertexes of edgelist_graph.
+  CSR_T* Build(const GID_T gid, EDGE_LIST_T* edgelist_graph,
+               VID_T* vid_map = nullptr) {
+    LOG_INFO("CSRBuilder::Build(): NumEdges: ",
+             edgelist_graph->get_num_edges());
+    auto graphs = Build(
+        edgelist_graph->buf_graph_,
+        edgelist_graph->IsWeighted() ? edgelist_graph->edata_ : nullptr,
+        edgelist_graph->get_num_edges(), edgelist_graph->get_max_vid(),
+        [](VID_T vid) { return (GID_T)0; }, 1, vid_map);
+    if (graphs[0] != nullptr) graphs[0]->gid_ = gid;
+    return graphs[0];
+  }
+
+ private:
+  // @brief: allocate a CSR in the layout of the ImmutableCSR constructor,
+  // with only localid_by_globalid and vdata cleared.
+  CSR_T* Allocate(const GID_T gid, const size_t num_vertexes,
+                  const size_t sum_in_edges, const size_t sum_out_edges,
+                  const VID_T max_vid, const bool weighted) {
+    auto graph = new CSR_T(gid, nullptr);
+    graph->num_vertexes_ = num_vertexes;
+    graph->sum_in_edges_ = sum_in_edges;
+    graph->sum_out_edges_ = sum_out_edges;
+    graph->num_edges_ = sum_in_edges + sum_out_edges;
+    graph->max_vid_ = max_vid;
+    graph->aligned_max_vid_ =
+        ceil(graph->get_max_vid() / ALIGNMENT_FACTOR) * ALIGNMENT_FACTOR;
+    graph->bitmap_ = new Bitmap(graph->get_aligned_max_vid());
+    graph->bitmap_->clear();
+
+    size_t size_globalid = sizeof(VID_T) * num_vertexes;
+    size_t size_degree = sizeof(size_t) * num_vertexes;
+    size_t start_indegree = size_globalid;
+    size_t start_outdegree = start_indegree + size_degree;
+    size_t start_in_offset = start_outdegree + size_degree;
+    size_t start_out_offset = start_in_offset + size_degree;
+    size_t start_in_edges = start_out_offset + size_degree;
+    size_t start_out_edges = start_in_edges + sizeof(VID_T) * sum_in_edges;
+    size_t start_localid_by_globalid =
+        start_out_edges + sizeof(VID_T) * sum_out_edges;
+    size_t size_localid_by_globalid =
+        sizeof(VID_T) * graph->get_aligned_max_vid();
+
+    auto buf_graph = (char*)utility::HugePageAlloc(start_localid_by_globalid +
+                                                   size_localid_by_globalid);
+    graph->buf_graph_ = (VID_T*)buf_graph;
+    graph->globalid_by_index_ = (VID_T*)buf_graph;
+    graph->indegree_ = (size_t*)(buf_graph + start_indegree);
+    graph->outdegree_ = (size_t*)(buf_graph + start_outdegree);
+    graph->in_offset_ = (size_t*)(buf_graph + start_in_offset);
+    graph->out_offset_ = (size_t*)(buf_graph + start_out_offset);
+    graph->in_edges_ = (VID_T*)(buf_graph + start_in_edges);
+    graph->out_edges_ = (VID_T*)(buf_graph + start_out_edges);
+    graph->localid_by_globalid_ =
+        (VID_T*)(buf_graph + start_localid_by_globalid);
+    memset(graph->localid_by_globalid_, 0, size_localid_by_globalid);
+
+    graph->vdata_ =
+        (VDATA_T*)utility::HugePageAlloc(sizeof(VDATA_T) * num_vertexes);
+    memset(graph->vdata_, 0, sizeof(VDATA_T) * num_vertexes);
+    if (weighted) {
+      // edata_ holds weights of in_edges followed by weights of out_edges.
+      graph->edata_ = (EDATA_T*)utility::HugePageAlloc(
+          sizeof(EDATA_T) * (sum_in_edges + sum_out_edges));
+      graph->csr_flags_ |= CSR_WEIGHTED;
+    }
+    graph->is_serialized_ = true;
+    return graph;
+  }
+
+  size_t cores_ = 1;
+  bool sort_ = false;
+  bool skip_self_loops_ = false;
+  std::unique_ptr<utility::CPUThreadPool> thread_pool_;
+};
+
+}  // namespace graphs
+}  // namespace minigraph
+#endif  // MINIGRAPH_GRAPHS_CSR_BUILDER_H
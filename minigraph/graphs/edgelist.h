@@ -33,7 +33,7 @@ class EdgeList : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
  public:
   EdgeList(const GID_T gid = 0, const size_t num_edges = 0,
            const size_t num_vertexes = 0, VID_T max_vid = 0,
-           VID_T* buf_graph = nullptr)
+           VID_T* buf_graph = nullptr, EDATA_T* edata = nullptr)
       : Graph<GID_T, VID_T, VDATA_T, EDATA_T>() {
     this->gid_ = gid;
     this->num_edges_ = num_edges;
@@ -63,9 +63,22 @@ class EdgeList : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
       memcpy(this->buf_graph_, buf_graph,
              this->get_num_edges() * sizeof(VID_T) * 2);
     }
+    if (edata != nullptr && num_edges != 0) {
+      this->edata_ = (EDATA_T*)malloc(sizeof(EDATA_T) * this->get_num_edges());
+      memcpy(this->edata_, edata, sizeof(EDATA_T) * this->get_num_edges());
+    }
   }
 
-  ~EdgeList() = default;
+  ~EdgeList() {
+    if (this->edata_ != nullptr) {
+      free(this->edata_);
+      this->edata_ = nullptr;
+    }
+  };
+
+  // @brief: whether edges carry weights, edata_[i] is the weight of the i-th
+  // edge in buf_graph_.
+  inline bool IsWeighted() const { return this->edata_ != nullptr; }
 
   void CleanUp() override {
     if (vertexes_info_ != nullptr) {
@@ -85,7 +98,9 @@ class EdgeList : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
     for (size_t i = 0; i < this->get_num_edges(); i++) {
       if (i > count) break;
       std::cout << "src: " << *(this->buf_graph_ + i * 2)
-                << ", dst: " << *(this->buf_graph_ + i * 2 + 1) << std::endl;
+                << ", dst: " << *(this->buf_graph_ + i * 2 + 1);
+      if (IsWeighted()) std::cout << ", weight: " << this->edata_[i];
+      std::cout << std::endl;
     }
     std::cout << ">>>> vdata_ " << std::endl;
     for (size_t i = 0; i < this->get_num_vertexes(); i++) {
@@ -7,6 +7,7 @@
 
 #include "portability/sys_types.h"
 #include "utility/bitmap.h"
+#include "utility/memory.h"
 
 #include <folly/AtomicHashMap.h>
 #include <folly/FBString.h>
@@ -24,7 +25,9 @@ class VertexInfo {
   VID_T* in_edges = nullptr;
   VID_T* out_edges = nullptr;
   VDATA_T* vdata = nullptr;
+  // Weights of in_edges and out_edges respectively, if the graph is weighted.
   EDATA_T* edata = nullptr;
+  EDATA_T* out_edata = nullptr;
   char* state = nullptr;
 
   VertexInfo() = default;
@@ -86,7 +89,8 @@ class Graph {
 
   void InitVdata2AllX(const VDATA_T init_vdata = 0) {
     if (vdata_ == nullptr) {
-      vdata_ = (VDATA_T*)malloc(sizeof(VDATA_T) * get_num_vertexes());
+      vdata_ = (VDATA_T*)utility::HugePageAlloc(sizeof(VDATA_T) *
+                                                get_num_vertexes());
       if (init_vdata != 0)
         for (size_t i = 0; i < this->get_num_vertexes(); i++)
           vdata_[i] = init_vdata;
@@ -102,7 +106,8 @@ class Graph {
 
   void InitVdataByVid() {
     if (vdata_ == nullptr) {
-      vdata_ = (VDATA_T*)malloc(sizeof(VDATA_T) * get_num_vertexes());
+      vdata_ = (VDATA_T*)utility::HugePageAlloc(sizeof(VDATA_T) *
+                                                get_num_vertexes());
       memset(vdata_, 0, sizeof(VDATA_T) * this->get_num_vertexes());
       for (size_t i = 0; i < this->get_num_vertexes(); i++) vdata_[i] = i;
 
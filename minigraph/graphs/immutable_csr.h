@@ -1,12 +1,15 @@
 #ifndef MINIGRAPH_GRAPHS_IMMUTABLECSR_H
 #define MINIGRAPH_GRAPHS_IMMUTABLECSR_H
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <malloc.h>
 #include <map>
 #include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "graphs/edgelist.h"
 #include "graphs/graph.h"
@@ -14,6 +17,7 @@
 #include "portability/sys_types.h"
 #include "utility/bitmap.h"
 #include "utility/logging.h"
+#include "utility/memory.h"
 #include "utility/sort.h"
 #include "utility/thread_pool.h"
 
@@ -88,17 +92,36 @@ class ImmutableCSR : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
     size_t start_out_edges = start_in_edges + size_in_edges;
     size_t start_localid_by_globalid = start_out_edges + size_out_edges;
 
-    this->vdata_ = (VDATA_T*)malloc(sizeof(VDATA_T) * num_vertexes);
-    memset(this->vdata_, 0, sizeof(VDATA_T) * num_vertexes);
-    this->buf_graph_ = (VID_T*)malloc(total_size);
+    this->buf_graph_ = (VID_T*)utility::HugePageAlloc(total_size);
     memset(this->buf_graph_, 0, total_size);
 
+    // edata_ holds weights of in_edges followed by weights of out_edges.
+    this->edata_ = (EDATA_T*)utility::HugePageAlloc(
+        sizeof(EDATA_T) * (sum_in_edges_ + sum_out_edges_));
+    memset(this->edata_, 0, sizeof(EDATA_T) * (sum_in_edges_ + sum_out_edges_));
+    EDATA_T* in_edata = this->edata_;
+    EDATA_T* out_edata = this->edata_ + sum_in_edges_;
+    size_t in_edata_offset = 0, out_edata_offset = 0;
+
     size_t count = 0;
     auto local_id = 0;
     for (VID_T global_id = 0; global_id < this->get_aligned_max_vid();
          global_id++) {
       if (set_vertexes[global_id] == nullptr) continue;
       if (vid_map != nullptr) vid_map[global_id] = local_id;
+      auto u = set_vertexes[global_id];
+      if (u->edata != nullptr) {
+        memcpy(in_edata + in_edata_offset, u->edata,
+               sizeof(EDATA_T) * u->indegree);
+        csr_flags_ |= CSR_WEIGHTED;
+      }
+      if (u->out_edata != nullptr) {
+        memcpy(out_edata + out_edata_offset, u->out_edata,
+               sizeof(EDATA_T) * u->outdegree);
+        csr_flags_ |= CSR_WEIGHTED;
+      }
+      in_edata_offset += u->indegree;
+      out_edata_offset += u->outdegree;
       this->bitmap_->set_bit(global_id);
       ((VID_T*)((char*)this->buf_graph_ +
                 start_localid_by_globalid))[global_id] = local_id;
@@ -165,11 +188,9 @@ class ImmutableCSR : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
 
     this->num_edges_ = sum_in_edges_ + sum_out_edges_;
     this->gid_ = gid;
-    this->vdata_ = (VDATA_T*)malloc(sizeof(VDATA_T) * this->get_num_vertexes());
+    this->vdata_ = (VDATA_T*)utility::HugePageAlloc(sizeof(VDATA_T) *
+                                                    this->get_num_vertexes());
     memset(this->vdata_, 0, sizeof(VDATA_T) * this->get_num_vertexes());
-    this->edata_ =
-        (EDATA_T*)malloc(sizeof(EDATA_T) * this->get_num_out_edges());
-    memset(this->edata_, 0, sizeof(EDATA_T) * this->get_num_out_edges());
 
     is_serialized_ = true;
     return;
@@ -283,6 +304,9 @@ class ImmutableCSR : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
     vertex_info.out_edges = (out_edges_ + get_out_offset_by_index(index));
     vertex_info.vdata = (this->vdata_ + index);
     vertex_info.edata = (this->edata_ + get_in_offset_by_index(index));
+    if (this->edata_ != nullptr && !IsEdgeStreaming())
+      vertex_info.out_edata =
+          (this->edata_ + sum_in_edges_ + get_out_offset_by_index(index));
 
     vertex_info.state = (vertexes_state_ + index);
     return vertex_info;
@@ -297,7 +321,11 @@ class ImmutableCSR : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
     vertex_info->in_edges = (in_edges_ + in_offset_[index]);
     vertex_info->out_edges = (out_edges_ + out_offset_[index]);
     vertex_info->vdata = (this->vdata_ + index);
-    vertex_info->edata = (this->edata_ + in_offset_[index]);
+    if (this->edata_ != nullptr)
+      vertex_info->edata = (this->edata_ + in_offset_[index]);
+    if (this->edata_ != nullptr && !IsEdgeStreaming())
+      vertex_info->out_edata =
+          (this->edata_ + sum_in_edges_ + out_offset_[index]);
     vertex_info->state = (vertexes_state_ + index);
     return vertex_info;
   }
@@ -308,9 +336,12 @@ class ImmutableCSR : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
     size_t index = vid;
     vertex_info.outdegree = outdegree_[index];
     vertex_info.indegree = indegree_[index];
-    vertex_info.in_edges = (in_edges_ + in_offset_[index]);
-    vertex_info.out_edges = (out_edges_ + out_offset_[index]);
-    vertex_info.edata = (this->edata_ + in_offset_[index]);
+    vertex_info.in_edges = (in_edges_ + get_in_offset_by_index(index));
+    vertex_info.out_edges = (out_edges_ + get_out_offset_by_index(index));
+    vertex_info.edata = (this->edata_ + get_in_offset_by_index(index));
+    if (this->edata_ != nullptr && !IsEdgeStreaming())
+      vertex_info.out_edata =
+          (this->edata_ + sum_in_edges_ + get_out_offset_by_index(index));
     vertex_info.vdata = (this->vdata_ + index);
     vertex_info.state = (vertexes_state_ + index);
     return vertex_info;
@@ -379,14 +410,148 @@ class ImmutableCSR : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
       thread_pool.Commit([&, i, &cores, &pending_packages, &finish_cv]() {
         for (size_t j = i; j < this->get_num_vertexes(); j += cores) {
           auto u = GetVertexByIndex(j);
-          QuickSort(u.out_edges, 0, u.outdegree - 1);
-          QuickSort(u.in_edges, 0, u.indegree - 1);
+          if (IsWeighted()) {
+            SortWithEdata(u.out_edges, u.out_edata, u.outdegree);
+            SortWithEdata(u.in_edges, u.edata, u.indegree);
+          } else {
+            std::sort(u.out_edges, u.out_edges + u.outdegree);
+            std::sort(u.in_edges, u.in_edges + u.indegree);
+          }
+        }
+        if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
+        return;
+      });
+    }
+    finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
+    csr_flags_ |= CSR_SORTED;
+    return;
+  }
+
+  // @brief: whether in_edges and out_edges of every vertex are sorted in
+  // ascending order of global ids, see utility/set_intersection.h.
+  inline bool IsSorted() const { return csr_flags_ & CSR_SORTED; }
+
+  // @brief: whether edges carry weights. Weights of the in_edges and the
+  // out_edges of a vertex are VertexInfo::edata and VertexInfo::out_edata.
+  inline bool IsWeighted() const {
+    return (csr_flags_ & CSR_WEIGHTED) && this->edata_ != nullptr;
+  }
+
+  // @brief: relabel local vertexes, i.e. the vertex at index order[i] is moved
+  // to index i. Edges keep global ids, globalid_by_index_ and
+  // localid_by_globalid_ are updated, so results still map to original ids.
+  // @param: vid_map, if not nullptr, is the global-to-local map shared by all
+  // fragments, entries of vertexes in this fragment are updated.
+  void Reorder(const VID_T* order, VID_T* vid_map = nullptr,
+               const size_t cores = 1) {
+    assert(order != nullptr && !IsEdgeStreaming());
+    size_t num_vertexes = this->get_num_vertexes();
+    size_t size_globalid = sizeof(VID_T) * num_vertexes;
+    size_t size_degree = sizeof(size_t) * num_vertexes;
+    size_t size_in_edges = sizeof(VID_T) * sum_in_edges_;
+    size_t size_out_edges = sizeof(VID_T) * sum_out_edges_;
+    size_t size_localid_by_globalid =
+        sizeof(VID_T) * this->get_aligned_max_vid();
+    size_t start_indegree = size_globalid;
+    size_t start_outdegree = start_indegree + size_degree;
+    size_t start_in_offset = start_outdegree + size_degree;
+    size_t start_out_offset = start_in_offset + size_degree;
+    size_t start_in_edges = start_out_offset + size_degree;
+    size_t start_out_edges = start_in_edges + size_in_edges;
+    size_t start_localid_by_globalid = start_out_edges + size_out_edges;
+    size_t total_size = start_localid_by_globalid + size_localid_by_globalid;
+
+    auto buf_graph = (VID_T*)utility::HugePageAlloc(total_size);
+    auto globalid_by_index = (VID_T*)buf_graph;
+    auto indegree = (size_t*)((char*)buf_graph + start_indegree);
+    auto outdegree = (size_t*)((char*)buf_graph + start_outdegree);
+    auto in_offset = (size_t*)((char*)buf_graph + start_in_offset);
+    auto out_offset = (size_t*)((char*)buf_graph + start_out_offset);
+    auto in_edges = (VID_T*)((char*)buf_graph + start_in_edges);
+    auto out_edges = (VID_T*)((char*)buf_graph + start_out_edges);
+    auto localid_by_globalid =
+        (VID_T*)((char*)buf_graph + start_localid_by_globalid);
+    memcpy(localid_by_globalid, localid_by_globalid_,
+           size_localid_by_globalid);
+
+    size_t sum_in = 0, sum_out = 0;
+    for (size_t i = 0; i < num_vertexes; i++) {
+      indegree[i] = indegree_[order[i]];
+      outdegree[i] = outdegree_[order[i]];
+      in_offset[i] = sum_in;
+      out_offset[i] = sum_out;
+      sum_in += indegree[i];
+      sum_out += outdegree[i];
+    }
+
+    VDATA_T* vdata = nullptr;
+    EDATA_T* edata = nullptr;
+    if (this->vdata_ != nullptr)
+      vdata = (VDATA_T*)utility::HugePageAlloc(sizeof(VDATA_T) * num_vertexes);
+    if (this->edata_ != nullptr)
+      edata = (EDATA_T*)utility::HugePageAlloc(
+          sizeof(EDATA_T) * (sum_in_edges_ + sum_out_edges_));
+    char* vertexes_state = nullptr;
+    if (vertexes_state_ != nullptr)
+      vertexes_state = (char*)malloc(sizeof(char) * num_vertexes);
+
+    auto thread_pool = minigraph::utility::CPUThreadPool(cores, 1);
+    std::mutex mtx;
+    std::condition_variable finish_cv;
+    std::unique_lock<std::mutex> lck(mtx);
+    std::atomic<size_t> pending_packages(cores);
+    for (size_t i = 0; i < cores; i++) {
+      thread_pool.Commit([&, i]() {
+        for (size_t j = i; j < num_vertexes; j += cores) {
+          VID_T old_index = order[j];
+          VID_T global_id = globalid_by_index_[old_index];
+          globalid_by_index[j] = global_id;
+          localid_by_globalid[global_id] = j;
+          if (vid_map != nullptr) vid_map[global_id] = j;
+          memcpy(in_edges + in_offset[j], in_edges_ + in_offset_[old_index],
+                 sizeof(VID_T) * indegree[j]);
+          memcpy(out_edges + out_offset[j],
+                 out_edges_ + out_offset_[old_index],
+                 sizeof(VID_T) * outdegree[j]);
+          if (edata != nullptr) {
+            memcpy(edata + in_offset[j], this->edata_ + in_offset_[old_index],
+                   sizeof(EDATA_T) * indegree[j]);
+            memcpy(edata + sum_in_edges_ + out_offset[j],
+                   this->edata_ + sum_in_edges_ + out_offset_[old_index],
+                   sizeof(EDATA_T) * outdegree[j]);
+          }
+          if (vdata != nullptr) vdata[j] = this->vdata_[old_index];
+          if (vertexes_state != nullptr)
+            vertexes_state[j] = vertexes_state_[old_index];
         }
         if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
         return;
       });
     }
     finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
+
+    free(this->buf_graph_);
+    this->buf_graph_ = buf_graph;
+    globalid_by_index_ = globalid_by_index;
+    indegree_ = indegree;
+    outdegree_ = outdegree;
+    in_offset_ = in_offset;
+    out_offset_ = out_offset;
+    in_edges_ = in_edges;
+    out_edges_ = out_edges;
+    localid_by_globalid_ = localid_by_globalid;
+    if (vdata != nullptr) {
+      free(this->vdata_);
+      this->vdata_ = vdata;
+    }
+    if (edata != nullptr) {
+      free(this->edata_);
+      this->edata_ = edata;
+    }
+    if (vertexes_state_ != nullptr) {
+      free(vertexes_state_);
+      vertexes_state_ = vertexes_state;
+    }
     return;
   }
 
@@ -405,14 +570,35 @@ class ImmutableCSR : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
   void set_out_offset_base(size_t base) { out_offset_base_ = base; };
   void set_in_offset_base(size_t base) { in_offset_base_ = base; };
 
+  // @brief: whether the edges of the graph are streamed from disk in blocks
+  // rather than resident in memory.
+  inline bool IsEdgeStreaming() const { return edge_block_size_ > 0; }
+
   ImmutableCSR* GetClassType(void) override { return this; }
 
+ private:
+  // @brief: sort edges and permute their weights accordingly.
+  static void SortWithEdata(VID_T* edges, EDATA_T* edata, const size_t degree) {
+    if (degree < 2) return;
+    std::vector<std::pair<VID_T, EDATA_T>> pairs(degree);
+    for (size_t k = 0; k < degree; k++)
+      pairs[k] = std::make_pair(edges[k], edata[k]);
+    std::sort(pairs.begin(), pairs.end());
+    for (size_t k = 0; k < degree; k++) {
+      edges[k] = pairs[k].first;
+      edata[k] = pairs[k].second;
+    }
+  }
+
  public:
   size_t sum_in_edges_ = 0;
   size_t sum_out_edges_ = 0;
 
   bool is_serialized_ = false;
 
+  // Flags of the fragment, e.g. CSR_SORTED, kept in the meta file.
+  size_t csr_flags_ = 0;
+
   // serialized data in CSR format.
   VID_T* localid_by_globalid_ = nullptr;
   VID_T* globalid_by_index_ = nullptr;
@@ -426,6 +612,15 @@ class ImmutableCSR : public Graph<GID_T, VID_T, VDATA_T, EDATA_T> {
   size_t in_offset_base_ = 0;
   size_t out_offset_base_ = 0;
 
+  // Out-of-core edge streaming. If edge_block_size_ > 0, only vertex arrays
+  // are resident and in_edges_/out_edges_ point to the block currently
+  // loaded by an EdgeBlockReader. in_edges_pos_ and out_edges_pos_ are the
+  // byte offsets of the edge arrays in data_pt_.
+  size_t edge_block_size_ = 0;
+  size_t in_edges_pos_ = 0;
+  size_t out_edges_pos_ = 0;
+  std::string data_pt_;
+
   char* vertexes_state_ = nullptr;
   std::map<VID_T, graphs::VertexInfo<VID_T, VDATA_T, EDATA_T>*>*
       vertexes_info_ = nullptr;
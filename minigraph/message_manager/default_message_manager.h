@@ -4,8 +4,10 @@
 #include "graphs/graph.h"
 #include "message_manager/message_manager_base.h"
 #include "portability/sys_data_structure.h"
+#include "utility/atomic.h"
 #include "utility/io/data_mngr.h"
 #include <fstream>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -26,6 +28,21 @@ class DefaultMessageManager : public MessageManagerBase {
                         const std::string& work_space, bool is_mining = false)
       : MessageManagerBase() {}
 
+  ~DefaultMessageManager() {
+    if (border_adjacency_ != nullptr) {
+      for (VID_T vid = 0; vid < aligned_max_vid_; vid++) {
+        if (border_adjacency_[vid] != nullptr) free(border_adjacency_[vid]);
+        if (pending_adjacency_[vid] != nullptr) free(pending_adjacency_[vid]);
+      }
+      free(border_adjacency_);
+      free(border_degree_);
+      free(pending_adjacency_);
+      free(pending_degree_);
+      delete pending_adjacency_map_;
+    }
+    if (border_message_ != nullptr) free(border_message_);
+  }
+
   void Init(const std::string work_space,
             const bool load_dependencies = false) override {
     LOG_INFO("Init Message Manager: ", work_space);
@@ -54,7 +71,8 @@ class DefaultMessageManager : public MessageManagerBase {
     global_border_vid_map_ = out3.second;
     aligned_max_vid_ =
         ceil((float)max_vid_ / ALIGNMENT_FACTOR) * ALIGNMENT_FACTOR;
-    global_border_vdata_ = (VDATA_T*)malloc(aligned_max_vid_ * sizeof(VDATA_T));
+    global_border_vdata_ = (VDATA_T*)utility::HugePageAlloc(
+        aligned_max_vid_ * sizeof(VDATA_T));
 
     for (VID_T vid = 0; vid < aligned_max_vid_; vid++)
       global_border_vdata_[vid] = VDATA_MAX;
@@ -67,6 +85,8 @@ class DefaultMessageManager : public MessageManagerBase {
       si_[i] = data_mngr_->ReadStatisticInfo(si_pt);
       si_[i].ShowInfo();
     }
+    elapsed_time_.assign(num_graphs_, 0);
+    num_evals_.assign(num_graphs_, 0);
 
     // Init others.
     historical_state_matrix_ = (char*)malloc(sizeof(char) * num_graphs_);
@@ -77,7 +97,8 @@ class DefaultMessageManager : public MessageManagerBase {
 
     active_vertexes_bit_map_ = new Bitmap(max_vid_);
     active_vertexes_bit_map_->clear();
-    global_vertexes_state_ = (char*)malloc(sizeof(char) * max_vid_);
+    global_vertexes_state_ =
+        (char*)utility::HugePageAlloc(sizeof(char) * max_vid_);
     memset(global_vertexes_state_, VERTEXUNLABELED, sizeof(char) * max_vid_);
 
     // init Message bucket
@@ -116,19 +137,122 @@ class DefaultMessageManager : public MessageManagerBase {
 
   size_t get_max_vid() { return max_vid_; }
 
+  size_t get_aligned_max_vid() { return aligned_max_vid_; }
+
+  // @brief: account one PEval or IncEval of fragment gid that took
+  // elapsed_time seconds. Kept apart from si_, which apps may use freely.
+  void UpdateRunCost(const GID_T gid, const float elapsed_time) {
+    elapsed_time_[gid] += elapsed_time;
+    ++num_evals_[gid];
+  }
+
+  bool WriteRunCost(const std::string pt) {
+    data_mngr_->MakeDirectory(pt);
+    for (size_t i = 0; i < num_graphs_; i++) {
+      std::string out_pt = pt + std::to_string(i) + ".yaml";
+      if (!data_mngr_->WriteRunCost(elapsed_time_[i], num_evals_[i], out_pt))
+        return false;
+    }
+    return true;
+  }
+
   bool WriteStatisticInfo(const std::string pt) {
-    this->MakeDirectory(pt);
+    data_mngr_->MakeDirectory(pt);
     for (size_t i = 0; i < num_graphs_; i++) {
       std::string out_pt = pt + std::to_string(i) + ".yaml";
-      std::ofstream fout(out_pt);
+      data_mngr_->WriteStatisticInfo(si_[i], out_pt);
     }
+    return true;
   }
 
   bool CheckDependenes(const GID_T x, const GID_T y) {
     return *(communication_matrix_ + x * num_graphs_ + y) == 1;
   }
 
+  // @brief: share the neighbor list of a border vertex with other fragments,
+  // e.g. for apps that intersect neighborhoods across fragments. The list is
+  // copied, it is set by the fragment owning globalid and becomes visible to
+  // the other fragments in the next superstep, see PublishBorderAdjacency().
+  void SetBorderAdjacency(const VID_T globalid, const VID_T* nbrs,
+                          const size_t degree) {
+    std::call_once(border_adjacency_once_, [this]() {
+      border_adjacency_ = AllocArray<VID_T*>();
+      border_degree_ = AllocArray<size_t>();
+      pending_adjacency_ = AllocArray<VID_T*>();
+      pending_degree_ = AllocArray<size_t>();
+      pending_adjacency_map_ = new Bitmap(aligned_max_vid_);
+      pending_adjacency_map_->clear();
+    });
+    if (pending_adjacency_[globalid] != nullptr)
+      free(pending_adjacency_[globalid]);
+    pending_adjacency_[globalid] = (VID_T*)malloc(sizeof(VID_T) * degree);
+    memcpy(pending_adjacency_[globalid], nbrs, sizeof(VID_T) * degree);
+    pending_degree_[globalid] = degree;
+    pending_adjacency_map_->set_bit(globalid);
+  }
+
+  // @brief: replace the neighbor lists returned by GetBorderAdjacency() with
+  // those set since the last call. Lists may be held by any fragment during
+  // a superstep, so this is only called at the barrier between two.
+  void PublishBorderAdjacency() {
+    if (pending_adjacency_map_ == nullptr) return;
+    for (size_t i = 0; i <= WORD_OFFSET(pending_adjacency_map_->size_); i++) {
+      unsigned long word = pending_adjacency_map_->data_[i];
+      while (word != 0) {
+        VID_T vid = (i << 6) + __builtin_ctzl(word);
+        word &= word - 1;
+        if (border_adjacency_[vid] != nullptr) free(border_adjacency_[vid]);
+        border_adjacency_[vid] = pending_adjacency_[vid];
+        border_degree_[vid] = pending_degree_[vid];
+        pending_adjacency_[vid] = nullptr;
+      }
+      pending_adjacency_map_->data_[i] = 0;
+    }
+  }
+
+  // @brief: neighbor list of a border vertex set by SetBorderAdjacency, or
+  // (nullptr, 0) if none.
+  std::pair<VID_T*, size_t> GetBorderAdjacency(const VID_T globalid) {
+    if (border_adjacency_ == nullptr) return std::make_pair(nullptr, 0);
+    return std::make_pair(border_adjacency_[globalid],
+                          border_degree_[globalid]);
+  }
+
+  // @brief: send delta to the vertex globalid, typically a border vertex
+  // owned by another fragment. Messages to the same vertex are combined by
+  // sum until its owner takes them.
+  void AddBorderMessage(const VID_T globalid, const VDATA_T delta) {
+    write_add(GetBorderMessage() + globalid, delta);
+  }
+
+  // @brief: take the sum of the messages sent to globalid and reset it.
+  VDATA_T TakeBorderMessage(const VID_T globalid) {
+    VDATA_T* border_message = GetBorderMessage();
+    if (__atomic_load_n(border_message + globalid, __ATOMIC_RELAXED) == 0)
+      return 0;
+    return __sync_lock_test_and_set(border_message + globalid, 0);
+  }
+
  private:
+  // @brief: the messages sent to border vertexes, allocated by the first
+  // caller. Readers pass the same once_flag as writers, so they see it.
+  VDATA_T* GetBorderMessage() {
+    std::call_once(border_message_once_, [this]() {
+      border_message_ =
+          (VDATA_T*)utility::HugePageAlloc(sizeof(VDATA_T) * aligned_max_vid_);
+      memset(border_message_, 0, sizeof(VDATA_T) * aligned_max_vid_);
+    });
+    return border_message_;
+  }
+
+  // @brief: an array of T by global id, set to 0.
+  template <typename T>
+  T* AllocArray() {
+    T* buf = (T*)utility::HugePageAlloc(sizeof(T) * aligned_max_vid_);
+    memset(buf, 0, sizeof(T) * aligned_max_vid_);
+    return buf;
+  }
+
   size_t num_graphs_ = 0;
   utility::io::DataMngr<GRAPH_T>* data_mngr_ = nullptr;
   VID_T* vid_map_ = nullptr;
@@ -141,7 +265,24 @@ class DefaultMessageManager : public MessageManagerBase {
   bool* communication_matrix_ = nullptr;
   char* historical_state_matrix_ = nullptr;
   StatisticInfo* si_ = nullptr;
+
+  // Seconds spent on, and number of PEval/IncEval of, each fragment.
+  std::vector<float> elapsed_time_;
+  std::vector<size_t> num_evals_;
   std::atomic<size_t> offset_bucket = 0;
+
+  // Neighbor lists of border vertexes by global id, and those set in the
+  // current superstep.
+  std::once_flag border_adjacency_once_;
+  VID_T** border_adjacency_ = nullptr;
+  size_t* border_degree_ = nullptr;
+  VID_T** pending_adjacency_ = nullptr;
+  size_t* pending_degree_ = nullptr;
+  Bitmap* pending_adjacency_map_ = nullptr;
+
+  // Sum of messages sent to each vertex by global id.
+  std::once_flag border_message_once_;
+  VDATA_T* border_message_ = nullptr;
 };
 
 }  // namespace message
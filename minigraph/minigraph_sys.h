@@ -6,7 +6,9 @@
 #include "components/discharge_component.h"
 #include "components/load_component.h"
 #include "message_manager/default_message_manager.h"
+#include "utility/io/checkpoint_mngr.h"
 #include "utility/io/data_mngr.h"
+#include "utility/io/delta_store.h"
 #include "utility/paritioner/edge_cut_partitioner.h"
 #include "utility/state_machine.h"
 #include <folly/synchronization/NativeSemaphore.h>
@@ -43,7 +45,8 @@ class MiniGraphSys {
                const size_t num_workers_cc = 1, const size_t num_workers_dc = 1,
                const size_t num_cores = 1, const size_t buffer_size = 0,
                APP_WRAPPER* app_wrapper = nullptr, std::string mode = "Default",
-               const size_t num_iter = 30, std::string scheduler = "FIFO") {
+               const size_t num_iter = 30, std::string scheduler = "FIFO",
+               const size_t edge_block_size = 0) {
     assert(num_workers_dc > 0 && num_workers_cc > 0 && num_workers_dc > 0 &&
            num_cores / num_workers_cc >= 1);
     assert(buffer_size >= 1);
@@ -55,10 +58,12 @@ class MiniGraphSys {
              ", buffer size: ", buffer_size);
 
     num_threads_ = 3;
+    work_space_ = work_space;
 
     // init Data Manager.
     data_mngr_ = std::make_unique<utility::io::DataMngr<GRAPH_T>>();
     data_mngr_->InitWorkList(work_space);
+    data_mngr_->SetEdgeBlockSize(edge_block_size);
 
     // init Message Manager
     msg_mngr_ = std::make_unique<message::DefaultMessageManager<GRAPH_T>>(
@@ -68,6 +73,12 @@ class MiniGraphSys {
     pt_by_gid_ = std::make_unique<std::unordered_map<GID_T, Path>>(
         data_mngr_->InitPtByGid(work_space));
 
+    // init Delta Store, fragments are read with their pending edge updates.
+    delta_store_ =
+        std::make_unique<utility::io::DeltaStore<GRAPH_T>>(work_space);
+    delta_store_->Init(*pt_by_gid_);
+    data_mngr_->SetDeltaStore(delta_store_.get());
+
     // init global superstep
     global_superstep_ = new std::atomic<size_t>(0);
 
@@ -80,6 +91,10 @@ class MiniGraphSys {
       vec_gid.push_back(iter.first);
     }
 
+    // init checkpoints, taken only once SetCheckpoint() enables them.
+    checkpoint_mngr_ =
+        std::make_unique<utility::io::CheckpointMngr<GRAPH_T>>(work_space);
+
     // init read_trigger
     read_trigger_ = std::make_unique<std::queue<GID_T>>();
     for (auto& iter : vec_gid) {
@@ -109,6 +124,9 @@ class MiniGraphSys {
     app_wrapper_ = std::make_unique<AppWrapper<AUTOAPP_T, GRAPH_T>>();
     app_wrapper_.reset(app_wrapper);
     app_wrapper_->InitMsgMngr(msg_mngr_.get());
+    if (edge_block_size > 0 && !app_wrapper_->auto_app_->IsEdgeStreamable())
+      LOG_FATAL("Kernels of this app read edges out of the current edge "
+                "block, run it without -edge_block_size.");
 
     // init mutex, lck and cv
     read_trigger_mtx_ = std::make_unique<std::mutex>();
@@ -155,7 +173,8 @@ class MiniGraphSys {
             pt_by_gid_.get(), data_mngr_.get(), msg_mngr_.get(),
             partial_result_lck_.get(), partial_result_cv_.get(),
             task_queue_cv_.get(), read_trigger_cv_.get(), system_switch_.get(),
-            system_switch_lck_.get(), system_switch_cv_.get(), num_iter, mode);
+            system_switch_lck_.get(), system_switch_cv_.get(), num_iter, mode,
+            checkpoint_mngr_.get());
     LOG_INFO("Init MiniGraphSys: Finish.");
   };
 
@@ -174,6 +193,125 @@ class MiniGraphSys {
     discharge_component_->~DischargeComponent();
   }
 
+  // @brief: take a checkpoint every checkpoint_interval supersteps, 0
+  // disables them. If resume, restart from the last checkpoint of
+  // work_space. Call it before RunSys(). Fatal for apps that are not
+  // AutoAppBase::IsCheckpointable().
+  void SetCheckpoint(const size_t checkpoint_interval,
+                     const bool resume = false) {
+    if ((checkpoint_interval > 0 || resume) &&
+        !app_wrapper_->auto_app_->IsCheckpointable())
+      LOG_FATAL("Checkpoints don't cover the state of this app, run it "
+                "without -checkpoint_interval and -resume.");
+    checkpoint_mngr_->SetInterval(checkpoint_interval);
+    if (resume && !checkpoint_mngr_->Restore(global_superstep_,
+                                             superstep_by_gid_, msg_mngr_.get(),
+                                             pt_by_gid_.get()))
+      LOG_INFO("Resume: no checkpoint, start from superstep 0.");
+  }
+
+  // @brief: write the time spent on every fragment to
+  // work_space/minigraph_cost/ once RunSys() finishes, e.g. for
+  // tools/graph_rebalance.cpp.
+  void SetRunCost(const bool run_cost) { run_cost_ = run_cost; }
+
+  // @brief: merge edge updates into fragments in background once a fragment
+  // holds compact_threshold of them, 0 disables it.
+  void SetCompaction(const size_t compact_threshold) {
+    delta_store_->StartCompaction(compact_threshold);
+  }
+
+  // @brief: keep global_border_vdata, where stream apps hold their results,
+  // under work_space/minigraph_stream/<name>.bin once RunSys() finishes,
+  // along with the number of edge updates of the workspace it reflects. If
+  // incremental, restore the results of the last run and append to batch
+  // the edge updates logged since, for the app to seed the run from them,
+  // see SetIncremental(). A run resumed from a checkpoint isn't restored.
+  // @return: whether the results have been restored.
+  bool SetStreamResult(
+      const std::string& name, const bool incremental,
+      std::vector<typename utility::io::DeltaStore<GRAPH_T>::DeltaEdge>*
+          batch) {
+    stream_result_pt_ = work_space_ + "minigraph_stream/" + name + ".bin";
+    stream_batch_end_ = delta_store_->GetBatchSize();
+    if (!incremental || global_superstep_->load() > 0) return false;
+
+    std::ifstream result_file(stream_result_pt_, std::ios::binary);
+    size_t from = 0, size = 0;
+    if (!result_file.read((char*)&from, sizeof(size_t)) ||
+        !result_file.read((char*)&size, sizeof(size_t)) ||
+        size != msg_mngr_->get_aligned_max_vid()) {
+      LOG_INFO("Incremental: no results of ", name, ", start over.");
+      return false;
+    }
+    std::vector<VDATA_T> result(size);
+    size_t end = 0;
+    if (!result_file.read((char*)result.data(), sizeof(VDATA_T) * size) ||
+        !delta_store_->ReadBatch(from, batch, &end)) {
+      XLOG(ERR, "Incremental: results of ", name,
+           " don't match the workspace, start over.");
+      batch->clear();
+      return false;
+    }
+    memcpy(msg_mngr_->GetGlobalVdata(), result.data(),
+           sizeof(VDATA_T) * size);
+    stream_batch_end_ = end;
+    LOG_INFO("Incremental: restored results of ", name, ", ", end - from,
+             " edge updates since.");
+    return true;
+  }
+
+  // @brief: outside of the run, read the csr_bin fragments holding a vertex
+  // of frontier, a bitmap of global ids, one at a time and call
+  // visit(graph, vids) on each, with the local ids of those vertexes whose
+  // bits are cleared. visit may set bits of other vertexes, which are visited
+  // in turn until frontier is empty, e.g. to invalidate results before
+  // SetIncremental().
+  // @return: number of fragments read.
+  template <typename F>
+  size_t VisitFragments(Bitmap* frontier, F visit) {
+    size_t num_reads = 0;
+    std::vector<char> active;
+    while (CollectFragments(frontier, &active) > 0) {
+      for (GID_T gid = 0; gid < active.size(); gid++) {
+        if (!active[gid]) continue;
+        if (!data_mngr_->ReadGraph(gid, pt_by_gid_->find(gid)->second,
+                                   csr_bin)) {
+          XLOG(ERR, "VisitFragments: read graph fault: ", gid);
+          return num_reads;
+        }
+        auto graph = (GRAPH_T*)data_mngr_->GetGraph(gid);
+        std::vector<VID_T> vids;
+        for (VID_T i = 0; i < graph->get_num_vertexes(); i++) {
+          auto globalid = graph->localid2globalid(i);
+          if (!frontier->get_bit(globalid)) continue;
+          frontier->rm_bit(globalid);
+          vids.push_back(i);
+        }
+        visit(graph, vids);
+        data_mngr_->EraseGraph(gid);
+        num_reads++;
+      }
+    }
+    return num_reads;
+  }
+
+  // @brief: refresh restored results instead of computing them from
+  // scratch. Fragments start from IncEval rather than Init and PEval, and
+  // only those holding a vertex of GetGlobalActiveVidMap() are read in the
+  // first superstep; any other is read once a fragment it depends on
+  // changes. Call it before RunSys().
+  void SetIncremental() {
+    std::vector<char> active;
+    size_t num_active =
+        CollectFragments(msg_mngr_->GetGlobalActiveVidMap(), &active);
+    global_superstep_->store(1);
+    for (auto& iter : *superstep_by_gid_) iter.second->store(1);
+    load_component_->SetActiveFragments(std::move(active), 1);
+    LOG_INFO("Incremental: ", num_active, " / ", pt_by_gid_->size(),
+             " fragments touched.");
+  }
+
   bool RunSys() {
     LOG_INFO("START MiniGraph.");
     auto task_lc = std::bind(&components::LoadComponent<GRAPH_T>::Run,
@@ -204,15 +342,72 @@ class MiniGraphSys {
                      (double)CLOCKS_PER_SEC
               << ", Superstep: " << this->global_superstep_->load()
               << " ####      " << std::endl;
+    if (run_cost_ && !msg_mngr_->WriteRunCost(work_space_ + "minigraph_cost/"))
+      XLOG(ERR, "Write run costs fault: ", work_space_, "minigraph_cost/");
+    if (!stream_result_pt_.empty()) {
+      if (!WriteStreamResult())
+        XLOG(ERR, "Write results fault: ", stream_result_pt_);
+      else if (!delta_store_->TrimBatch())
+        XLOG(ERR, "Trim edge updates fault: ", work_space_);
+    }
+    delta_store_->StopCompaction();
     this->Stop();
     return true;
   }
 
  private:
+  // @brief: mark in active the fragments holding a vertex of map. Bits of
+  // vertexes out of the workspace are cleared.
+  // @return: number of fragments marked.
+  size_t CollectFragments(Bitmap* map, std::vector<char>* active) {
+    active->assign(pt_by_gid_->size(), 0);
+    size_t num_active = 0;
+    GID_T owners[64];
+    for (size_t i = 0; i <= WORD_OFFSET(map->size_); i++) {
+      if (map->data_[i] == 0) continue;
+      delta_store_->GetOwners(i << 6, 64, owners);
+      for (size_t vid = i << 6; vid < ((i + 1) << 6); vid++) {
+        if (!map->get_bit(vid)) continue;
+        auto gid = owners[vid - (i << 6)];
+        if (gid >= active->size()) {
+          map->rm_bit(vid);
+          continue;
+        }
+        if (!(*active)[gid]) num_active++;
+        (*active)[gid] = 1;
+      }
+    }
+    return num_active;
+  }
+
+  bool WriteStreamResult() {
+    std::error_code ec;
+    std::filesystem::create_directories(work_space_ + "minigraph_stream/",
+                                        ec);
+    std::string tmp_pt = stream_result_pt_ + ".tmp";
+    {
+      std::ofstream out(tmp_pt, std::ios::binary);
+      size_t size = msg_mngr_->get_aligned_max_vid();
+      out.write((char*)&stream_batch_end_, sizeof(size_t));
+      out.write((char*)&size, sizeof(size_t));
+      out.write((char*)msg_mngr_->GetGlobalVdata(), sizeof(VDATA_T) * size);
+      if (!out) return false;
+    }
+    return rename(tmp_pt.c_str(), stream_result_pt_.c_str()) == 0;
+  }
+
   // file path by gid.
   // folly::AtomicHashMap<GID_T, Path>* pt_by_gid_ = nullptr;
   std::unique_ptr<std::unordered_map<GID_T, Path>> pt_by_gid_ = nullptr;
 
+  std::string work_space_;
+
+  bool run_cost_ = false;
+
+  // results of a stream app and the number of edge updates they reflect.
+  std::string stream_result_pt_;
+  size_t stream_batch_end_ = 0;
+
   // thread pool.
   size_t num_threads_ = 0;
   std::unique_ptr<utility::EDFThreadPool> thread_pool_ = nullptr;
@@ -249,11 +444,16 @@ class MiniGraphSys {
   // data manager
   std::unique_ptr<utility::io::DataMngr<GRAPH_T>> data_mngr_ = nullptr;
 
+  std::unique_ptr<utility::io::DeltaStore<GRAPH_T>> delta_store_ = nullptr;
+
   // App wrapper
   std::unique_ptr<AppWrapper<AUTOAPP_T, GRAPH_T>> app_wrapper_ = nullptr;
 
   std::unique_ptr<message::DefaultMessageManager<GRAPH_T>> msg_mngr_ = nullptr;
 
+  std::unique_ptr<utility::io::CheckpointMngr<GRAPH_T>> checkpoint_mngr_ =
+      nullptr;
+
   std::unique_ptr<std::mutex> read_trigger_mtx_ = nullptr;
   std::unique_ptr<std::mutex> task_queue_mtx_ = nullptr;
   std::unique_ptr<std::mutex> partial_result_mtx_ = nullptr;
@@ -17,6 +17,15 @@ using edata_t = unsigned;
 #define ALIGNMENT_FACTOR (double)64.0
 #define NUM_NEW_BUCKETS 1
 
+// Flags of a csr_bin fragment, stored in its meta file.
+#define CSR_SORTED 0x1
+// Edges carry weights in edata. Also used by the meta file of edgelist_bin.
+#define CSR_WEIGHTED 0x2
+// Neighbor lists in the data file are delta-encoded and packed by Stream
+// VByte, see CSRIOAdapter::WriteCompressedData(). Fragments are decompressed
+// on load, the flag is kept so that they are written back compressed.
+#define CSR_COMPRESSED 0x4
+
 
 #ifndef HAVE_MODE_T
 #define HAVE_MODE_T 1
@@ -58,6 +67,8 @@ DEFINE_string(o, "", "output path");
 DEFINE_string(pattern, "", "query graph (edge list in csv)");
 DEFINE_bool(tobin, false, "convert the graph to binary format");
 DEFINE_bool(frombin, false, "convert the graph of binary format");
+DEFINE_bool(weighted, false,
+            "edges of the input carry an integer weight in the third column");
 DEFINE_string(
     gtype, "csr_bin",
     "two types of edge list files are supported: csr_bin, edge_list_bin");
@@ -77,16 +88,77 @@ DEFINE_uint64(cores, 4, "the number of cores we used");
 DEFINE_uint64(buffer_size, 1, "buffer size");
 DEFINE_uint64(niters, 50, "number of iterations for graph-level while loop");
 DEFINE_uint64(walks_per_source, 5, "walks per source vertex for random walk");
+DEFINE_uint64(walk_length, 80, "number of vertexes of each random walk");
+DEFINE_double(walk_p, 1.0, "return parameter p of node2vec random walks");
+DEFINE_double(walk_q, 1.0, "in-out parameter q of node2vec random walks");
+DEFINE_uint64(seed, 0, "seed of random number generators");
+DEFINE_bool(permute, false,
+            "relabel vertexes of generated graphs as Graph500 does");
 DEFINE_uint64(inner_niters, 4, "number of iterations for inner while loop");
 DEFINE_string(init_model, "val", "init model for vdata of all vertexes");
 DEFINE_string(mode, "default", "MiniGraph with entire optimization");
 DEFINE_string(partitioner, "edgecut",
-              "graph partition solutions include vertexcut, edgecut");
+              "graph partition solutions include vertexcut, edgecut, "
+              "ldg, fennel, multilevel");
+DEFINE_double(balance_slack, 1.1,
+              "max size of a fragment over the average for ldg, fennel and "
+              "multilevel");
+DEFINE_bool(run_cost, false,
+            "leave the time spent on every fragment in minigraph_cost/ of "
+            "the workspace, see graph_rebalance");
+DEFINE_bool(compress, false,
+            "delta-encode and pack neighbor lists of csr_bin fragments");
+DEFINE_string(reorder, "none",
+              "relabel vertexes of each fragment by none, degree, rcm or "
+              "gorder");
 DEFINE_string(scheduler, "FIFO",
               "subgraphs scheduler include FIFO, hash, learned_model");
+DEFINE_uint64(edge_block_size, 0,
+              "number of edges per block when edges of fragments are streamed "
+              "from disk, 0 keeps edges in memory. Only wcc_vc_batch "
+              "supports it");
 DEFINE_uint64(init_val, 0, "init value for vdata of all vertexes");
-DEFINE_uint64(walsk_per_source, 1, "walks per vertex for random walks application.");
 DEFINE_uint64(root, 0, "the id of root vertex");
+DEFINE_string(sources, "",
+              "file of source vertexes, one per line, that are queried "
+              "together as a batch");
+DEFINE_double(alpha, 0.15, "teleport probability of personalized PageRank");
+DEFINE_double(epsilon, 1e-6, "convergence threshold of iterative apps");
+DEFINE_bool(sync, false,
+            "update vertexes from the values of the previous superstep "
+            "instead of in place, e.g. in label propagation");
+DEFINE_bool(multi_pivot, false,
+            "find SCCs by coloring only, where every color root is a pivot, "
+            "instead of starting from a single pivot");
+DEFINE_bool(homomorphism, false,
+            "match patterns by homomorphism, where pattern vertexes may be "
+            "matched to the same vertex, instead of isomorphism");
+DEFINE_uint64(max_buffered_matches, 1 << 20,
+              "partial matches buffered in memory for a fragment before they "
+              "spill to state_dir");
+DEFINE_string(state_dir, "",
+              "directory where apps spill per-vertex state of released "
+              "fragments, empty keeps it in memory");
+DEFINE_uint64(checkpoint_interval, 0,
+              "take a checkpoint of vertex states every checkpoint_interval "
+              "supersteps, 0 disables checkpoints");
+DEFINE_bool(resume, false,
+            "restart from the last checkpoint under the workspace");
+DEFINE_string(insertions, "",
+              "edges to insert into a workspace, in csv, see graph_update");
+DEFINE_string(deletions, "",
+              "edges to delete from a workspace, in csv, see graph_update");
+DEFINE_bool(compact, false,
+            "merge pending edge updates of a workspace into its fragments");
+DEFINE_uint64(compact_threshold, 0,
+              "merge the edge updates of a fragment in background once it "
+              "holds this many, 0 disables it");
+DEFINE_bool(incremental, false,
+            "refresh the results of the last run of a stream app from the "
+            "edge updates logged since, instead of starting over");
+DEFINE_uint64(delta, 0,
+              "bucket width of delta-stepping SSSP, 0 uses the average edge "
+              "weight of each fragment");
 DEFINE_double(
     a, 0.25,
     "probability of an edge falling into partition a in the R-MAT model");
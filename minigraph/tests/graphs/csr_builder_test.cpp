@@ -0,0 +1,164 @@
+#include "graphs/csr_builder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace minigraph {
+namespace graphs {
+
+using CSR_T = ImmutableCSR<unsigned, unsigned, unsigned, unsigned>;
+using CSR_BUILDER_T = CSRBuilder<unsigned, unsigned, unsigned, unsigned>;
+using NEIGHBORS_T = std::vector<std::pair<unsigned, unsigned>>;
+
+// Vertexes 0 to 2999 go to fragments 0 to 2 by vid % 3, those from 3000 to
+// none. Fragment 3 is left empty.
+static unsigned GidOf(unsigned vid) { return vid < 3000 ? vid % 3 : GID_MAX; }
+
+static const size_t kNumFragments = 4;
+static const unsigned kMaxVid = 3499;
+
+class CSRBuilderTest : public ::testing::TestWithParam<std::tuple<bool, bool>> {
+ protected:
+  void SetUp() override {
+    // Skewed degrees, duplicate edges and self loops, weight j + 1 on edge j.
+    for (unsigned j = 0; j < 40000; j++) {
+      unsigned src = (j * 2654435761u) % (kMaxVid + 1);
+      unsigned dst = j % 5 == 0 ? src : (j * j * 40503u) % (j % 3 ? 64 : 3500);
+      edges_.insert(edges_.end(), {src, dst});
+      edata_.push_back(j + 1);
+    }
+  }
+
+  // @brief: in- and out-neighbors of each vertex as <vid, weight>, the
+  // order of edges unless sorted.
+  void Expected(const bool skip_self_loops, std::vector<NEIGHBORS_T>* in,
+                std::vector<NEIGHBORS_T>* out) {
+    in->assign(kMaxVid + 1, NEIGHBORS_T());
+    out->assign(kMaxVid + 1, NEIGHBORS_T());
+    for (size_t j = 0; j < edata_.size(); j++) {
+      unsigned src = edges_[2 * j], dst = edges_[2 * j + 1];
+      if (skip_self_loops && src == dst) continue;
+      if (GidOf(src) != GID_MAX) (*out)[src].emplace_back(dst, edata_[j]);
+      if (GidOf(dst) != GID_MAX) (*in)[dst].emplace_back(src, edata_[j]);
+    }
+  }
+
+  std::vector<unsigned> edges_;
+  std::vector<unsigned> edata_;
+};
+
+TEST_P(CSRBuilderTest, MatchesEdgesOfEachVertex) {
+  bool sort = std::get<0>(GetParam());
+  bool skip_self_loops = std::get<1>(GetParam());
+  std::vector<NEIGHBORS_T> expected_in, expected_out;
+  Expected(skip_self_loops, &expected_in, &expected_out);
+
+  std::vector<unsigned> vid_map(kMaxVid + 1, VID_MAX);
+  CSR_BUILDER_T builder(4, sort, skip_self_loops);
+  auto graphs = builder.Build(edges_.data(), edata_.data(), edata_.size(),
+                              kMaxVid, GidOf, kNumFragments, vid_map.data());
+  ASSERT_EQ(graphs.size(), kNumFragments);
+  EXPECT_EQ(graphs[3], nullptr);
+
+  std::vector<char> seen(kMaxVid + 1, 0);
+  for (unsigned gid = 0; gid < 3; gid++) {
+    CSR_T* graph = graphs[gid];
+    ASSERT_NE(graph, nullptr);
+    EXPECT_EQ(graph->get_gid(), gid);
+    EXPECT_EQ(graph->IsSorted(), sort);
+    EXPECT_TRUE(graph->IsWeighted());
+    size_t sum_in_edges = 0, sum_out_edges = 0;
+    for (size_t i = 0; i < graph->get_num_vertexes(); i++) {
+      unsigned vid = graph->globalid_by_index_[i];
+      // Local ids follow global ids.
+      if (i > 0) EXPECT_LT(graph->globalid_by_index_[i - 1], vid);
+      EXPECT_EQ(GidOf(vid), gid);
+      EXPECT_EQ(graph->localid_by_globalid_[vid], i);
+      EXPECT_EQ(vid_map[vid], i);
+      EXPECT_EQ(graph->in_offset_[i], sum_in_edges);
+      EXPECT_EQ(graph->out_offset_[i], sum_out_edges);
+      seen[vid] = 1;
+
+      NEIGHBORS_T in, out;
+      for (size_t k = 0; k < graph->indegree_[i]; k++)
+        in.emplace_back(graph->in_edges_[graph->in_offset_[i] + k],
+                        graph->edata_[graph->in_offset_[i] + k]);
+      for (size_t k = 0; k < graph->outdegree_[i]; k++)
+        out.emplace_back(graph->out_edges_[graph->out_offset_[i] + k],
+                         graph->edata_[graph->sum_in_edges_ +
+                                       graph->out_offset_[i] + k]);
+      sum_in_edges += in.size();
+      sum_out_edges += out.size();
+      if (sort) {
+        auto by_vid = [](const std::pair<unsigned, unsigned>& a,
+                         const std::pair<unsigned, unsigned>& b) {
+          return a.first < b.first;
+        };
+        EXPECT_TRUE(std::is_sorted(in.begin(), in.end(), by_vid));
+        EXPECT_TRUE(std::is_sorted(out.begin(), out.end(), by_vid));
+      }
+      // Edges land in any order unless sorted, and duplicates of a sorted
+      // list in any order of their weights.
+      std::sort(in.begin(), in.end());
+      std::sort(out.begin(), out.end());
+      std::sort(expected_in[vid].begin(), expected_in[vid].end());
+      std::sort(expected_out[vid].begin(), expected_out[vid].end());
+      ASSERT_EQ(in, expected_in[vid]) << "vid: " << vid;
+      ASSERT_EQ(out, expected_out[vid]) << "vid: " << vid;
+    }
+    EXPECT_EQ(graph->sum_in_edges_, sum_in_edges);
+    EXPECT_EQ(graph->sum_out_edges_, sum_out_edges);
+  }
+
+  // Every vertex of a fragment with edges is built, and only those.
+  for (unsigned vid = 0; vid <= kMaxVid; vid++) {
+    bool has_edges = !expected_in[vid].empty() || !expected_out[vid].empty();
+    EXPECT_EQ((bool)seen[vid], has_edges) << "vid: " << vid;
+    if (!has_edges) EXPECT_EQ(vid_map[vid], VID_MAX);
+  }
+  for (auto graph : graphs) delete graph;
+}
+
+INSTANTIATE_TEST_SUITE_P(SortAndSelfLoops, CSRBuilderTest,
+                         ::testing::Combine(::testing::Bool(),
+                                            ::testing::Bool()));
+
+// The same fragments whatever the number of cores.
+TEST(CSRBuilderCoresTest, SameFragmentsWhateverTheNumberOfCores) {
+  std::vector<unsigned> edges;
+  for (unsigned j = 0; j < 10000; j++)
+    edges.insert(edges.end(), {j * 7 % 1000, j * 13 % 997});
+  auto one_fragment = [](unsigned vid) { return 0u; };
+  CSR_BUILDER_T single(1, true);
+  CSR_T* expected =
+      single.Build(edges.data(), nullptr, 10000, 999, one_fragment, 1)[0];
+  ASSERT_NE(expected, nullptr);
+  for (size_t cores : {2, 3, 8}) {
+    CSR_BUILDER_T builder(cores, true);
+    CSR_T* graph =
+        builder.Build(edges.data(), nullptr, 10000, 999, one_fragment, 1)[0];
+    ASSERT_NE(graph, nullptr);
+    EXPECT_FALSE(graph->IsWeighted());
+    ASSERT_EQ(graph->get_num_vertexes(), expected->get_num_vertexes());
+    ASSERT_EQ(graph->sum_in_edges_, expected->sum_in_edges_);
+    ASSERT_EQ(graph->sum_out_edges_, expected->sum_out_edges_);
+    for (size_t i = 0; i < graph->get_num_vertexes(); i++) {
+      ASSERT_EQ(graph->globalid_by_index_[i], expected->globalid_by_index_[i]);
+      ASSERT_EQ(graph->in_offset_[i], expected->in_offset_[i]);
+      ASSERT_EQ(graph->out_offset_[i], expected->out_offset_[i]);
+    }
+    for (size_t k = 0; k < graph->sum_in_edges_; k++)
+      ASSERT_EQ(graph->in_edges_[k], expected->in_edges_[k]);
+    for (size_t k = 0; k < graph->sum_out_edges_; k++)
+      ASSERT_EQ(graph->out_edges_[k], expected->out_edges_[k]);
+    delete graph;
+  }
+  delete expected;
+}
+
+}  // namespace graphs
+}  // namespace minigraph
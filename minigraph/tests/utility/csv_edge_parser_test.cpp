@@ -0,0 +1,148 @@
+#include "utility/io/csv_edge_parser.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace minigraph {
+namespace utility {
+namespace io {
+
+class CSVEdgeParserTest : public ::testing::Test {
+ protected:
+  void TearDown() override { remove(pt_.c_str()); }
+
+  void WriteFile(const std::string& text) {
+    std::ofstream fout(pt_, std::ios::binary);
+    fout << text;
+  }
+
+  std::vector<unsigned> ToVector(const unsigned* edges, const size_t n) {
+    return std::vector<unsigned>(edges, edges + 2 * n);
+  }
+
+  std::string pt_ = ::testing::TempDir() + "csv_edge_parser_test.csv";
+};
+
+TEST_F(CSVEdgeParserTest, SkipsCommentsBlankAndMalformedLines) {
+  WriteFile(
+      "# comment\n"
+      "% comment\n"
+      "\n"
+      "0,1\n"
+      "  2 , 3 \r\n"
+      "4,\n"
+      "x,5\n"
+      "6,7");
+  unsigned* edges = nullptr;
+  size_t num_edges = 0;
+  unsigned max_vid = 0;
+  CSVEdgeParser<unsigned, unsigned> parser(',', 2);
+  ASSERT_TRUE(parser.Parse(pt_, &edges, &num_edges, &max_vid));
+  EXPECT_EQ(ToVector(edges, num_edges),
+            std::vector<unsigned>({0, 1, 2, 3, 6, 7}));
+  EXPECT_EQ(max_vid, 7);
+  free(edges);
+}
+
+TEST_F(CSVEdgeParserTest, ParsesEveryNumberOfDigits) {
+  // Ids of 1 to 10 digits cross the 8-byte words at every offset, and the
+  // last one ends the file, where words can't be loaded.
+  std::string text;
+  std::vector<unsigned> expected;
+  unsigned v = 0;
+  for (size_t digits = 1; digits <= 10; digits++) {
+    v = v * 10 + digits % 10;
+    for (unsigned other : {0u, 12345678u, 4294967295u}) {
+      text += std::to_string(v) + "\t" + std::to_string(other) + "\n";
+      expected.insert(expected.end(), {v, other});
+    }
+  }
+  text += "4294967295 123456789";
+  expected.insert(expected.end(), {4294967295u, 123456789u});
+  WriteFile(text);
+  unsigned* edges = nullptr;
+  size_t num_edges = 0;
+  unsigned max_vid = 0;
+  CSVEdgeParser<unsigned, unsigned> parser('\t', 4);
+  ASSERT_TRUE(parser.Parse(pt_, &edges, &num_edges, &max_vid));
+  EXPECT_EQ(ToVector(edges, num_edges), expected);
+  EXPECT_EQ(max_vid, 4294967295u);
+  free(edges);
+}
+
+TEST_F(CSVEdgeParserTest, ParsesWeightsAndSkipsSelfLoops) {
+  WriteFile("0,1,0.5\n1,1,2\n1,2,3e2\n2,0\n");
+  unsigned* edges = nullptr;
+  float* edata = nullptr;
+  size_t num_edges = 0;
+  unsigned max_vid = 0;
+  CSVEdgeParser<unsigned, float> parser(',', 1);
+  ASSERT_TRUE(parser.Parse(pt_, &edges, &num_edges, &max_vid, &edata, true));
+  EXPECT_EQ(ToVector(edges, num_edges), std::vector<unsigned>({0, 1, 1, 2}));
+  ASSERT_EQ(num_edges, 2);
+  EXPECT_FLOAT_EQ(edata[0], 0.5);
+  EXPECT_FLOAT_EQ(edata[1], 300);
+  free(edges);
+  free(edata);
+}
+
+TEST_F(CSVEdgeParserTest, SameEdgesWhateverTheNumberOfChunks) {
+  std::string text;
+  for (unsigned i = 0; i < 5000; i++)
+    text += std::to_string(i * 2654435761u % 100003) + "," +
+            std::to_string(i) + (i % 7 == 0 ? "\n\n" : "\n");
+  WriteFile(text);
+  std::vector<unsigned> expected;
+  for (size_t cores : {1, 3, 16}) {
+    unsigned* edges = nullptr;
+    size_t num_edges = 0;
+    unsigned max_vid = 0;
+    CSVEdgeParser<unsigned, unsigned> parser(',', cores);
+    ASSERT_TRUE(parser.Parse(pt_, &edges, &num_edges, &max_vid));
+    ASSERT_EQ(num_edges, 5000);
+    if (expected.empty()) expected = ToVector(edges, num_edges);
+    EXPECT_EQ(ToVector(edges, num_edges), expected);
+    free(edges);
+  }
+  for (unsigned i = 0; i < 5000; i++) {
+    EXPECT_EQ(expected[2 * i], i * 2654435761u % 100003);
+    EXPECT_EQ(expected[2 * i + 1], i);
+  }
+}
+
+TEST_F(CSVEdgeParserTest, RejectsIdsBeyondVidType) {
+  unsigned* edges = nullptr;
+  size_t num_edges = 0;
+  unsigned max_vid = 0;
+  WriteFile("0,1\n4294967296,2\n");
+  CSVEdgeParser<unsigned, unsigned> parser(',', 2);
+  EXPECT_FALSE(parser.Parse(pt_, &edges, &num_edges, &max_vid));
+
+  // Beyond 64 bits, and the largest id below UINT64_MAX.
+  WriteFile("0,1\n2,18446744073709551616\n");
+  size_t* wide_edges = nullptr;
+  size_t wide_max_vid = 0;
+  CSVEdgeParser<size_t, unsigned> wide_parser(',', 2);
+  EXPECT_FALSE(
+      wide_parser.Parse(pt_, &wide_edges, &num_edges, &wide_max_vid));
+  WriteFile("0,1\n2,18446744073709551614\n");
+  ASSERT_TRUE(wide_parser.Parse(pt_, &wide_edges, &num_edges, &wide_max_vid));
+  EXPECT_EQ(wide_max_vid, 18446744073709551614ul);
+  free(wide_edges);
+}
+
+TEST_F(CSVEdgeParserTest, FailsOnMissingFile) {
+  unsigned* edges = nullptr;
+  size_t num_edges = 0;
+  unsigned max_vid = 0;
+  CSVEdgeParser<unsigned, unsigned> parser;
+  EXPECT_FALSE(parser.Parse(pt_ + ".missing", &edges, &num_edges, &max_vid));
+}
+
+}  // namespace io
+}  // namespace utility
+}  // namespace minigraph
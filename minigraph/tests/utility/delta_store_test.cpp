@@ -0,0 +1,271 @@
+#include "utility/io/delta_store.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "graphs/csr_builder.h"
+#include "graphs/immutable_csr.h"
+#include "utility/io/csr_io_adapter.h"
+
+namespace minigraph {
+namespace utility {
+namespace io {
+
+using CSR_T = graphs::ImmutableCSR<unsigned, unsigned, unsigned, unsigned>;
+using DELTA_STORE_T = DeltaStore<CSR_T>;
+using EDGES_T = std::map<std::pair<unsigned, unsigned>, unsigned>;
+
+// Vertexes 0 to 99 go to fragments 0 and 1 by vid % 2.
+static const size_t kNumFragments = 2;
+static const unsigned kMaxVid = 99;
+
+class DeltaStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    work_space_ = ::testing::TempDir() + "delta_store_test/";
+    std::filesystem::remove_all(work_space_);
+    std::filesystem::create_directories(work_space_);
+    // A ring, so that every vertex is in a fragment, and a chord per vertex.
+    std::vector<unsigned> edges;
+    for (unsigned vid = 0; vid <= kMaxVid; vid++)
+      for (unsigned dst : {(vid + 1) % 100, (vid * 7 + 3) % 100}) {
+        if (dst == vid || edges_.count(std::make_pair(vid, dst))) continue;
+        edges.insert(edges.end(), {vid, dst});
+        edges_[std::make_pair(vid, dst)] = 0;
+      }
+    graphs::CSRBuilder<unsigned, unsigned, unsigned, unsigned> builder(1,
+                                                                      true);
+    auto graphs = builder.Build(
+        edges.data(), nullptr, edges.size() / 2, kMaxVid,
+        [](unsigned vid) { return vid % 2; }, kNumFragments);
+    for (unsigned gid = 0; gid < kNumFragments; gid++) {
+      std::string prefix = work_space_ + std::to_string(gid);
+      Path path = {prefix + "_meta.bin", prefix + "_data.bin",
+                   prefix + "_vdata.bin"};
+      ASSERT_TRUE(csr_io_adapter_.Write(*graphs[gid], csr_bin, false,
+                                        path.meta_pt, path.data_pt,
+                                        path.vdata_pt));
+      pt_by_gid_[gid] = path;
+      delete graphs[gid];
+    }
+  }
+
+  void TearDown() override { std::filesystem::remove_all(work_space_); }
+
+  // @brief: update the reference edges as DeltaStore::Update() would.
+  void Update(DELTA_STORE_T* store, const std::vector<unsigned>& edges,
+              const std::vector<unsigned>& weights, const bool insert) {
+    size_t n = edges.size() / 2;
+    EXPECT_EQ(store->Update(edges.data(), weights.data(), n, insert), n);
+    for (size_t i = 0; i < n; i++) {
+      auto key = std::make_pair(edges[2 * i], edges[2 * i + 1]);
+      if (insert)
+        edges_[key] = weights[i];
+      else
+        edges_.erase(key);
+    }
+  }
+
+  // @brief: read each fragment, merge its pending updates if apply, and
+  // check its in- and out-edges against the reference.
+  void ExpectEdges(DELTA_STORE_T* store, const bool apply) {
+    EDGES_T in_edges, out_edges;
+    for (unsigned gid = 0; gid < kNumFragments; gid++) {
+      auto& path = pt_by_gid_[gid];
+      CSR_T graph;
+      ASSERT_TRUE(csr_io_adapter_.Read(&graph, csr_bin, gid, path.meta_pt,
+                                       path.data_pt, path.vdata_pt));
+      if (apply) ASSERT_TRUE(store->Apply(gid, &graph));
+      ASSERT_EQ(graph.sum_in_edges_ + graph.sum_out_edges_, graph.num_edges_);
+      for (size_t i = 0; i < graph.get_num_vertexes(); i++) {
+        unsigned vid = graph.globalid_by_index_[i];
+        EXPECT_EQ(vid % 2, gid);
+        for (size_t k = 0; k < graph.indegree_[i]; k++) {
+          size_t j = graph.in_offset_[i] + k;
+          if (k > 0) EXPECT_LT(graph.in_edges_[j - 1], graph.in_edges_[j]);
+          unsigned w = graph.edata_ == nullptr ? 0 : graph.edata_[j];
+          in_edges[std::make_pair(graph.in_edges_[j], vid)] = w;
+        }
+        for (size_t k = 0; k < graph.outdegree_[i]; k++) {
+          size_t j = graph.out_offset_[i] + k;
+          if (k > 0) EXPECT_LT(graph.out_edges_[j - 1], graph.out_edges_[j]);
+          unsigned w = graph.edata_ == nullptr
+                           ? 0
+                           : graph.edata_[graph.sum_in_edges_ + j];
+          out_edges[std::make_pair(vid, graph.out_edges_[j])] = w;
+        }
+      }
+    }
+    EXPECT_EQ(in_edges, edges_);
+    EXPECT_EQ(out_edges, edges_);
+  }
+
+  std::string work_space_;
+  std::unordered_map<unsigned, Path> pt_by_gid_;
+  CSRIOAdapter<unsigned, unsigned, unsigned, unsigned> csr_io_adapter_;
+  EDGES_T edges_;
+};
+
+TEST_F(DeltaStoreTest, LastUpdateOfAnEdgeWins) {
+  DELTA_STORE_T store(work_space_);
+  ASSERT_TRUE(store.Init(pt_by_gid_));
+  // Reweight base edges, insert edges within and across fragments, then
+  // update some of them again in later batches.
+  Update(&store, {0, 1, 2, 4, 3, 50, 50, 3}, {5, 6, 7, 8}, true);
+  Update(&store, {0, 1, 2, 4, 98, 99}, {0, 0, 0}, false);
+  Update(&store, {2, 4, 3, 50}, {9, 10}, true);
+  Update(&store, {5, 6, 6, 7}, {0, 0}, false);
+  EXPECT_GT(store.GetNumDeltas(0), 0);
+  ExpectEdges(&store, true);
+
+  // Self loops and vertexes out of the workspace are dropped.
+  std::vector<unsigned> dropped = {4, 4, 1000, 1, 1, 1000};
+  EXPECT_EQ(store.Update(dropped.data(), nullptr, 3, true), 0);
+  ExpectEdges(&store, true);
+}
+
+TEST_F(DeltaStoreTest, LogIsReplayedOnInit) {
+  {
+    DELTA_STORE_T store(work_space_);
+    ASSERT_TRUE(store.Init(pt_by_gid_));
+    Update(&store, {1, 2, 10, 11, 11, 10}, {1, 2, 3}, true);
+    Update(&store, {10, 11, 12, 13}, {0, 0}, false);
+  }
+  DELTA_STORE_T store(work_space_);
+  ASSERT_TRUE(store.Init(pt_by_gid_));
+  ExpectEdges(&store, true);
+}
+
+TEST_F(DeltaStoreTest, CompactMergesAndDropsTheLog) {
+  DELTA_STORE_T store(work_space_);
+  ASSERT_TRUE(store.Init(pt_by_gid_));
+  Update(&store, {1, 2, 10, 11, 40, 41}, {1, 2, 3}, true);
+  Update(&store, {20, 21, 41, 42}, {0, 0}, false);
+  ASSERT_TRUE(store.CompactAll());
+  for (unsigned gid = 0; gid < kNumFragments; gid++) {
+    EXPECT_EQ(store.GetNumDeltas(gid), 0);
+    EXPECT_FALSE(std::filesystem::exists(work_space_ + "minigraph_delta/" +
+                                         std::to_string(gid) + ".bin"));
+  }
+  ExpectEdges(&store, false);
+
+  // Updates after a compaction land on the new fragments.
+  Update(&store, {1, 2, 70, 71}, {4, 5}, true);
+  ExpectEdges(&store, true);
+  DELTA_STORE_T restarted(work_space_);
+  ASSERT_TRUE(restarted.Init(pt_by_gid_));
+  ExpectEdges(&restarted, true);
+}
+
+TEST_F(DeltaStoreTest, InitFinishesCommittedCompactions) {
+  // Compact a copy of the workspace, then put its new fragment 0 in place of
+  // a commit cut short after the data file was moved, and leave an
+  // uncommitted compaction of fragment 1.
+  std::string copy = ::testing::TempDir() + "delta_store_test_copy/";
+  std::filesystem::remove_all(copy);
+  std::filesystem::copy(work_space_, copy);
+  std::unordered_map<unsigned, Path> copy_pt_by_gid;
+  for (auto& iter : pt_by_gid_)
+    copy_pt_by_gid[iter.first] = {copy + std::to_string(iter.first) +
+                                      "_meta.bin",
+                                  copy + std::to_string(iter.first) +
+                                      "_data.bin",
+                                  copy + std::to_string(iter.first) +
+                                      "_vdata.bin"};
+  {
+    DELTA_STORE_T store(copy);
+    ASSERT_TRUE(store.Init(copy_pt_by_gid));
+    Update(&store, {2, 4, 3, 5}, {6, 7}, true);
+    ASSERT_TRUE(store.CompactAll());
+  }
+  std::string root = work_space_ + "minigraph_delta/";
+  std::filesystem::create_directories(root + "0.tmp/");
+  std::filesystem::create_directories(root + "1.tmp/");
+  std::filesystem::copy_file(copy + "0_data.bin", pt_by_gid_[0].data_pt,
+                             std::filesystem::copy_options::overwrite_existing);
+  std::filesystem::copy_file(copy + "0_meta.bin", root + "0.tmp/meta");
+  std::filesystem::copy_file(copy + "0_vdata.bin", root + "0.tmp/vdata");
+  std::ofstream(root + "0.commit").close();
+  std::filesystem::copy_file(copy + "1_data.bin", root + "1.tmp/data");
+  std::filesystem::remove_all(copy);
+
+  DELTA_STORE_T store(work_space_);
+  ASSERT_TRUE(store.Init(pt_by_gid_));
+  EXPECT_FALSE(std::filesystem::exists(root + "0.commit"));
+  EXPECT_FALSE(std::filesystem::exists(root + "0.tmp/"));
+  EXPECT_FALSE(std::filesystem::exists(root + "1.tmp/"));
+  // Fragment 0 is the compacted one, with 2->4, fragment 1 keeps its old
+  // edges, without 3->5.
+  edges_.erase(std::make_pair(3u, 5u));
+  ExpectEdges(&store, false);
+}
+
+TEST_F(DeltaStoreTest, OwnersOfARangeOfVertexes) {
+  DELTA_STORE_T store(work_space_);
+  ASSERT_TRUE(store.Init(pt_by_gid_));
+  unsigned owners[64];
+  store.GetOwners(64, 64, owners);
+  for (unsigned i = 0; i < 64; i++) {
+    EXPECT_EQ(owners[i], 64 + i <= kMaxVid ? (64 + i) % 2 : GID_MAX);
+    EXPECT_EQ(store.GetOwner(64 + i), owners[i]);
+  }
+}
+
+TEST_F(DeltaStoreTest, BatchIsTrimmedToTheOldestResult) {
+  DELTA_STORE_T store(work_space_);
+  ASSERT_TRUE(store.Init(pt_by_gid_));
+  Update(&store, {1, 2, 3, 4, 5, 6, 7, 8}, {1, 2, 3, 4}, true);
+  Update(&store, {9, 10, 11, 12}, {0, 0}, false);
+  ASSERT_EQ(store.GetBatchSize(), 6);
+  std::vector<DELTA_STORE_T::DeltaEdge> batch;
+  size_t end = 0;
+  ASSERT_TRUE(store.ReadBatch(0, &batch, &end));
+  ASSERT_EQ(end, 6);
+  ASSERT_EQ(batch.size(), 6);
+  for (size_t i = 0; i < batch.size(); i++) {
+    EXPECT_EQ(batch[i].vid, 2 * i + 1);
+    EXPECT_EQ(batch[i].nbr, 2 * i + 2);
+    EXPECT_EQ(batch[i].dir, DELTA_STORE_T::kOut);
+    EXPECT_EQ(batch[i].op, i < 4 ? DELTA_STORE_T::kInsert
+                                 : DELTA_STORE_T::kDelete);
+  }
+
+  // Results of two apps, at positions 5 and 4 of the batch.
+  std::filesystem::create_directories(work_space_ + "minigraph_stream/");
+  for (auto result : {std::make_pair("a", 5ul), std::make_pair("b", 4ul)}) {
+    std::ofstream out(work_space_ + "minigraph_stream/" + result.first + ".bin",
+                      std::ios::binary);
+    out.write((char*)&result.second, sizeof(size_t));
+  }
+  ASSERT_TRUE(store.TrimBatch());
+  EXPECT_EQ(store.GetBatchSize(), 6);
+  EXPECT_EQ(std::filesystem::file_size(work_space_ +
+                                       "minigraph_delta/batch.bin"),
+            sizeof(size_t) + 2 * sizeof(DELTA_STORE_T::DeltaEdge));
+  batch.clear();
+  EXPECT_FALSE(store.ReadBatch(3, &batch, &end));
+  batch.clear();
+  ASSERT_TRUE(store.ReadBatch(4, &batch, &end));
+  ASSERT_EQ(end, 6);
+  ASSERT_EQ(batch.size(), 2);
+  EXPECT_EQ(batch[0].vid, 9);
+  EXPECT_EQ(batch[1].vid, 11);
+
+  // Positions go on from the trimmed ones.
+  Update(&store, {13, 14}, {1}, true);
+  batch.clear();
+  ASSERT_TRUE(store.ReadBatch(5, &batch, &end));
+  ASSERT_EQ(end, 7);
+  ASSERT_EQ(batch.size(), 2);
+  EXPECT_EQ(batch[1].vid, 13);
+}
+
+}  // namespace io
+}  // namespace utility
+}  // namespace minigraph
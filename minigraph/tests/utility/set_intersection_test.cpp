@@ -0,0 +1,118 @@
+#include "utility/set_intersection.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace minigraph {
+namespace utility {
+
+// @brief: n ascending values without duplicates, drawn from [0, range).
+template <typename T>
+static std::vector<T> RandomSet(std::mt19937_64* rng, const size_t n,
+                                const T range) {
+  std::vector<T> set;
+  std::uniform_int_distribution<T> dist(0, range - 1);
+  while (set.size() < n) {
+    for (size_t i = set.size(); i < n; i++) set.push_back(dist(*rng));
+    std::sort(set.begin(), set.end());
+    set.erase(std::unique(set.begin(), set.end()), set.end());
+  }
+  return set;
+}
+
+// @brief: check every intersection of a and b, either way round, against
+// std::set_intersection.
+template <typename T>
+static void ExpectIntersection(const std::vector<T>& a,
+                               const std::vector<T>& b) {
+  std::vector<T> expected;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(expected));
+  std::vector<T> out(std::min(a.size(), b.size()) + 1);
+  for (auto x : {&a, &b}) {
+    auto y = x == &a ? &b : &a;
+    size_t count = Intersect(x->data(), x->size(), y->data(), y->size(),
+                             out.data());
+    ASSERT_EQ(count, expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), out.begin()));
+    EXPECT_EQ(Intersect(x->data(), x->size(), y->data(), y->size()), count);
+
+    EXPECT_EQ(MergeIntersect(x->data(), x->size(), y->data(), y->size()),
+              count);
+    if (x->size() <= y->size()) {
+      ASSERT_EQ(GallopingIntersect(x->data(), x->size(), y->data(),
+                                   y->size(), out.data()),
+                count);
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), out.begin()));
+    }
+#if defined(__AVX512F__) || defined(__AVX2__)
+    if (sizeof(T) == sizeof(uint32_t)) {
+      ASSERT_EQ(SIMDIntersect((const uint32_t*)x->data(), x->size(),
+                              (const uint32_t*)y->data(), y->size(),
+                              (uint32_t*)out.data()),
+                count);
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), out.begin()));
+    }
+#endif
+  }
+}
+
+TEST(SetIntersectionTest, EmptyAndEqualSets) {
+  std::vector<uint32_t> empty, set;
+  for (uint32_t i = 0; i < 100; i++) set.push_back(3 * i);
+  ExpectIntersection(empty, empty);
+  ExpectIntersection(empty, set);
+  ExpectIntersection(set, set);
+}
+
+TEST(SetIntersectionTest, SizesAroundSIMDBlocks) {
+  std::mt19937_64 rng(7);
+  for (size_t na : {1, 7, 8, 9, 15, 16, 17, 31, 33, 64})
+    for (size_t nb : {1, 7, 8, 9, 15, 16, 17, 31, 33, 64})
+      for (uint32_t range : {64u, 256u, 4096u})
+        ExpectIntersection(RandomSet<uint32_t>(&rng, na, range),
+                           RandomSet<uint32_t>(&rng, nb, range));
+}
+
+TEST(SetIntersectionTest, InterleavedAndLargeIds) {
+  std::vector<uint32_t> even, odd, top;
+  for (uint32_t i = 0; i < 1000; i++) {
+    even.push_back(2 * i);
+    odd.push_back(2 * i + 1);
+    top.push_back(0xFFFFFFFFu - 999 + i);
+  }
+  ExpectIntersection(even, odd);
+  ExpectIntersection(even, top);
+  top.insert(top.begin(), {0, 2, 4, 8});
+  ExpectIntersection(even, top);
+}
+
+TEST(SetIntersectionTest, SkewedSizesGallop) {
+  std::mt19937_64 rng(11);
+  for (size_t na : {1, 3, 20, 100}) {
+    auto b = RandomSet<uint32_t>(&rng, 100000, 1000000);
+    auto a = RandomSet<uint32_t>(&rng, na, 1000000);
+    // Half of a taken from b.
+    for (size_t i = 0; i < na; i += 2) a[i] = b[(i * 7919) % b.size()];
+    std::sort(a.begin(), a.end());
+    a.erase(std::unique(a.begin(), a.end()), a.end());
+    ExpectIntersection(a, b);
+  }
+}
+
+TEST(SetIntersectionTest, WideIdsTakeTheScalarMerge) {
+  std::mt19937_64 rng(13);
+  for (size_t n : {5, 50, 500})
+    ExpectIntersection(RandomSet<uint64_t>(&rng, n, 1ull << 40),
+                       RandomSet<uint64_t>(&rng, 2 * n, 1ull << 40));
+  std::vector<uint64_t> a = {1, 1ull << 33, 1ull << 34};
+  std::vector<uint64_t> b = {1ull << 33, 1ull << 35};
+  ExpectIntersection(a, b);
+}
+
+}  // namespace utility
+}  // namespace minigraph
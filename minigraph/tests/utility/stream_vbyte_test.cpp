@@ -0,0 +1,172 @@
+#include "utility/stream_vbyte.h"
+
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+#include "graphs/csr_builder.h"
+#include "graphs/immutable_csr.h"
+#include "utility/io/csr_io_adapter.h"
+
+namespace minigraph {
+namespace utility {
+
+using CSR_T = graphs::ImmutableCSR<unsigned, unsigned, unsigned, unsigned>;
+
+// Encode n values, check the data length against the value lengths, and
+// decode them back, with data_end at the last data byte so that the tail
+// group takes the scalar loop.
+static void ExpectRoundTrip(const std::vector<uint32_t>& in) {
+  size_t n = in.size();
+  std::vector<uint8_t> ctrl(StreamVByteControlBytes(n));
+  std::vector<uint8_t> data(StreamVByteMaxDataBytes(n));
+  size_t data_bytes = StreamVByteEncode(in.data(), n, ctrl.data(), data.data());
+  size_t expected_bytes = 0;
+  for (auto v : in)
+    expected_bytes += v < (1u << 8)    ? 1
+                      : v < (1u << 16) ? 2
+                      : v < (1u << 24) ? 3
+                                       : 4;
+  EXPECT_EQ(data_bytes, expected_bytes);
+
+  std::vector<uint32_t> out(n, 0xDEADBEEF);
+  const uint8_t* end = StreamVByteDecode(ctrl.data(), data.data(),
+                                         data.data() + data_bytes, n,
+                                         out.data());
+  EXPECT_EQ(end, data.data() + data_bytes);
+  EXPECT_EQ(out, in);
+}
+
+TEST(StreamVByteTest, RoundTripOfPartialGroups) {
+  for (size_t n : {0, 1, 2, 3, 5, 6, 7, 9, 13, 30}) {
+    std::vector<uint32_t> in(n);
+    for (size_t i = 0; i < n; i++)
+      in[i] = (uint32_t)(i * 2654435761u) >> (i % 32);
+    ExpectRoundTrip(in);
+  }
+}
+
+TEST(StreamVByteTest, EachLengthOfValues) {
+  // Smallest and largest value of each length of 1 to 4 bytes.
+  std::vector<uint32_t> in = {0,       0xFF,     0x100,     0xFFFF,
+                              0x10000, 0xFFFFFF, 0x1000000, 0xFFFFFFFF};
+  uint8_t ctrl[2];
+  uint8_t data[32];
+  EXPECT_EQ(StreamVByteEncode(in.data(), in.size(), ctrl, data), 20);
+  // Lengths minus one, two bits per value, the first value lowest.
+  EXPECT_EQ(ctrl[0], 0b01010000);
+  EXPECT_EQ(ctrl[1], 0b11111010);
+  ExpectRoundTrip(in);
+
+  // Each length in every position of a group, with data to spare so that
+  // groups are shuffled.
+  for (size_t shift = 0; shift < 4; shift++) {
+    std::vector<uint32_t> group(16);
+    for (size_t i = 0; i < group.size(); i++)
+      group[i] = 0xFFFFFFFFu >> (8 * ((i + shift) % 4));
+    ExpectRoundTrip(group);
+  }
+}
+
+TEST(StreamVByteTest, DeltaOfSortedLists) {
+  std::vector<uint32_t> in = {3, 3, 7, 300, 70000, 0xFFFFFFFF};
+  std::vector<uint32_t> deltas(in.size());
+  DeltaEncode(in.data(), in.size(), true, deltas.data());
+  EXPECT_EQ(deltas, std::vector<uint32_t>({3, 0, 4, 293, 69700, 4294897295u}));
+  DeltaDecode(deltas.data(), deltas.size(), true);
+  EXPECT_EQ(deltas, in);
+}
+
+TEST(StreamVByteTest, ZigzagOfDescendingSteps) {
+  std::vector<uint32_t> in = {100, 90, 89, 0, 0xFFFFFFFF, 5, 6};
+  std::vector<uint32_t> deltas(in.size());
+  DeltaEncode(in.data(), in.size(), false, deltas.data());
+  // Steps of -10 and -1 take a byte, not four.
+  EXPECT_EQ(deltas[0], 200);
+  EXPECT_EQ(deltas[1], 19);
+  EXPECT_EQ(deltas[2], 1);
+  EXPECT_EQ(deltas[3], 177);
+  EXPECT_EQ(deltas[6], 2);
+  ExpectRoundTrip(deltas);
+  DeltaDecode(deltas.data(), deltas.size(), false);
+  EXPECT_EQ(deltas, in);
+}
+
+class CompressedCSRBinTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    work_space_ = ::testing::TempDir() + "compressed_csr_bin_test/";
+    mkdir(work_space_.c_str(), 0777);
+  }
+
+  std::string work_space_;
+};
+
+// Write a fragment compressed, read it back, and compare it with the
+// fragment as built.
+TEST_P(CompressedCSRBinTest, WriteReadEquality) {
+  bool sorted = GetParam();
+  std::vector<unsigned> edges;
+  for (unsigned src = 0; src < 300; src++)
+    for (unsigned k = 1; k <= src % 13; k++)
+      edges.insert(edges.end(), {src, (src * 7919 + k * 104729) % 100000});
+  edges.insert(edges.end(), {99999, 0, 0, 99999, 5, 5});
+  graphs::CSRBuilder<unsigned, unsigned, unsigned, unsigned> builder(2,
+                                                                    sorted);
+  CSR_T* graph = builder.Build(
+      edges.data(), nullptr, edges.size() / 2, 99999,
+      [](unsigned vid) { return 0u; }, 1)[0];
+  ASSERT_NE(graph, nullptr);
+  graph->csr_flags_ |= CSR_COMPRESSED;
+
+  std::string meta_pt = work_space_ + "0_meta.bin";
+  std::string data_pt = work_space_ + "0_data.bin";
+  std::string vdata_pt = work_space_ + "0_vdata.bin";
+  io::CSRIOAdapter<unsigned, unsigned, unsigned, unsigned> csr_io_adapter;
+  ASSERT_TRUE(csr_io_adapter.Write(*graph, csr_bin, false, meta_pt, data_pt,
+                                   vdata_pt));
+  struct stat st;
+  ASSERT_EQ(stat(data_pt.c_str(), &st), 0);
+  EXPECT_LT((size_t)st.st_size,
+            sizeof(unsigned) * (graph->sum_in_edges_ + graph->sum_out_edges_ +
+                                graph->get_aligned_max_vid()) +
+                3 * sizeof(size_t) * graph->get_num_vertexes());
+
+  auto loaded = new CSR_T;
+  ASSERT_TRUE(csr_io_adapter.Read(loaded, csr_bin, 0, meta_pt, data_pt,
+                                  vdata_pt));
+  EXPECT_TRUE(loaded->csr_flags_ & CSR_COMPRESSED);
+  EXPECT_EQ(loaded->IsSorted(), sorted);
+  ASSERT_EQ(loaded->get_num_vertexes(), graph->get_num_vertexes());
+  ASSERT_EQ(loaded->sum_in_edges_, graph->sum_in_edges_);
+  ASSERT_EQ(loaded->sum_out_edges_, graph->sum_out_edges_);
+  size_t n = graph->get_num_vertexes();
+  for (size_t i = 0; i < n; i++) {
+    ASSERT_EQ(loaded->globalid_by_index_[i], graph->globalid_by_index_[i]);
+    ASSERT_EQ(loaded->indegree_[i], graph->indegree_[i]);
+    ASSERT_EQ(loaded->outdegree_[i], graph->outdegree_[i]);
+    ASSERT_EQ(loaded->in_offset_[i], graph->in_offset_[i]);
+    ASSERT_EQ(loaded->out_offset_[i], graph->out_offset_[i]);
+  }
+  for (size_t i = 0; i < graph->sum_in_edges_; i++)
+    ASSERT_EQ(loaded->in_edges_[i], graph->in_edges_[i]);
+  for (size_t i = 0; i < graph->sum_out_edges_; i++)
+    ASSERT_EQ(loaded->out_edges_[i], graph->out_edges_[i]);
+  for (size_t vid = 0; vid < graph->get_aligned_max_vid(); vid++)
+    ASSERT_EQ(loaded->localid_by_globalid_[vid],
+              graph->localid_by_globalid_[vid]);
+
+  remove(meta_pt.c_str());
+  remove(data_pt.c_str());
+  remove(vdata_pt.c_str());
+  delete loaded;
+  delete graph;
+}
+
+INSTANTIATE_TEST_SUITE_P(SortedAndUnsorted, CompressedCSRBinTest,
+                         ::testing::Bool());
+
+}  // namespace utility
+}  // namespace minigraph
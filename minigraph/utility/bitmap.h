@@ -6,6 +6,8 @@
 #include <cassert>
 #include <cstring>
 
+#include "utility/memory.h"
+
 #define WORD_OFFSET(i) (i >> 6)
 #define BIT_OFFSET(i) (i & 0x3f)
 
@@ -14,6 +16,10 @@ class Bitmap {
   size_t size_ = 0;
   unsigned long* data_ = nullptr;
 
+  // One bit per 64 words of data_ that may be nonzero, see track_dirty().
+  unsigned long* dirty_ = nullptr;
+  size_t capacity_ = 0;
+
   Bitmap() = default;
 
   Bitmap(const size_t size) {
@@ -28,13 +34,15 @@ class Bitmap {
 
   ~Bitmap() {
     if (data_ != nullptr) free(data_);
+    if (dirty_ != nullptr) free(dirty_);
     size_ = 0;
     return;
   }
 
   void init(size_t size) {
     this->size_ = size;
-    this->data_ = new unsigned long[WORD_OFFSET(size) + 1];
+    this->data_ = (unsigned long*)minigraph::utility::HugePageAlloc(
+        sizeof(unsigned long) * (WORD_OFFSET(size) + 1));
     return;
   }
 
@@ -44,10 +52,37 @@ class Bitmap {
     return;
   }
 
+  // @brief: track the 64-word chunks of the first capacity bits written by
+  // set_bit(), fill() and the batch operations, so that clear() resets only
+  // those. The bitmap may be resized within capacity afterwards.
+  void track_dirty(const size_t capacity) {
+    capacity_ = WORD_OFFSET(capacity) + 1;
+    dirty_ = (unsigned long*)calloc(WORD_OFFSET(capacity_) + 1,
+                                    sizeof(unsigned long));
+    mark_dirty(0, capacity_);
+    return;
+  }
+
   void clear() {
     size_t bm_size = WORD_OFFSET(size_);
-    for (size_t i = 0; i <= bm_size; i++) {
-      data_[i] = 0;
+    if (dirty_ == nullptr) {
+      for (size_t i = 0; i <= bm_size; i++) {
+        data_[i] = 0;
+      }
+      return;
+    }
+    for (size_t i = 0; i <= WORD_OFFSET(bm_size); i++) {
+      unsigned long chunks = dirty_[i];
+      while (chunks != 0) {
+        size_t chunk = (i << 6) + __builtin_ctzl(chunks);
+        chunks &= chunks - 1;
+        if ((chunk << 6) > bm_size) break;
+        size_t end = (chunk + 1) << 6;
+        if (end > capacity_) end = capacity_;
+        memset(data_ + (chunk << 6), 0,
+               sizeof(unsigned long) * (end - (chunk << 6)));
+        dirty_[i] &= ~(1ul << BIT_OFFSET(chunk));
+      }
     }
     return;
   }
@@ -76,6 +111,7 @@ class Bitmap {
     for (size_t i = (bm_size << 6); i < size_; i++) {
       data_[bm_size] |= 1ul << BIT_OFFSET(i);
     }
+    mark_dirty(0, bm_size + 1);
     return;
   }
 
@@ -91,6 +127,7 @@ class Bitmap {
   void set_bit(size_t i) {
     if (i > size_) return;
     __sync_fetch_and_or(data_ + WORD_OFFSET(i), 1ul << BIT_OFFSET(i));
+    if (dirty_ != nullptr) mark_dirty(WORD_OFFSET(i));
     return;
   }
 
@@ -123,12 +160,14 @@ class Bitmap {
     for (size_t i = 0; i <= bm_size; i++) {
       __sync_fetch_and_or(data_ + i, b.data_[i]);
     }
+    mark_dirty(0, bm_size + 1);
     return true;
   }
 
   bool copy_bit(Bitmap& b) {
     if (size_ != b.size_) return false;
     memcpy(data_, b.data_, sizeof(unsigned long) * (WORD_OFFSET(size_) + 1));
+    mark_dirty(0, WORD_OFFSET(size_) + 1);
     return true;
   }
 
@@ -146,6 +185,20 @@ class Bitmap {
     }
     return count;
   }
+
+ private:
+  void mark_dirty(const size_t word) {
+    unsigned long* chunks = dirty_ + WORD_OFFSET(WORD_OFFSET(word));
+    unsigned long bit = 1ul << BIT_OFFSET(WORD_OFFSET(word));
+    if ((*chunks & bit) == 0) __sync_fetch_and_or(chunks, bit);
+    return;
+  }
+
+  void mark_dirty(const size_t from, const size_t to) {
+    if (dirty_ == nullptr) return;
+    for (size_t i = from & ~0x3ful; i < to; i += 64) mark_dirty(i);
+    return;
+  }
 };
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
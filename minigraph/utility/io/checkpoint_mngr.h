@@ -0,0 +1,290 @@
+#ifndef MINIGRAPH_UTILITY_IO_CHECKPOINT_MNGR_H
+#define MINIGRAPH_UTILITY_IO_CHECKPOINT_MNGR_H
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "graphs/immutable_csr.h"
+#include "message_manager/default_message_manager.h"
+#include "portability/sys_data_structure.h"
+#include "utility/logging.h"
+
+namespace minigraph {
+namespace utility {
+namespace io {
+
+// @brief: CheckpointMngr saves the state of a run at superstep boundaries
+// and restores it on -resume. A checkpoint holds the superstep counters, the
+// state matrix, global_border_vdata, the global active vid map, the statistic
+// info and the vdata of all fragments, so it covers apps whose state lives
+// in vdata and global_border_vdata. The state is copied in memory by the
+// caller thread and written by a background thread under
+//   work_space/minigraph_checkpoint/<global superstep>/
+// whose name is committed to minigraph_checkpoint/last when it's complete.
+template <typename GRAPH_T>
+class CheckpointMngr {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using CSR_T = graphs::ImmutableCSR<GID_T, VID_T, VDATA_T, EDATA_T>;
+  using MSG_MNGR_T = message::DefaultMessageManager<GRAPH_T>;
+
+ public:
+  CheckpointMngr(const std::string& work_space,
+                 const size_t checkpoint_interval = 0)
+      : root_(work_space + "minigraph_checkpoint/"),
+        checkpoint_interval_(checkpoint_interval) {}
+
+  ~CheckpointMngr() { Wait(); }
+
+  void SetInterval(const size_t checkpoint_interval) {
+    checkpoint_interval_ = checkpoint_interval;
+  }
+
+  // @brief: whether a checkpoint is due once global_superstep supersteps
+  // have finished.
+  bool IsDue(const size_t global_superstep) const {
+    return checkpoint_interval_ > 0 && global_superstep > 0 &&
+           global_superstep % checkpoint_interval_ == 0;
+  }
+
+  // @brief: copy the state of the run and write it in background. All
+  // fragments must be released, i.e. their vdata is on disk and no one
+  // updates global_border_vdata or the superstep counters meanwhile.
+  void Take(const size_t global_superstep,
+            std::unordered_map<GID_T, std::atomic<size_t>*>* superstep_by_gid,
+            MSG_MNGR_T* msg_mngr, std::unordered_map<GID_T, Path>* pt_by_gid) {
+    // Keep one checkpoint in flight.
+    Wait();
+    auto snapshot = std::make_unique<Snapshot>();
+    snapshot->global_superstep = global_superstep;
+    size_t num_graphs = pt_by_gid->size();
+    snapshot->superstep_by_gid.resize(num_graphs);
+    snapshot->state_matrix.resize(num_graphs);
+    snapshot->vdata_by_gid.resize(num_graphs);
+    for (GID_T gid = 0; gid < num_graphs; gid++) {
+      snapshot->superstep_by_gid[gid] =
+          superstep_by_gid->find(gid)->second->load();
+      snapshot->state_matrix[gid] = msg_mngr->GetStateMatrix(gid);
+      if (IsSameType<GRAPH_T, CSR_T>() &&
+          !ReadVdata(pt_by_gid->find(gid)->second,
+                     &snapshot->vdata_by_gid[gid])) {
+        XLOG(ERR, "Checkpoint skipped: vdata of ", gid, " is unreadable.");
+        return;
+      }
+    }
+    snapshot->global_vdata.assign(
+        msg_mngr->GetGlobalVdata(),
+        msg_mngr->GetGlobalVdata() + msg_mngr->get_aligned_max_vid());
+    auto active_map = msg_mngr->GetGlobalActiveVidMap();
+    snapshot->active_map.assign(
+        active_map->data_,
+        active_map->data_ + WORD_OFFSET(active_map->size_) + 1);
+    snapshot->si.assign(msg_mngr->GetStatisticInfo(),
+                        msg_mngr->GetStatisticInfo() + num_graphs);
+
+    writer_ = std::thread([this, snapshot = std::move(snapshot)]() {
+      if (Write(*snapshot))
+        LOG_INFO("Checkpoint: superstep ", snapshot->global_superstep);
+      else
+        XLOG(ERR, "Checkpoint failed: superstep ",
+             snapshot->global_superstep);
+    });
+  }
+
+  // @brief: wait for the checkpoint in flight, if any.
+  void Wait() {
+    if (writer_.joinable()) writer_.join();
+  }
+
+  // @brief: restore the last complete checkpoint. The vdata of each fragment
+  // is written back in place, so that the edata following it is kept.
+  // Fragments are left Idle, they resume from IncEval.
+  // @return: false if there is no usable checkpoint, in which case nothing
+  // has been changed.
+  bool Restore(
+      std::atomic<size_t>* global_superstep,
+      std::unordered_map<GID_T, std::atomic<size_t>*>* superstep_by_gid,
+      MSG_MNGR_T* msg_mngr, std::unordered_map<GID_T, Path>* pt_by_gid) {
+    std::ifstream last_file(root_ + "last");
+    std::string step;
+    if (!(last_file >> step)) {
+      XLOG(ERR, "No checkpoint under ", root_);
+      return false;
+    }
+    Snapshot snapshot;
+    size_t num_graphs = pt_by_gid->size();
+    auto active_map = msg_mngr->GetGlobalActiveVidMap();
+    if (!Read(root_ + step + "/", num_graphs,
+              msg_mngr->get_aligned_max_vid(),
+              WORD_OFFSET(active_map->size_) + 1, &snapshot)) {
+      XLOG(ERR, "Read checkpoint fault: ", root_ + step);
+      return false;
+    }
+    // Refuse checkpoints of other partitions before touching any fragment.
+    std::vector<size_t> num_vertexes(num_graphs, 0);
+    for (GID_T gid = 0; gid < num_graphs && IsSameType<GRAPH_T, CSR_T>();
+         gid++) {
+      num_vertexes[gid] = ReadNumVertexes(pt_by_gid->find(gid)->second);
+      if (num_vertexes[gid] != snapshot.vdata_by_gid[gid].size()) {
+        XLOG(ERR, "Checkpoint doesn't match fragment ", gid, ": ",
+             snapshot.vdata_by_gid[gid].size(), " vs ", num_vertexes[gid],
+             " vertexes");
+        return false;
+      }
+    }
+
+    for (GID_T gid = 0; gid < num_graphs && IsSameType<GRAPH_T, CSR_T>();
+         gid++) {
+      std::fstream vdata_file(pt_by_gid->find(gid)->second.vdata_pt,
+                              std::ios::binary | std::ios::in | std::ios::out);
+      vdata_file.write((char*)snapshot.vdata_by_gid[gid].data(),
+                       sizeof(VDATA_T) * num_vertexes[gid]);
+    }
+    global_superstep->store(snapshot.global_superstep);
+    for (GID_T gid = 0; gid < num_graphs; gid++) {
+      superstep_by_gid->find(gid)->second->store(
+          snapshot.superstep_by_gid[gid]);
+      msg_mngr->SetStateMatrix(gid, snapshot.state_matrix[gid]);
+    }
+    memcpy(msg_mngr->GetGlobalVdata(), snapshot.global_vdata.data(),
+           sizeof(VDATA_T) * snapshot.global_vdata.size());
+    memcpy(active_map->data_, snapshot.active_map.data(),
+           sizeof(unsigned long) * snapshot.active_map.size());
+    memcpy(msg_mngr->GetStatisticInfo(), snapshot.si.data(),
+           sizeof(StatisticInfo) * num_graphs);
+    LOG_INFO("Resume from checkpoint: superstep ", snapshot.global_superstep);
+    return true;
+  }
+
+ private:
+  struct Snapshot {
+    size_t global_superstep = 0;
+    std::vector<size_t> superstep_by_gid;
+    std::vector<char> state_matrix;
+    std::vector<VDATA_T> global_vdata;
+    std::vector<unsigned long> active_map;
+    std::vector<StatisticInfo> si;
+    std::vector<std::vector<VDATA_T>> vdata_by_gid;
+  };
+
+  std::string root_;
+  size_t checkpoint_interval_ = 0;
+  std::thread writer_;
+
+  // @brief: number of vertexes of a csr_bin fragment, the first field of
+  // its meta file.
+  static size_t ReadNumVertexes(const Path& path) {
+    size_t num_vertexes = 0;
+    std::ifstream meta_file(path.meta_pt, std::ios::binary);
+    meta_file.read((char*)&num_vertexes, sizeof(size_t));
+    return meta_file ? num_vertexes : 0;
+  }
+
+  static bool ReadVdata(const Path& path, std::vector<VDATA_T>* vdata) {
+    vdata->resize(ReadNumVertexes(path));
+    std::ifstream vdata_file(path.vdata_pt, std::ios::binary);
+    vdata_file.read((char*)vdata->data(), sizeof(VDATA_T) * vdata->size());
+    return (bool)vdata_file;
+  }
+
+  template <typename T>
+  static void WriteVector(std::ofstream& out, const std::vector<T>& vec) {
+    size_t size = vec.size();
+    out.write((char*)&size, sizeof(size_t));
+    out.write((char*)vec.data(), sizeof(T) * size);
+  }
+
+  template <typename T>
+  static bool ReadVector(std::ifstream& in, std::vector<T>* vec) {
+    size_t size = 0;
+    if (!in.read((char*)&size, sizeof(size_t))) return false;
+    vec->resize(size);
+    return (bool)in.read((char*)vec->data(), sizeof(T) * size);
+  }
+
+  // @brief: write snapshot into a temporary directory, rename it to its
+  // superstep and point last to it, then drop older checkpoints.
+  bool Write(const Snapshot& snapshot) {
+    std::string step = std::to_string(snapshot.global_superstep);
+    std::string tmp_pt = root_ + step + ".tmp/";
+    std::error_code ec;
+    std::filesystem::remove_all(tmp_pt, ec);
+    if (!std::filesystem::create_directories(tmp_pt, ec)) return false;
+
+    {
+      std::ofstream out(tmp_pt + "state.bin", std::ios::binary);
+      out.write((char*)&snapshot.global_superstep, sizeof(size_t));
+      WriteVector(out, snapshot.superstep_by_gid);
+      WriteVector(out, snapshot.state_matrix);
+      WriteVector(out, snapshot.global_vdata);
+      WriteVector(out, snapshot.active_map);
+      WriteVector(out, snapshot.si);
+      if (!out) return false;
+    }
+    for (size_t gid = 0; gid < snapshot.vdata_by_gid.size(); gid++) {
+      std::ofstream out(tmp_pt + std::to_string(gid) + ".v", std::ios::binary);
+      WriteVector(out, snapshot.vdata_by_gid[gid]);
+      if (!out) return false;
+    }
+
+    std::filesystem::remove_all(root_ + step, ec);
+    std::filesystem::rename(tmp_pt, root_ + step, ec);
+    if (ec) return false;
+    {
+      std::ofstream out(root_ + "last.tmp");
+      out << step << std::endl;
+      if (!out) return false;
+    }
+    if (rename((root_ + "last.tmp").c_str(), (root_ + "last").c_str()) != 0)
+      return false;
+
+    for (const auto& entry : std::filesystem::directory_iterator(root_, ec)) {
+      if (entry.is_directory() && entry.path().filename() != step)
+        std::filesystem::remove_all(entry.path(), ec);
+    }
+    return true;
+  }
+
+  static bool Read(const std::string& pt, const size_t num_graphs,
+                   const size_t aligned_max_vid, const size_t num_words,
+                   Snapshot* snapshot) {
+    std::ifstream in(pt + "state.bin", std::ios::binary);
+    if (!in.read((char*)&snapshot->global_superstep, sizeof(size_t)) ||
+        !ReadVector(in, &snapshot->superstep_by_gid) ||
+        !ReadVector(in, &snapshot->state_matrix) ||
+        !ReadVector(in, &snapshot->global_vdata) ||
+        !ReadVector(in, &snapshot->active_map) ||
+        !ReadVector(in, &snapshot->si))
+      return false;
+    if (snapshot->superstep_by_gid.size() != num_graphs ||
+        snapshot->state_matrix.size() != num_graphs ||
+        snapshot->si.size() != num_graphs ||
+        snapshot->global_vdata.size() != aligned_max_vid ||
+        snapshot->active_map.size() != num_words) {
+      XLOG(ERR, "Checkpoint doesn't match the workspace: ", pt);
+      return false;
+    }
+    snapshot->vdata_by_gid.resize(num_graphs);
+    for (size_t gid = 0; gid < num_graphs && IsSameType<GRAPH_T, CSR_T>();
+         gid++) {
+      std::ifstream vdata_in(pt + std::to_string(gid) + ".v",
+                             std::ios::binary);
+      if (!ReadVector(vdata_in, &snapshot->vdata_by_gid[gid])) return false;
+    }
+    return true;
+  }
+};
+
+}  // namespace io
+}  // namespace utility
+}  // namespace minigraph
+
+#endif  // MINIGRAPH_UTILITY_IO_CHECKPOINT_MNGR_H
@@ -11,6 +11,7 @@
 #include <folly/AtomicHashMap.h>
 #include <folly/FileUtil.h>
 
+#include "graphs/csr_builder.h"
 #include "graphs/immutable_csr.h"
 #include "io_adapter_base.h"
 #include "portability/sys_data_structure.h"
@@ -18,6 +19,8 @@
 #include "rapidcsv.h"
 #include "utility/bitmap.h"
 #include "utility/logging.h"
+#include "utility/memory.h"
+#include "utility/stream_vbyte.h"
 
 namespace minigraph {
 namespace utility {
@@ -84,148 +87,116 @@ class CSRIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     return tag;
   }
 
+  // @brief: build a CSR of all vertexes of edgelist_graph, see
+  // graphs::CSRBuilder.
   CSR_T* EdgeList2CSR(const GID_T gid = 0,
                       EDGE_LIST_T* edgelist_graph = nullptr,
                       const size_t cores = 1, VID_T* vid_map = nullptr) {
     assert(edgelist_graph != nullptr);
     LOG_INFO("EdgeList2CSR()");
-    auto thread_pool = CPUThreadPool(cores, 1);
-    std::mutex mtx;
-    std::condition_variable finish_cv;
-    std::unique_lock<std::mutex> lck(mtx);
-
-    VID_T aligned_max_vid =
-        ceil(edgelist_graph->get_aligned_max_vid() / ALIGNMENT_FACTOR) *
-        ALIGNMENT_FACTOR;
-
-    std::atomic<size_t> pending_packages(cores);
-    LOG_INFO("Aligned max vid: ", aligned_max_vid, "  ",
-             edgelist_graph->get_max_vid());
-
-    size_t* num_in_edges = (size_t*)malloc(sizeof(size_t) * aligned_max_vid);
-    size_t* num_out_edges = (size_t*)malloc(sizeof(size_t) * aligned_max_vid);
-    memset(num_in_edges, 0, sizeof(size_t) * aligned_max_vid);
-    memset(num_out_edges, 0, sizeof(size_t) * aligned_max_vid);
-
-    Bitmap* vertex_indicator = new Bitmap(aligned_max_vid);
-    vertex_indicator->clear();
-
-    size_t num_vertexes = edgelist_graph->get_num_vertexes();
-    size_t num_edges = edgelist_graph->get_num_edges();
-
-    LOG_INFO(
-        "Run: Go through every edges to count the size of each vertex. "
-        "NumEdges: ",
-        num_edges);
-    pending_packages.store(cores);
-    for (size_t tid = 0; tid < cores; tid++) {
-      thread_pool.Commit([tid, &cores, &num_in_edges, &num_out_edges,
-                          &num_edges, &edgelist_graph, &vertex_indicator,
-                          &pending_packages, &finish_cv, &num_vertexes]() {
-        for (size_t j = tid; j < num_edges; j += cores) {
-          auto src_vid = edgelist_graph->buf_graph_[j * 2];
-          auto dst_vid = edgelist_graph->buf_graph_[j * 2 + 1];
-          if (!vertex_indicator->get_bit(src_vid)) {
-            vertex_indicator->set_bit(src_vid);
-          }
-          if (!vertex_indicator->get_bit(dst_vid)) {
-            vertex_indicator->set_bit(dst_vid);
-          }
-          __sync_add_and_fetch(num_out_edges + src_vid, 1);
-          __sync_add_and_fetch(num_in_edges + dst_vid, 1);
-        }
-        if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
-        return;
-      });
+    graphs::CSRBuilder<GID_T, VID_T, VDATA_T, EDATA_T> csr_builder(cores);
+    return csr_builder.Build(gid, edgelist_graph, vid_map);
+  }
+
+  // @brief: read a fragment of csr_bin for out-of-core edge streaming. Only
+  // vertex arrays and vdata are loaded, in_edges and out_edges stay on disk
+  // and are scanned by EdgeBlockReader in blocks of edge_block_size edges.
+  bool ReadCSRVertexesFromCSRBin(GRAPH_BASE_T* graph_base, const GID_T& gid,
+                                 const std::string& meta_pt,
+                                 const std::string& data_pt,
+                                 const std::string& vdata_pt,
+                                 const size_t edge_block_size) {
+    LOG_INFO("Read CSR vertexes from CSR bin, edge_block_size: ",
+             edge_block_size);
+    if (!this->Exist(meta_pt)) {
+      XLOG(ERR, "Read file fault: meta_pt, ", meta_pt, ", not exist");
+      return false;
     }
-    finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
-
-    graphs::VertexInfo<VID_T, VDATA_T, EDATA_T>** vertexes = nullptr;
-    vertexes = (graphs::VertexInfo<VID_T, VDATA_T, EDATA_T>**)malloc(
-        sizeof(graphs::VertexInfo<VID_T, VDATA_T, EDATA_T>*) * aligned_max_vid);
-
-    for (size_t i = 0; i < aligned_max_vid; i++) vertexes[i] = nullptr;
-
-    VID_T local_id = 0;
-
-    LOG_INFO("Run: Merge edges");
-    pending_packages.store(cores);
-    for (size_t tid = 0; tid < cores; tid++) {
-      thread_pool.Commit([this, tid, &local_id, &cores, &num_in_edges, &vid_map,
-                          &num_out_edges, &aligned_max_vid, &vertex_indicator,
-                          &vertexes, &pending_packages, &finish_cv]() {
-        for (VID_T global_id = tid; global_id < aligned_max_vid;
-             global_id += cores) {
-          if (!vertex_indicator->get_bit(global_id)) continue;
-          auto u = new graphs::VertexInfo<VID_T, VDATA_T, EDATA_T>();
-          u->vid = __sync_fetch_and_add(&local_id, 1);
-          if (vid_map != nullptr) vid_map[global_id] = u->vid;
-          u->indegree = num_in_edges[global_id];
-          u->outdegree = num_out_edges[global_id];
-          u->in_edges = (VID_T*)malloc(sizeof(VID_T) * (u->indegree));
-          memset(u->in_edges, 0, sizeof(VID_T) * (u->indegree));
-          u->out_edges = (VID_T*)malloc(sizeof(VID_T) * (u->outdegree));
-          memset(u->out_edges, 0, sizeof(VID_T) * (u->outdegree));
-          vertexes[global_id] = u;
-          LOG_INFO(u->vid, " ", global_id);
-        }
-        if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
-        return;
-      });
+    if (!this->Exist(data_pt)) {
+      XLOG(ERR, "Read file fault: data_pt, ", data_pt, ", not exist");
+      return false;
     }
-    finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
-
-    LOG_INFO("Run: Edges fill");
-    size_t sum_in_edges = 0, sum_out_edges = 0;
-    size_t* offset_in_edges = (size_t*)malloc(sizeof(size_t) * aligned_max_vid);
-    size_t* offset_out_edges =
-        (size_t*)malloc(sizeof(size_t) * aligned_max_vid);
-    memset(offset_in_edges, 0, sizeof(size_t) * aligned_max_vid);
-    memset(offset_out_edges, 0, sizeof(size_t) * aligned_max_vid);
-    pending_packages.store(cores);
-    for (size_t i = 0; i < cores; i++) {
-      size_t tid = i;
-      thread_pool.Commit([tid, &cores, &num_in_edges, &num_out_edges,
-                          &num_edges, &offset_in_edges, &offset_out_edges,
-                          sum_in_edges, sum_out_edges, &edgelist_graph,
-                          &vertex_indicator, &vertexes, &pending_packages,
-                          &finish_cv]() {
-        for (VID_T global_eid = tid; global_eid < num_edges;
-             global_eid += cores) {
-          auto src_vid = edgelist_graph->buf_graph_[global_eid * 2];
-          auto dst_vid = edgelist_graph->buf_graph_[global_eid * 2 + 1];
-          assert(vertexes[src_vid] != nullptr);
-          assert(vertexes[dst_vid] != nullptr);
-          vertexes[src_vid]
-              ->out_edges[__sync_fetch_and_add(offset_out_edges + src_vid, 1)] =
-              dst_vid;
-          vertexes[dst_vid]
-              ->in_edges[__sync_fetch_and_add(offset_in_edges + dst_vid, 1)] =
-              src_vid;
-        }
-        if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
-        return;
-      });
+    if (graph_base == nullptr || edge_block_size == 0) {
+      XLOG(ERR, "Input fault: graph is nullptr or edge_block_size is 0");
+      return false;
+    }
+    auto graph = (CSR_T*)graph_base;
+    {
+      std::ifstream meta_file(meta_pt, std::ios::binary);
+      size_t buf_meta[3] = {0};
+      meta_file.read((char*)buf_meta, sizeof(size_t) * 3);
+      graph->num_vertexes_ = buf_meta[0];
+      graph->sum_in_edges_ = buf_meta[1];
+      graph->sum_out_edges_ = buf_meta[2];
+      graph->num_edges_ = buf_meta[1] + buf_meta[2];
+      assert(graph->get_num_vertexes() > 0);
+      meta_file.read((char*)&graph->max_vid_, sizeof(VID_T));
+      // csr_flags_ is absent in meta files written by older versions.
+      if (!meta_file.read((char*)&graph->csr_flags_, sizeof(size_t)))
+        graph->csr_flags_ = 0;
+      graph->aligned_max_vid_ =
+          ceil(graph->get_max_vid() / ALIGNMENT_FACTOR) * ALIGNMENT_FACTOR;
+      assert(graph->get_aligned_max_vid() > 0);
+      meta_file.close();
+    }
+    if (graph->csr_flags_ & CSR_COMPRESSED) {
+      // Compressed neighbor lists can't be sliced by offset on disk.
+      LOG_INFO("GID: ", gid, " is compressed, read it whole.");
+      return ReadCSRFromCSRBin(graph_base, gid, meta_pt, data_pt, vdata_pt);
+    }
+    graph->bitmap_ = new Bitmap(graph->get_aligned_max_vid());
+    graph->bitmap_->clear();
+
+    {
+      // read vertex arrays, skip in_edges and out_edges.
+      size_t n = graph->get_num_vertexes();
+      size_t size_globalid = sizeof(VID_T) * n;
+      size_t size_vertex_arrays = size_globalid + sizeof(size_t) * n * 4;
+      size_t size_in_edges = sizeof(VID_T) * graph->sum_in_edges_;
+      size_t size_out_edges = sizeof(VID_T) * graph->sum_out_edges_;
+      size_t size_localid_by_globalid =
+          sizeof(VID_T) * graph->get_aligned_max_vid();
+
+      std::ifstream data_file(data_pt, std::ios::binary);
+      graph->buf_graph_ = (VID_T*)utility::HugePageAlloc(
+          size_vertex_arrays + size_localid_by_globalid);
+      data_file.read((char*)graph->buf_graph_, size_vertex_arrays);
+      data_file.seekg(size_vertex_arrays + size_in_edges + size_out_edges);
+      data_file.read((char*)graph->buf_graph_ + size_vertex_arrays,
+                     size_localid_by_globalid);
+      data_file.close();
+
+      graph->globalid_by_index_ = graph->buf_graph_;
+      graph->indegree_ = (size_t*)((char*)graph->buf_graph_ + size_globalid);
+      graph->outdegree_ = graph->indegree_ + n;
+      graph->in_offset_ = graph->outdegree_ + n;
+      graph->out_offset_ = graph->in_offset_ + n;
+      graph->localid_by_globalid_ =
+          (VID_T*)((char*)graph->buf_graph_ + size_vertex_arrays);
+      graph->in_edges_ = nullptr;
+      graph->out_edges_ = nullptr;
+      graph->in_edges_pos_ = size_vertex_arrays;
+      graph->out_edges_pos_ = size_vertex_arrays + size_in_edges;
+      graph->edge_block_size_ = edge_block_size;
+      graph->data_pt_ = data_pt;
+      for (size_t i = 0; i < n; i++)
+        graph->bitmap_->set_bit(graph->globalid_by_index_[i]);
     }
-    finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
-
-    LOG_INFO("Run: Compute sum_in_edges & sum_out_edges");
-    for (VID_T global_id = 0; global_id < aligned_max_vid; global_id++) {
-      if (!vertex_indicator->get_bit(global_id)) continue;
-      auto u = vertexes[global_id];
-      __sync_fetch_and_add(&sum_in_edges, u->indegree);
-      __sync_fetch_and_add(&sum_out_edges, u->outdegree);
+
+    {
+      // read vdata only, edata is left on disk.
+      std::ifstream vdata_file(vdata_pt, std::ios::binary);
+      graph->vdata_ = (VDATA_T*)utility::HugePageAlloc(
+          sizeof(VDATA_T) * graph->get_num_vertexes());
+      memset(graph->vdata_, 0, sizeof(VDATA_T) * graph->get_num_vertexes());
+      vdata_file.read((char*)graph->vdata_,
+                      sizeof(VDATA_T) * graph->get_num_vertexes());
+      vdata_file.close();
     }
 
-    LOG_INFO("Run: Construct graph");
-    auto csr_graph = new graphs::ImmutableCSR<GID_T, VID_T, VDATA_T, EDATA_T>(
-        gid, vertexes, edgelist_graph->num_vertexes_, sum_in_edges,
-        sum_out_edges, edgelist_graph->max_vid_);
-    delete offset_out_edges;
-    delete offset_in_edges;
-    delete num_in_edges;
-    delete num_out_edges;
-    return csr_graph;
+    graph->is_serialized_ = true;
+    graph->gid_ = gid;
+    return true;
   }
 
  private:
@@ -346,6 +317,9 @@ class CSRIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
       assert(graph->get_num_vertexes() > 0);
       // read bitmap
       meta_file.read((char*)&graph->max_vid_, sizeof(VID_T));
+      // csr_flags_ is absent in meta files written by older versions.
+      if (!meta_file.read((char*)&graph->csr_flags_, sizeof(size_t)))
+        graph->csr_flags_ = 0;
       graph->aligned_max_vid_ =
           ceil(graph->get_max_vid() / ALIGNMENT_FACTOR) * ALIGNMENT_FACTOR;
       assert(graph->get_aligned_max_vid() > 0);
@@ -379,8 +353,15 @@ class CSRIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
       size_t start_localid_by_globalid = start_out_edges + size_out_edges;
 
       std::ifstream data_file(data_pt, std::ios::binary | std::ios::app);
-      graph->buf_graph_ = (VID_T*)malloc(total_size);
-      data_file.read((char*)graph->buf_graph_, total_size);
+      graph->buf_graph_ = (VID_T*)utility::HugePageAlloc(total_size);
+      if (graph->csr_flags_ & CSR_COMPRESSED) {
+        if (!ReadCompressedData(graph, data_file, (char*)graph->buf_graph_)) {
+          XLOG(ERR, "Read compressed data fault: ", data_pt);
+          return false;
+        }
+      } else {
+        data_file.read((char*)graph->buf_graph_, total_size);
+      }
       graph->globalid_by_index_ =
           (VID_T*)((char*)graph->buf_graph_ + start_globalid);
       graph->out_offset_ =
@@ -400,21 +381,18 @@ class CSRIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     {
       // read vdata and edata
       std::ifstream vdata_file(vdata_pt, std::ios::binary | std::ios::app);
-      graph->vdata_ =
-          (VDATA_T*)malloc(sizeof(VDATA_T) * graph->get_num_vertexes());
+      graph->vdata_ = (VDATA_T*)utility::HugePageAlloc(
+          sizeof(VDATA_T) * graph->get_num_vertexes());
       memset(graph->vdata_, 0, sizeof(VDATA_T) * graph->get_num_vertexes());
       vdata_file.read((char*)graph->vdata_,
                       sizeof(VDATA_T) * graph->get_num_vertexes());
-      graph->edata_ = (EDATA_T*)malloc(
-          sizeof(EDATA_T) * ceil(graph->get_num_in_edges() / ALIGNMENT_FACTOR) *
-          ALIGNMENT_FACTOR);
-      memset(graph->edata_, 0,
-             sizeof(EDATA_T) *
-                 ceil(graph->get_num_in_edges() / ALIGNMENT_FACTOR) *
-                 ALIGNMENT_FACTOR);
-
-      vdata_file.read((char*)graph->edata_,
-                      sizeof(EDATA_T) * graph->get_num_in_edges());
+      // weights of in_edges followed by weights of out_edges. Files written
+      // by older versions hold fewer zeros, the rest is left zero.
+      size_t num_edata = graph->get_num_in_edges() + graph->get_num_out_edges();
+      graph->edata_ =
+          (EDATA_T*)utility::HugePageAlloc(sizeof(EDATA_T) * num_edata);
+      memset(graph->edata_, 0, sizeof(EDATA_T) * num_edata);
+      vdata_file.read((char*)graph->edata_, sizeof(EDATA_T) * num_edata);
       vdata_file.close();
     }
 
@@ -435,7 +413,26 @@ class CSRIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
       XLOG(ERR, "Segmentation fault: buf_graph is nullptr");
       return false;
     }
+    if (graph.IsEdgeStreaming() && !vdata_only) {
+      XLOG(ERR, "Edges of a streaming graph are not resident.");
+      return false;
+    }
+    if (vdata_only && (graph.IsEdgeStreaming() || this->Exist(vdata_pt))) {
+      // overwrite vdata in place so that edata on disk is kept, edges in
+      // memory may be streamed or carry updates of a DeltaStore.
+      std::fstream vdata_file(vdata_pt,
+                              std::ios::binary | std::ios::in | std::ios::out);
+      vdata_file.write((char*)graph.vdata_,
+                       sizeof(VDATA_T) * graph.get_num_vertexes());
+      vdata_file.close();
+      return true;
+    }
     if (!vdata_only) {
+      if ((graph.csr_flags_ & CSR_COMPRESSED) &&
+          sizeof(VID_T) != sizeof(uint32_t)) {
+        LOG_INFO("Compression takes 32-bit vids, write uncompressed.");
+        graph.csr_flags_ &= ~(size_t)CSR_COMPRESSED;
+      }
       // write meta
       if (this->Exist(meta_pt)) remove(meta_pt.c_str());
       if (this->Exist(data_pt)) remove(data_pt.c_str());
@@ -447,12 +444,12 @@ class CSRIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
       buf_meta[2] = graph.sum_out_edges_;
       meta_file.write((char*)buf_meta, sizeof(size_t) * 3);
       meta_file.write((char*)&graph.max_vid_, sizeof(VID_T));
+      meta_file.write((char*)&graph.csr_flags_, sizeof(size_t));
       free(buf_meta);
       meta_file.close();
 
       // write data
       std::ofstream data_file(data_pt, std::ios::binary | std::ios::app);
-      size_t size_localid = sizeof(VID_T) * graph.get_num_vertexes();
       size_t size_globalid = sizeof(VID_T) * graph.get_num_vertexes();
       size_t size_localid_by_globalid =
           sizeof(VID_T) * graph.get_aligned_max_vid();
@@ -463,11 +460,13 @@ class CSRIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
       size_t size_in_edges = sizeof(VID_T) * graph.sum_in_edges_;
       size_t size_out_edges = sizeof(VID_T) * graph.sum_out_edges_;
 
-      size_t total_size = size_localid + size_globalid + size_in_offset +
-                          size_indegree + size_outdegree + size_out_offset +
-                          size_in_edges + size_out_edges +
-                          size_localid_by_globalid;
-      data_file.write((char*)graph.buf_graph_, total_size);
+      size_t total_size = size_globalid + size_in_offset + size_indegree +
+                          size_outdegree + size_out_offset + size_in_edges +
+                          size_out_edges + size_localid_by_globalid;
+      if (graph.csr_flags_ & CSR_COMPRESSED)
+        WriteCompressedData(graph, data_file);
+      else
+        data_file.write((char*)graph.buf_graph_, total_size);
       data_file.close();
     }
 
@@ -481,12 +480,110 @@ class CSRIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
       //                  sizeof(char) * graph.num_vertexes_);
 
       // write edata
-      vdata_file.write((char*)graph.edata_,
-                       sizeof(EDATA_T) * graph.get_num_out_edges());
+      if (graph.edata_ != nullptr)
+        vdata_file.write(
+            (char*)graph.edata_,
+            sizeof(EDATA_T) * (graph.get_num_in_edges() +
+                               graph.get_num_out_edges()));
       vdata_file.close();
     }
     return true;
   }
+
+  // @brief: write the data file of a CSR_COMPRESSED fragment, i.e. global
+  // ids, indegree and outdegree of vertexes, in_edges, out_edges and
+  // localid_by_globalid. Offsets are left out as they are prefix sums of
+  // degrees. Each neighbor list is delta-encoded, see utility::DeltaEncode,
+  // and the deltas of a direction are packed by utility::StreamVByteEncode
+  // into <size_t data bytes, control bytes, data bytes>.
+  void WriteCompressedData(const CSR_T& graph, std::ofstream& data_file) {
+    size_t n = graph.get_num_vertexes();
+    data_file.write((char*)graph.globalid_by_index_, sizeof(VID_T) * n);
+    data_file.write((char*)graph.indegree_, sizeof(size_t) * n);
+    data_file.write((char*)graph.outdegree_, sizeof(size_t) * n);
+    size_t raw_size =
+        sizeof(VID_T) * (graph.sum_in_edges_ + graph.sum_out_edges_);
+    size_t compressed_size =
+        WriteCompressedEdges(graph, data_file, graph.in_edges_,
+                             graph.in_offset_, graph.indegree_,
+                             graph.sum_in_edges_) +
+        WriteCompressedEdges(graph, data_file, graph.out_edges_,
+                             graph.out_offset_, graph.outdegree_,
+                             graph.sum_out_edges_);
+    data_file.write((char*)graph.localid_by_globalid_,
+                    sizeof(VID_T) * graph.get_aligned_max_vid());
+    LOG_INFO("GID: ", graph.gid_, " compressed edges from ", raw_size,
+             " to ", compressed_size, " bytes");
+  }
+
+  size_t WriteCompressedEdges(const CSR_T& graph, std::ofstream& data_file,
+                              const VID_T* edges, const size_t* offset,
+                              const size_t* degree, const size_t num_edges) {
+    std::vector<uint32_t> deltas(num_edges);
+    size_t pos = 0;
+    for (size_t i = 0; i < graph.get_num_vertexes(); i++) {
+      DeltaEncode((const uint32_t*)edges + offset[i], degree[i],
+                  graph.IsSorted(), deltas.data() + pos);
+      pos += degree[i];
+    }
+    size_t ctrl_bytes = StreamVByteControlBytes(num_edges);
+    std::vector<uint8_t> buf(ctrl_bytes + StreamVByteMaxDataBytes(num_edges));
+    size_t data_bytes = StreamVByteEncode(deltas.data(), num_edges, buf.data(),
+                                          buf.data() + ctrl_bytes);
+    data_file.write((char*)&data_bytes, sizeof(size_t));
+    data_file.write((char*)buf.data(), ctrl_bytes + data_bytes);
+    return sizeof(size_t) + ctrl_bytes + data_bytes;
+  }
+
+  // @brief: read the data file written by WriteCompressedData() into buf in
+  // the layout of an uncompressed fragment.
+  bool ReadCompressedData(CSR_T* graph, std::ifstream& data_file, char* buf) {
+    if (sizeof(VID_T) != sizeof(uint32_t)) {
+      XLOG(ERR, "Compressed fragments take 32-bit vids.");
+      return false;
+    }
+    size_t n = graph->get_num_vertexes();
+    auto globalid = (VID_T*)buf;
+    auto indegree = (size_t*)(buf + sizeof(VID_T) * n);
+    auto outdegree = indegree + n;
+    auto in_offset = outdegree + n;
+    auto out_offset = in_offset + n;
+    auto in_edges = (VID_T*)(out_offset + n);
+    auto out_edges = in_edges + graph->sum_in_edges_;
+    auto localid_by_globalid = out_edges + graph->sum_out_edges_;
+    data_file.read((char*)globalid, sizeof(VID_T) * n);
+    data_file.read((char*)indegree, sizeof(size_t) * n);
+    data_file.read((char*)outdegree, sizeof(size_t) * n);
+    for (size_t i = 0; i < n; i++) {
+      in_offset[i] = i == 0 ? 0 : in_offset[i - 1] + indegree[i - 1];
+      out_offset[i] = i == 0 ? 0 : out_offset[i - 1] + outdegree[i - 1];
+    }
+    bool sorted = graph->csr_flags_ & CSR_SORTED;
+    if (!ReadCompressedEdges(data_file, in_edges, in_offset, indegree, n,
+                             graph->sum_in_edges_, sorted) ||
+        !ReadCompressedEdges(data_file, out_edges, out_offset, outdegree, n,
+                             graph->sum_out_edges_, sorted))
+      return false;
+    data_file.read((char*)localid_by_globalid,
+                   sizeof(VID_T) * graph->get_aligned_max_vid());
+    return !data_file.fail();
+  }
+
+  bool ReadCompressedEdges(std::ifstream& data_file, VID_T* edges,
+                           const size_t* offset, const size_t* degree,
+                           const size_t n, const size_t num_edges,
+                           const bool sorted) {
+    size_t data_bytes = 0;
+    if (!data_file.read((char*)&data_bytes, sizeof(size_t))) return false;
+    size_t ctrl_bytes = StreamVByteControlBytes(num_edges);
+    std::vector<uint8_t> buf(ctrl_bytes + data_bytes);
+    if (!data_file.read((char*)buf.data(), buf.size())) return false;
+    StreamVByteDecode(buf.data(), buf.data() + ctrl_bytes,
+                      buf.data() + buf.size(), num_edges, (uint32_t*)edges);
+    for (size_t i = 0; i < n; i++)
+      DeltaDecode((uint32_t*)edges + offset[i], degree[i], sorted);
+    return true;
+  }
 };
 
 }  // namespace io
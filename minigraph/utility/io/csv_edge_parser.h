@@ -0,0 +1,265 @@
+#ifndef MINIGRAPH_UTILITY_IO_CSV_EDGE_PARSER_H
+#define MINIGRAPH_UTILITY_IO_CSV_EDGE_PARSER_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "utility/logging.h"
+#include "utility/thread_pool.h"
+
+namespace minigraph {
+namespace utility {
+namespace io {
+
+// @brief: CSVEdgeParser reads edge lists in CSV, i.e. <src, dst> or
+// <src, dst, weight> per line, straight into an interleaved edge buffer as
+// used by buf_graph_ of EdgeList. The file is mapped into memory and split
+// at line boundaries into chunks that are parsed in parallel, taking eight
+// digits at a time within a 64-bit word. Blank lines, lines starting with
+// '#' or '%' and lines without enough numeric fields are skipped, while an
+// id that does not fit in VID_T fails the parse.
+template <typename VID_T, typename EDATA_T>
+class CSVEdgeParser {
+ public:
+  CSVEdgeParser(const char separator = ',', const size_t cores = 1)
+      : separator_(separator), cores_(cores == 0 ? 1 : cores) {}
+  ~CSVEdgeParser() = default;
+
+  // @brief: parse the edges of pt.
+  // @param edges: set to a malloc'ed buffer of 2 * num_edges vids.
+  // @param edata: set to a malloc'ed buffer of num_edges weights if not
+  // nullptr, the third field of each line.
+  // @param skip_self_loops: drop edges whose src equals dst.
+  bool Parse(const std::string& pt, VID_T** edges, size_t* num_edges,
+             VID_T* max_vid, EDATA_T** edata = nullptr,
+             const bool skip_self_loops = false) {
+    int fd = open(pt.c_str(), O_RDONLY);
+    if (fd < 0) {
+      XLOG(ERR, "Open file fault: ", pt);
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      XLOG(ERR, "Stat file fault: ", pt);
+      return false;
+    }
+    size_t size = st.st_size;
+    const char* data = nullptr;
+    if (size > 0) {
+      data = (const char*)mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        close(fd);
+        XLOG(ERR, "Mmap file fault: ", pt);
+        return false;
+      }
+      // Advice values are not flags, each needs a call of its own.
+      madvise((void*)data, size, MADV_SEQUENTIAL);
+      madvise((void*)data, size, MADV_WILLNEED);
+    }
+    close(fd);
+    LOG_INFO("Parse ", pt, ", size: ", size, " bytes");
+
+    // Split at line boundaries, several chunks per core to even the load.
+    size_t num_chunks = size == 0 ? 0 : std::min(size, cores_ * 4);
+    std::vector<size_t> bounds(num_chunks + 1, size);
+    for (size_t i = 0; i < num_chunks; i++) {
+      size_t pos = size / num_chunks * i;
+      if (i > 0) {
+        const char* nl = (const char*)memchr(data + pos - 1, '\n',
+                                             size - pos + 1);
+        pos = nl == nullptr ? size : nl - data + 1;
+      }
+      bounds[i] = std::max(pos, i > 0 ? bounds[i - 1] : 0);
+    }
+
+    // Lines of each chunk bound the edges it may hold.
+    CPUThreadPool thread_pool(cores_, 1);
+    std::vector<size_t> offset(num_chunks + 1, 0);
+    thread_pool.ParallelRun(num_chunks, [&](const size_t i) {
+      size_t lines = 0;
+      const char* p = data + bounds[i];
+      const char* end = data + bounds[i + 1];
+      while (p < end) {
+        const char* nl = (const char*)memchr(p, '\n', end - p);
+        ++lines;
+        p = nl == nullptr ? end : nl + 1;
+      }
+      offset[i + 1] = lines;
+    });
+    for (size_t i = 0; i < num_chunks; i++) offset[i + 1] += offset[i];
+
+    VID_T* buf = (VID_T*)malloc(sizeof(VID_T) * 2 * (offset.back() + 1));
+    EDATA_T* ebuf = nullptr;
+    if (edata != nullptr)
+      ebuf = (EDATA_T*)malloc(sizeof(EDATA_T) * (offset.back() + 1));
+
+    std::vector<size_t> count(num_chunks, 0);
+    std::vector<VID_T> chunk_max_vid(num_chunks, 0);
+    // Offset of the first line of each chunk whose id does not fit in VID_T.
+    std::vector<size_t> out_of_range(num_chunks, SIZE_MAX);
+    const char* file_end = data + size;
+    thread_pool.ParallelRun(num_chunks, [&](const size_t i) {
+      const char* p = data + bounds[i];
+      const char* end = data + bounds[i + 1];
+      VID_T* out = buf + 2 * offset[i];
+      EDATA_T* eout = ebuf == nullptr ? nullptr : ebuf + offset[i];
+      size_t n = 0;
+      VID_T local_max = 0;
+      while (p < end) {
+        const char* line = p;
+        uint64_t src = 0, dst = 0;
+        EDATA_T weight = EDATA_T();
+        bool ok = SkipBlank(&p, end) && *p != '#' && *p != '%' &&
+                  ParseUint(&p, end, file_end, &src) &&
+                  SkipSeparator(&p, end) &&
+                  ParseUint(&p, end, file_end, &dst) &&
+                  (eout == nullptr ||
+                   (SkipSeparator(&p, end) &&
+                    ParseWeight(&p, end, file_end, &weight)));
+        const char* nl = (const char*)memchr(p, '\n', end - p);
+        p = nl == nullptr ? end : nl + 1;
+        if (!ok || (skip_self_loops && src == dst)) continue;
+        if (!InRange(src) || !InRange(dst)) {
+          out_of_range[i] = std::min(out_of_range[i], (size_t)(line - data));
+          continue;
+        }
+        out[2 * n] = src;
+        out[2 * n + 1] = dst;
+        if (eout != nullptr) eout[n] = weight;
+        local_max = std::max(local_max, (VID_T)std::max(src, dst));
+        ++n;
+      }
+      count[i] = n;
+      chunk_max_vid[i] = local_max;
+    });
+
+    for (size_t i = 0; i < num_chunks; i++) {
+      if (out_of_range[i] == SIZE_MAX) continue;
+      XLOG(ERR, "Vertex id out of range at byte ", out_of_range[i], " of ",
+           pt, ", max: ", (size_t)std::numeric_limits<VID_T>::max());
+      munmap((void*)data, size);
+      free(buf);
+      free(ebuf);
+      return false;
+    }
+
+    // Close the gaps left by skipped lines.
+    size_t total = 0;
+    *max_vid = 0;
+    for (size_t i = 0; i < num_chunks; i++) {
+      if (total != offset[i]) {
+        memmove(buf + 2 * total, buf + 2 * offset[i],
+                sizeof(VID_T) * 2 * count[i]);
+        if (ebuf != nullptr)
+          memmove(ebuf + total, ebuf + offset[i], sizeof(EDATA_T) * count[i]);
+      }
+      total += count[i];
+      *max_vid = std::max(*max_vid, chunk_max_vid[i]);
+    }
+    if (size > 0) munmap((void*)data, size);
+
+    *edges = buf;
+    if (edata != nullptr) *edata = ebuf;
+    *num_edges = total;
+    LOG_INFO("Parse ", pt, " num edges: ", total, ", skipped lines: ",
+             offset.back() - total);
+    return true;
+  }
+
+ private:
+  char separator_;
+  size_t cores_;
+
+  static bool IsDigit(const char c) { return c >= '0' && c <= '9'; }
+
+  // @brief: skip spaces and tabs.
+  // @return: false at the end of the line.
+  static bool SkipBlank(const char** p, const char* end) {
+    while (*p < end && (**p == ' ' || **p == '\t' || **p == '\r')) ++*p;
+    return *p < end && **p != '\n';
+  }
+
+  // @brief: skip the separator and blanks around it.
+  bool SkipSeparator(const char** p, const char* end) const {
+    if (!SkipBlank(p, end)) return false;
+    if (**p == separator_) ++*p;
+    return SkipBlank(p, end);
+  }
+
+  // @brief: parse the run of decimal digits at *p. Words of eight bytes are
+  // loaded while they lie within the file, the leading digits of a word are
+  // found by a bitmask and converted by three multiplications.
+  static bool ParseUint(const char** p, const char* end, const char* file_end,
+                        uint64_t* val) {
+    const char* q = *p;
+    uint64_t v = 0;
+    bool overflow = false;
+    while (q + 8 <= file_end && q < end) {
+      uint64_t word;
+      memcpy(&word, q, 8);
+      uint64_t mismatch =
+          ((word & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull) |
+          (((word + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) ^
+           0x3030303030303030ull);
+      size_t digits = mismatch == 0 ? 8 : __builtin_ctzll(mismatch) / 8;
+      if (digits == 0) break;
+      word -= 0x3030303030303030ull;
+      if (digits < 8) word <<= 8 * (8 - digits);
+      word = (word * 10 + (word >> 8)) & 0x00FF00FF00FF00FFull;
+      word = (word * 100 + (word >> 16)) & 0x0000FFFF0000FFFFull;
+      word = (word * 10000 + (word >> 32)) & 0xFFFFFFFFull;
+      overflow |= __builtin_mul_overflow(v, kPow10[digits], &v) |
+                  __builtin_add_overflow(v, word, &v);
+      q += digits;
+      if (digits < 8) break;
+    }
+    for (; q < end && IsDigit(*q); q++)
+      overflow |= __builtin_mul_overflow(v, 10, &v) |
+                  __builtin_add_overflow(v, (uint64_t)(*q - '0'), &v);
+    if (q == *p) return false;
+    // Saturate instead of wrapping around, see InRange().
+    if (overflow) v = UINT64_MAX;
+    *p = q;
+    *val = v;
+    return true;
+  }
+
+  // @brief: whether an id parsed by ParseUint fits in VID_T.
+  static bool InRange(const uint64_t v) {
+    return v != UINT64_MAX && v <= std::numeric_limits<VID_T>::max();
+  }
+
+  static bool ParseWeight(const char** p, const char* end,
+                          const char* file_end, EDATA_T* weight) {
+    if constexpr (std::is_integral<EDATA_T>::value) {
+      uint64_t v = 0;
+      if (!ParseUint(p, end, file_end, &v)) return false;
+      *weight = v;
+      return true;
+    } else {
+      auto res = std::from_chars(*p, end, *weight);
+      if (res.ec != std::errc()) return false;
+      *p = res.ptr;
+      return true;
+    }
+  }
+
+  static constexpr uint64_t kPow10[9] = {
+      1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+};
+
+}  // namespace io
+}  // namespace utility
+}  // namespace minigraph
+
+#endif  // MINIGRAPH_UTILITY_IO_CSV_EDGE_PARSER_H
@@ -7,6 +7,7 @@
 #include "yaml-cpp/yaml.h"
 
 #include "utility/io/csr_io_adapter.h"
+#include "utility/io/delta_store.h"
 #include "utility/io/edge_list_io_adapter.h"
 #include "utility/io/relation_io_adapter.h"
 
@@ -52,7 +53,16 @@ class DataMngr {
                  const GraphFormat& graph_format, char separator_params = ',') {
     bool out = false;
     GRAPH_BASE_T* graph = nullptr;
-    if (graph_format == csr_bin) {
+    std::unique_lock<std::mutex> file_lck;
+    if (graph_format == csr_bin && delta_store_ != nullptr &&
+        delta_store_->GetFileMutex(gid) != nullptr)
+      file_lck = std::unique_lock<std::mutex>(*delta_store_->GetFileMutex(gid));
+    if (graph_format == csr_bin && edge_block_size_ > 0) {
+      graph = new CSR_T;
+      out = csr_io_adapter_->ReadCSRVertexesFromCSRBin(
+          (GRAPH_BASE_T*)graph, gid, path.meta_pt, path.data_pt,
+          path.vdata_pt, edge_block_size_);
+    } else if (graph_format == csr_bin) {
       graph = new CSR_T;
       out = csr_io_adapter_->Read((GRAPH_BASE_T*)graph, csr_bin, gid,
                                   path.meta_pt, path.data_pt, path.vdata_pt);
@@ -67,6 +77,9 @@ class DataMngr {
                                        separator_params, path.meta_pt,
                                        path.data_pt);
     }
+    // Kernels see the fragment with its pending updates merged.
+    if (out && graph_format == csr_bin && delta_store_ != nullptr)
+      out = delta_store_->Apply(gid, (CSR_T*)graph);
 
     if (out) {
       pgraph_mtx_->lock();
@@ -83,6 +96,10 @@ class DataMngr {
   bool WriteGraph(const GID_T& gid, const Path& path,
                   const GraphFormat& graph_format, bool vdata_only = false) {
     if (graph_format == csr_bin) {
+      std::unique_lock<std::mutex> file_lck;
+      if (delta_store_ != nullptr && delta_store_->GetFileMutex(gid) != nullptr)
+        file_lck =
+            std::unique_lock<std::mutex>(*delta_store_->GetFileMutex(gid));
       auto graph = this->GetGraph(gid);
       return csr_io_adapter_->Write(*((GRAPH_BASE_T*)graph), csr_bin,
                                     vdata_only, path.meta_pt, path.data_pt,
@@ -287,6 +304,35 @@ class DataMngr {
     return true;
   }
 
+  // @brief: write the seconds a run spent on a fragment over num_evals
+  // PEval/IncEval, see MiniGraphSys::RunSys().
+  bool WriteRunCost(const float elapsed_time, const size_t num_evals,
+                    const std::string& out_pt) {
+    std::ofstream fout(out_pt);
+    YAML::Node cost_node;
+    cost_node["elapsed_time"] = elapsed_time;
+    cost_node["num_evals"] = num_evals;
+    fout << cost_node << std::endl;
+    return !fout.fail();
+  }
+
+  bool ReadRunCost(const std::string& in_pt, float* elapsed_time,
+                   size_t* num_evals) {
+    YAML::Node cost_node;
+    try {
+      cost_node = YAML::LoadFile(in_pt);
+    } catch (YAML::BadFile& e) {
+      LOG_INFO("Read", in_pt, " error.");
+      return false;
+    }
+    if (!cost_node["elapsed_time"].IsDefined() ||
+        !cost_node["num_evals"].IsDefined())
+      return false;
+    *elapsed_time = cost_node["elapsed_time"].as<float>();
+    *num_evals = cost_node["num_evals"].as<size_t>();
+    return true;
+  }
+
   StatisticInfo ReadStatisticInfo(const std::string& in_pt) {
     YAML::Node si_node;
     try {
@@ -310,6 +356,19 @@ class DataMngr {
     return si;
   }
 
+  // @brief: load csr_bin fragments in out-of-core edge streaming mode, i.e.
+  // edges are scanned from disk in blocks of edge_block_size edges.
+  // 0 disables streaming.
+  void SetEdgeBlockSize(const size_t edge_block_size) {
+    edge_block_size_ = edge_block_size;
+  }
+
+  // @brief: merge the pending updates of delta_store into csr_bin fragments
+  // as they're read, see DeltaStore.
+  void SetDeltaStore(DeltaStore<GRAPH_T>* delta_store) {
+    delta_store_ = delta_store;
+  }
+
   GRAPH_BASE_T* GetGraph(const GID_T& gid) {
     if (pgraph_by_gid_->count(gid)) {
       return pgraph_by_gid_->find(gid)->second;
@@ -437,6 +496,8 @@ class DataMngr {
   std::unique_ptr<folly::AtomicHashMap<GID_T, GRAPH_BASE_T*>> pgraph_by_gid_ =
       nullptr;
   std::mutex* pgraph_mtx_ = nullptr;
+  size_t edge_block_size_ = 0;
+  DeltaStore<GRAPH_T>* delta_store_ = nullptr;
 };
 
 }  // namespace io
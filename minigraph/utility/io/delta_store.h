@@ -0,0 +1,781 @@
+#ifndef MINIGRAPH_UTILITY_IO_DELTA_STORE_H
+#define MINIGRAPH_UTILITY_IO_DELTA_STORE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "graphs/immutable_csr.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/io/csr_io_adapter.h"
+#include "utility/logging.h"
+#include "utility/memory.h"
+
+namespace minigraph {
+namespace utility {
+namespace io {
+
+// @brief: DeltaStore keeps edge insertions and deletions of an edgecut
+// workspace apart from its immutable csr_bin fragments. An edge (src, dst)
+// is an out-edge of the fragment owning src and an in-edge of the fragment
+// owning dst, so each update is routed to both. Per fragment and direction,
+// updates are kept as a list sorted by <vid, nbr>, with one entry per edge:
+// an insertion makes (vid, nbr) a single edge of the given weight, a
+// deletion removes it. Both replace base edges with the same endpoints, so
+// replaying them is idempotent.
+//
+// Updates are appended to work_space/minigraph_delta/<gid>.bin and kept in
+// memory. Apply() merges the delta of a fragment into a loaded CSR, so
+// kernels see the union view as a plain CSR. Compact() merges it into a new
+// csr_bin of the fragment and drops it from the log, either on demand or by
+// a background thread once a fragment holds enough updates. The new files
+// are written under minigraph_delta/<gid>.tmp/ and committed by creating
+// minigraph_delta/<gid>.commit before they replace the fragment, so that
+// Init() completes a commit cut short instead of leaving a fragment of old
+// and new files.
+//
+// Accepted updates are also appended, as out-edges in order of arrival, to
+// work_space/minigraph_delta/batch.bin, which compaction leaves alone. Stream
+// apps read it from where their last results stand to refresh them, see
+// MiniGraphSys::SetStreamResult(). Positions in batch.bin count updates
+// since the workspace was built: its header holds the position of its first
+// update, so TrimBatch() can drop those that all results reflect without
+// touching them.
+//
+// Endpoints must be vertexes of the workspace, new vertexes take a
+// repartition.
+template <typename GRAPH_T>
+class DeltaStore {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using GRAPH_BASE_T = graphs::Graph<GID_T, VID_T, VDATA_T, EDATA_T>;
+  using CSR_T = graphs::ImmutableCSR<GID_T, VID_T, VDATA_T, EDATA_T>;
+
+ public:
+  enum Direction : uint8_t { kIn = 0, kOut = 1 };
+  enum Op : uint8_t { kDelete = 0, kInsert = 1 };
+
+  // An update of the adjacency list of vid, as kept in the log.
+  struct DeltaEdge {
+    VID_T vid;
+    VID_T nbr;
+    EDATA_T weight;
+    uint8_t dir;
+    uint8_t op;
+  };
+
+  DeltaStore(const std::string& work_space)
+      : work_space_(work_space), root_(work_space + "minigraph_delta/") {}
+
+  ~DeltaStore() { StopCompaction(); }
+
+  // @brief: finish the compactions cut short and replay the logs of the
+  // fragments in pt_by_gid.
+  bool Init(const std::unordered_map<GID_T, Path>& pt_by_gid) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    pt_by_gid_ = pt_by_gid;
+    num_graphs_ = pt_by_gid.size();
+    deltas_.assign(num_graphs_, FragmentDelta());
+    file_mtx_.clear();
+    for (size_t i = 0; i < num_graphs_; i++)
+      file_mtx_.emplace_back(std::make_unique<std::mutex>());
+
+    bool tag = true;
+    for (GID_T gid = 0; gid < num_graphs_; gid++) {
+      std::error_code ec;
+      if (std::filesystem::exists(CommitPt(gid), ec)) {
+        LOG_INFO("DeltaStore: finish compaction of fragment ", gid);
+        tag = ReplaceFragment(gid) && tag;
+      } else {
+        std::filesystem::remove_all(TmpPt(gid), ec);
+      }
+    }
+
+    size_t total = 0;
+    for (GID_T gid = 0; gid < num_graphs_; gid++) {
+      std::ifstream log_file(LogPt(gid), std::ios::binary);
+      if (!log_file) continue;
+      std::vector<DeltaEdge> log;
+      DeltaEdge e;
+      while (log_file.read((char*)&e, sizeof(DeltaEdge))) log.push_back(e);
+      Merge(log, &deltas_[gid]);
+      total += log.size();
+    }
+    if (total > 0) LOG_INFO("DeltaStore: replayed ", total, " updates");
+    return tag;
+  }
+
+  // @brief: insert, or delete if !insert, the n edges of edges, given as
+  // <src, dst> pairs. weights may be nullptr.
+  // @return: the number of updates accepted. Self loops and edges whose
+  // endpoints aren't in the workspace are dropped.
+  size_t Update(const VID_T* edges, const EDATA_T* weights, const size_t n,
+                const bool insert) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    if (!LoadOwners()) return 0;
+    std::vector<std::vector<DeltaEdge>> batch(num_graphs_);
+    std::vector<DeltaEdge> accepted_edges;
+    size_t accepted = 0;
+    bool border_changed = false;
+    for (size_t i = 0; i < n; i++) {
+      VID_T src = edges[2 * i], dst = edges[2 * i + 1];
+      if (src == dst || src >= owner_.size() || dst >= owner_.size() ||
+          owner_[src] == GID_MAX || owner_[dst] == GID_MAX)
+        continue;
+      DeltaEdge e;
+      memset(&e, 0, sizeof(DeltaEdge));
+      e.weight = weights == nullptr ? EDATA_T() : weights[i];
+      e.op = insert ? kInsert : kDelete;
+      e.vid = src;
+      e.nbr = dst;
+      e.dir = kOut;
+      batch[owner_[src]].push_back(e);
+      accepted_edges.push_back(e);
+      e.vid = dst;
+      e.nbr = src;
+      e.dir = kIn;
+      batch[owner_[dst]].push_back(e);
+      if (insert && owner_[src] != owner_[dst])
+        border_changed |= SetBorder(src, dst);
+      ++accepted;
+    }
+
+    for (GID_T gid = 0; gid < num_graphs_; gid++) {
+      if (batch[gid].empty()) continue;
+      std::filesystem::create_directories(root_);
+      std::ofstream log_file(LogPt(gid), std::ios::binary | std::ios::app);
+      log_file.write((char*)batch[gid].data(),
+                     sizeof(DeltaEdge) * batch[gid].size());
+      Merge(batch[gid], &deltas_[gid]);
+    }
+    if (!accepted_edges.empty()) {
+      std::error_code ec;
+      bool empty = std::filesystem::file_size(BatchPt(), ec) < sizeof(size_t);
+      std::ofstream batch_file(BatchPt(), std::ios::binary | std::ios::app);
+      size_t base = 0;
+      if (empty || ec) batch_file.write((char*)&base, sizeof(size_t));
+      batch_file.write((char*)accepted_edges.data(),
+                       sizeof(DeltaEdge) * accepted_edges.size());
+    }
+    if (border_changed) WriteBorder();
+    if (accepted < n)
+      LOG_INFO("DeltaStore: dropped ", n - accepted,
+               " updates of self loops or unknown vertexes");
+    return accepted;
+  }
+
+  // @brief: number of pending updates of a fragment, of both directions.
+  size_t GetNumDeltas(const GID_T gid) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    return deltas_[gid].in.size() + deltas_[gid].out.size();
+  }
+
+  // @brief: append to batch the updates logged to batch.bin from position
+  // from on, and set end to the position past the last one.
+  // @return: false if batch.bin doesn't hold them all, e.g. it has been
+  // trimmed or removed since.
+  bool ReadBatch(const size_t from, std::vector<DeltaEdge>* batch,
+                 size_t* end) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    size_t base = 0;
+    *end = ReadBatchRange(&base);
+    if (from < base || from > *end) return false;
+    if (from == *end) return true;
+    std::ifstream batch_file(BatchPt(), std::ios::binary);
+    batch_file.seekg(sizeof(size_t) + sizeof(DeltaEdge) * (from - base));
+    size_t offset = batch->size();
+    batch->resize(offset + *end - from);
+    return (bool)batch_file.read((char*)(batch->data() + offset),
+                                 sizeof(DeltaEdge) * (*end - from));
+  }
+
+  // @brief: position past the last update logged to batch.bin.
+  size_t GetBatchSize() {
+    std::lock_guard<std::mutex> lck(mtx_);
+    size_t base = 0;
+    return ReadBatchRange(&base);
+  }
+
+  // @brief: drop from batch.bin the updates that the results of every stream
+  // app, work_space/minigraph_stream/*.bin, already reflect. The file is only
+  // rewritten once they make up half of it.
+  bool TrimBatch() {
+    std::lock_guard<std::mutex> lck(mtx_);
+    size_t base = 0;
+    size_t end = ReadBatchRange(&base);
+    size_t from = end;
+    std::error_code ec;
+    for (auto& entry : std::filesystem::directory_iterator(
+             work_space_ + "minigraph_stream/", ec)) {
+      if (entry.path().extension() != ".bin") continue;
+      std::ifstream result_file(entry.path(), std::ios::binary);
+      size_t offset = 0;
+      if (result_file.read((char*)&offset, sizeof(size_t)))
+        from = std::min(from, std::max(offset, base));
+    }
+    if (from == base || 2 * (from - base) < end - base) return true;
+
+    std::vector<DeltaEdge> tail(end - from);
+    std::ifstream batch_file(BatchPt(), std::ios::binary);
+    batch_file.seekg(sizeof(size_t) + sizeof(DeltaEdge) * (from - base));
+    if (!batch_file.read((char*)tail.data(), sizeof(DeltaEdge) * tail.size()))
+      return false;
+    std::string tmp_pt = BatchPt() + ".tmp";
+    {
+      std::ofstream out(tmp_pt, std::ios::binary);
+      out.write((char*)&from, sizeof(size_t));
+      out.write((char*)tail.data(), sizeof(DeltaEdge) * tail.size());
+      if (!out) return false;
+    }
+    if (rename(tmp_pt.c_str(), BatchPt().c_str()) != 0) return false;
+    LOG_INFO("DeltaStore: trimmed ", from - base, " updates of batch.bin");
+    return true;
+  }
+
+  // @brief: fragment holding vid, GID_MAX if none.
+  GID_T GetOwner(const VID_T vid) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    if (!LoadOwners() || vid >= owner_.size()) return GID_MAX;
+    return owner_[vid];
+  }
+
+  // @brief: fragments holding vids from to from + n - 1, GID_MAX if none,
+  // looked up at once.
+  void GetOwners(const VID_T from, const size_t n, GID_T* owners) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    bool loaded = LoadOwners();
+    for (size_t i = 0; i < n; i++)
+      owners[i] = loaded && from + i < owner_.size() ? owner_[from + i]
+                                                     : GID_MAX;
+  }
+
+  // @brief: lock of the files of gid, held while they're read, written or
+  // compacted.
+  std::mutex* GetFileMutex(const GID_T gid) {
+    return gid < file_mtx_.size() ? file_mtx_[gid].get() : nullptr;
+  }
+
+  // @brief: merge the pending updates of gid into graph, a csr_bin fragment
+  // loaded in memory. Vertexes keep their local ids, so vdata is unchanged.
+  bool Apply(const GID_T gid, CSR_T* graph) {
+    FragmentDelta delta;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      if (gid >= num_graphs_) return true;
+      if (deltas_[gid].in.empty() && deltas_[gid].out.empty()) return true;
+      delta = deltas_[gid];
+    }
+    if (graph->IsEdgeStreaming()) {
+      XLOG(ERR, "Fragment ", gid, " has ", delta.in.size() + delta.out.size(),
+           " pending updates, compact it to stream its edges.");
+      return false;
+    }
+    ApplyTo(delta, graph);
+    return true;
+  }
+
+  // @brief: rewrite the csr_bin of gid with its pending updates merged, then
+  // drop them from the log. Updates arriving meanwhile are kept.
+  bool Compact(const GID_T gid) {
+    std::lock_guard<std::mutex> file_lck(*file_mtx_[gid]);
+    FragmentDelta delta;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      delta = deltas_[gid];
+    }
+    if (delta.in.empty() && delta.out.empty()) return true;
+
+    auto& path = pt_by_gid_.find(gid)->second;
+    CSR_T graph;
+    if (!csr_io_adapter_.Read((GRAPH_BASE_T*)&graph, csr_bin, gid,
+                              path.meta_pt, path.data_pt, path.vdata_pt)) {
+      XLOG(ERR, "Compact: read fragment fault: ", gid);
+      return false;
+    }
+    ApplyTo(delta, &graph);
+
+    // Files are written beside the log, as the fragment directories only
+    // hold fragments.
+    std::error_code ec;
+    std::filesystem::remove_all(TmpPt(gid), ec);
+    std::filesystem::create_directories(TmpPt(gid), ec);
+    if (!csr_io_adapter_.Write(graph, csr_bin, false, TmpPt(gid) + "meta",
+                               TmpPt(gid) + "data", TmpPt(gid) + "vdata"))
+      return false;
+    {
+      std::ofstream commit_file(CommitPt(gid) + ".tmp");
+      if (!commit_file) return false;
+    }
+    if (rename((CommitPt(gid) + ".tmp").c_str(), CommitPt(gid).c_str()) != 0 ||
+        !ReplaceFragment(gid)) {
+      XLOG(ERR, "Compact: replace fragment fault: ", gid);
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lck(mtx_);
+    Drop(delta.in, &deltas_[gid].in);
+    Drop(delta.out, &deltas_[gid].out);
+    RewriteLog(gid);
+    LOG_INFO("Compact: GID ", gid, " merged ",
+             delta.in.size() + delta.out.size(), " updates, ",
+             graph.get_num_in_edges(), " in_edges, ",
+             graph.get_num_out_edges(), " out_edges");
+    return true;
+  }
+
+  // @brief: compact all fragments with pending updates.
+  bool CompactAll() {
+    bool tag = true;
+    for (GID_T gid = 0; gid < num_graphs_; gid++)
+      if (GetNumDeltas(gid) > 0) tag = Compact(gid) && tag;
+    return tag;
+  }
+
+  // @brief: compact, every interval_ms in background, the fragments holding
+  // at least threshold updates. 0 disables it.
+  void StartCompaction(const size_t threshold,
+                       const size_t interval_ms = 1000) {
+    StopCompaction();
+    if (threshold == 0) return;
+    compaction_switch_ = true;
+    compactor_ = std::thread([this, threshold, interval_ms]() {
+      std::unique_lock<std::mutex> lck(compaction_mtx_);
+      while (!compaction_cv_.wait_for(
+          lck, std::chrono::milliseconds(interval_ms),
+          [this] { return !compaction_switch_.load(); })) {
+        for (GID_T gid = 0; gid < num_graphs_ && compaction_switch_; gid++)
+          if (GetNumDeltas(gid) >= threshold) Compact(gid);
+      }
+    });
+  }
+
+  void StopCompaction() {
+    {
+      std::lock_guard<std::mutex> lck(compaction_mtx_);
+      compaction_switch_ = false;
+    }
+    compaction_cv_.notify_all();
+    if (compactor_.joinable()) compactor_.join();
+  }
+
+ private:
+  struct FragmentDelta {
+    std::vector<DeltaEdge> in;
+    std::vector<DeltaEdge> out;
+  };
+
+  std::string work_space_;
+  std::string root_;
+  size_t num_graphs_ = 0;
+  std::unordered_map<GID_T, Path> pt_by_gid_;
+  CSRIOAdapter<GID_T, VID_T, VDATA_T, EDATA_T> csr_io_adapter_;
+
+  // Guards deltas_, the logs and the border files.
+  std::mutex mtx_;
+  std::vector<FragmentDelta> deltas_;
+  std::vector<std::unique_ptr<std::mutex>> file_mtx_;
+
+  // Fragment of each vertex by global id, GID_MAX if none, and the border
+  // vertexes and communication matrix of the workspace. Loaded by the first
+  // Update() or GetOwner().
+  std::vector<GID_T> owner_;
+  std::vector<unsigned long> border_words_;
+  size_t border_size_ = 0;
+  std::vector<char> communication_matrix_;
+
+  std::thread compactor_;
+  std::atomic<bool> compaction_switch_ = false;
+  std::mutex compaction_mtx_;
+  std::condition_variable compaction_cv_;
+
+  std::string LogPt(const GID_T gid) const {
+    return root_ + std::to_string(gid) + ".bin";
+  }
+
+  std::string BatchPt() const { return root_ + "batch.bin"; }
+
+  std::string TmpPt(const GID_T gid) const {
+    return root_ + std::to_string(gid) + ".tmp/";
+  }
+
+  std::string CommitPt(const GID_T gid) const {
+    return root_ + std::to_string(gid) + ".commit";
+  }
+
+  // @brief: move the committed files of a compaction of gid over the
+  // fragment. Files already moved by a run cut short are skipped.
+  bool ReplaceFragment(const GID_T gid) {
+    auto& path = pt_by_gid_.find(gid)->second;
+    std::error_code ec;
+    for (auto& file : {std::make_pair(std::string("data"), path.data_pt),
+                       std::make_pair(std::string("vdata"), path.vdata_pt),
+                       std::make_pair(std::string("meta"), path.meta_pt)}) {
+      std::string tmp_pt = TmpPt(gid) + file.first;
+      if (!std::filesystem::exists(tmp_pt, ec)) continue;
+      if (rename(tmp_pt.c_str(), file.second.c_str()) != 0) return false;
+    }
+    remove(CommitPt(gid).c_str());
+    std::filesystem::remove_all(TmpPt(gid), ec);
+    return true;
+  }
+
+  // @brief: read the header of batch.bin into base.
+  // @return: the position past its last update.
+  size_t ReadBatchRange(size_t* base) {
+    *base = 0;
+    std::error_code ec;
+    auto size = std::filesystem::file_size(BatchPt(), ec);
+    if (ec || size < sizeof(size_t)) return 0;
+    std::ifstream batch_file(BatchPt(), std::ios::binary);
+    if (!batch_file.read((char*)base, sizeof(size_t))) return 0;
+    return *base + (size - sizeof(size_t)) / sizeof(DeltaEdge);
+  }
+
+  static bool KeyLess(const DeltaEdge& a, const DeltaEdge& b) {
+    return a.vid < b.vid || (a.vid == b.vid && a.nbr < b.nbr);
+  }
+
+  static bool SameKey(const DeltaEdge& a, const DeltaEdge& b) {
+    return a.vid == b.vid && a.nbr == b.nbr;
+  }
+
+  // @brief: merge updates, in order of arrival, into delta. The last update
+  // of an edge wins.
+  static void Merge(const std::vector<DeltaEdge>& updates,
+                    FragmentDelta* delta) {
+    for (auto dir : {kIn, kOut}) {
+      auto& list = dir == kIn ? delta->in : delta->out;
+      size_t mid = list.size();
+      for (auto& e : updates)
+        if (e.dir == dir) list.push_back(e);
+      if (list.size() == mid) continue;
+      std::stable_sort(list.begin() + mid, list.end(), KeyLess);
+      std::inplace_merge(list.begin(), list.begin() + mid, list.end(),
+                         KeyLess);
+      // Keep the last of each run of equal keys.
+      size_t k = 0;
+      for (size_t i = 0; i < list.size(); i++) {
+        if (i + 1 < list.size() && SameKey(list[i], list[i + 1])) continue;
+        list[k++] = list[i];
+      }
+      list.resize(k);
+    }
+  }
+
+  // @brief: remove from list the updates of compacted that it still holds.
+  static void Drop(const std::vector<DeltaEdge>& compacted,
+                   std::vector<DeltaEdge>* list) {
+    size_t k = 0, j = 0;
+    for (size_t i = 0; i < list->size(); i++) {
+      auto& e = (*list)[i];
+      while (j < compacted.size() && KeyLess(compacted[j], e)) j++;
+      if (j < compacted.size() && SameKey(compacted[j], e) &&
+          compacted[j].op == e.op && compacted[j].weight == e.weight)
+        continue;
+      (*list)[k++] = e;
+    }
+    list->resize(k);
+  }
+
+  void RewriteLog(const GID_T gid) {
+    auto& delta = deltas_[gid];
+    if (delta.in.empty() && delta.out.empty()) {
+      remove(LogPt(gid).c_str());
+      return;
+    }
+    std::string tmp_pt = LogPt(gid) + ".tmp";
+    {
+      std::ofstream log_file(tmp_pt, std::ios::binary);
+      log_file.write((char*)delta.in.data(),
+                     sizeof(DeltaEdge) * delta.in.size());
+      log_file.write((char*)delta.out.data(),
+                     sizeof(DeltaEdge) * delta.out.size());
+    }
+    rename(tmp_pt.c_str(), LogPt(gid).c_str());
+  }
+
+  // @brief: read the global ids of every fragment, the first array of its
+  // data file, and the border files of the workspace.
+  bool LoadOwners() {
+    if (!owner_.empty()) return true;
+    std::vector<std::vector<VID_T>> globalids(num_graphs_);
+    VID_T max_vid = 0;
+    for (GID_T gid = 0; gid < num_graphs_; gid++) {
+      auto& path = pt_by_gid_.find(gid)->second;
+      size_t num_vertexes = 0;
+      std::ifstream meta_file(path.meta_pt, std::ios::binary);
+      meta_file.read((char*)&num_vertexes, sizeof(size_t));
+      globalids[gid].resize(num_vertexes);
+      std::ifstream data_file(path.data_pt, std::ios::binary);
+      if (!meta_file || !data_file.read((char*)globalids[gid].data(),
+                                        sizeof(VID_T) * num_vertexes)) {
+        XLOG(ERR, "DeltaStore: read fragment fault: ", gid);
+        return false;
+      }
+      for (auto vid : globalids[gid]) max_vid = std::max(max_vid, vid);
+    }
+    std::vector<GID_T> owner(max_vid + 1, GID_MAX);
+    for (GID_T gid = 0; gid < num_graphs_; gid++) {
+      for (auto vid : globalids[gid]) {
+        if (owner[vid] != GID_MAX) {
+          XLOG(ERR, "DeltaStore: vertex ", vid, " is in fragments ",
+               owner[vid], " and ", gid, ", updates need an edgecut "
+               "workspace.");
+          return false;
+        }
+        owner[vid] = gid;
+      }
+    }
+
+    std::ifstream border_file(
+        work_space_ + "minigraph_message/global_border_vid_map.bin",
+        std::ios::binary);
+    size_t meta[2] = {0, 0};
+    if (border_file.read((char*)meta, sizeof(size_t) * 2)) {
+      border_size_ = meta[0];
+      border_words_.assign(meta[1] / sizeof(unsigned long), 0);
+      border_file.read((char*)border_words_.data(), meta[1]);
+    }
+    std::ifstream matrix_file(
+        work_space_ + "minigraph_border_vertexes/communication_matrix.bin",
+        std::ios::binary);
+    size_t num_graphs = 0;
+    if (matrix_file.read((char*)&num_graphs, sizeof(size_t)) &&
+        num_graphs == num_graphs_) {
+      communication_matrix_.assign(num_graphs * num_graphs, 0);
+      matrix_file.read(communication_matrix_.data(), num_graphs * num_graphs);
+    }
+    owner_.swap(owner);
+    return true;
+  }
+
+  // @brief: mark src and dst as border vertexes and their fragments as
+  // dependent on each other.
+  // @return: whether anything changed.
+  bool SetBorder(const VID_T src, const VID_T dst) {
+    bool changed = false;
+    for (auto vid : {src, dst}) {
+      if (vid > border_size_ || WORD_OFFSET(vid) >= border_words_.size())
+        continue;
+      unsigned long bit = 1ul << BIT_OFFSET(vid);
+      if (border_words_[WORD_OFFSET(vid)] & bit) continue;
+      border_words_[WORD_OFFSET(vid)] |= bit;
+      changed = true;
+    }
+    if (!communication_matrix_.empty()) {
+      GID_T x = owner_[src], y = owner_[dst];
+      for (auto i : {x * num_graphs_ + y, y * num_graphs_ + x}) {
+        if (communication_matrix_[i]) continue;
+        communication_matrix_[i] = 1;
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  void WriteBorder() {
+    if (!border_words_.empty()) {
+      std::ofstream border_file(
+          work_space_ + "minigraph_message/global_border_vid_map.bin",
+          std::ios::binary | std::ios::trunc);
+      size_t meta[2] = {border_size_,
+                        sizeof(unsigned long) * border_words_.size()};
+      border_file.write((char*)meta, sizeof(size_t) * 2);
+      border_file.write((char*)border_words_.data(), meta[1]);
+    }
+    if (!communication_matrix_.empty()) {
+      std::ofstream matrix_file(
+          work_space_ + "minigraph_border_vertexes/communication_matrix.bin",
+          std::ios::binary | std::ios::trunc);
+      matrix_file.write((char*)&num_graphs_, sizeof(size_t));
+      matrix_file.write(communication_matrix_.data(),
+                        communication_matrix_.size());
+    }
+  }
+
+  // @brief: neighbors of a vertex in the union view: base edges without an
+  // update, followed by insertions, sorted if sorted.
+  // @return: the degree, out and out_w are only counted if nullptr.
+  static size_t MergeList(const VID_T* base, const EDATA_T* base_w,
+                          const size_t degree, const DeltaEdge* d,
+                          const size_t nd, const bool sorted, VID_T* out,
+                          EDATA_T* out_w) {
+    size_t k = 0;
+    for (size_t i = 0; i < degree; i++) {
+      VID_T nbr = base[i];
+      auto iter = std::lower_bound(
+          d, d + nd, nbr,
+          [](const DeltaEdge& e, const VID_T v) { return e.nbr < v; });
+      if (iter != d + nd && iter->nbr == nbr) continue;
+      if (out != nullptr) {
+        out[k] = nbr;
+        out_w[k] = base_w[i];
+      }
+      k++;
+    }
+    for (size_t j = 0; j < nd; j++) {
+      if (d[j].op != kInsert) continue;
+      if (out != nullptr) {
+        out[k] = d[j].nbr;
+        out_w[k] = d[j].weight;
+      }
+      k++;
+    }
+    if (out != nullptr && sorted && k > 1) {
+      std::vector<std::pair<VID_T, EDATA_T>> pairs(k);
+      for (size_t i = 0; i < k; i++)
+        pairs[i] = std::make_pair(out[i], out_w[i]);
+      std::sort(pairs.begin(), pairs.end());
+      for (size_t i = 0; i < k; i++) {
+        out[i] = pairs[i].first;
+        out_w[i] = pairs[i].second;
+      }
+    }
+    return k;
+  }
+
+  // @brief: rebuild the edge arrays of graph with delta merged, in the
+  // layout of ImmutableCSR.
+  static void ApplyTo(const FragmentDelta& delta, CSR_T* graph) {
+    size_t n = graph->get_num_vertexes();
+    // Updates of each local vertex, as a range of delta.in and delta.out.
+    std::vector<std::pair<size_t, size_t>> in_range(n, {0, 0});
+    std::vector<std::pair<size_t, size_t>> out_range(n, {0, 0});
+    for (auto dir : {kIn, kOut}) {
+      auto& list = dir == kIn ? delta.in : delta.out;
+      auto& range = dir == kIn ? in_range : out_range;
+      for (size_t i = 0; i < list.size();) {
+        size_t j = i;
+        while (j < list.size() && list[j].vid == list[i].vid) j++;
+        VID_T vid = list[i].vid;
+        if (vid < graph->get_aligned_max_vid() && graph->bitmap_->get_bit(vid))
+          range[graph->globalid2localid(vid)] = std::make_pair(i, j);
+        i = j;
+      }
+    }
+
+    if (graph->edata_ == nullptr) {
+      size_t num_edata = graph->sum_in_edges_ + graph->sum_out_edges_;
+      graph->edata_ =
+          (EDATA_T*)utility::HugePageAlloc(sizeof(EDATA_T) * num_edata);
+      memset(graph->edata_, 0, sizeof(EDATA_T) * num_edata);
+    }
+    for (auto& list : {&delta.in, &delta.out})
+      for (auto& e : *list)
+        if (e.op == kInsert && e.weight != EDATA_T())
+          graph->csr_flags_ |= CSR_WEIGHTED;
+
+    bool sorted = graph->IsSorted();
+    EDATA_T* base_in_w = graph->edata_;
+    EDATA_T* base_out_w = graph->edata_ + graph->sum_in_edges_;
+    std::vector<size_t> indegree(n), outdegree(n);
+    size_t sum_in = 0, sum_out = 0;
+    for (size_t i = 0; i < n; i++) {
+      indegree[i] = MergeList(
+          graph->in_edges_ + graph->in_offset_[i], nullptr,
+          graph->indegree_[i], delta.in.data() + in_range[i].first,
+          in_range[i].second - in_range[i].first, sorted, nullptr, nullptr);
+      outdegree[i] = MergeList(
+          graph->out_edges_ + graph->out_offset_[i], nullptr,
+          graph->outdegree_[i], delta.out.data() + out_range[i].first,
+          out_range[i].second - out_range[i].first, sorted, nullptr, nullptr);
+      sum_in += indegree[i];
+      sum_out += outdegree[i];
+    }
+
+    size_t size_globalid = sizeof(VID_T) * n;
+    size_t size_degree = sizeof(size_t) * n;
+    size_t size_localid_by_globalid =
+        sizeof(VID_T) * graph->get_aligned_max_vid();
+    size_t start_indegree = size_globalid;
+    size_t start_outdegree = start_indegree + size_degree;
+    size_t start_in_offset = start_outdegree + size_degree;
+    size_t start_out_offset = start_in_offset + size_degree;
+    size_t start_in_edges = start_out_offset + size_degree;
+    size_t start_out_edges = start_in_edges + sizeof(VID_T) * sum_in;
+    size_t start_localid_by_globalid =
+        start_out_edges + sizeof(VID_T) * sum_out;
+    size_t total_size = start_localid_by_globalid + size_localid_by_globalid;
+
+    auto buf_graph = (VID_T*)utility::HugePageAlloc(total_size);
+    auto in_offset = (size_t*)((char*)buf_graph + start_in_offset);
+    auto out_offset = (size_t*)((char*)buf_graph + start_out_offset);
+    auto in_edges = (VID_T*)((char*)buf_graph + start_in_edges);
+    auto out_edges = (VID_T*)((char*)buf_graph + start_out_edges);
+    auto edata =
+        (EDATA_T*)utility::HugePageAlloc(sizeof(EDATA_T) * (sum_in + sum_out));
+    memcpy(buf_graph, graph->globalid_by_index_, size_globalid);
+    memcpy((char*)buf_graph + start_indegree, indegree.data(), size_degree);
+    memcpy((char*)buf_graph + start_outdegree, outdegree.data(), size_degree);
+    memcpy((char*)buf_graph + start_localid_by_globalid,
+           graph->localid_by_globalid_, size_localid_by_globalid);
+
+    size_t in_pos = 0, out_pos = 0;
+    for (size_t i = 0; i < n; i++) {
+      in_offset[i] = in_pos;
+      out_offset[i] = out_pos;
+      if (in_range[i].first == in_range[i].second) {
+        memcpy(in_edges + in_pos, graph->in_edges_ + graph->in_offset_[i],
+               sizeof(VID_T) * indegree[i]);
+        memcpy(edata + in_pos, base_in_w + graph->in_offset_[i],
+               sizeof(EDATA_T) * indegree[i]);
+      } else {
+        MergeList(graph->in_edges_ + graph->in_offset_[i],
+                  base_in_w + graph->in_offset_[i], graph->indegree_[i],
+                  delta.in.data() + in_range[i].first,
+                  in_range[i].second - in_range[i].first, sorted,
+                  in_edges + in_pos, edata + in_pos);
+      }
+      if (out_range[i].first == out_range[i].second) {
+        memcpy(out_edges + out_pos, graph->out_edges_ + graph->out_offset_[i],
+               sizeof(VID_T) * outdegree[i]);
+        memcpy(edata + sum_in + out_pos, base_out_w + graph->out_offset_[i],
+               sizeof(EDATA_T) * outdegree[i]);
+      } else {
+        MergeList(graph->out_edges_ + graph->out_offset_[i],
+                  base_out_w + graph->out_offset_[i], graph->outdegree_[i],
+                  delta.out.data() + out_range[i].first,
+                  out_range[i].second - out_range[i].first, sorted,
+                  out_edges + out_pos, edata + sum_in + out_pos);
+      }
+      in_pos += indegree[i];
+      out_pos += outdegree[i];
+    }
+
+    free(graph->buf_graph_);
+    free(graph->edata_);
+    graph->buf_graph_ = buf_graph;
+    graph->edata_ = edata;
+    graph->globalid_by_index_ = buf_graph;
+    graph->indegree_ = (size_t*)((char*)buf_graph + start_indegree);
+    graph->outdegree_ = (size_t*)((char*)buf_graph + start_outdegree);
+    graph->in_offset_ = in_offset;
+    graph->out_offset_ = out_offset;
+    graph->in_edges_ = in_edges;
+    graph->out_edges_ = out_edges;
+    graph->localid_by_globalid_ =
+        (VID_T*)((char*)buf_graph + start_localid_by_globalid);
+    graph->sum_in_edges_ = sum_in;
+    graph->sum_out_edges_ = sum_out;
+    graph->num_edges_ = sum_in + sum_out;
+  }
+};
+
+}  // namespace io
+}  // namespace utility
+}  // namespace minigraph
+
+#endif  // MINIGRAPH_UTILITY_IO_DELTA_STORE_H
@@ -0,0 +1,149 @@
+#ifndef MINIGRAPH_UTILITY_IO_EDGE_BLOCK_READER_H
+#define MINIGRAPH_UTILITY_IO_EDGE_BLOCK_READER_H
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <future>
+#include <string>
+
+#include "graphs/immutable_csr.h"
+#include "utility/logging.h"
+#include "utility/memory.h"
+
+namespace minigraph {
+namespace utility {
+namespace io {
+
+// @brief: EdgeBlockReader scans the edges of a streaming ImmutableCSR
+// sequentially from disk. Each block covers a contiguous range of vertexes
+// [begin, end) whose in-edges and out-edges sum to at most edge_block_size_
+// (a single vertex with a larger degree forms a block on its own). The next
+// block is prefetched while the current one is being processed.
+template <typename GRAPH_T>
+class EdgeBlockReader {
+  using VID_T = typename GRAPH_T::vid_t;
+
+  struct EdgeBlock {
+    size_t begin = 0;
+    size_t end = 0;
+    VID_T* in_edges = nullptr;
+    VID_T* out_edges = nullptr;
+    size_t in_capacity = 0;
+    size_t out_capacity = 0;
+  };
+
+ public:
+  EdgeBlockReader(GRAPH_T* graph) {
+    assert(graph != nullptr && graph->IsEdgeStreaming());
+    graph_ = graph;
+    fd_ = open(graph_->data_pt_.c_str(), O_RDONLY);
+    if (fd_ < 0) XLOG(ERR, "Open file fault: ", graph_->data_pt_);
+  }
+
+  ~EdgeBlockReader() {
+    if (prefetch_.valid()) prefetch_.wait();
+    for (auto& block : blocks_) {
+      if (block.in_edges != nullptr) free(block.in_edges);
+      if (block.out_edges != nullptr) free(block.out_edges);
+    }
+    graph_->in_edges_ = nullptr;
+    graph_->out_edges_ = nullptr;
+    graph_->set_in_offset_base(0);
+    graph_->set_out_offset_base(0);
+    if (fd_ >= 0) close(fd_);
+  }
+
+  // @brief: load the next block and point in_edges_ and out_edges_ of the
+  // graph at it.
+  // @return: false if all vertexes have been scanned or the read failed.
+  bool Next(size_t* begin, size_t* end) {
+    if (fd_ < 0) return false;
+    bool tag = false;
+    if (!prefetch_.valid()) {
+      if (cursor_ >= graph_->get_num_vertexes()) return false;
+      tag = Load(&blocks_[cur_]);
+    } else {
+      cur_ ^= 1;
+      tag = prefetch_.get();
+    }
+    if (!tag) return false;
+
+    EdgeBlock& block = blocks_[cur_];
+    graph_->in_edges_ = block.in_edges;
+    graph_->out_edges_ = block.out_edges;
+    graph_->set_in_offset_base(graph_->in_offset_[block.begin]);
+    graph_->set_out_offset_base(graph_->out_offset_[block.begin]);
+    *begin = block.begin;
+    *end = block.end;
+
+    if (cursor_ < graph_->get_num_vertexes())
+      prefetch_ = std::async(std::launch::async, &EdgeBlockReader::Load, this,
+                             &blocks_[cur_ ^ 1]);
+    return true;
+  }
+
+ private:
+  bool Load(EdgeBlock* block) {
+    block->begin = cursor_;
+    size_t num_edges = 0;
+    size_t end = cursor_;
+    while (end < graph_->get_num_vertexes()) {
+      size_t degree = graph_->indegree_[end] + graph_->outdegree_[end];
+      if (end > cursor_ && num_edges + degree > graph_->edge_block_size_)
+        break;
+      num_edges += degree;
+      ++end;
+    }
+    block->end = end;
+    cursor_ = end;
+
+    size_t last = end - 1;
+    size_t num_in_edges = graph_->in_offset_[last] + graph_->indegree_[last] -
+                          graph_->in_offset_[block->begin];
+    size_t num_out_edges = graph_->out_offset_[last] +
+                           graph_->outdegree_[last] -
+                           graph_->out_offset_[block->begin];
+    Reserve(&block->in_edges, &block->in_capacity, num_in_edges);
+    Reserve(&block->out_edges, &block->out_capacity, num_out_edges);
+
+    return ReadFully(block->in_edges, sizeof(VID_T) * num_in_edges,
+                     graph_->in_edges_pos_ +
+                         sizeof(VID_T) * graph_->in_offset_[block->begin]) &&
+           ReadFully(block->out_edges, sizeof(VID_T) * num_out_edges,
+                     graph_->out_edges_pos_ +
+                         sizeof(VID_T) * graph_->out_offset_[block->begin]);
+  }
+
+  void Reserve(VID_T** buf, size_t* capacity, const size_t size) {
+    if (*capacity >= size && *buf != nullptr) return;
+    if (*buf != nullptr) free(*buf);
+    *capacity = size > graph_->edge_block_size_ ? size
+                                                : graph_->edge_block_size_;
+    *buf = (VID_T*)utility::HugePageAlloc(sizeof(VID_T) * (*capacity));
+  }
+
+  bool ReadFully(VID_T* buf, const size_t size, const size_t pos) {
+    size_t offset = 0;
+    while (offset < size) {
+      ssize_t n = pread(fd_, (char*)buf + offset, size - offset, pos + offset);
+      if (n <= 0) {
+        XLOG(ERR, "Read edge block fault: ", graph_->data_pt_);
+        return false;
+      }
+      offset += n;
+    }
+    return true;
+  }
+
+  GRAPH_T* graph_ = nullptr;
+  int fd_ = -1;
+  size_t cursor_ = 0;
+  size_t cur_ = 0;
+  EdgeBlock blocks_[2];
+  std::future<bool> prefetch_;
+};
+
+}  // namespace io
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_IO_EDGE_BLOCK_READER_H
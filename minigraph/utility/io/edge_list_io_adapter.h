@@ -3,13 +3,12 @@
 
 #include "graphs/edgelist.h"
 #include "io_adapter_base.h"
+#include "utility/io/csv_edge_parser.h"
 #include "portability/sys_data_structure.h"
 #include "portability/sys_types.h"
 #include "utility/atomic.h"
 #include "utility/thread_pool.h"
 
-#include "rapidcsv.h"
-
 #include <sys/stat.h>
 #include <filesystem>
 #include <fstream>
@@ -26,8 +25,9 @@ namespace io {
 // In addition, two types of binary formatted edge list files are also
 // supported:
 //   Unweighted. Edges are tuples of <4 byte source, 4 byte destination>.
-//   Weighted. Edges are tuples of <4 byte source, 4 byte destination, 4 byte
-//   float typed weight>.
+//   Weighted. Edges are tuples of <4 byte source, 4 byte destination>,
+//   followed by the weights (EDATA_T) of all edges, flagged with CSR_WEIGHTED
+//   in the meta file.
 template <typename GID_T, typename VID_T, typename VDATA_T, typename EDATA_T>
 class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
   using GRAPH_BASE_T = graphs::Graph<GID_T, VID_T, VDATA_T, EDATA_T>;
@@ -47,6 +47,8 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
         tag = ReadEdgeListFromCSV(graph, pt[0], gid, true, separator_params);
         break;
       case weight_edgelist_csv:
+        tag = ParallelReadEdgeListFromCSV(graph, pt[0], gid, separator_params,
+                                          1, true);
         break;
       case edgelist_bin:
         tag = ReadEdgeListFromBin(graph, gid, pt[0], pt[1], pt[2]);
@@ -67,6 +69,10 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
         tag = ParallelReadEdgeListFromCSV(graph, pt[0], gid, separator_params,
                                           cores);
         break;
+      case weight_edgelist_csv:
+        tag = ParallelReadEdgeListFromCSV(graph, pt[0], gid, separator_params,
+                                          cores, true);
+        break;
       default:
         break;
     }
@@ -122,41 +128,35 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
       XLOG(ERR, "segmentation fault: graph is nullptr");
       return false;
     }
-    // auto edge_list = (EDGE_LIST_T*)graph;
-    rapidcsv::Document doc(pt, rapidcsv::LabelParams(-1, -1),
-                           rapidcsv::SeparatorParams(separator_params));
-    std::vector<VID_T> src = doc.GetColumn<VID_T>(0);
-    std::vector<VID_T> dst = doc.GetColumn<VID_T>(1);
-    ((EDGE_LIST_T*)graph)->buf_graph_ =
-        (vid_t*)malloc(sizeof(vid_t) * (src.size() + dst.size()));
-
-    VID_T* buff = (VID_T*)((EDGE_LIST_T*)graph)->buf_graph_;
-    memset((char*)buff, 0, sizeof(VID_T) * (src.size() + dst.size()));
-    LOG_INFO("num edges: ", src.size(), " sizeof(VID_T)", sizeof(VID_T));
-    for (size_t i = 0; i < src.size(); i++) {
-      *((VID_T*)((EDGE_LIST_T*)graph)->buf_graph_ + i * 2) = src.at(i);
-      *((VID_T*)((EDGE_LIST_T*)graph)->buf_graph_ + i * 2 + 1) = dst.at(i);
-    }
+    size_t num_edges = 0;
+    VID_T max_vid = 0;
+    VID_T* buff = nullptr;
+    if (!CSVEdgeParser<VID_T, EDATA_T>(separator_params)
+             .Parse(pt, &buff, &num_edges, &max_vid))
+      return false;
+    ((EDGE_LIST_T*)graph)->buf_graph_ = buff;
+    LOG_INFO("num edges: ", num_edges, " sizeof(VID_T)", sizeof(VID_T));
     if (assemble) {
       std::unordered_map<VID_T, std::vector<VID_T>*> graph_out_edges;
       std::unordered_map<VID_T, std::vector<VID_T>*> graph_in_edges;
 
-      for (size_t i = 0; i < src.size(); i++) {
-        auto iter = graph_out_edges.find(src.at(i));
+      for (size_t i = 0; i < num_edges; i++) {
+        VID_T src = buff[i * 2], dst = buff[i * 2 + 1];
+        auto iter = graph_out_edges.find(src);
         if (iter != graph_out_edges.end()) {
-          iter->second->push_back(dst.at(i));
+          iter->second->push_back(dst);
         } else {
           std::vector<VID_T>* out_edges = new std::vector<VID_T>;
-          out_edges->push_back(dst.at(i));
-          graph_out_edges.insert(std::make_pair(src.at(i), out_edges));
+          out_edges->push_back(dst);
+          graph_out_edges.insert(std::make_pair(src, out_edges));
         }
-        iter = graph_in_edges.find(dst.at(i));
+        iter = graph_in_edges.find(dst);
         if (iter != graph_in_edges.end()) {
-          iter->second->push_back(src.at(i));
+          iter->second->push_back(src);
         } else {
           std::vector<VID_T>* in_edges = new std::vector<VID_T>;
-          in_edges->push_back(src.at(i));
-          graph_in_edges.insert(std::make_pair(dst.at(i), in_edges));
+          in_edges->push_back(src);
+          graph_in_edges.insert(std::make_pair(dst, in_edges));
         }
       }
 
@@ -233,7 +233,7 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     memset(((EDGE_LIST_T*)graph)->vdata_, 0,
            sizeof(VDATA_T) * ((EDGE_LIST_T*)graph)->num_vertexes_);
 
-    ((EDGE_LIST_T*)graph)->num_edges_ = src.size();
+    ((EDGE_LIST_T*)graph)->num_edges_ = num_edges;
     ((EDGE_LIST_T*)graph)->gid_ = gid;
     ((EDGE_LIST_T*)graph)->vertexes_state_ =
         (char*)malloc(sizeof(char) * ((EDGE_LIST_T*)graph)->get_num_vertexes());
@@ -261,6 +261,9 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     memset((char*)meta_buff, 0, sizeof(size_t) * 2);
     meta_file.read((char*)meta_buff, sizeof(size_t) * 2);
     meta_file.read((char*)&edge_list_graph->max_vid_, sizeof(VID_T));
+    // flags are absent in meta files written by older versions.
+    size_t flags = 0;
+    if (!meta_file.read((char*)&flags, sizeof(size_t))) flags = 0;
     edge_list_graph->aligned_max_vid_ =
         ceil(edge_list_graph->max_vid_ / ALIGNMENT_FACTOR) * ALIGNMENT_FACTOR;
 
@@ -269,6 +272,13 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     edge_list_graph->vdata_ = (VDATA_T*)malloc(sizeof(VDATA_T) * meta_buff[0]);
     data_file.read((char*)edge_list_graph->buf_graph_,
                    sizeof(VID_T) * 2 * meta_buff[1]);
+    if (flags & CSR_WEIGHTED) {
+      // weights follow the edges in the data file.
+      edge_list_graph->edata_ =
+          (EDATA_T*)malloc(sizeof(EDATA_T) * meta_buff[1]);
+      data_file.read((char*)edge_list_graph->edata_,
+                     sizeof(EDATA_T) * meta_buff[1]);
+    }
     vdata_file.read((char*)edge_list_graph->vdata_,
                     sizeof(VDATA_T) * meta_buff[0]);
     edge_list_graph->globalid_by_localid_ =
@@ -304,10 +314,12 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     return true;
   }
 
+  // @brief: read <src, dst> edges, or <src, dst, weight> edges if weighted is
+  // true, in which case weights are kept in edata_ of the edge list.
   bool ParallelReadEdgeListFromCSV(
       graphs::Graph<GID_T, VID_T, VDATA_T, EDATA_T>* graph,
       const std::string& pt, const GID_T gid, char separator_params,
-      const size_t cores = 1) {
+      const size_t cores = 1, const bool weighted = false) {
     if (!this->Exist(pt)) {
       XLOG(ERR, "Read file fault: ", pt);
       return false;
@@ -322,38 +334,15 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     std::condition_variable finish_cv;
     std::unique_lock<std::mutex> lck(mtx);
 
-    rapidcsv::Document doc(pt, rapidcsv::LabelParams(-1, -1),
-                           rapidcsv::SeparatorParams(separator_params));
     LOG_INFO("Open ", pt);
-
-    std::vector<VID_T> src = doc.GetColumn<VID_T>(0);
-    std::vector<VID_T> dst = doc.GetColumn<VID_T>(1);
-    graph->buf_graph_ =
-        (VID_T*)malloc(sizeof(VID_T) * (src.size() + dst.size()));
-
-    memset((char*)graph->buf_graph_, 0,
-           sizeof(VID_T) * (src.size() + dst.size()));
-    std::atomic<VID_T> max_vid_atom(0);
-
+    size_t num_edges = 0;
     VID_T max_vid = 0;
-    LOG_INFO("Traverse the entire graph to get the maximum vid.");
-    std::atomic<size_t> pending_packages(cores);
-    for (size_t tid = 0; tid < cores; tid++) {
-      thread_pool.Commit([tid, &cores, &src, &dst, &graph, &pending_packages,
-                          &finish_cv, &max_vid]() {
-        for (size_t j = tid; j < src.size(); j += cores) {
-          *(graph->buf_graph_ + j * 2) = src.at(j);
-          *(graph->buf_graph_ + j * 2 + 1) = dst.at(j);
-          write_max(&max_vid, src.at(j));
-          write_max(&max_vid, dst.at(j));
-        }
-        if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
-        return;
-      });
-    }
-    finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
+    if (!CSVEdgeParser<VID_T, EDATA_T>(separator_params, cores)
+             .Parse(pt, &graph->buf_graph_, &num_edges, &max_vid,
+                    weighted ? &graph->edata_ : nullptr))
+      return false;
 
-    ((EDGE_LIST_T*)graph)->num_edges_ = src.size();
+    ((EDGE_LIST_T*)graph)->num_edges_ = num_edges;
     ((EDGE_LIST_T*)graph)->max_vid_ = max_vid;
     ((EDGE_LIST_T*)graph)->aligned_max_vid_ =
         ceil(max_vid / ALIGNMENT_FACTOR) * ALIGNMENT_FACTOR;
@@ -363,8 +352,8 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     Bitmap* vertex_indicator = new Bitmap(graph->get_aligned_max_vid());
     vertex_indicator->clear();
 
-    LOG_INFO("Traverse the entire graph again to fill the vertex_indicator.");
-    pending_packages.store(cores);
+    LOG_INFO("Traverse the entire graph to fill the vertex_indicator.");
+    std::atomic<size_t> pending_packages(cores);
     for (size_t i = 0; i < cores; i++) {
       size_t tid = i;
       thread_pool.Commit([tid, &cores, &graph, &vertex_indicator,
@@ -415,10 +404,15 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     meta_buff[0] = ((EDGE_LIST_T*)&graph)->num_vertexes_;
     meta_buff[1] = ((EDGE_LIST_T*)&graph)->num_edges_;
 
+    size_t flags = graph.IsWeighted() ? CSR_WEIGHTED : 0;
     meta_file.write((char*)meta_buff, 2 * sizeof(size_t));
     meta_file.write((char*)&graph.max_vid_, sizeof(VID_T));
+    meta_file.write((char*)&flags, sizeof(size_t));
     data_file.write((char*)((EDGE_LIST_T*)&graph)->buf_graph_,
                     sizeof(VID_T) * 2 * ((EDGE_LIST_T*)&graph)->num_edges_);
+    if (graph.IsWeighted())
+      data_file.write((char*)graph.edata_,
+                      sizeof(EDATA_T) * ((EDGE_LIST_T*)&graph)->num_edges_);
 
     LOG_INFO("VID_T size: ", sizeof(VID_T));
     if ((char*)((EDGE_LIST_T*)&graph)->vdata_ != nullptr)
@@ -469,38 +463,19 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     memset((char*)offset_edges_bucket, 0, sizeof(size_t) * (1 + files.size()));
 
     VID_T max_vid = 0;
-    std::atomic<VID_T> max_vid_atom(0);
+    CSVEdgeParser<VID_T, EDATA_T> parser(separator_params, cores);
     for (auto pi = 0; pi < files.size(); pi++) {
       LOG_INFO("Process ", files.at(pi));
-      rapidcsv::Document doc(files.at(pi), rapidcsv::LabelParams(-1, -1),
-                             rapidcsv::SeparatorParams(separator_params));
-      std::vector<VID_T> src = doc.GetColumn<VID_T>(0);
-      std::vector<VID_T> dst = doc.GetColumn<VID_T>(1);
-      VID_T* buff = (vid_t*)malloc(sizeof(vid_t) * (src.size() + dst.size()));
-      memset((char*)buff, 0, sizeof(VID_T) * (src.size() + dst.size()));
-      buf_graph_bucket_[pi] = buff;
-
-      std::atomic<size_t> pending_packages(cores);
-
-      for (size_t i = 0; i < cores; i++) {
-        size_t tid = i;
-        thread_pool.Commit([tid, &cores, &src, &dst, &graph, &pending_packages,
-                            &finish_cv, &max_vid, &buff]() {
-          for (size_t j = tid; j < src.size(); j += cores) {
-            if (src.at(j) == dst.at(j)) continue;
-            *(buff + j * 2) = src.at(j);
-            *(buff + j * 2 + 1) = dst.at(j);
-            write_max(&max_vid, src.at(j));
-            write_max(&max_vid, dst.at(j));
-          }
-          if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
-          return;
-        });
-      }
-      finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
-      ((EDGE_LIST_T*)graph)->num_edges_ += src.size();
-      num_edges_bucket[pi] = src.size();
-      offset_edges_bucket[pi + 1] = src.size();
+      VID_T file_max_vid = 0;
+      // Self loops are dropped.
+      if (!parser.Parse(files.at(pi), &buf_graph_bucket_[pi],
+                        &num_edges_bucket[pi], &file_max_vid, nullptr,
+                        true))
+        return false;
+      max_vid = std::max(max_vid, file_max_vid);
+      ((EDGE_LIST_T*)graph)->num_edges_ += num_edges_bucket[pi];
+      offset_edges_bucket[pi + 1] =
+          offset_edges_bucket[pi] + num_edges_bucket[pi];
     }
 
     ((EDGE_LIST_T*)graph)->buf_graph_ =
@@ -512,7 +487,11 @@ class EdgeListIOAdapter : public IOAdapterBase<GID_T, VID_T, VDATA_T, EDATA_T> {
     for (size_t pi = 0; pi < files.size(); pi++) {
       memcpy(((EDGE_LIST_T*)graph)->buf_graph_ + offset_edges_bucket[pi] * 2,
              buf_graph_bucket_[pi], num_edges_bucket[pi] * 2 * sizeof(VID_T));
+      free(buf_graph_bucket_[pi]);
     }
+    free(buf_graph_bucket_);
+    free(num_edges_bucket);
+    free(offset_edges_bucket);
 
     ((EDGE_LIST_T*)graph)->max_vid_ = max_vid;
     ((EDGE_LIST_T*)graph)->aligned_max_vid_ =
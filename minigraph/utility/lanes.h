@@ -0,0 +1,151 @@
+#ifndef MINIGRAPH_UTILITY_LANES_H
+#define MINIGRAPH_UTILITY_LANES_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <fstream>
+#include <string>
+
+#include "utility/logging.h"
+#include "utility/memory.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Rows of lanes are padded to a multiple of this number of 32-bit values,
+// i.e. one AVX2 register, so that operations on rows have no tail.
+#define LANE_WIDTH 8
+
+namespace minigraph {
+namespace utility {
+
+// @brief: operations on rows of n lanes, e.g. the values of a vertex for each
+// query of a batch. n is a multiple of LANE_WIDTH.
+
+// @brief: dst += a * src.
+inline void LaneAxpy(float* dst, const float a, const float* src,
+                     const size_t n) {
+#if defined(__AVX2__)
+  const __m256 va = _mm256_set1_ps(a);
+  for (size_t k = 0; k < n; k += 8) {
+    __m256 vd = _mm256_loadu_ps(dst + k);
+    __m256 vs = _mm256_loadu_ps(src + k);
+    _mm256_storeu_ps(dst + k, _mm256_add_ps(vd, _mm256_mul_ps(va, vs)));
+  }
+#else
+  for (size_t k = 0; k < n; k++) dst[k] += a * src[k];
+#endif
+}
+
+// @brief: dst = a * src.
+inline void LaneScale(float* dst, const float a, const float* src,
+                      const size_t n) {
+#if defined(__AVX2__)
+  const __m256 va = _mm256_set1_ps(a);
+  for (size_t k = 0; k < n; k += 8)
+    _mm256_storeu_ps(dst + k, _mm256_mul_ps(va, _mm256_loadu_ps(src + k)));
+#else
+  for (size_t k = 0; k < n; k++) dst[k] = a * src[k];
+#endif
+}
+
+// @brief: max |a - b| over lanes.
+inline float LaneMaxAbsDiff(const float* a, const float* b, const size_t n) {
+  float out = 0;
+#if defined(__AVX2__)
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  __m256 vmax = _mm256_setzero_ps();
+  for (size_t k = 0; k < n; k += 8) {
+    __m256 diff =
+        _mm256_sub_ps(_mm256_loadu_ps(a + k), _mm256_loadu_ps(b + k));
+    vmax = _mm256_max_ps(vmax, _mm256_andnot_ps(sign, diff));
+  }
+  float buf[8];
+  _mm256_storeu_ps(buf, vmax);
+  for (size_t k = 0; k < 8; k++) out = buf[k] > out ? buf[k] : out;
+#else
+  for (size_t k = 0; k < n; k++) out = fmaxf(out, fabsf(a[k] - b[k]));
+#endif
+  return out;
+}
+
+// @brief: dst = min(dst, src + inc), e.g. hop distances of a batch of BFS.
+// src + inc must not overflow.
+// @return: whether any lane of dst is lowered.
+inline bool LaneMinPlus(uint32_t* dst, const uint32_t* src, const uint32_t inc,
+                        const size_t n) {
+  bool changed = false;
+#if defined(__AVX2__)
+  const __m256i vinc = _mm256_set1_epi32(inc);
+  for (size_t k = 0; k < n; k += 8) {
+    __m256i vd = _mm256_loadu_si256((const __m256i*)(dst + k));
+    __m256i vs = _mm256_add_epi32(
+        _mm256_loadu_si256((const __m256i*)(src + k)), vinc);
+    __m256i vmin = _mm256_min_epu32(vd, vs);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(vmin, vd)) != -1) {
+      _mm256_storeu_si256((__m256i*)(dst + k), vmin);
+      changed = true;
+    }
+  }
+#else
+  for (size_t k = 0; k < n; k++) {
+    if (src[k] + inc < dst[k]) {
+      dst[k] = src[k] + inc;
+      changed = true;
+    }
+  }
+#endif
+  return changed;
+}
+
+// @brief: LanesArray holds a row of lanes for each vertex by global id, e.g.
+// the vdata of a batch of queries that share fragment loads.
+template <typename T>
+class LanesArray {
+  static_assert(sizeof(T) == 4, "lanes are 32-bit values");
+
+ public:
+  LanesArray(const size_t num_vertexes, const size_t num_lanes,
+             const T init) {
+    num_vertexes_ = num_vertexes;
+    num_lanes_ = num_lanes;
+    stride_ = (num_lanes + LANE_WIDTH - 1) / LANE_WIDTH * LANE_WIDTH;
+    buf_ = (T*)HugePageAlloc(sizeof(T) * stride_ * num_vertexes_);
+    for (size_t i = 0; i < stride_ * num_vertexes_; i++) buf_[i] = init;
+  }
+
+  ~LanesArray() { free(buf_); }
+
+  T* operator[](const size_t globalid) { return buf_ + stride_ * globalid; }
+
+  size_t get_num_vertexes() const { return num_vertexes_; }
+  size_t get_num_lanes() const { return num_lanes_; }
+  size_t get_stride() const { return stride_; }
+
+  // @brief: write num_lanes values of each vertex in order of global ids,
+  // padding lanes are dropped.
+  bool Write(const std::string& pt) {
+    std::ofstream file(pt, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!file) {
+      XLOG(ERR, "Open file failed: ", pt);
+      return false;
+    }
+    for (size_t i = 0; i < num_vertexes_; i++)
+      file.write((char*)(buf_ + stride_ * i), sizeof(T) * num_lanes_);
+    file.close();
+    return true;
+  }
+
+ private:
+  size_t num_vertexes_ = 0;
+  size_t num_lanes_ = 0;
+  size_t stride_ = 0;
+  T* buf_ = nullptr;
+};
+
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_LANES_H
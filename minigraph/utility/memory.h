@@ -0,0 +1,38 @@
+#ifndef MINIGRAPH_UTILITY_MEMORY_H
+#define MINIGRAPH_UTILITY_MEMORY_H
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#ifdef USE_NUMA
+#include <numa.h>
+#endif
+
+#define HUGE_PAGE_SIZE (2ul << 20)
+
+namespace minigraph {
+namespace utility {
+
+// @brief: allocate a large buffer, e.g. topology, vdata or a bitmap.
+// Buffers of at least one huge page are aligned to huge pages and advised
+// with MADV_HUGEPAGE, so that they are backed by transparent huge pages.
+// With USE_NUMA, their pages are interleaved over all NUMA nodes before the
+// first touch: threads of a TaskRunner are spread over every socket, and the
+// loading thread would otherwise pull the whole buffer to its own node.
+// @note: the buffer is released by free().
+inline void* HugePageAlloc(const size_t size) {
+  if (size < HUGE_PAGE_SIZE) return malloc(size);
+  void* buf = nullptr;
+  size_t aligned_size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+  if (posix_memalign(&buf, HUGE_PAGE_SIZE, aligned_size) != 0) return nullptr;
+  madvise(buf, aligned_size, MADV_HUGEPAGE);
+#ifdef USE_NUMA
+  if (numa_available() >= 0 && numa_num_configured_nodes() > 1)
+    numa_interleave_memory(buf, aligned_size, numa_all_nodes_ptr);
+#endif
+  return buf;
+}
+
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_MEMORY_H
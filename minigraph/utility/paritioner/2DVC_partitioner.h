@@ -47,6 +47,11 @@ class TwoDVCPartitioner : public PartitionerBase<GRAPH_T> {
                          bool delete_graph = false) override {
     LOG_INFO("ParallelPartition(): 2DVC ", num_partitions, " x ",
              num_partitions);
+    if (edgelist_graph->IsWeighted()) {
+      XLOG(ERR, "Edge weights are not kept by this partitioner, use edgecut "
+                "or vertexcut for weighted graphs.");
+      return false;
+    }
 
     minigraph::utility::io::CSRIOAdapter<GID_T, VID_T, VDATA_T, EDATA_T>
         csr_io_adapter;
@@ -221,6 +226,8 @@ class TwoDVCPartitioner : public PartitionerBase<GRAPH_T> {
             csr_io_adapter.EdgeList2CSR(gid, edgelist_graph, cores);
         delete edgelist_graph;
         csr_graph->Sort(cores);
+        this->ReorderFragment(csr_graph, cores);
+        this->CompressFragment(csr_graph);
         free(edges_2d_buckets[two_d_bid]);
         csr_graph->InitVdata2AllX(0);
         if (!delete_graph) {
@@ -42,6 +42,11 @@ class HybridCutPartitioner : public PartitionerBase<GRAPH_T> {
                          const size_t cores = 1, const std::string dst_pt = "",
                          bool delete_graph = false) override {
     LOG_INFO("ParallelPartition(): HybridCut");
+    if (edgelist_graph->IsWeighted()) {
+      XLOG(ERR, "Edge weights are not kept by this partitioner, use edgecut "
+                "or vertexcut for weighted graphs.");
+      return false;
+    }
 
     auto thread_pool = CPUThreadPool(cores, 1);
     std::mutex mtx;
@@ -255,6 +260,9 @@ class HybridCutPartitioner : public PartitionerBase<GRAPH_T> {
     this->global_border_vid_map_->clear();
     for (auto& iter_fragments : *this->fragments_) {
       auto fragment = (CSR_T*)iter_fragments;
+      if (!fragment->IsSorted()) fragment->Sort(cores);
+      this->ReorderFragment(fragment, cores, this->vid_map_);
+      this->CompressFragment(fragment);
       fragment->InitVdata2AllX(0);
       fragment->SetGlobalBorderVidMap(this->global_border_vid_map_,
                                       is_in_bucketX,
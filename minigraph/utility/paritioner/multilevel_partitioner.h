@@ -0,0 +1,566 @@
+#ifndef MINIGRAPH_UTILITY_MULTILEVEL_PARTITIONER_H
+#define MINIGRAPH_UTILITY_MULTILEVEL_PARTITIONER_H
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graphs/csr_builder.h"
+#include "portability/sys_types.h"
+#include "utility/atomic.h"
+#include "utility/bitmap.h"
+#include "utility/io/csr_io_adapter.h"
+#include "utility/io/data_mngr.h"
+#include "utility/paritioner/partitioner_base.h"
+#include "utility/thread_pool.h"
+
+namespace minigraph {
+namespace utility {
+namespace partitioner {
+
+// MultilevelPartitioner is an edgecut partitioner in the spirit of METIS.
+// The graph, taken as undirected, is coarsened by heavy-edge matching until
+// a few dozen vertexes per fragment are left, the coarsest graph is split by
+// greedy graph growing, and the split is projected back level by level and
+// refined by size-constrained label propagation on each of them. A vertex
+// weighs one plus its in- and out-degree and no fragment may weigh more
+// than slack times the average, so fragments hold about as many edges each
+// while few edges, and hence few border vertexes, cross fragments.
+template <typename GRAPH_T>
+class MultilevelPartitioner : public PartitionerBase<GRAPH_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using CSR_T = graphs::ImmutableCSR<GID_T, VID_T, VDATA_T, EDATA_T>;
+  using EDGE_LIST_T =
+      minigraph::graphs::EdgeList<gid_t, vid_t, vdata_t, edata_t>;
+
+  // Undirected graph of one level with weighted vertexes and edges.
+  struct Level {
+    size_t num_vertexes = 0;
+    std::vector<size_t> offset;
+    std::vector<VID_T> adj;
+    std::vector<size_t> adj_weight;
+    std::vector<size_t> vertex_weight;
+    // The vertex of the next coarser level each vertex is merged into.
+    std::vector<VID_T> coarse_id;
+  };
+
+ public:
+  MultilevelPartitioner(const double slack = 1.1, const size_t seed = 0) {
+    slack_ = slack;
+    seed_ = seed;
+  }
+  ~MultilevelPartitioner() = default;
+
+  bool ParallelPartition(EDGE_LIST_T* edgelist_graph,
+                         const size_t num_partitions = 1,
+                         const size_t cores = 1, const std::string dst_pt = "",
+                         bool delete_graph = false) override {
+    LOG_INFO("ParallelPartition(): Multilevel");
+    minigraph::utility::io::DataMngr<CSR_T> data_mngr;
+    cores_ = std::max((size_t)1, cores);
+    thread_pool_ = std::make_unique<CPUThreadPool>(cores_, 1);
+    this->max_vid_ = edgelist_graph->get_max_vid();
+    this->aligned_max_vid_ =
+        ceil((this->max_vid_ + 1) / ALIGNMENT_FACTOR) * ALIGNMENT_FACTOR;
+    this->num_vertexes_ = edgelist_graph->get_num_vertexes();
+    this->num_edges_ = edgelist_graph->get_num_edges();
+    this->num_partitions = num_partitions;
+    this->global_border_vid_map_ = new Bitmap(this->aligned_max_vid_);
+    this->global_border_vid_map_->clear();
+    this->vid_map_ = (VID_T*)malloc(sizeof(VID_T) * this->aligned_max_vid_);
+    memset(this->vid_map_, 0, sizeof(VID_T) * this->aligned_max_vid_);
+    this->communication_matrix_ =
+        (bool*)malloc(sizeof(bool) * num_partitions * num_partitions);
+    memset(this->communication_matrix_, 0,
+           sizeof(bool) * num_partitions * num_partitions);
+
+    LOG_INFO("Run: Join edges");
+    bool weighted = edgelist_graph->IsWeighted();
+    JoinEdges(edgelist_graph);
+
+    LOG_INFO("Run: Coarsen");
+    std::vector<Level> levels(1);
+    std::vector<VID_T> vid_by_index;
+    BuildFinestLevel(&levels[0], &vid_by_index);
+    size_t total_weight = 0;
+    for (auto w : levels[0].vertex_weight) total_weight += w;
+    capacity_ = std::max((size_t)1, (size_t)ceil(slack_ * total_weight /
+                                                 num_partitions));
+    max_vertex_weight_ = std::max(
+        (size_t)1, (size_t)(1.5 * total_weight /
+                            (kCoarsestSize * num_partitions)));
+    while (num_partitions > 1 &&
+           levels.back().num_vertexes > kCoarsestSize * num_partitions) {
+      Level coarse;
+      if (!Coarsen(&levels.back(), &coarse)) break;
+      levels.push_back(std::move(coarse));
+      LOG_INFO("  level: ", levels.size() - 1,
+               " num_vertexes: ", levels.back().num_vertexes,
+               " num_edges: ", levels.back().adj.size() / 2);
+    }
+
+    LOG_INFO("Run: Initial partition and refine, capacity: ", capacity_);
+    std::vector<GID_T> gid_by_index =
+        InitialPartition(levels.back(), num_partitions);
+    Refine(levels.back(), num_partitions, &gid_by_index);
+    while (levels.size() > 1) {
+      levels.pop_back();
+      auto& fine = levels.back();
+      std::vector<GID_T> fine_gid(fine.num_vertexes);
+      thread_pool_->ParallelFor(fine.num_vertexes, [&](size_t tid, size_t u) {
+        fine_gid[u] = gid_by_index[fine.coarse_id[u]];
+      });
+      gid_by_index.swap(fine_gid);
+      Refine(fine, num_partitions, &gid_by_index);
+    }
+
+    gid_by_vid_.assign(this->aligned_max_vid_, GID_MAX);
+    for (size_t u = 0; u < vid_by_index.size(); u++)
+      gid_by_vid_[vid_by_index[u]] = gid_by_index[u];
+    std::vector<Level>().swap(levels);
+
+    LOG_INFO("Run: Set communication matrix and global_border_vid_map");
+    std::vector<size_t> cut(cores_, 0);
+    thread_pool_->ParallelFor(
+        this->aligned_max_vid_, [&](size_t tid, size_t u) {
+          GID_T gid = gid_by_vid_[u];
+          if (gid == GID_MAX) return;
+          for (size_t k = out_offset_[u]; k < out_offset_[u + 1]; k++) {
+            GID_T dst_gid = gid_by_vid_[out_edges_[k]];
+            if (dst_gid == gid) continue;
+            ++cut[tid];
+            this->global_border_vid_map_->set_bit(u);
+            this->global_border_vid_map_->set_bit(out_edges_[k]);
+            this->communication_matrix_[gid * num_partitions + dst_gid] = 1;
+            this->communication_matrix_[dst_gid * num_partitions + gid] = 1;
+          }
+        });
+    size_t sum_cut = 0;
+    for (auto c : cut) sum_cut += c;
+    LOG_INFO("  cut edges: ", sum_cut, " of ", out_edges_.size());
+
+    ReleaseEdges();
+
+    LOG_INFO("Run: Construct sub-graphs");
+    graphs::CSRBuilder<GID_T, VID_T, VDATA_T, EDATA_T> csr_builder(cores_,
+                                                                   true, true);
+    auto fragments = csr_builder.Build(
+        edgelist_graph->buf_graph_,
+        weighted ? edgelist_graph->edata_ : nullptr,
+        edgelist_graph->get_num_edges(), this->max_vid_,
+        [this](VID_T vid) { return gid_by_vid_[vid]; }, num_partitions,
+        this->vid_map_);
+    if (delete_graph) delete edgelist_graph;
+    // csr_bin fragments can't be empty, and every gid of the communication
+    // matrix needs one.
+    for (GID_T gid = 0; gid < num_partitions; gid++) {
+      if (fragments[gid] != nullptr) continue;
+      XLOG(ERR, "Empty fragment: ", gid, ", partition into fewer fragments.");
+      for (auto graph : fragments) delete graph;
+      std::vector<GID_T>().swap(gid_by_vid_);
+      thread_pool_.reset();
+      return false;
+    }
+    for (GID_T gid = 0; gid < num_partitions; gid++) {
+      auto graph = fragments[gid];
+      LOG_INFO("  GID: ", gid, " num_vertexes: ", graph->get_num_vertexes(),
+               " sum_in_edges: ", graph->get_num_in_edges(),
+               " sum_out_edges: ", graph->get_num_out_edges());
+      this->ReorderFragment(graph, cores_, this->vid_map_);
+      this->CompressFragment(graph);
+      if (!delete_graph) {
+        this->fragments_->push_back((graphs::Graph<GID_T, VID_T, VDATA_T,
+                                                   EDATA_T>*)graph);
+        continue;
+      }
+      std::string meta_pt =
+          dst_pt + "minigraph_meta/" + std::to_string(gid) + ".bin";
+      std::string data_pt =
+          dst_pt + "minigraph_data/" + std::to_string(gid) + ".bin";
+      std::string vdata_pt =
+          dst_pt + "minigraph_vdata/" + std::to_string(gid) + ".bin";
+      data_mngr.csr_io_adapter_->Write(*graph, csr_bin, false, meta_pt,
+                                       data_pt, vdata_pt);
+      StatisticInfo&& si = this->ParallelSetStatisticInfo(*graph, cores_);
+      std::string si_pt =
+          dst_pt + "minigraph_si/" + std::to_string(gid) + ".yaml";
+      data_mngr.WriteStatisticInfo(si, si_pt);
+      delete graph;
+    }
+
+    std::vector<GID_T>().swap(gid_by_vid_);
+    thread_pool_.reset();
+    return true;
+  }
+
+ private:
+  // Vertexes per fragment at which coarsening stops.
+  static const size_t kCoarsestSize = 32;
+  static const size_t kMatchRounds = 3;
+  static const size_t kInitTries = 4;
+  static const size_t kRefineRounds = 8;
+
+  static size_t Mix(size_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // @brief: bucket the edges, but self loops, by source and by destination.
+  void JoinEdges(EDGE_LIST_T* edgelist_graph) {
+    size_t num_edges = edgelist_graph->get_num_edges();
+    auto buf_graph = edgelist_graph->buf_graph_;
+    out_offset_.assign(this->aligned_max_vid_ + 1, 0);
+    in_offset_.assign(this->aligned_max_vid_ + 1, 0);
+    thread_pool_->ParallelFor(num_edges, [&](size_t tid, size_t j) {
+      VID_T src = buf_graph[2 * j], dst = buf_graph[2 * j + 1];
+      if (src == dst) return;
+      write_add(&out_offset_[src + 1], (size_t)1);
+      write_add(&in_offset_[dst + 1], (size_t)1);
+    });
+    for (size_t i = 0; i < this->aligned_max_vid_; i++) {
+      out_offset_[i + 1] += out_offset_[i];
+      in_offset_[i + 1] += in_offset_[i];
+    }
+    size_t sum_edges = out_offset_[this->aligned_max_vid_];
+    out_edges_.resize(sum_edges);
+    in_edges_.resize(sum_edges);
+    std::vector<size_t> out_fill(out_offset_.begin(), out_offset_.end() - 1);
+    std::vector<size_t> in_fill(in_offset_.begin(), in_offset_.end() - 1);
+    thread_pool_->ParallelFor(num_edges, [&](size_t tid, size_t j) {
+      VID_T src = buf_graph[2 * j], dst = buf_graph[2 * j + 1];
+      if (src == dst) return;
+      out_edges_[__sync_fetch_and_add(&out_fill[src], 1)] = dst;
+      in_edges_[__sync_fetch_and_add(&in_fill[dst], 1)] = src;
+    });
+  }
+
+  void ReleaseEdges() {
+    std::vector<size_t>().swap(out_offset_);
+    std::vector<size_t>().swap(in_offset_);
+    std::vector<VID_T>().swap(out_edges_);
+    std::vector<VID_T>().swap(in_edges_);
+  }
+
+  // @brief: the undirected graph over vertexes with at least one edge,
+  // vid_by_index maps its vertexes back to global ids.
+  void BuildFinestLevel(Level* level, std::vector<VID_T>* vid_by_index) {
+    std::vector<VID_T> index_by_vid(this->aligned_max_vid_, VID_MAX);
+    for (VID_T vid = 0; vid < this->aligned_max_vid_; vid++) {
+      if (out_offset_[vid] == out_offset_[vid + 1] &&
+          in_offset_[vid] == in_offset_[vid + 1])
+        continue;
+      index_by_vid[vid] = vid_by_index->size();
+      vid_by_index->push_back(vid);
+    }
+    size_t n = vid_by_index->size();
+    level->num_vertexes = n;
+    level->vertex_weight.resize(n);
+    std::vector<size_t> bound(n);
+    thread_pool_->ParallelFor(n, [&](size_t tid, size_t u) {
+      VID_T vid = vid_by_index->at(u);
+      bound[u] = out_offset_[vid + 1] - out_offset_[vid] +
+                 in_offset_[vid + 1] - in_offset_[vid];
+      level->vertex_weight[u] = 1 + bound[u];
+    });
+    BuildAdjacency(
+        bound,
+        [&](size_t u, std::vector<std::pair<VID_T, size_t>>* nbrs) {
+          VID_T vid = vid_by_index->at(u);
+          for (size_t k = out_offset_[vid]; k < out_offset_[vid + 1]; k++)
+            nbrs->emplace_back(index_by_vid[out_edges_[k]], 1);
+          for (size_t k = in_offset_[vid]; k < in_offset_[vid + 1]; k++)
+            nbrs->emplace_back(index_by_vid[in_edges_[k]], 1);
+        },
+        level);
+  }
+
+  // @brief: fill the adjacency of level by gather(u, nbrs), which appends at
+  // most bound[u] (neighbor, weight) pairs of u. Pairs of the same neighbor
+  // are merged and u itself is dropped.
+  template <typename F>
+  void BuildAdjacency(const std::vector<size_t>& bound, F gather,
+                      Level* level) {
+    size_t n = level->num_vertexes;
+    std::vector<size_t> slot(n + 1, 0);
+    for (size_t u = 0; u < n; u++) slot[u + 1] = slot[u] + bound[u];
+    std::vector<VID_T> adj(slot[n]);
+    std::vector<size_t> adj_weight(slot[n]);
+    std::vector<size_t> degree(n, 0);
+    std::vector<std::vector<std::pair<VID_T, size_t>>> nbrs_by_tid(cores_);
+    thread_pool_->ParallelFor(n, [&](size_t tid, size_t u) {
+      auto& nbrs = nbrs_by_tid[tid];
+      nbrs.clear();
+      gather(u, &nbrs);
+      std::sort(nbrs.begin(), nbrs.end());
+      size_t k = slot[u];
+      for (auto& nbr : nbrs) {
+        if (nbr.first == u) continue;
+        if (k > slot[u] && adj[k - 1] == nbr.first) {
+          adj_weight[k - 1] += nbr.second;
+        } else {
+          adj[k] = nbr.first;
+          adj_weight[k++] = nbr.second;
+        }
+      }
+      degree[u] = k - slot[u];
+    });
+    level->offset.assign(n + 1, 0);
+    for (size_t u = 0; u < n; u++)
+      level->offset[u + 1] = level->offset[u] + degree[u];
+    level->adj.resize(level->offset[n]);
+    level->adj_weight.resize(level->offset[n]);
+    thread_pool_->ParallelFor(n, [&](size_t tid, size_t u) {
+      memcpy(level->adj.data() + level->offset[u], adj.data() + slot[u],
+             sizeof(VID_T) * degree[u]);
+      memcpy(level->adj_weight.data() + level->offset[u],
+             adj_weight.data() + slot[u], sizeof(size_t) * degree[u]);
+    });
+  }
+
+  // @brief: merge pairs of vertexes of fine matched along heavy edges into
+  // coarse. In each round every unmatched vertex proposes to its heaviest
+  // unmatched neighbor and mutual proposals are matched.
+  // @return: false if the graph would hardly shrink.
+  bool Coarsen(Level* fine, Level* coarse) {
+    size_t n = fine->num_vertexes;
+    std::vector<VID_T> match(n, VID_MAX);
+    std::vector<VID_T> proposal(n, VID_MAX);
+    for (size_t round = 0; round < kMatchRounds; round++) {
+      thread_pool_->ParallelFor(n, [&](size_t tid, size_t u) {
+        proposal[u] = VID_MAX;
+        if (match[u] != VID_MAX) return;
+        size_t best_weight = 0, best_key = 0;
+        for (size_t k = fine->offset[u]; k < fine->offset[u + 1]; k++) {
+          VID_T v = fine->adj[k];
+          if (match[v] != VID_MAX ||
+              fine->vertex_weight[u] + fine->vertex_weight[v] >
+                  max_vertex_weight_)
+            continue;
+          size_t key = Mix(seed_ + round * n + v);
+          if (fine->adj_weight[k] > best_weight ||
+              (fine->adj_weight[k] == best_weight && key > best_key)) {
+            proposal[u] = v;
+            best_weight = fine->adj_weight[k];
+            best_key = key;
+          }
+        }
+      });
+      thread_pool_->ParallelFor(n, [&](size_t tid, size_t u) {
+        VID_T v = proposal[u];
+        if (v != VID_MAX && proposal[v] == u) match[u] = v;
+      });
+    }
+
+    std::vector<VID_T> leaders;
+    fine->coarse_id.resize(n);
+    for (VID_T u = 0; u < n; u++) {
+      if (match[u] == VID_MAX) match[u] = u;
+      if (match[u] < u) continue;
+      fine->coarse_id[u] = leaders.size();
+      leaders.push_back(u);
+    }
+    if (leaders.size() > 0.95 * n) {
+      std::vector<VID_T>().swap(fine->coarse_id);
+      return false;
+    }
+    thread_pool_->ParallelFor(n, [&](size_t tid, size_t u) {
+      if (match[u] < u) fine->coarse_id[u] = fine->coarse_id[match[u]];
+    });
+
+    size_t cn = leaders.size();
+    coarse->num_vertexes = cn;
+    coarse->vertex_weight.resize(cn);
+    std::vector<size_t> bound(cn);
+    thread_pool_->ParallelFor(cn, [&](size_t tid, size_t c) {
+      VID_T u = leaders[c], v = match[u];
+      coarse->vertex_weight[c] = fine->vertex_weight[u];
+      bound[c] = fine->offset[u + 1] - fine->offset[u];
+      if (v == u) return;
+      coarse->vertex_weight[c] += fine->vertex_weight[v];
+      bound[c] += fine->offset[v + 1] - fine->offset[v];
+    });
+    BuildAdjacency(
+        bound,
+        [&](size_t c, std::vector<std::pair<VID_T, size_t>>* nbrs) {
+          VID_T u = leaders[c], v = match[u];
+          for (size_t k = fine->offset[u]; k < fine->offset[u + 1]; k++)
+            nbrs->emplace_back(fine->coarse_id[fine->adj[k]],
+                               fine->adj_weight[k]);
+          if (v == u) return;
+          for (size_t k = fine->offset[v]; k < fine->offset[v + 1]; k++)
+            nbrs->emplace_back(fine->coarse_id[fine->adj[k]],
+                               fine->adj_weight[k]);
+        },
+        coarse);
+    return true;
+  }
+
+  // @brief: grow fragments one by one from a random vertex, each time taking
+  // the frontier vertex with the heaviest edges into the fragment, until it
+  // weighs 1/k of the graph. The last fragment takes what is left. The try
+  // with the least cut among those within capacity is kept.
+  std::vector<GID_T> InitialPartition(const Level& level,
+                                      const size_t num_partitions) {
+    size_t n = level.num_vertexes;
+    size_t total_weight = 0;
+    for (auto w : level.vertex_weight) total_weight += w;
+    size_t target = ceil((double)total_weight / num_partitions);
+    std::vector<GID_T> best(n, 0);
+    size_t best_cut = 0, best_max_load = 0;
+    if (num_partitions <= 1 || n == 0) return best;
+
+    std::vector<size_t> conn(n, 0);
+    for (size_t t = 0; t < kInitTries; t++) {
+      std::mt19937_64 rng(seed_ + t);
+      std::vector<GID_T> gid_by_index(n, GID_MAX);
+      size_t max_load = 0;
+      for (GID_T gid = 0; gid + 1 < num_partitions; gid++) {
+        size_t load = 0;
+        std::priority_queue<std::pair<size_t, VID_T>> frontier;
+        std::vector<VID_T> touched;
+        while (load < target) {
+          VID_T u = VID_MAX;
+          while (!frontier.empty() && u == VID_MAX) {
+            auto top = frontier.top();
+            frontier.pop();
+            if (gid_by_index[top.second] == GID_MAX &&
+                conn[top.second] == top.first)
+              u = top.second;
+          }
+          if (u == VID_MAX) {
+            size_t start = rng() % n;
+            for (size_t i = 0; i < n && u == VID_MAX; i++)
+              if (gid_by_index[(start + i) % n] == GID_MAX)
+                u = (start + i) % n;
+          }
+          if (u == VID_MAX) break;
+          gid_by_index[u] = gid;
+          load += level.vertex_weight[u];
+          for (size_t k = level.offset[u]; k < level.offset[u + 1]; k++) {
+            VID_T v = level.adj[k];
+            if (gid_by_index[v] != GID_MAX) continue;
+            if (conn[v] == 0) touched.push_back(v);
+            conn[v] += level.adj_weight[k];
+            frontier.emplace(conn[v], v);
+          }
+        }
+        for (auto v : touched) conn[v] = 0;
+        max_load = std::max(max_load, load);
+      }
+      size_t load = 0;
+      for (size_t u = 0; u < n; u++) {
+        if (gid_by_index[u] != GID_MAX) continue;
+        gid_by_index[u] = num_partitions - 1;
+        load += level.vertex_weight[u];
+      }
+      max_load = std::max(max_load, load);
+
+      size_t cut = 0;
+      for (size_t u = 0; u < n; u++)
+        for (size_t k = level.offset[u]; k < level.offset[u + 1]; k++)
+          if (gid_by_index[level.adj[k]] != gid_by_index[u])
+            cut += level.adj_weight[k];
+      bool fit = max_load <= capacity_, best_fit = best_max_load <= capacity_;
+      if (t == 0 || (fit && (!best_fit || cut < best_cut)) ||
+          (!fit && !best_fit && max_load < best_max_load)) {
+        best.swap(gid_by_index);
+        best_cut = cut;
+        best_max_load = max_load;
+      }
+    }
+    return best;
+  }
+
+  // @brief: move vertexes to the fragment most of their edges go to, as
+  // long as it has room, and out of fragments above capacity.
+  void Refine(const Level& level, const size_t num_partitions,
+              std::vector<GID_T>* gid_by_index) {
+    size_t n = level.num_vertexes;
+    auto& gids = *gid_by_index;
+    std::vector<size_t> load(num_partitions, 0);
+    for (size_t u = 0; u < n; u++) load[gids[u]] += level.vertex_weight[u];
+    std::vector<std::vector<size_t>> conn_by_tid(
+        cores_, std::vector<size_t>(num_partitions, 0));
+    std::vector<std::vector<GID_T>> touched_by_tid(cores_);
+    for (size_t round = 0; round < kRefineRounds; round++) {
+      std::vector<size_t> num_moves(cores_, 0);
+      thread_pool_->ParallelFor(n, [&](size_t tid, size_t u) {
+        auto& conn = conn_by_tid[tid];
+        auto& touched = touched_by_tid[tid];
+        GID_T from = gids[u];
+        size_t w = level.vertex_weight[u];
+        for (size_t k = level.offset[u]; k < level.offset[u + 1]; k++) {
+          GID_T gid = gids[level.adj[k]];
+          if (conn[gid] == 0) touched.push_back(gid);
+          conn[gid] += level.adj_weight[k];
+        }
+        bool overloaded = load[from] > capacity_;
+        GID_T to = GID_MAX;
+        for (auto gid : touched) {
+          if (gid == from || load[gid] + w > capacity_) continue;
+          if (to == GID_MAX || conn[gid] > conn[to] ||
+              (conn[gid] == conn[to] && load[gid] < load[to]))
+            to = gid;
+        }
+        if (to == GID_MAX && overloaded) {
+          to = std::min_element(load.begin(), load.end()) - load.begin();
+          if (to == from || load[to] + w > capacity_) to = GID_MAX;
+        }
+        bool move = false;
+        if (to != GID_MAX) {
+          if (overloaded || conn[to] > conn[from])
+            move = true;
+          else if (conn[to] == conn[from])
+            move = load[to] + w < load[from];
+        }
+        for (auto gid : touched) conn[gid] = 0;
+        touched.clear();
+        if (!move) return;
+        if (__sync_add_and_fetch(&load[to], w) > capacity_) {
+          __sync_fetch_and_sub(&load[to], w);
+          return;
+        }
+        __sync_fetch_and_sub(&load[from], w);
+        gids[u] = to;
+        ++num_moves[tid];
+      });
+      size_t sum_moves = 0;
+      for (auto moves : num_moves) sum_moves += moves;
+      if (sum_moves == 0) break;
+    }
+  }
+
+  double slack_ = 1.1;
+  size_t seed_ = 0;
+  size_t cores_ = 1;
+  std::unique_ptr<CPUThreadPool> thread_pool_;
+
+  size_t capacity_ = 0;
+  size_t max_vertex_weight_ = 0;
+  std::vector<GID_T> gid_by_vid_;
+
+  // Edges by source and by destination, indexed by global id.
+  std::vector<size_t> out_offset_;
+  std::vector<VID_T> out_edges_;
+  std::vector<size_t> in_offset_;
+  std::vector<VID_T> in_edges_;
+};
+
+}  // namespace partitioner
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_MULTILEVEL_PARTITIONER_H
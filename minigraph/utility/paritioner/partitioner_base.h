@@ -1,7 +1,10 @@
 #ifndef MINIGRAPH_PARTITIONER_BASE_H
 #define MINIGRAPH_PARTITIONER_BASE_H
 
+#include <string>
+
 #include "graphs/graph.h"
+#include "utility/paritioner/vertex_reorder.h"
 
 namespace minigraph {
 namespace utility {
@@ -92,6 +95,39 @@ class PartitionerBase {
     return si;
   }
 
+  // @brief: set how local vertexes of each fragment are relabeled before
+  // the fragment is written, i.e. none, degree, rcm or gorder.
+  void SetReorder(const std::string& t_reorder) {
+    assert(VertexReorder<CSR_T>::IsValid(t_reorder));
+    reorder_ = t_reorder;
+  }
+
+  // @brief: whether fragments are written with CSR_COMPRESSED neighbor
+  // lists.
+  void SetCompress(const bool compress) { compress_ = compress; }
+
+  // @brief: relabel local vertexes of csr_graph according to reorder_.
+  // Called on each fragment right before it is written.
+  // @param: vid_map is the global-to-local map shared by all fragments, it
+  // is updated if not nullptr.
+  void ReorderFragment(CSR_T* csr_graph, const size_t cores,
+                       VID_T* vid_map = nullptr) {
+    if (reorder_ == "none" || csr_graph->get_num_vertexes() == 0) return;
+    LOG_INFO("Reorder GID: ", csr_graph->get_gid(), " by ", reorder_);
+    auto order =
+        (VID_T*)malloc(sizeof(VID_T) * csr_graph->get_num_vertexes());
+    VertexReorder<CSR_T> vertex_reorder(csr_graph);
+    if (vertex_reorder.GetOrder(reorder_, order))
+      csr_graph->Reorder(order, vid_map, cores);
+    free(order);
+  }
+
+  // @brief: flag csr_graph CSR_COMPRESSED if compress_ is set, so that its
+  // neighbor lists are packed when it is written.
+  void CompressFragment(CSR_T* csr_graph) {
+    if (compress_) csr_graph->csr_flags_ |= CSR_COMPRESSED;
+  }
+
   std::vector<graphs::Graph<GID_T, VID_T, VDATA_T, EDATA_T>*>* GetFragments() {
     return fragments_;
   }
@@ -132,6 +168,8 @@ class PartitionerBase {
   size_t num_vertexes_ = 0;
   size_t num_edges_ = 0;
   size_t num_partitions = 0;
+  std::string reorder_ = "none";
+  bool compress_ = false;
 
   bool* communication_matrix_ = nullptr;
   Bitmap* global_border_vid_map_ = nullptr;
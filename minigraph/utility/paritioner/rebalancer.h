@@ -0,0 +1,443 @@
+#ifndef MINIGRAPH_UTILITY_REBALANCER_H
+#define MINIGRAPH_UTILITY_REBALANCER_H
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "graphs/csr_builder.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/bitmap.h"
+#include "utility/io/data_mngr.h"
+#include "utility/paritioner/partitioner_base.h"
+#include "utility/thread_pool.h"
+
+namespace minigraph {
+namespace utility {
+namespace partitioner {
+
+// Rebalancer moves vertexes of an edgecut partition on disk from fragments
+// that cost the most in the last run to those that cost the least. The cost
+// of a fragment is its elapsed_time in minigraph_cost/, or its sum_dgv if some
+// fragment has not been timed yet, and is spread over its vertexes by degree.
+// Vertexes leave fragments above slack times the average cost for fragments
+// below the average, those with more neighbors in the destination than in
+// the source first. Only fragments that gain or lose vertexes are rebuilt
+// and rewritten, together with vid_map, global_border_vid_map and the
+// communication matrix.
+template <typename GRAPH_T>
+class Rebalancer : public PartitionerBase<GRAPH_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using GRAPH_BASE_T = graphs::Graph<GID_T, VID_T, VDATA_T, EDATA_T>;
+  using CSR_T = graphs::ImmutableCSR<GID_T, VID_T, VDATA_T, EDATA_T>;
+  using EDGE_LIST_T =
+      minigraph::graphs::EdgeList<gid_t, vid_t, vdata_t, edata_t>;
+
+  struct Move {
+    VID_T vid;
+    GID_T dst_gid;
+    long gain;
+  };
+
+ public:
+  Rebalancer(const double slack = 1.1, const size_t cores = 1)
+      : PartitionerBase<GRAPH_T>() {
+    slack_ = std::max(1.0, slack);
+    cores_ = std::max((size_t)1, cores);
+  }
+
+  // Rebalancer works on fragments that are already partitioned, see
+  // Rebalance().
+  bool ParallelPartition(EDGE_LIST_T* edgelist_graph = nullptr,
+                         const size_t num_partitions = 1,
+                         const size_t cores = 1, const std::string dst_pt = "",
+                         bool delete_graph = false) override {
+    XLOG(ERR, "Rebalancer does not partition edge lists, use Rebalance().");
+    return false;
+  }
+
+  // @brief: rebalance the fragments in work_space in place.
+  // @return: false if work_space is not an edgecut partition or can not be
+  // read, in which case nothing is rewritten.
+  bool Rebalance(const std::string& work_space) {
+    thread_pool_ = std::make_unique<utility::CPUThreadPool>(cores_, 1);
+    utility::io::DataMngr<GRAPH_T> data_mngr;
+    auto pt_by_gid = data_mngr.InitPtByGid(work_space);
+    size_t k = pt_by_gid.size();
+    this->num_partitions = k;
+    LOG_INFO("Rebalance: ", work_space, " num_fragments: ", k);
+
+    if (!ReadFragments(work_space, pt_by_gid, &data_mngr)) {
+      ReleaseFragments();
+      return false;
+    }
+
+    // Cost of each fragment, spread over its vertexes by degree.
+    bool timed = true;
+    for (auto elapsed_time : elapsed_time_)
+      timed = timed && elapsed_time > 0;
+    std::vector<double> cost(k, 0);
+    double total_cost = 0;
+    vertex_cost_.assign(this->aligned_max_vid_, 0);
+    for (GID_T gid = 0; gid < k; gid++) {
+      auto graph = graphs_[gid];
+      if (timed)
+        cost[gid] = elapsed_time_[gid];
+      else if (si_[gid].sum_dgv > 0)
+        cost[gid] = si_[gid].sum_dgv;
+      else
+        cost[gid] = graph->get_num_out_edges();
+      double scale =
+          cost[gid] / std::max((size_t)1, graph->get_num_vertexes() +
+                                              graph->get_num_edges());
+      thread_pool_->ParallelFor(
+          graph->get_num_vertexes(), [&](size_t tid, size_t i) {
+            vertex_cost_[graph->globalid_by_index_[i]] =
+                scale * (1 + graph->indegree_[i] + graph->outdegree_[i]);
+          });
+      total_cost += cost[gid];
+    }
+    double target = total_cost / k;
+    LOG_INFO("Run: Balance ", timed ? "elapsed_time" : "sum_dgv",
+             ", average: ", target, ", limit: ", slack_ * target);
+
+    std::vector<char> affected(k, 0);
+    size_t num_moved = 0;
+    for (size_t round = 0; round < kRounds; round++) {
+      size_t moved = Balance(cost, target, &affected);
+      num_moved += moved;
+      if (moved == 0) break;
+    }
+    for (GID_T gid = 0; gid < k; gid++)
+      LOG_INFO("  GID: ", gid, " cost: ", cost[gid],
+               affected[gid] ? " (rebuilt)" : "");
+    LOG_INFO("  moved vertexes: ", num_moved);
+    if (num_moved == 0) {
+      LOG_INFO("Fragments are balanced, nothing to rewrite.");
+      ReleaseFragments();
+      return true;
+    }
+
+    if (!Rebuild(affected)) {
+      ReleaseFragments();
+      return false;
+    }
+    SetBorderVertexes();
+
+    LOG_INFO("Run: Write rebuilt fragments");
+    for (GID_T gid = 0; gid < k; gid++) {
+      if (!affected[gid]) continue;
+      auto graph = graphs_[gid];
+      auto& path = pt_by_gid.find(gid)->second;
+      remove(path.meta_pt.c_str());
+      remove(path.data_pt.c_str());
+      remove(path.vdata_pt.c_str());
+      data_mngr.csr_io_adapter_->Write(*graph, csr_bin, false, path.meta_pt,
+                                       path.data_pt, path.vdata_pt);
+      StatisticInfo&& si = this->ParallelSetStatisticInfo(*graph, cores_);
+      data_mngr.WriteStatisticInfo(
+          si, work_space + "minigraph_si/" + std::to_string(gid) + ".yaml");
+      // The estimate stands for the time of the next run, which overwrites
+      // it.
+      if (timed)
+        data_mngr.WriteRunCost(
+            cost[gid], num_evals_[gid],
+            work_space + "minigraph_cost/" + std::to_string(gid) + ".yaml");
+    }
+
+    LOG_INFO("Run: Write vid_map, global_border_vid_map and communication "
+             "matrix");
+    std::string vid_map_pt = work_space + "minigraph_message/vid_map.bin";
+    std::string border_pt =
+        work_space + "minigraph_message/global_border_vid_map.bin";
+    std::string matrix_pt =
+        work_space + "minigraph_border_vertexes/communication_matrix.bin";
+    remove(vid_map_pt.c_str());
+    remove(border_pt.c_str());
+    remove(matrix_pt.c_str());
+    data_mngr.WriteVidMap(this->max_vid_, this->vid_map_, vid_map_pt);
+    data_mngr.WriteBitmap(this->global_border_vid_map_, border_pt);
+    data_mngr.WriteCommunicationMatrix(matrix_pt, this->communication_matrix_,
+                                       k);
+    ReleaseFragments();
+    return true;
+  }
+
+ private:
+  static const size_t kRounds = 4;
+
+  // @brief: read fragments, statistics and vid_map, and set the fragment of
+  // each vertex.
+  bool ReadFragments(const std::string& work_space,
+                     std::unordered_map<GID_T, Path>& pt_by_gid,
+                     utility::io::DataMngr<GRAPH_T>* data_mngr) {
+    size_t k = pt_by_gid.size();
+    if (k == 0) {
+      XLOG(ERR, "No fragments in ", work_space);
+      return false;
+    }
+    std::string vid_map_pt = work_space + "minigraph_message/vid_map.bin";
+    if (!data_mngr->Exist(vid_map_pt)) {
+      XLOG(ERR, "Read file fault: ", vid_map_pt, ", not exist");
+      return false;
+    }
+
+    graphs_.assign(k, nullptr);
+    si_.assign(k, StatisticInfo());
+    elapsed_time_.assign(k, 0);
+    num_evals_.assign(k, 0);
+    size_t num_ids = 0;
+    for (GID_T gid = 0; gid < k; gid++) {
+      auto iter = pt_by_gid.find(gid);
+      if (iter == pt_by_gid.end()) {
+        XLOG(ERR, "Missing fragment: ", gid);
+        return false;
+      }
+      auto graph = new CSR_T;
+      graphs_[gid] = graph;
+      if (!data_mngr->csr_io_adapter_->Read(
+              (GRAPH_BASE_T*)graph, csr_bin, gid, iter->second.meta_pt,
+              iter->second.data_pt, iter->second.vdata_pt))
+        return false;
+      // Rebuilt fragments stay compressed if the workspace is.
+      if (graph->csr_flags_ & CSR_COMPRESSED) this->compress_ = true;
+      std::string si_pt =
+          work_space + "minigraph_si/" + std::to_string(gid) + ".yaml";
+      if (data_mngr->Exist(si_pt))
+        si_[gid] = data_mngr->ReadStatisticInfo(si_pt);
+      std::string cost_pt =
+          work_space + "minigraph_cost/" + std::to_string(gid) + ".yaml";
+      if (data_mngr->Exist(cost_pt) &&
+          !data_mngr->ReadRunCost(cost_pt, &elapsed_time_[gid],
+                                  &num_evals_[gid]))
+        elapsed_time_[gid] = 0;
+      for (size_t i = 0; i < graph->get_num_vertexes(); i++)
+        num_ids = std::max(num_ids, (size_t)graph->globalid_by_index_[i] + 1);
+    }
+
+    auto vid_map = data_mngr->ReadVidMap(vid_map_pt);
+    this->max_vid_ = vid_map.first;
+    this->aligned_max_vid_ =
+        ceil((float)std::max(num_ids, (size_t)this->max_vid_) /
+             ALIGNMENT_FACTOR) *
+        ALIGNMENT_FACTOR;
+    this->vid_map_ = (VID_T*)malloc(sizeof(VID_T) * this->aligned_max_vid_);
+    memset(this->vid_map_, 0, sizeof(VID_T) * this->aligned_max_vid_);
+    memcpy(this->vid_map_, vid_map.second, sizeof(VID_T) * vid_map.first);
+    free(vid_map.second);
+
+    gid_by_vid_.assign(this->aligned_max_vid_, GID_MAX);
+    for (GID_T gid = 0; gid < k; gid++) {
+      auto graph = graphs_[gid];
+      for (size_t i = 0; i < graph->get_num_vertexes(); i++) {
+        VID_T vid = graph->globalid_by_index_[i];
+        if (gid_by_vid_[vid] != GID_MAX) {
+          XLOG(ERR, "Vertex ", vid, " is in fragments ", gid_by_vid_[vid],
+               " and ", gid, ", only edgecut partitions can be rebalanced.");
+          return false;
+        }
+        gid_by_vid_[vid] = gid;
+      }
+    }
+    return true;
+  }
+
+  // @brief: one round of moves from overloaded fragments.
+  // @return: the number of vertexes moved.
+  size_t Balance(std::vector<double>& cost, const double target,
+                 std::vector<char>* affected) {
+    size_t k = cost.size();
+    std::vector<char> is_over(k, 0), is_under(k, 0);
+    bool any_over = false, any_under = false;
+    for (GID_T gid = 0; gid < k; gid++) {
+      is_over[gid] = cost[gid] > slack_ * target;
+      is_under[gid] = cost[gid] < target;
+      any_over = any_over || is_over[gid];
+      any_under = any_under || is_under[gid];
+    }
+    if (!any_over || !any_under) return 0;
+
+    // Pick the destination of each vertex of an overloaded fragment. Its
+    // neighbor lists are still those of the fragment it was read from.
+    std::vector<std::vector<Move>> moves_by_tid(cores_);
+    std::vector<std::vector<long>> count_by_tid(cores_,
+                                                std::vector<long>(k, 0));
+    for (auto graph : graphs_) {
+      thread_pool_->ParallelFor(
+          graph->get_num_vertexes(), [&](size_t tid, size_t i) {
+            VID_T vid = graph->globalid_by_index_[i];
+            GID_T gid = gid_by_vid_[vid];
+            if (!is_over[gid]) return;
+            auto& count = count_by_tid[tid];
+            auto u = graph->GetVertexByIndex(i);
+            ForEachNeighbor(u, [&](VID_T nbr) {
+              if (gid_by_vid_[nbr] != GID_MAX) ++count[gid_by_vid_[nbr]];
+            });
+            GID_T dst_gid = GID_MAX;
+            for (GID_T h = 0; h < k; h++) {
+              if (!is_under[h]) continue;
+              if (dst_gid == GID_MAX || count[h] > count[dst_gid] ||
+                  (count[h] == count[dst_gid] && cost[h] < cost[dst_gid]))
+                dst_gid = h;
+            }
+            moves_by_tid[tid].push_back(
+                {vid, dst_gid, count[dst_gid] - count[gid]});
+            ForEachNeighbor(u, [&](VID_T nbr) {
+              if (gid_by_vid_[nbr] != GID_MAX) count[gid_by_vid_[nbr]] = 0;
+            });
+            count[gid] = 0;
+          });
+    }
+    std::vector<Move> moves;
+    for (auto& local_moves : moves_by_tid)
+      moves.insert(moves.end(), local_moves.begin(), local_moves.end());
+    std::stable_sort(
+        moves.begin(), moves.end(),
+        [](const Move& a, const Move& b) { return a.gain > b.gain; });
+
+    size_t num_moved = 0;
+    for (auto& move : moves) {
+      GID_T gid = gid_by_vid_[move.vid];
+      double w = vertex_cost_[move.vid];
+      if (cost[gid] <= target || cost[move.dst_gid] + w > target) continue;
+      gid_by_vid_[move.vid] = move.dst_gid;
+      cost[gid] -= w;
+      cost[move.dst_gid] += w;
+      (*affected)[gid] = 1;
+      (*affected)[move.dst_gid] = 1;
+      ++num_moved;
+    }
+    return num_moved;
+  }
+
+  // @brief: rebuild the affected fragments out of their out-edges and the
+  // in-edges they share with the others.
+  bool Rebuild(const std::vector<char>& affected) {
+    size_t k = graphs_.size();
+    bool weighted = true;
+    for (auto graph : graphs_) weighted = weighted && graph->IsWeighted();
+    auto is_affected = [&](VID_T vid) {
+      return gid_by_vid_[vid] != GID_MAX && affected[gid_by_vid_[vid]];
+    };
+
+    LOG_INFO("Run: Rebuild fragments");
+    std::vector<VID_T> edges;
+    std::vector<EDATA_T> edata;
+    for (GID_T gid = 0; gid < k; gid++) {
+      if (!affected[gid]) continue;
+      auto graph = graphs_[gid];
+      for (size_t i = 0; i < graph->get_num_vertexes(); i++) {
+        auto u = graph->GetVertexByIndex(i);
+        VID_T vid = graph->globalid_by_index_[i];
+        for (size_t j = 0; j < u.outdegree; j++) {
+          edges.push_back(vid);
+          edges.push_back(u.out_edges[j]);
+          if (weighted) edata.push_back(u.out_edata[j]);
+        }
+        for (size_t j = 0; j < u.indegree; j++) {
+          if (is_affected(u.in_edges[j])) continue;
+          edges.push_back(u.in_edges[j]);
+          edges.push_back(vid);
+          if (weighted) edata.push_back(u.edata[j]);
+        }
+      }
+    }
+
+    graphs::CSRBuilder<GID_T, VID_T, VDATA_T, EDATA_T> csr_builder(cores_,
+                                                                   true);
+    auto built = csr_builder.Build(
+        edges.data(), weighted ? edata.data() : nullptr, edges.size() / 2,
+        this->aligned_max_vid_ - 1,
+        [&](VID_T vid) {
+          return is_affected(vid) ? gid_by_vid_[vid] : GID_MAX;
+        },
+        k, this->vid_map_);
+    for (GID_T gid = 0; gid < k; gid++) {
+      if (!affected[gid]) continue;
+      if (built[gid] == nullptr) {
+        XLOG(ERR, "Empty fragment: ", gid);
+        for (auto graph : built) delete graph;
+        return false;
+      }
+    }
+    for (GID_T gid = 0; gid < k; gid++) {
+      if (!affected[gid]) continue;
+      LOG_INFO("  GID: ", gid, " num_vertexes: ",
+               built[gid]->get_num_vertexes(),
+               " sum_in_edges: ", built[gid]->get_num_in_edges(),
+               " sum_out_edges: ", built[gid]->get_num_out_edges());
+      this->ReorderFragment(built[gid], cores_, this->vid_map_);
+      this->CompressFragment(built[gid]);
+      delete graphs_[gid];
+      graphs_[gid] = built[gid];
+    }
+    return true;
+  }
+
+  // @brief: set global_border_vid_map and the communication matrix of all
+  // fragments.
+  void SetBorderVertexes() {
+    size_t k = graphs_.size();
+    this->global_border_vid_map_ = new Bitmap(this->aligned_max_vid_);
+    this->global_border_vid_map_->clear();
+    this->communication_matrix_ = (bool*)malloc(sizeof(bool) * k * k);
+    memset(this->communication_matrix_, 0, sizeof(bool) * k * k);
+    for (GID_T gid = 0; gid < k; gid++) {
+      auto graph = graphs_[gid];
+      thread_pool_->ParallelFor(
+          graph->get_num_vertexes(), [&](size_t tid, size_t i) {
+            auto u = graph->GetVertexByIndex(i);
+            ForEachNeighbor(u, [&](VID_T nbr) {
+              GID_T nbr_gid = gid_by_vid_[nbr];
+              if (nbr_gid == gid || nbr_gid == GID_MAX) return;
+              this->global_border_vid_map_->set_bit(nbr);
+              this->communication_matrix_[gid * k + nbr_gid] = 1;
+              this->communication_matrix_[nbr_gid * k + gid] = 1;
+            });
+          });
+    }
+  }
+
+  template <typename F>
+  static void ForEachNeighbor(
+      const graphs::VertexInfo<VID_T, VDATA_T, EDATA_T>& u, F f) {
+    for (size_t j = 0; j < u.indegree; j++) f(u.in_edges[j]);
+    for (size_t j = 0; j < u.outdegree; j++) f(u.out_edges[j]);
+  }
+
+  void ReleaseFragments() {
+    for (auto graph : graphs_) delete graph;
+    std::vector<CSR_T*>().swap(graphs_);
+    std::vector<GID_T>().swap(gid_by_vid_);
+    std::vector<double>().swap(vertex_cost_);
+  }
+
+  double slack_ = 1.1;
+  size_t cores_ = 1;
+  std::unique_ptr<utility::CPUThreadPool> thread_pool_;
+
+  std::vector<CSR_T*> graphs_;
+  std::vector<StatisticInfo> si_;
+  // Seconds the last run spent on, and number of PEval/IncEval of, each
+  // fragment.
+  std::vector<float> elapsed_time_;
+  std::vector<size_t> num_evals_;
+  std::vector<GID_T> gid_by_vid_;
+  std::vector<double> vertex_cost_;
+};
+
+}  // namespace partitioner
+}  // namespace utility
+}  // namespace minigraph
+
+#endif  // MINIGRAPH_UTILITY_REBALANCER_H
@@ -0,0 +1,419 @@
+#ifndef MINIGRAPH_UTILITY_STREAMING_PARTITIONER_H
+#define MINIGRAPH_UTILITY_STREAMING_PARTITIONER_H
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "graphs/csr_builder.h"
+#include "portability/sys_types.h"
+#include "utility/bitmap.h"
+#include "utility/io/csr_io_adapter.h"
+#include "utility/io/data_mngr.h"
+#include "utility/paritioner/partitioner_base.h"
+
+namespace minigraph {
+namespace utility {
+namespace partitioner {
+
+// StreamingPartitioner is an edgecut partitioner that reads the edge list a
+// chunk at a time and never holds the whole graph in memory. Edges are taken
+// in runs of the same source vertex, and the first time a source shows up it
+// goes to the fragment P that scores best with its neighbors placed so far:
+//   ldg:    |N(u) ∩ P| * (1 - |P| / C)
+//   fennel: |N(u) ∩ P| - alpha * gamma * |P|^(gamma - 1), with gamma = 1.5
+// where no fragment takes more than C = slack * |V| / k vertexes. Vertexes
+// that are never a source go to the fragment of their first in-neighbor if
+// it has room. Edges are appended to on-disk buckets of the fragment of
+// their source, then moved to buckets of the fragment of their destination,
+// and fragments are built from their buckets one at a time, so that peak
+// memory is bounded by the largest fragment plus a few bytes per vertex.
+template <typename GRAPH_T>
+class StreamingPartitioner : public PartitionerBase<GRAPH_T> {
+  using GID_T = typename GRAPH_T::gid_t;
+  using VID_T = typename GRAPH_T::vid_t;
+  using VDATA_T = typename GRAPH_T::vdata_t;
+  using EDATA_T = typename GRAPH_T::edata_t;
+  using CSR_T = graphs::ImmutableCSR<GID_T, VID_T, VDATA_T, EDATA_T>;
+  using EDGE_LIST_T =
+      minigraph::graphs::EdgeList<gid_t, vid_t, vdata_t, edata_t>;
+
+  // Edges appended to a file per bucket, their weights to a second one.
+  class EdgeBuckets {
+   public:
+    EdgeBuckets(const std::string& prefix, const size_t num_buckets,
+                const bool weighted) {
+      prefix_ = prefix;
+      weighted_ = weighted;
+      edges_.resize(num_buckets);
+      edata_.resize(num_buckets);
+    }
+
+    void Append(const GID_T gid, const VID_T src, const VID_T dst,
+                const EDATA_T edata) {
+      edges_[gid].push_back(src);
+      edges_[gid].push_back(dst);
+      if (weighted_) edata_[gid].push_back(edata);
+      if (edges_[gid].size() >= 2 * kBufferSize) Flush(gid);
+    }
+
+    void Flush() {
+      for (GID_T gid = 0; gid < edges_.size(); gid++) Flush(gid);
+    }
+
+    // @brief: call f(src, dst, edata) for each edge of bucket gid.
+    template <typename F>
+    bool ForEach(const GID_T gid, F f) {
+      std::ifstream edges_file(GetPath(gid, "edges"), std::ios::binary);
+      std::ifstream edata_file(GetPath(gid, "edata"), std::ios::binary);
+      std::vector<VID_T> edges(2 * kBufferSize);
+      std::vector<EDATA_T> edata(kBufferSize);
+      while (edges_file) {
+        edges_file.read((char*)edges.data(), sizeof(VID_T) * edges.size());
+        size_t n = edges_file.gcount() / (2 * sizeof(VID_T));
+        if (weighted_ &&
+            !edata_file.read((char*)edata.data(), sizeof(EDATA_T) * n)) {
+          XLOG(ERR, "Read edge weights failed: ", GetPath(gid, "edata"));
+          return false;
+        }
+        for (size_t j = 0; j < n; j++)
+          f(edges[2 * j], edges[2 * j + 1], weighted_ ? edata[j] : 0);
+      }
+      return true;
+    }
+
+    void Remove() {
+      for (GID_T gid = 0; gid < edges_.size(); gid++) {
+        remove(GetPath(gid, "edges").c_str());
+        remove(GetPath(gid, "edata").c_str());
+      }
+    }
+
+   private:
+    static const size_t kBufferSize = 1 << 16;
+
+    std::string GetPath(const GID_T gid, const std::string& type) const {
+      return prefix_ + std::to_string(gid) + "." + type;
+    }
+
+    void Flush(const GID_T gid) {
+      if (edges_[gid].empty()) return;
+      std::ofstream edges_file(GetPath(gid, "edges"),
+                               std::ios::binary | std::ios::app);
+      edges_file.write((char*)edges_[gid].data(),
+                       sizeof(VID_T) * edges_[gid].size());
+      edges_[gid].clear();
+      if (!weighted_) return;
+      std::ofstream edata_file(GetPath(gid, "edata"),
+                               std::ios::binary | std::ios::app);
+      edata_file.write((char*)edata_[gid].data(),
+                       sizeof(EDATA_T) * edata_[gid].size());
+      edata_[gid].clear();
+    }
+
+    std::string prefix_;
+    bool weighted_ = false;
+    std::vector<std::vector<VID_T>> edges_;
+    std::vector<std::vector<EDATA_T>> edata_;
+  };
+
+ public:
+  // @param: score is ldg or fennel. Buckets are kept in bucket_root, by
+  // default minigraph_buckets/ in the workspace.
+  StreamingPartitioner(const std::string& score = "fennel",
+                       const double slack = 1.1,
+                       const std::string& bucket_root = "",
+                       const size_t chunk_size = 1 << 22) {
+    assert(IsValid(score));
+    score_ = score;
+    slack_ = slack;
+    bucket_root_ = bucket_root;
+    chunk_size_ = chunk_size;
+  }
+  ~StreamingPartitioner() = default;
+
+  static bool IsValid(const std::string& score) {
+    return score == "ldg" || score == "fennel";
+  }
+
+  // @brief: partition an edge list already in memory, e.g. read from csv.
+  bool ParallelPartition(EDGE_LIST_T* edgelist_graph,
+                         const size_t num_partitions = 1,
+                         const size_t cores = 1, const std::string dst_pt = "",
+                         bool delete_graph = false) override {
+    LOG_INFO("ParallelPartition(): Streaming ", score_);
+    size_t num_edges = edgelist_graph->get_num_edges();
+    bool weighted = edgelist_graph->IsWeighted();
+    auto read = [&](const size_t offset, VID_T* edges, EDATA_T* edata) {
+      size_t n = std::min(chunk_size_, num_edges - offset);
+      memcpy(edges, edgelist_graph->buf_graph_ + 2 * offset,
+             sizeof(VID_T) * 2 * n);
+      if (weighted)
+        memcpy(edata, edgelist_graph->edata_ + offset, sizeof(EDATA_T) * n);
+      return n;
+    };
+    bool tag = Partition(read, edgelist_graph->get_num_vertexes(), num_edges,
+                         edgelist_graph->get_max_vid(), weighted,
+                         num_partitions, cores, dst_pt, delete_graph);
+    if (delete_graph) delete edgelist_graph;
+    return tag;
+  }
+
+  // @brief: partition the edge list in binary format at meta_pt and data_pt,
+  // see EdgeListIOAdapter::ReadEdgeListFromBin(), reading chunk_size edges
+  // at a time.
+  bool PartitionBin(const std::string& meta_pt, const std::string& data_pt,
+                    const size_t num_partitions = 1, const size_t cores = 1,
+                    const std::string& dst_pt = "", bool delete_graph = true) {
+    LOG_INFO("PartitionBin(): Streaming ", score_, " ", data_pt);
+    std::ifstream meta_file(meta_pt, std::ios::binary);
+    size_t meta[2] = {0, 0};
+    VID_T max_vid = 0;
+    size_t flags = 0;
+    if (!meta_file.read((char*)meta, sizeof(size_t) * 2) ||
+        !meta_file.read((char*)&max_vid, sizeof(VID_T))) {
+      XLOG(ERR, "Read meta failed: ", meta_pt);
+      return false;
+    }
+    if (!meta_file.read((char*)&flags, sizeof(size_t))) flags = 0;
+    bool weighted = flags & CSR_WEIGHTED;
+    size_t num_edges = meta[1];
+
+    std::ifstream data_file(data_pt, std::ios::binary);
+    // Weights follow the edges in the data file.
+    std::ifstream edata_file(data_pt, std::ios::binary);
+    edata_file.seekg(sizeof(VID_T) * 2 * num_edges);
+    auto read = [&](const size_t offset, VID_T* edges, EDATA_T* edata) {
+      size_t n = std::min(chunk_size_, num_edges - offset);
+      if (!data_file.read((char*)edges, sizeof(VID_T) * 2 * n) ||
+          (weighted &&
+           !edata_file.read((char*)edata, sizeof(EDATA_T) * n))) {
+        XLOG(ERR, "Read edges failed: ", data_pt);
+        return (size_t)0;
+      }
+      return n;
+    };
+    return Partition(read, meta[0], num_edges, max_vid, weighted,
+                     num_partitions, cores, dst_pt, delete_graph);
+  }
+
+ private:
+  // @brief: read(offset, edges, edata) copies up to chunk_size_ edges from
+  // offset on and returns how many, 0 at the end.
+  template <typename READ_T>
+  bool Partition(READ_T read, const size_t num_vertexes,
+                 const size_t num_edges, const VID_T max_vid,
+                 const bool weighted, const size_t num_partitions,
+                 const size_t cores, const std::string& dst_pt,
+                 bool delete_graph) {
+    minigraph::utility::io::DataMngr<CSR_T> data_mngr;
+    this->max_vid_ = max_vid;
+    this->aligned_max_vid_ =
+        ceil((max_vid + 1) / ALIGNMENT_FACTOR) * ALIGNMENT_FACTOR;
+    this->num_partitions = num_partitions;
+    this->global_border_vid_map_ = new Bitmap(this->aligned_max_vid_);
+    this->global_border_vid_map_->clear();
+    this->vid_map_ = (VID_T*)malloc(sizeof(VID_T) * this->aligned_max_vid_);
+    memset(this->vid_map_, 0, sizeof(VID_T) * this->aligned_max_vid_);
+    this->communication_matrix_ =
+        (bool*)malloc(sizeof(bool) * num_partitions * num_partitions);
+    memset(this->communication_matrix_, 0,
+           sizeof(bool) * num_partitions * num_partitions);
+
+    std::string bucket_root =
+        bucket_root_.empty() ? dst_pt + "minigraph_buckets/" : bucket_root_;
+    bool own_root = !data_mngr.Exist(bucket_root);
+    if (own_root) data_mngr.MakeDirectory(bucket_root);
+    EdgeBuckets out_buckets(bucket_root + "out_", num_partitions, weighted);
+    EdgeBuckets in_buckets(bucket_root + "in_", num_partitions, weighted);
+    // @brief: drop bucket files, and the bucket directory if we made it.
+    auto remove_buckets = [&]() {
+      out_buckets.Remove();
+      in_buckets.Remove();
+      std::error_code ec;
+      if (own_root) std::filesystem::remove(bucket_root, ec);
+    };
+
+    size_t n = num_vertexes > 0 ? num_vertexes : (size_t)max_vid + 1;
+    capacity_ = std::max((size_t)1, (size_t)ceil(slack_ * n / num_partitions));
+    // alpha = sqrt(k) * |E| / |V|^1.5 as suggested for Fennel.
+    alpha_ = sqrt(num_partitions) * num_edges / pow(n, 1.5);
+    gid_by_vid_.assign(this->aligned_max_vid_, GID_MAX);
+    load_.assign(num_partitions, 0);
+    num_nbrs_.assign(num_partitions, 0);
+
+    LOG_INFO("Run: Stream edges, capacity: ", capacity_);
+    hint_.assign(this->aligned_max_vid_, GID_MAX);
+    std::vector<VID_T> edges(2 * chunk_size_);
+    std::vector<EDATA_T> edata(weighted ? chunk_size_ : 0);
+    size_t offset = 0, size = 0;
+    while ((size = read(offset, edges.data(), edata.data())) > 0) {
+      offset += size;
+      for (size_t j = 0; j < size; j++) {
+        VID_T src = edges[2 * j], dst = edges[2 * j + 1];
+        if (src == dst) continue;
+        if (gid_by_vid_[src] == GID_MAX) {
+          size_t end = j;
+          while (end < size && edges[2 * end] == src) end++;
+          Assign(src, edges.data() + 2 * j, end - j);
+        }
+        GID_T gid = gid_by_vid_[src];
+        if (hint_[dst] == GID_MAX) hint_[dst] = gid;
+        out_buckets.Append(gid, src, dst, weighted ? edata[j] : 0);
+      }
+    }
+    out_buckets.Flush();
+    if (offset < num_edges) {
+      XLOG(ERR, "Stream edges failed: ", offset, " / ", num_edges);
+      remove_buckets();
+      return false;
+    }
+    for (VID_T vid = 0; vid < this->aligned_max_vid_; vid++) {
+      if (gid_by_vid_[vid] != GID_MAX || hint_[vid] == GID_MAX) continue;
+      GID_T gid = hint_[vid];
+      if (load_[gid] >= capacity_)
+        gid = std::min_element(load_.begin(), load_.end()) - load_.begin();
+      gid_by_vid_[vid] = gid;
+      ++load_[gid];
+    }
+    std::vector<GID_T>().swap(hint_);
+    for (GID_T gid = 0; gid < num_partitions; gid++)
+      LOG_INFO("  GID: ", gid, " num_vertexes: ", load_[gid]);
+
+    LOG_INFO("Run: Bucket edges by destination");
+    for (GID_T gid = 0; gid < num_partitions; gid++) {
+      bool tag = out_buckets.ForEach(gid, [&](VID_T src, VID_T dst,
+                                              EDATA_T w) {
+        GID_T dst_gid = gid_by_vid_[dst];
+        in_buckets.Append(dst_gid, src, dst, w);
+        if (dst_gid == gid) return;
+        this->global_border_vid_map_->set_bit(src);
+        this->global_border_vid_map_->set_bit(dst);
+        this->communication_matrix_[gid * num_partitions + dst_gid] = 1;
+        this->communication_matrix_[dst_gid * num_partitions + gid] = 1;
+      });
+      if (!tag) {
+        remove_buckets();
+        return false;
+      }
+    }
+    in_buckets.Flush();
+
+    LOG_INFO("Run: Construct sub-graphs");
+    for (GID_T gid = 0; gid < num_partitions; gid++) {
+      auto graph =
+          BuildFragment(gid, out_buckets, in_buckets, weighted, cores);
+      if (graph == nullptr) continue;
+      this->ReorderFragment(graph, cores, this->vid_map_);
+      this->CompressFragment(graph);
+      if (!delete_graph) {
+        this->fragments_->push_back((graphs::Graph<GID_T, VID_T, VDATA_T,
+                                                   EDATA_T>*)graph);
+        continue;
+      }
+      std::string meta_pt =
+          dst_pt + "minigraph_meta/" + std::to_string(gid) + ".bin";
+      std::string data_pt =
+          dst_pt + "minigraph_data/" + std::to_string(gid) + ".bin";
+      std::string vdata_pt =
+          dst_pt + "minigraph_vdata/" + std::to_string(gid) + ".bin";
+      data_mngr.csr_io_adapter_->Write(*graph, csr_bin, false, meta_pt,
+                                       data_pt, vdata_pt);
+      StatisticInfo&& si = this->ParallelSetStatisticInfo(*graph, cores);
+      std::string si_pt =
+          dst_pt + "minigraph_si/" + std::to_string(gid) + ".yaml";
+      data_mngr.WriteStatisticInfo(si, si_pt);
+      delete graph;
+    }
+    remove_buckets();
+    std::vector<GID_T>().swap(gid_by_vid_);
+    return true;
+  }
+
+  // @brief: place src given its out-neighbors in the first degree edges
+  // (pairs of vids) of its run. A neighbor not placed yet counts for the
+  // fragment of its first in-neighbor, and so does src for its own.
+  void Assign(const VID_T src, const VID_T* edges, const size_t degree) {
+    size_t num_partitions = load_.size();
+    std::vector<GID_T> touched;
+    auto count = [&](const GID_T gid) {
+      if (gid == GID_MAX) return;
+      if (num_nbrs_[gid]++ == 0) touched.push_back(gid);
+    };
+    count(hint_[src]);
+    for (size_t k = 0; k < degree; k++) {
+      VID_T nbr = edges[2 * k + 1];
+      count(gid_by_vid_[nbr] != GID_MAX ? gid_by_vid_[nbr] : hint_[nbr]);
+    }
+    GID_T best = GID_MAX;
+    double best_score = 0;
+    for (GID_T gid = 0; gid < num_partitions; gid++) {
+      if (load_[gid] >= capacity_) continue;
+      double score = 0;
+      if (score_ == "ldg")
+        score = num_nbrs_[gid] * (1 - (double)load_[gid] / capacity_);
+      else
+        score = num_nbrs_[gid] - alpha_ * 1.5 * sqrt((double)load_[gid]);
+      if (best == GID_MAX || score > best_score ||
+          (score == best_score && load_[gid] < load_[best])) {
+        best = gid;
+        best_score = score;
+      }
+    }
+    if (best == GID_MAX)
+      best = std::min_element(load_.begin(), load_.end()) - load_.begin();
+    gid_by_vid_[src] = best;
+    ++load_[best];
+    for (auto gid : touched) num_nbrs_[gid] = 0;
+  }
+
+  // @brief: build the CSR of fragment gid from its buckets, i.e. the
+  // out-edges of its vertexes and the in-edges that come from elsewhere.
+  CSR_T* BuildFragment(const GID_T gid, EdgeBuckets& out_buckets,
+                       EdgeBuckets& in_buckets, const bool weighted,
+                       const size_t cores) {
+    std::vector<VID_T> edges;
+    std::vector<EDATA_T> edata;
+    auto append = [&](VID_T src, VID_T dst, EDATA_T w) {
+      edges.push_back(src);
+      edges.push_back(dst);
+      if (weighted) edata.push_back(w);
+    };
+    out_buckets.ForEach(gid, append);
+    in_buckets.ForEach(gid, [&](VID_T src, VID_T dst, EDATA_T w) {
+      if (gid_by_vid_[src] != gid) append(src, dst, w);
+    });
+    graphs::CSRBuilder<GID_T, VID_T, VDATA_T, EDATA_T> csr_builder(cores,
+                                                                   true);
+    auto graph = csr_builder.Build(
+        edges.data(), weighted ? edata.data() : nullptr, edges.size() / 2,
+        this->max_vid_,
+        [&](VID_T vid) { return gid_by_vid_[vid] == gid ? gid : GID_MAX; },
+        gid + 1, this->vid_map_)[gid];
+    if (graph == nullptr) XLOG(ERR, "Empty fragment: ", gid);
+    return graph;
+  }
+
+  std::string score_;
+  double slack_ = 1.1;
+  std::string bucket_root_;
+  size_t chunk_size_ = 1 << 22;
+
+  size_t capacity_ = 0;
+  double alpha_ = 0;
+  std::vector<GID_T> gid_by_vid_;
+  // Fragment of the first in-neighbor of each vertex.
+  std::vector<GID_T> hint_;
+  std::vector<size_t> load_;
+  std::vector<size_t> num_nbrs_;
+};
+
+}  // namespace partitioner
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_STREAMING_PARTITIONER_H
@@ -92,6 +92,14 @@ class VertexCutPartitioner : public PartitionerBase<GRAPH_T> {
       edges_buckets[i] = (VID_T*)malloc(sizeof(VID_T) * 2 * size_per_bucket[i]);
       memset(edges_buckets[i], 0, sizeof(VID_T) * 2 * size_per_bucket[i]);
     }
+    // Weights of edges in each bucket, if the input is weighted.
+    EDATA_T** edata_buckets =
+        (EDATA_T**)malloc(sizeof(EDATA_T*) * num_partitions);
+    for (GID_T i = 0; i < num_partitions; i++)
+      edata_buckets[i] =
+          edgelist_graph->IsWeighted()
+              ? (EDATA_T*)malloc(sizeof(EDATA_T) * size_per_bucket[i])
+              : nullptr;
     Bitmap* is_in_bucketX[num_partitions];
     for (size_t i = 0; i < num_partitions; i++) {
       is_in_bucketX[i] = new Bitmap(aligned_max_vid);
@@ -110,7 +118,8 @@ class VertexCutPartitioner : public PartitionerBase<GRAPH_T> {
       thread_pool.Commit([tid, &cores, &num_edges, &edgelist_graph,
                           &num_partitions, &max_vid_per_bucket, &buckets_offset,
                           &is_in_bucketX, &num_vertexes_per_bucket,
-                          &edges_buckets, &pending_packages, &finish_cv]() {
+                          &edges_buckets, &edata_buckets, &pending_packages,
+                          &finish_cv]() {
         for (size_t j = tid; j < num_edges; j += cores) {
           auto src_vid = edgelist_graph->buf_graph_[j * 2];
           auto dst_vid = edgelist_graph->buf_graph_[j * 2 + 1];
@@ -122,6 +131,8 @@ class VertexCutPartitioner : public PartitionerBase<GRAPH_T> {
           auto offset = __sync_fetch_and_add(buckets_offset + bucket_id, 1);
           edges_buckets[bucket_id][offset * 2] = src_vid;
           edges_buckets[bucket_id][offset * 2 + 1] = dst_vid;
+          if (edata_buckets[bucket_id] != nullptr)
+            edata_buckets[bucket_id][offset] = edgelist_graph->edata_[j];
 
           is_in_bucketX[bucket_id]->set_bit(src_vid);
           is_in_bucketX[bucket_id]->set_bit(dst_vid);
@@ -147,12 +158,15 @@ class VertexCutPartitioner : public PartitionerBase<GRAPH_T> {
     for (size_t gid = 0; gid < num_partitions; gid++) {
       auto edgelist_graph = new EDGE_LIST_T(
           gid, size_per_bucket[gid], num_vertexes_per_bucket[gid],
-          max_vid_per_bucket[gid], edges_buckets[gid]);
+          max_vid_per_bucket[gid], edges_buckets[gid], edata_buckets[gid]);
       auto csr_graph = csr_io_adapter.EdgeList2CSR(gid, edgelist_graph, cores);
       delete edgelist_graph;
       free(edges_buckets[gid]);
+      if (edata_buckets[gid] != nullptr) free(edata_buckets[gid]);
       csr_graph->InitVdata2AllX(0);
       csr_graph->Sort(cores);
+      this->ReorderFragment(csr_graph, cores);
+      this->CompressFragment(csr_graph);
       if (!delete_graph) {
         this->fragments_->push_back(csr_graph);
       } else {
@@ -190,6 +204,7 @@ class VertexCutPartitioner : public PartitionerBase<GRAPH_T> {
     for (size_t i = 0; i < num_partitions; i++) {
       delete is_in_bucketX[i];
     }
+    free(edata_buckets);
     free(num_vertexes_per_bucket);
     free(max_vid_per_bucket);
     free(size_per_bucket);
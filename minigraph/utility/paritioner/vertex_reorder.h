@@ -0,0 +1,201 @@
+#ifndef MINIGRAPH_UTILITY_PARTITIONER_VERTEX_REORDER_H
+#define MINIGRAPH_UTILITY_PARTITIONER_VERTEX_REORDER_H
+
+#include <math.h>
+#include <algorithm>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "graphs/immutable_csr.h"
+#include "utility/logging.h"
+
+namespace minigraph {
+namespace utility {
+namespace partitioner {
+
+// @brief: VertexReorder computes a new order of the local vertexes of a
+// fragment, so that vertexes accessed together get close indexes in vdata.
+// Three orders are supported:
+//   degree: vertexes sorted by descending degree (hubs first).
+//   rcm: reverse Cuthill-McKee, a BFS order that minimizes bandwidth.
+//   gorder: greedy Gorder (Wei et al., SIGMOD'16) with a sliding window.
+// Only edges whose both ends are in the fragment are considered.
+template <typename GRAPH_T>
+class VertexReorder {
+  using VID_T = typename GRAPH_T::vid_t;
+
+ public:
+  VertexReorder(GRAPH_T* graph) {
+    assert(graph != nullptr);
+    graph_ = graph;
+    num_vertexes_ = graph_->get_num_vertexes();
+    BuildLocalAdjacency();
+  }
+
+  static bool IsValid(const std::string& t_reorder) {
+    return t_reorder == "none" || t_reorder == "degree" ||
+           t_reorder == "rcm" || t_reorder == "gorder";
+  }
+
+  // @brief: fill order with the old index of the vertex placed at each new
+  // index. order has num_vertexes elements.
+  bool GetOrder(const std::string& t_reorder, VID_T* order) {
+    if (t_reorder == "degree") {
+      DegreeOrder(order);
+    } else if (t_reorder == "rcm") {
+      RCMOrder(order);
+    } else if (t_reorder == "gorder") {
+      GOrder(order);
+    } else {
+      XLOG(ERR, "Unknown reorder: ", t_reorder);
+      return false;
+    }
+    return true;
+  }
+
+  void DegreeOrder(VID_T* order) {
+    for (size_t i = 0; i < num_vertexes_; i++) order[i] = i;
+    std::stable_sort(order, order + num_vertexes_, [this](VID_T a, VID_T b) {
+      return GetDegree(a) > GetDegree(b);
+    });
+  }
+
+  void RCMOrder(VID_T* order) {
+    // Start a BFS from the unvisited vertex with the minimum degree of each
+    // connected component, neighbors are visited by ascending degree.
+    std::vector<VID_T> by_degree(num_vertexes_);
+    for (size_t i = 0; i < num_vertexes_; i++) by_degree[i] = i;
+    auto less_degree = [this](VID_T a, VID_T b) {
+      return GetDegree(a) < GetDegree(b);
+    };
+    std::stable_sort(by_degree.begin(), by_degree.end(), less_degree);
+
+    std::vector<bool> visited(num_vertexes_, false);
+    std::vector<VID_T> nbrs;
+    size_t head = 0, tail = 0;
+    for (auto root : by_degree) {
+      if (visited[root]) continue;
+      visited[root] = true;
+      order[tail++] = root;
+      while (head < tail) {
+        VID_T u = order[head++];
+        nbrs.clear();
+        for (size_t i = offset_[u]; i < offset_[u + 1]; i++) {
+          if (visited[nbrs_[i]]) continue;
+          visited[nbrs_[i]] = true;
+          nbrs.push_back(nbrs_[i]);
+        }
+        std::stable_sort(nbrs.begin(), nbrs.end(), less_degree);
+        for (auto v : nbrs) order[tail++] = v;
+      }
+    }
+    std::reverse(order, order + num_vertexes_);
+  }
+
+  // @brief: place next the vertex that shares the most neighbors (siblings)
+  // and edges with the last window_size placed vertexes. Siblings through
+  // hubs, i.e. in-neighbors with more than sqrt(n) out-neighbors, are
+  // skipped, as in the original Gorder.
+  void GOrder(VID_T* order, const size_t window_size = 5) {
+    std::vector<long> score(num_vertexes_, 0);
+    std::vector<bool> placed(num_vertexes_, false);
+    std::priority_queue<std::pair<long, VID_T>> heap;
+    size_t hub_degree = sqrt(num_vertexes_);
+
+    std::vector<VID_T> by_degree(num_vertexes_);
+    for (size_t i = 0; i < num_vertexes_; i++) by_degree[i] = i;
+    std::stable_sort(by_degree.begin(), by_degree.end(),
+                     [this](VID_T a, VID_T b) {
+                       return GetInDegree(a) > GetInDegree(b);
+                     });
+    size_t cursor = 0;
+
+    auto update = [&](VID_T v, long delta) {
+      auto add = [&](VID_T u) {
+        if (placed[u]) return;
+        score[u] += delta;
+        heap.push(std::make_pair(score[u], u));
+      };
+      for (size_t i = out_offset_[v]; i < out_offset_[v + 1]; i++)
+        add(out_nbrs_[i]);
+      for (size_t i = in_offset_[v]; i < in_offset_[v + 1]; i++) {
+        VID_T x = in_nbrs_[i];
+        add(x);
+        if (out_offset_[x + 1] - out_offset_[x] > hub_degree) continue;
+        for (size_t j = out_offset_[x]; j < out_offset_[x + 1]; j++)
+          if (out_nbrs_[j] != v) add(out_nbrs_[j]);
+      }
+    };
+
+    for (size_t i = 0; i < num_vertexes_; i++) {
+      VID_T v = num_vertexes_;
+      while (!heap.empty()) {
+        auto top = heap.top();
+        heap.pop();
+        if (placed[top.second] || top.first != score[top.second]) continue;
+        if (top.first <= 0) break;
+        v = top.second;
+        break;
+      }
+      if (v == num_vertexes_) {
+        while (placed[by_degree[cursor]]) ++cursor;
+        v = by_degree[cursor];
+      }
+      placed[v] = true;
+      order[i] = v;
+      update(v, 1);
+      if (i >= window_size) update(order[i - window_size], -1);
+    }
+  }
+
+ private:
+  // @brief: convert edges in global ids to local adjacency lists. nbrs_ holds
+  // in- and out-neighbors of each vertex, in_nbrs_ and out_nbrs_ keep the
+  // direction.
+  void BuildLocalAdjacency() {
+    in_offset_.resize(num_vertexes_ + 1, 0);
+    out_offset_.resize(num_vertexes_ + 1, 0);
+    offset_.resize(num_vertexes_ + 1, 0);
+    for (size_t i = 0; i < num_vertexes_; i++) {
+      auto u = graph_->GetVertexByIndex(i);
+      for (size_t j = 0; j < u.indegree; j++)
+        if (graph_->IsInGraph(u.in_edges[j]))
+          in_nbrs_.push_back(graph_->globalid2localid(u.in_edges[j]));
+      for (size_t j = 0; j < u.outdegree; j++)
+        if (graph_->IsInGraph(u.out_edges[j]))
+          out_nbrs_.push_back(graph_->globalid2localid(u.out_edges[j]));
+      in_offset_[i + 1] = in_nbrs_.size();
+      out_offset_[i + 1] = out_nbrs_.size();
+    }
+    nbrs_.reserve(in_nbrs_.size() + out_nbrs_.size());
+    for (size_t i = 0; i < num_vertexes_; i++) {
+      nbrs_.insert(nbrs_.end(), in_nbrs_.begin() + in_offset_[i],
+                   in_nbrs_.begin() + in_offset_[i + 1]);
+      nbrs_.insert(nbrs_.end(), out_nbrs_.begin() + out_offset_[i],
+                   out_nbrs_.begin() + out_offset_[i + 1]);
+      offset_[i + 1] = nbrs_.size();
+    }
+  }
+
+  size_t GetDegree(const VID_T v) const { return offset_[v + 1] - offset_[v]; }
+  size_t GetInDegree(const VID_T v) const {
+    return in_offset_[v + 1] - in_offset_[v];
+  }
+
+  GRAPH_T* graph_ = nullptr;
+  size_t num_vertexes_ = 0;
+
+  std::vector<size_t> in_offset_;
+  std::vector<size_t> out_offset_;
+  std::vector<size_t> offset_;
+  std::vector<VID_T> in_nbrs_;
+  std::vector<VID_T> out_nbrs_;
+  std::vector<VID_T> nbrs_;
+};
+
+}  // namespace partitioner
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_PARTITIONER_VERTEX_REORDER_H
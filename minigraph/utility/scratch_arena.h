@@ -0,0 +1,167 @@
+#ifndef MINIGRAPH_UTILITY_SCRATCH_ARENA_H
+#define MINIGRAPH_UTILITY_SCRATCH_ARENA_H
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "utility/bitmap.h"
+#include "utility/memory.h"
+
+#define NUM_SIZE_CLASSES 64
+
+// Bytes of released buffers a ScratchArena keeps for reuse by default.
+#define SCRATCH_ARENA_CAPACITY (256ul << 20)
+
+namespace minigraph {
+namespace utility {
+
+// @brief: ScratchArena hands out frontier bitmaps and temporary arrays that
+// are reused across supersteps instead of being allocated, page-faulted and
+// freed for every fragment. Buffers are grouped in power-of-two size classes,
+// so a buffer released by a large fragment can serve any smaller one.
+// Resetting a reused buffer costs O(words touched since), not O(size):
+// bitmaps track their dirty chunks, see Bitmap::track_dirty(), and arrays
+// the prefix written before ReleaseArray(). Released buffers beyond the
+// capacity of the arena are freed instead of kept.
+// @note: a ScratchArena is not thread safe, every worker owns one. Like
+// new Bitmap(size), AcquireBitmap() does not clear the bitmap: clear() and
+// fill() only touch the words of the requested size, not of the capacity.
+class ScratchArena {
+ public:
+  ScratchArena(const size_t capacity = SCRATCH_ARENA_CAPACITY)
+      : capacity_(capacity) {}
+
+  ~ScratchArena() {
+    Trim();
+    for (auto& iter : bitmap_class_) delete iter.first;
+    for (auto& iter : buffers_in_use_) free(iter.first);
+  }
+
+  Bitmap* AcquireBitmap(const size_t size) {
+    size_t size_class = GetSizeClass(WORD_OFFSET(size) + 1);
+    Bitmap* bitmap = nullptr;
+    if (bitmaps_[size_class].empty()) {
+      bitmap = new Bitmap(((size_t)1 << size_class) << 6);
+      bitmap->track_dirty(bitmap->size_);
+    } else {
+      bitmap = bitmaps_[size_class].back();
+      bitmaps_[size_class].pop_back();
+      pooled_bytes_ -= GetBitmapBytes(size_class);
+    }
+    bitmap->size_ = size;
+    bitmap_class_.insert(std::make_pair(bitmap, size_class));
+    return bitmap;
+  }
+
+  void ReleaseBitmap(Bitmap* bitmap) {
+    if (bitmap == nullptr) return;
+    auto iter = bitmap_class_.find(bitmap);
+    if (iter == bitmap_class_.end()) {
+      delete bitmap;
+      return;
+    }
+    size_t size_class = iter->second;
+    bitmap_class_.erase(iter);
+    if (pooled_bytes_ + GetBitmapBytes(size_class) > capacity_) {
+      delete bitmap;
+      return;
+    }
+    bitmaps_[size_class].push_back(bitmap);
+    pooled_bytes_ += GetBitmapBytes(size_class);
+  }
+
+  // @brief: acquire an array of n elements of T, set to 0 if clear is true.
+  template <typename T>
+  T* AcquireArray(const size_t n, const bool clear = false) {
+    size_t size = sizeof(T) * n;
+    size_t size_class = GetSizeClass(size);
+    Buffer buffer;
+    if (buffers_[size_class].empty()) {
+      buffer.buf = HugePageAlloc((size_t)1 << size_class);
+      memset(buffer.buf, 0, (size_t)1 << size_class);
+    } else {
+      buffer = buffers_[size_class].back();
+      buffers_[size_class].pop_back();
+      pooled_bytes_ -= (size_t)1 << size_class;
+    }
+    // Bytes beyond buffer.dirty are already 0.
+    if (clear) {
+      memset(buffer.buf, 0, buffer.dirty < size ? buffer.dirty : size);
+      if (buffer.dirty <= size) buffer.dirty = 0;
+    }
+    buffer.size_class = size_class;
+    buffer.size = size;
+    buffers_in_use_.insert(std::make_pair(buffer.buf, buffer));
+    return (T*)buffer.buf;
+  }
+
+  // @brief: release buf, of which at most the first num_touched elements
+  // were written since it was acquired, by default all of them.
+  template <typename T>
+  void ReleaseArray(T* buf, const size_t num_touched = SIZE_MAX) {
+    if (buf == nullptr) return;
+    auto iter = buffers_in_use_.find((void*)buf);
+    if (iter == buffers_in_use_.end()) return;
+    Buffer buffer = iter->second;
+    buffers_in_use_.erase(iter);
+    size_t touched = num_touched < buffer.size / sizeof(T)
+                         ? sizeof(T) * num_touched
+                         : buffer.size;
+    if (touched > buffer.dirty) buffer.dirty = touched;
+    if (pooled_bytes_ + ((size_t)1 << buffer.size_class) > capacity_) {
+      free(buffer.buf);
+      return;
+    }
+    buffers_[buffer.size_class].push_back(buffer);
+    pooled_bytes_ += (size_t)1 << buffer.size_class;
+  }
+
+  // @brief: free all released buffers.
+  void Trim() {
+    for (size_t i = 0; i < NUM_SIZE_CLASSES; i++) {
+      for (auto bitmap : bitmaps_[i]) delete bitmap;
+      for (auto& buffer : buffers_[i]) free(buffer.buf);
+      bitmaps_[i].clear();
+      buffers_[i].clear();
+    }
+    pooled_bytes_ = 0;
+  }
+
+ private:
+  struct Buffer {
+    void* buf = nullptr;
+    size_t size_class = 0;
+    // Bytes requested by the current user.
+    size_t size = 0;
+    // Length of the prefix that may be nonzero.
+    size_t dirty = 0;
+  };
+
+  static size_t GetSizeClass(const size_t size) {
+    size_t size_class = 0;
+    while (((size_t)1 << size_class) < size) ++size_class;
+    return size_class;
+  }
+
+  static size_t GetBitmapBytes(const size_t size_class) {
+    return sizeof(unsigned long) << size_class;
+  }
+
+  const size_t capacity_;
+  size_t pooled_bytes_ = 0;
+
+  // Free buffers by size class.
+  std::vector<Bitmap*> bitmaps_[NUM_SIZE_CLASSES];
+  std::vector<Buffer> buffers_[NUM_SIZE_CLASSES];
+
+  // Buffers in use.
+  std::unordered_map<Bitmap*, size_t> bitmap_class_;
+  std::unordered_map<void*, Buffer> buffers_in_use_;
+};
+
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_SCRATCH_ARENA_H
@@ -0,0 +1,149 @@
+#ifndef MINIGRAPH_UTILITY_SET_INTERSECTION_H
+#define MINIGRAPH_UTILITY_SET_INTERSECTION_H
+
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+// Use galloping search once one list is this many times longer than the
+// other.
+#define GALLOPING_RATIO 32
+
+namespace minigraph {
+namespace utility {
+
+// @brief: intersection of sorted neighbor lists, e.g. out_edges of two
+// vertexes of an ImmutableCSR whose csr_flags_ contain CSR_SORTED.
+// All functions take two ascending lists without duplicates and return the
+// size of their intersection. If out is not nullptr, the common elements
+// are written to out, which has room for min(na, nb) elements.
+
+template <typename T>
+size_t MergeIntersect(const T* a, const size_t na, const T* b, const size_t nb,
+                      T* out = nullptr) {
+  size_t i = 0, j = 0, count = 0;
+  while (i < na && j < nb) {
+    if (a[i] < b[j]) {
+      ++i;
+    } else if (a[i] > b[j]) {
+      ++j;
+    } else {
+      if (out != nullptr) out[count] = a[i];
+      ++count;
+      ++i;
+      ++j;
+    }
+  }
+  return count;
+}
+
+// @brief: for each element of the short list a, gallop (exponential then
+// binary search) over the long list b. O(na * log(nb / na)).
+template <typename T>
+size_t GallopingIntersect(const T* a, const size_t na, const T* b,
+                          const size_t nb, T* out = nullptr) {
+  size_t j = 0, count = 0;
+  for (size_t i = 0; i < na && j < nb; i++) {
+    if (b[j] < a[i]) {
+      size_t step = 1;
+      while (j + step < nb && b[j + step] < a[i]) step <<= 1;
+      size_t lo = j + (step >> 1), hi = j + step < nb ? j + step : nb;
+      while (lo < hi) {
+        size_t mid = lo + ((hi - lo) >> 1);
+        if (b[mid] < a[i])
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      j = lo;
+      if (j == nb) break;
+    }
+    if (b[j] == a[i]) {
+      if (out != nullptr) out[count] = a[i];
+      ++count;
+      ++j;
+    }
+  }
+  return count;
+}
+
+#if defined(__AVX512F__)
+// @brief: compare blocks of 16 elements of a with blocks of 16 elements of
+// b, all pairs are covered by 16 rotations of the block of b.
+inline size_t SIMDIntersect(const uint32_t* a, const size_t na,
+                            const uint32_t* b, const size_t nb,
+                            uint32_t* out = nullptr) {
+  size_t i = 0, j = 0, count = 0;
+  const __m512i rotate =
+      _mm512_set_epi32(0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+  while (i + 16 <= na && j + 16 <= nb) {
+    __m512i va = _mm512_loadu_si512((const void*)(a + i));
+    __m512i vb = _mm512_loadu_si512((const void*)(b + j));
+    __mmask16 mask = 0;
+    for (size_t r = 0; r < 16; r++) {
+      mask |= _mm512_cmpeq_epi32_mask(va, vb);
+      vb = _mm512_permutexvar_epi32(rotate, vb);
+    }
+    if (out != nullptr)
+      _mm512_mask_compressstoreu_epi32(out + count, mask, va);
+    count += __builtin_popcount(mask);
+    uint32_t a_max = a[i + 15], b_max = b[j + 15];
+    if (a_max <= b_max) i += 16;
+    if (b_max <= a_max) j += 16;
+  }
+  return count + MergeIntersect(a + i, na - i, b + j, nb - j,
+                                out == nullptr ? nullptr : out + count);
+}
+#elif defined(__AVX2__)
+// @brief: compare blocks of 8 elements of a with blocks of 8 elements of b,
+// all pairs are covered by 8 rotations of the block of b.
+inline size_t SIMDIntersect(const uint32_t* a, const size_t na,
+                            const uint32_t* b, const size_t nb,
+                            uint32_t* out = nullptr) {
+  size_t i = 0, j = 0, count = 0;
+  const __m256i rotate = _mm256_set_epi32(0, 7, 6, 5, 4, 3, 2, 1);
+  while (i + 8 <= na && j + 8 <= nb) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + j));
+    __m256i cmp = _mm256_cmpeq_epi32(va, vb);
+    for (size_t r = 1; r < 8; r++) {
+      vb = _mm256_permutevar8x32_epi32(vb, rotate);
+      cmp = _mm256_or_si256(cmp, _mm256_cmpeq_epi32(va, vb));
+    }
+    uint32_t mask = _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+    if (out != nullptr) {
+      for (uint32_t m = mask; m != 0; m &= m - 1)
+        out[count++] = a[i + __builtin_ctz(m)];
+    } else {
+      count += __builtin_popcount(mask);
+    }
+    uint32_t a_max = a[i + 7], b_max = b[j + 7];
+    if (a_max <= b_max) i += 8;
+    if (b_max <= a_max) j += 8;
+  }
+  return count + MergeIntersect(a + i, na - i, b + j, nb - j,
+                                out == nullptr ? nullptr : out + count);
+}
+#endif
+
+// @brief: pick galloping search for lists of skewed sizes, the SIMD merge
+// for 32-bit ids if AVX2 or AVX-512 is enabled, and the scalar merge
+// otherwise.
+template <typename T>
+size_t Intersect(const T* a, const size_t na, const T* b, const size_t nb,
+                 T* out = nullptr) {
+  if (na == 0 || nb == 0) return 0;
+  if (na * GALLOPING_RATIO < nb) return GallopingIntersect(a, na, b, nb, out);
+  if (nb * GALLOPING_RATIO < na) return GallopingIntersect(b, nb, a, na, out);
+#if defined(__AVX512F__) || defined(__AVX2__)
+  if (sizeof(T) == sizeof(uint32_t) && std::is_unsigned<T>::value)
+    return SIMDIntersect((const uint32_t*)a, na, (const uint32_t*)b, nb,
+                         (uint32_t*)out);
+#endif
+  return MergeIntersect(a, na, b, nb, out);
+}
+
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_SET_INTERSECTION_H
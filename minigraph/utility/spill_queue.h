@@ -0,0 +1,133 @@
+#ifndef MINIGRAPH_UTILITY_SPILL_QUEUE_H
+#define MINIGRAPH_UTILITY_SPILL_QUEUE_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utility/logging.h"
+
+namespace minigraph {
+namespace utility {
+
+// @brief: SpillQueue holds records of record_size values of T, e.g. partial
+// matches shipped to a fragment, in no particular order. At most capacity
+// records stay in memory; beyond that the buffer is appended to the file
+// path, and Pop() reads them back before the ones in memory. With an empty
+// path all records stay in memory. Push() and Pop() may be called by many
+// threads. Once a spill or a read back fails the queue drops its records and
+// failed() turns true, the caller is expected to give up.
+template <typename T>
+class SpillQueue {
+ public:
+  SpillQueue(const size_t record_size, const size_t capacity,
+             const std::string& path = "") {
+    record_size_ = record_size;
+    capacity_ = capacity;
+    path_ = path;
+  }
+
+  ~SpillQueue() {
+    if (num_spilled_ > 0) remove(path_.c_str());
+  }
+
+  // @return: false if the queue failed.
+  bool Push(const T* records, const size_t num_records) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    if (failed_) return false;
+    if (!path_.empty() &&
+        buf_.size() / record_size_ + num_records > capacity_ && !Spill()) {
+      Fail();
+      return false;
+    }
+    buf_.insert(buf_.end(), records, records + num_records * record_size_);
+    size_ += num_records;
+    return true;
+  }
+
+  // @brief: move up to max_records records to out.
+  // @return: the number of records moved, 0 once the queue is empty.
+  size_t Pop(T* out, const size_t max_records) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    if (num_read_ < num_spilled_) {
+      size_t n = std::min(max_records, num_spilled_ - num_read_);
+      if (!reader_.is_open())
+        reader_.open(path_, std::ios::binary | std::ios::in);
+      if (reader_.read((char*)out, sizeof(T) * record_size_ * n)) {
+        num_read_ += n;
+      } else {
+        XLOG(ERR, "Read spilled records failed: ", path_);
+        Fail();
+        return 0;
+      }
+      if (num_read_ == num_spilled_) {
+        reader_.close();
+        remove(path_.c_str());
+        num_read_ = num_spilled_ = 0;
+      }
+      size_ -= n;
+      return n;
+    }
+    size_t n = std::min(max_records, buf_.size() / record_size_);
+    size_t offset = buf_.size() - n * record_size_;
+    memcpy(out, buf_.data() + offset, sizeof(T) * record_size_ * n);
+    buf_.resize(offset);
+    size_ -= n;
+    return n;
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lck(mtx_);
+    return size_;
+  }
+
+  bool failed() {
+    std::lock_guard<std::mutex> lck(mtx_);
+    return failed_;
+  }
+
+ private:
+  bool Spill() {
+    if (buf_.empty()) return true;
+    std::ofstream file(path_, std::ios::binary | std::ios::out | std::ios::app);
+    file.write((char*)buf_.data(), sizeof(T) * buf_.size());
+    file.close();
+    if (!file) {
+      XLOG(ERR, "Spill records failed: ", path_);
+      return false;
+    }
+    num_spilled_ += buf_.size() / record_size_;
+    buf_.clear();
+    return true;
+  }
+
+  // @brief: drop all records, spilled or not.
+  void Fail() {
+    failed_ = true;
+    if (reader_.is_open()) reader_.close();
+    if (!path_.empty()) remove(path_.c_str());
+    std::vector<T>().swap(buf_);
+    size_ = num_spilled_ = num_read_ = 0;
+  }
+
+  size_t record_size_ = 1;
+  size_t capacity_ = 0;
+  std::string path_;
+
+  std::mutex mtx_;
+  std::vector<T> buf_;
+  size_t size_ = 0;
+  size_t num_spilled_ = 0;
+  size_t num_read_ = 0;
+  bool failed_ = false;
+  std::ifstream reader_;
+};
+
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_SPILL_QUEUE_H
@@ -0,0 +1,117 @@
+#ifndef MINIGRAPH_UTILITY_STREAM_VBYTE_H
+#define MINIGRAPH_UTILITY_STREAM_VBYTE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+namespace minigraph {
+namespace utility {
+
+// Stream VByte (Lemire et al.) stores each 32-bit value in 1 to 4 bytes.
+// The lengths of four consecutive values are packed into one control byte,
+// and the control bytes are kept apart from the data bytes, so that a group
+// of four values is decoded by a single byte shuffle.
+
+// @brief: upper bound of the data bytes of n values.
+inline size_t StreamVByteMaxDataBytes(const size_t n) { return 4 * n; }
+
+inline size_t StreamVByteControlBytes(const size_t n) { return (n + 3) / 4; }
+
+// @brief: encode n values into ctrl, of StreamVByteControlBytes(n) bytes,
+// and data.
+// @return: the number of data bytes.
+inline size_t StreamVByteEncode(const uint32_t* in, const size_t n,
+                                uint8_t* ctrl, uint8_t* data) {
+  uint8_t* p = data;
+  memset(ctrl, 0, StreamVByteControlBytes(n));
+  for (size_t i = 0; i < n; i++) {
+    uint32_t v = in[i];
+    size_t len = v < (1u << 8)    ? 1
+                 : v < (1u << 16) ? 2
+                 : v < (1u << 24) ? 3
+                                  : 4;
+    ctrl[i >> 2] |= (len - 1) << (2 * (i & 3));
+    memcpy(p, &v, len);
+    p += len;
+  }
+  return p - data;
+}
+
+// Shuffle masks and data lengths of the 256 control bytes.
+struct StreamVByteTables {
+  uint8_t shuffle[256][16];
+  uint8_t length[256];
+
+  StreamVByteTables() {
+    for (size_t c = 0; c < 256; c++) {
+      uint8_t pos = 0;
+      for (size_t k = 0; k < 4; k++) {
+        size_t len = ((c >> (2 * k)) & 3) + 1;
+        for (size_t j = 0; j < 4; j++)
+          shuffle[c][4 * k + j] = j < len ? pos++ : 0x80;
+      }
+      length[c] = pos;
+    }
+  }
+};
+
+// @brief: decode n values of ctrl and data into out. data_end bounds the
+// data, groups are shuffled 16 bytes at a time while they lie within it.
+// @return: the end of the data bytes consumed.
+inline const uint8_t* StreamVByteDecode(const uint8_t* ctrl,
+                                        const uint8_t* data,
+                                        const uint8_t* data_end,
+                                        const size_t n, uint32_t* out) {
+  size_t i = 0;
+#if defined(__SSSE3__)
+  static const StreamVByteTables tables;
+  for (; i + 4 <= n && data + 16 <= data_end; i += 4) {
+    uint8_t c = ctrl[i >> 2];
+    __m128i in = _mm_loadu_si128((const __m128i*)data);
+    __m128i mask = _mm_loadu_si128((const __m128i*)tables.shuffle[c]);
+    _mm_storeu_si128((__m128i*)(out + i), _mm_shuffle_epi8(in, mask));
+    data += tables.length[c];
+  }
+#endif
+  for (; i < n; i++) {
+    size_t len = ((ctrl[i >> 2] >> (2 * (i & 3))) & 3) + 1;
+    uint32_t v = 0;
+    memcpy(&v, data, len);
+    out[i] = v;
+    data += len;
+  }
+  return data;
+}
+
+// @brief: deltas of a neighbor list, the first value is kept as is.
+// Descending steps of unsorted lists are zigzag encoded, so that small
+// steps either way take few bytes.
+inline void DeltaEncode(const uint32_t* in, const size_t n, const bool sorted,
+                        uint32_t* out) {
+  uint32_t prev = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint32_t d = in[i] - prev;
+    out[i] = sorted ? d : (d << 1) ^ (uint32_t)((int32_t)d >> 31);
+    prev = in[i];
+  }
+}
+
+// @brief: inverse of DeltaEncode(), in place.
+inline void DeltaDecode(uint32_t* vals, const size_t n, const bool sorted) {
+  uint32_t prev = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint32_t d = sorted ? vals[i] : (vals[i] >> 1) ^ (0u - (vals[i] & 1));
+    prev += d;
+    vals[i] = prev;
+  }
+}
+
+}  // namespace utility
+}  // namespace minigraph
+
+#endif  // MINIGRAPH_UTILITY_STREAM_VBYTE_H
@@ -2,11 +2,13 @@
 #define MINIGRAPH_UTILITY_THREAD_POOL_H_
 
 #include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <stdexcept>
 #include <vector>
@@ -71,6 +73,37 @@ class CPUThreadPool : virtual public ThreadPool {
     return cpu_executor_->getTaskQueueSize();
   }
 
+  // @brief: run f(i) for each i in [0, num_tasks), one task each, and wait
+  // until all of them are done.
+  template <typename F>
+  void ParallelRun(const size_t num_tasks, F&& f) {
+    std::mutex mtx;
+    std::condition_variable finish_cv;
+    std::unique_lock<std::mutex> lck(mtx);
+    std::atomic<size_t> pending_packages(num_tasks);
+    for (size_t i = 0; i < num_tasks; i++) {
+      Commit([i, &f, &mtx, &pending_packages, &finish_cv]() {
+        f(i);
+        if (pending_packages.fetch_sub(1) == 1) {
+          std::lock_guard<std::mutex> guard(mtx);
+          finish_cv.notify_all();
+        }
+      });
+    }
+    finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
+  }
+
+  // @brief: run f(tid, i) for each i in [0, n), in one block of consecutive
+  // i per thread.
+  template <typename F>
+  void ParallelFor(const size_t n, F&& f) {
+    ParallelRun(num_threads_, [&](const size_t tid) {
+      size_t begin = n * tid / num_threads_;
+      size_t end = n * (tid + 1) / num_threads_;
+      for (size_t i = begin; i < end; i++) f(tid, i);
+    });
+  }
+
  private:
   std::unique_ptr<folly::CPUThreadPoolExecutor> cpu_executor_;
   uint8_t num_priorities_ = 1;
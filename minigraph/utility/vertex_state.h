@@ -0,0 +1,103 @@
+#ifndef MINIGRAPH_UTILITY_VERTEX_STATE_H
+#define MINIGRAPH_UTILITY_VERTEX_STATE_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "utility/logging.h"
+#include "utility/memory.h"
+
+namespace minigraph {
+namespace utility {
+
+// @brief: VertexState keeps num_arrays values of T for each vertex of each
+// fragment, e.g. distances, path counts and dependencies, beyond the single
+// vdata that the discharge component writes back when a fragment is released.
+// The state of a fragment with n vertexes is a buffer of num_arrays * n values
+// returned by Acquire(gid, n), laid out by the app, e.g. as num_arrays arrays
+// indexed by local id. With an empty root the state stays in memory;
+// otherwise Release() writes it to root as name_[gid].state and frees it, and
+// the next Acquire() of the fragment reads it back, so that only the state of
+// fragments in memory takes space.
+template <typename GID_T, typename T>
+class VertexState {
+ public:
+  VertexState(const std::string& name, const size_t num_arrays, const T init,
+              const std::string& root = "") {
+    name_ = name;
+    num_arrays_ = num_arrays;
+    init_ = init;
+    root_ = root;
+  }
+
+  ~VertexState() {
+    for (auto& iter : buf_by_gid_) free(iter.second);
+  }
+
+  // @brief: the state of fragment gid, all values are init at the first call.
+  // @return: nullptr if the state written by Release() can't be read back.
+  T* Acquire(const GID_T gid, const size_t num_vertexes) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    auto iter = buf_by_gid_.find(gid);
+    if (iter != buf_by_gid_.end()) return iter->second;
+
+    size_t size = num_arrays_ * num_vertexes;
+    T* buf = (T*)HugePageAlloc(sizeof(T) * size);
+    if (written_.count(gid)) {
+      std::ifstream file(GetPath(gid), std::ios::binary | std::ios::in);
+      if (!file.read((char*)buf, sizeof(T) * size)) {
+        XLOG(ERR, "Read state failed: ", GetPath(gid));
+        free(buf);
+        return nullptr;
+      }
+    } else {
+      for (size_t i = 0; i < size; i++) buf[i] = init_;
+    }
+    buf_by_gid_[gid] = buf;
+    return buf;
+  }
+
+  // @brief: write the state of fragment gid to root and free it. It does
+  // nothing when root is empty.
+  bool Release(const GID_T gid, const size_t num_vertexes) {
+    if (root_.empty()) return true;
+    std::lock_guard<std::mutex> lck(mtx_);
+    auto iter = buf_by_gid_.find(gid);
+    if (iter == buf_by_gid_.end()) return false;
+    std::ofstream file(GetPath(gid),
+                       std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!file.write((char*)iter->second,
+                    sizeof(T) * num_arrays_ * num_vertexes)) {
+      XLOG(ERR, "Write state failed: ", GetPath(gid));
+      return false;
+    }
+    written_[gid] = true;
+    free(iter->second);
+    buf_by_gid_.erase(iter);
+    return true;
+  }
+
+  size_t get_num_arrays() const { return num_arrays_; }
+
+ private:
+  std::string GetPath(const GID_T gid) const {
+    return root_ + "/" + name_ + "_" + std::to_string(gid) + ".state";
+  }
+
+  std::string name_;
+  size_t num_arrays_ = 0;
+  T init_;
+  std::string root_;
+
+  std::mutex mtx_;
+  std::unordered_map<GID_T, T*> buf_by_gid_;
+  std::unordered_map<GID_T, bool> written_;
+};
+
+}  // namespace utility
+}  // namespace minigraph
+#endif  // MINIGRAPH_UTILITY_VERTEX_STATE_H
@@ -11,6 +11,7 @@
 #include "portability/sys_types.h"
 #include "utility/atomic.h"
 #include "utility/bitmap.h"
+#include "utility/io/csv_edge_parser.h"
 #include "utility/io/edge_list_io_adapter.h"
 #include "utility/logging.h"
 #include "utility/thread_pool.h"
@@ -32,38 +33,31 @@ void CompressEdgelistCSV2EdgeListCSV(const std::string input_pt,
 
   auto thread_pool = minigraph::utility::CPUThreadPool(cores, 1);
 
-  rapidcsv::Document* doc =
-      new rapidcsv::Document(input_pt, rapidcsv::LabelParams((-1, -1)),
-                             rapidcsv::SeparatorParams(separator_params));
-  std::vector<VID_T>* src = new std::vector<VID_T>();
-  *src = doc->GetColumn<VID_T>(0);
-  std::vector<VID_T>* dst = new std::vector<VID_T>();
-  *dst = doc->GetColumn<VID_T>(1);
-
-  size_t num_edges = src->size();
+  VID_T* edges = nullptr;
+  size_t num_edges = 0;
+  VID_T max_vid(0);
+  if (!minigraph::utility::io::CSVEdgeParser<VID_T, edata_t>(separator_params,
+                                                             cores)
+           .Parse(input_pt, &edges, &num_edges, &max_vid))
+    return;
   VID_T* src_v = (VID_T*)malloc(sizeof(VID_T) * num_edges);
   VID_T* dst_v = (VID_T*)malloc(sizeof(VID_T) * num_edges);
-  memset(src_v, 0, sizeof(VID_T) * num_edges);
-  memset(dst_v, 0, sizeof(VID_T) * num_edges);
-  VID_T max_vid(0);
 
   LOG_INFO("Read ", num_edges, " edges");
-  LOG_INFO("Run: get maximum vid");
   for (size_t i = 0; i < cores; i++) {
     size_t tid = i;
-    thread_pool.Commit([tid, &cores, &src_v, &dst_v, &src, &dst, &max_vid,
+    thread_pool.Commit([tid, &cores, &src_v, &dst_v, &edges, &num_edges,
                         &pending_packages, &finish_cv]() {
-      for (size_t j = tid; j < src->size(); j += cores) {
-        dst_v[j] = dst->at(j);
-        src_v[j] = src->at(j);
-        write_max(&max_vid, dst->at(j));
-        write_max(&max_vid, src->at(j));
+      for (size_t j = tid; j < num_edges; j += cores) {
+        src_v[j] = edges[j * 2];
+        dst_v[j] = edges[j * 2 + 1];
       }
       if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
       return;
     });
   }
   finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
+  free(edges);
   auto aligned_max_vid =
       (ceil((float)max_vid / ALIGNMENT_FACTOR)) * ALIGNMENT_FACTOR;
   LOG_INFO("#maximum vid: ", max_vid);
@@ -165,9 +159,6 @@ void CompressEdgelistCSV2EdgelistBin(const std::string input_pt,
   std::atomic<size_t> pending_packages(cores);
 
   auto thread_pool = minigraph::utility::CPUThreadPool(cores, 1);
-  std::vector<size_t>* src = new std::vector<size_t>();
-  std::vector<size_t>* dst = new std::vector<size_t>();
-
   size_t num_edges = 0;
   VID_T* src_v = nullptr;
   VID_T* dst_v = nullptr;
@@ -175,27 +166,21 @@ void CompressEdgelistCSV2EdgelistBin(const std::string input_pt,
 
   const char* s = &separator_params;
   if (read_num_edges == 0) {
-    rapidcsv::Document* doc =
-        new rapidcsv::Document(input_pt, rapidcsv::LabelParams(-1, -1),
-                               rapidcsv::SeparatorParams(separator_params));
-    *src = doc->GetColumn<size_t>(0);
-    *dst = doc->GetColumn<size_t>(1);
-    num_edges = src->size();
+    VID_T* edges = nullptr;
+    if (!minigraph::utility::io::CSVEdgeParser<VID_T, edata_t>(
+             separator_params, cores)
+             .Parse(input_pt, &edges, &num_edges, &max_vid))
+      return;
     src_v = (VID_T*)malloc(sizeof(VID_T) * num_edges);
     dst_v = (VID_T*)malloc(sizeof(VID_T) * num_edges);
-    memset(src_v, 0, sizeof(VID_T) * num_edges);
-    memset(dst_v, 0, sizeof(VID_T) * num_edges);
-    delete doc;
 
     for (size_t i = 0; i < cores; i++) {
       size_t tid = i;
-      thread_pool.Commit([tid, &cores, &src_v, &dst_v, &src, &dst,
-                          &pending_packages, &finish_cv, &max_vid]() {
-        for (size_t j = tid; j < src->size(); j += cores) {
-          dst_v[j] = dst->at(j);
-          src_v[j] = src->at(j);
-          write_max(&max_vid, dst_v[j]);
-          write_max(&max_vid, src_v[j]);
+      thread_pool.Commit([tid, &cores, &src_v, &dst_v, &edges, &num_edges,
+                          &pending_packages, &finish_cv]() {
+        for (size_t j = tid; j < num_edges; j += cores) {
+          src_v[j] = edges[j * 2];
+          dst_v[j] = edges[j * 2 + 1];
         }
         if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
         return;
@@ -204,8 +189,7 @@ void CompressEdgelistCSV2EdgelistBin(const std::string input_pt,
     finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
     VID_T aligned_max_vid =
         ceil((float)max_vid / ALIGNMENT_FACTOR) * ALIGNMENT_FACTOR;
-    delete src;
-    delete dst;
+    free(edges);
 
   } else {
     std::string line;
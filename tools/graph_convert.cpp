@@ -36,14 +36,18 @@ void EdgeListBin2EdgelistCSV(std::string src_pt, std::string dst_pt,
 
   for (size_t i = 0; i < edgelist_graph->get_num_edges(); i++) {
     out_file << *(edgelist_graph->buf_graph_ + 2 * i) << separator_params
-             << *(edgelist_graph->buf_graph_ + 2 * i + 1) << std::endl;
+             << *(edgelist_graph->buf_graph_ + 2 * i + 1);
+    if (edgelist_graph->IsWeighted())
+      out_file << separator_params << edgelist_graph->edata_[i];
+    out_file << std::endl;
   }
   out_file.close();
   return;
 }
 
 void EdgeList2CSR(std::string src_pt, std::string dst_pt, std::size_t cores,
-                  char separator_params = ',', const bool frombin = false) {
+                  char separator_params = ',', const bool frombin = false,
+                  const bool weighted = false) {
   minigraph::utility::io::DataMngr<CSR_T> data_mngr;
 
   minigraph::utility::partitioner::PartitionerBase<CSR_T>* partitioner =
@@ -63,7 +67,8 @@ void EdgeList2CSR(std::string src_pt, std::string dst_pt, std::size_t cores,
                                             meta_pt, data_pt, vdata_pt);
   } else {
     edgelist_io_adapter.ParallelReadEdgeListFromCSV(
-        (GRAPH_BASE_T*)edgelist_graph, src_pt, 0, separator_params, cores);
+        (GRAPH_BASE_T*)edgelist_graph, src_pt, 0, separator_params, cores,
+        weighted);
   }
 
   partitioner->ParallelPartition(edgelist_graph, 1, cores);
@@ -149,7 +154,8 @@ void EdgeList2CSR(std::string src_pt, std::string dst_pt, std::size_t cores,
 }
 
 void EdgeListCSV2EdgeListBin(std::string src_pt, std::string dst_pt,
-                             const size_t cores, char separator_params = ',') {
+                             const size_t cores, char separator_params = ',',
+                             const bool weighted = false) {
   std::cout << " #Converting " << FLAGS_t << ": input: " << src_pt
             << " output: " << dst_pt << std::endl;
   minigraph::utility::io::EdgeListIOAdapter<gid_t, vid_t, vdata_t, edata_t>
@@ -158,8 +164,8 @@ void EdgeListCSV2EdgeListBin(std::string src_pt, std::string dst_pt,
   std::string meta_pt = dst_pt + "minigraph_meta" + ".bin";
   std::string data_pt = dst_pt + "minigraph_data" + ".bin";
   std::string vdata_pt = dst_pt + "minigraph_vdata" + ".bin";
-  edge_list_io_adapter.ParallelReadEdgeListFromCSV((GRAPH_BASE_T*)graph, src_pt,
-                                                   0, separator_params, cores);
+  edge_list_io_adapter.ParallelReadEdgeListFromCSV(
+      (GRAPH_BASE_T*)graph, src_pt, 0, separator_params, cores, weighted);
   LOG_INFO("Write: ", meta_pt);
   LOG_INFO("Write: ", data_pt);
   LOG_INFO("Write: ", vdata_pt);
@@ -249,10 +255,12 @@ int main(int argc, char* argv[]) {
   LOG_INFO("In type: ", FLAGS_in_type, " Out type: ", FLAGS_out_type);
   if (FLAGS_tobin && FLAGS_out_type == "edgelist" &&
       FLAGS_in_type == "edgelist")
-    EdgeListCSV2EdgeListBin(src_pt, dst_pt, cores, *FLAGS_sep.c_str());
+    EdgeListCSV2EdgeListBin(src_pt, dst_pt, cores, *FLAGS_sep.c_str(),
+                            FLAGS_weighted);
 
   if (FLAGS_tobin && FLAGS_out_type == "csr" && FLAGS_in_type == "edgelist")
-    EdgeList2CSR(src_pt, dst_pt, cores, *FLAGS_sep.c_str(), FLAGS_frombin);
+    EdgeList2CSR(src_pt, dst_pt, cores, *FLAGS_sep.c_str(), FLAGS_frombin,
+                 FLAGS_weighted);
 
   if (FLAGS_frombin && FLAGS_out_type == "edgelist" &&
       FLAGS_in_type == "edgelist")
@@ -4,18 +4,22 @@
 #include <math.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 #include <iostream>
-#include <random>
+#include <queue>
 #include <string>
+#include <vector>
 
-#include <rapidcsv.h>
-
+#include "graphs/immutable_csr.h"
 #include "portability/sys_types.h"
-#include "utility/bitmap.h"
+#include "utility/io/data_mngr.h"
 #include "utility/logging.h"
+#include "utility/paritioner/streaming_partitioner.h"
 #include "utility/thread_pool.h"
 
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
 
 class GraphGen {
  public:
@@ -63,204 +67,365 @@ class GraphGen {
   };
 };
 
+// RMAT draws edge e by descending power levels of the adjacency matrix,
+// picking quadrant a, b, c or d at each level. Random numbers of edge e are
+// a function of (seed, e) only, so the graph does not depend on the number
+// of cores. Edges are generated in runs of kEdgesPerRun that are sorted,
+// deduplicated and spilled to disk, then the runs are merged into the
+// output, so memory is bounded by cores runs whatever the scale.
 class RMAT final : public GraphGen {
+  using EDGE_T = std::pair<vid_t, vid_t>;
+
  public:
   RMAT(const size_t power, const size_t num_edges, const std::string& out_pt,
-       const float a, const float b, const float c, const float d)
-      : GraphGen(std::pow(2, power), num_edges, out_pt) {
-    a_ = a;
-    b_ = b;
-    c_ = c;
-    d_ = d;
-    x_ = b_ + d_;
-    y_ = c_ + d_;
+       const double a, const double b, const double c, const double d,
+       const size_t seed = 0, const bool permute = false)
+      : GraphGen((size_t)1 << power, num_edges, out_pt) {
+    double sum = a + b + c + d;
+    a_ = a / sum;
+    b_ = b / sum;
+    c_ = c / sum;
     power_ = power;
-    x_signal_ = (bool*)malloc(sizeof(bool) * this->num_vertexes_);
-    y_signal_ = (bool*)malloc(sizeof(bool) * this->num_vertexes_);
-    memset(x_signal_, 0, sizeof(bool) * this->num_vertexes_);
-    memset(y_signal_, 0, sizeof(bool) * this->num_vertexes_);
-    std::cout << "GraphInfo. num_vertexes: " << 2 << "^" << power_ << "="
-              << std::pow(2, power) << ", num_edges: " << num_edges
-              << ", a: " << a_ << ", b: " << b_ << ", c: " << c_
-              << ", d_: " << d_ << std::endl;
+    seed_ = Mix(seed);
+    permute_ = permute;
+    LOG_INFO("GraphInfo. num_vertexes: 2^", power_, "=", this->num_vertexes_,
+             ", num_edges: ", num_edges, ", a: ", a_, ", b: ", b_,
+             ", c: ", c_, ", d: ", 1 - a_ - b_ - c_, ", seed: ", seed,
+             ", permute: ", permute_);
   }
 
-  RMAT(const size_t power, const size_t num_edges, const std::string& out_pt,
-       const float x, const float y)
-      : GraphGen(std::pow(2, power), num_edges, out_pt) {
-    x_ = x;
-    y_ = y;
-    power_ = power;
-    x_signal_ = (bool*)malloc(sizeof(bool) * this->num_vertexes_);
-    y_signal_ = (bool*)malloc(sizeof(bool) * this->num_vertexes_);
-    x_signal_bit_ = new Bitmap(this->num_vertexes_);
-    y_signal_bit_ = new Bitmap(this->num_vertexes_);
-
-    memset(x_signal_, 0, sizeof(bool) * this->num_vertexes_);
-    memset(y_signal_, 0, sizeof(bool) * this->num_vertexes_);
-    std::cout << "GraphInfo. num_vertexes: " << 2 << "^" << power_ << "="
-              << std::pow(2, power) << ", num_edges: " << num_edges
-              << ", x: " << x_ << ", y_: " << y_ << std::endl;
+  // @brief: generate the edges into sorted runs under runs_pt.
+  // @return: paths of the runs.
+  std::vector<std::string> ParallelRun(const size_t cores,
+                                       const std::string& runs_pt) {
+    MakeDirectory(runs_pt);
+    size_t num_runs = (this->num_edges_ + kEdgesPerRun - 1) / kEdgesPerRun;
+    std::vector<std::string> runs(num_runs);
+    for (size_t r = 0; r < num_runs; r++)
+      runs[r] = runs_pt + std::to_string(r) + ".bin";
+
+    minigraph::utility::CPUThreadPool thread_pool(cores, 1);
+    thread_pool.ParallelRun(cores, [&](const size_t i) {
+      std::vector<EDGE_T> edges;
+      for (size_t r = i; r < num_runs; r += cores) {
+        size_t begin = r * kEdgesPerRun;
+        size_t end = std::min(this->num_edges_, begin + kEdgesPerRun);
+        edges.resize(end - begin);
+        for (size_t e = begin; e < end; e++) edges[e - begin] = Edge(e);
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        std::ofstream run_file(runs[r], std::ios::binary);
+        run_file.write((char*)edges.data(), sizeof(EDGE_T) * edges.size());
+      }
+    });
+    return runs;
   }
 
-  std::pair<std::vector<size_t>, std::vector<size_t>> Run() {
-    std::vector<size_t> src;
-    std::vector<size_t> dst;
-    src.reserve(this->num_edges_);
-    dst.reserve(this->num_edges_);
-
-    for (size_t i = 0; i < this->num_edges_; i++) {
-      auto xy = Falling();
-      if (x_signal_[xy.first] && y_signal_[xy.second]) {
-        continue;
-      } else {
-        x_signal_[xy.first] ? 0 : x_signal_[xy.first] = true;
-        y_signal_[xy.second] ? 0 : y_signal_[xy.second] = true;
-        src.push_back(xy.first);
-        dst.push_back(xy.second);
+  // @brief: merge runs into out(src, dst) in ascending order, dropping
+  // duplicates. Runs are removed once merged.
+  // @return: the number of distinct edges.
+  template <typename OUT_T>
+  static size_t MergeRuns(std::vector<std::string> runs,
+                          const std::string& runs_pt, OUT_T out) {
+    for (size_t pass = 0; runs.size() > kMaxMergeWays; pass++) {
+      std::vector<std::string> merged;
+      for (size_t i = 0; i < runs.size(); i += kMaxMergeWays) {
+        std::vector<std::string> group(
+            runs.begin() + i,
+            runs.begin() + std::min(runs.size(), i + kMaxMergeWays));
+        std::string pt = runs_pt + "pass" + std::to_string(pass) + "_" +
+                         std::to_string(merged.size()) + ".bin";
+        EdgeWriter writer(pt);
+        Merge(group, [&](const EDGE_T& edge) { writer.Write(edge); });
+        merged.push_back(pt);
       }
+      runs.swap(merged);
     }
-    return std::make_pair(src, dst);
+    size_t count = 0;
+    Merge(runs, [&](const EDGE_T& edge) {
+      out(edge.first, edge.second);
+      ++count;
+    });
+    return count;
   }
 
-  std::pair<std::vector<size_t>, std::vector<size_t>> ParallelRun(
-      const size_t cores) {
-    std::vector<size_t>** p_src = new std::vector<size_t>*[cores];
-    std::vector<size_t>** p_dst = new std::vector<size_t>*[cores];
+  // @brief: write the edges as "src,dst" lines.
+  size_t WriteEdgeListCSV(const std::vector<std::string>& runs,
+                          const std::string& runs_pt,
+                          const std::string& out_pt) {
+    std::ofstream out_file(out_pt);
+    std::string buf;
+    buf.reserve(kBufferSize * 2);
+    size_t count = MergeRuns(runs, runs_pt, [&](vid_t src, vid_t dst) {
+      buf += std::to_string(src);
+      buf += ',';
+      buf += std::to_string(dst);
+      buf += '\n';
+      if (buf.size() >= kBufferSize) {
+        out_file.write(buf.data(), buf.size());
+        buf.clear();
+      }
+    });
+    out_file.write(buf.data(), buf.size());
+    LOG_INFO("Save to ", out_pt, " num edges: ", count);
+    return count;
+  }
 
-    for (size_t i = 0; i < cores; i++) {
-      p_src[i] = new std::vector<size_t>;
-      p_dst[i] = new std::vector<size_t>;
-      p_src[i]->reserve(this->num_edges_ / cores);
-      p_dst[i]->reserve(this->num_edges_ / cores);
+  // @brief: write the edges in edgelist_bin, i.e. minigraph_meta.bin,
+  // minigraph_data.bin and minigraph_vdata.bin under out_pt as read by
+  // graph_partition_exec -frombin.
+  size_t WriteEdgeListBin(const std::vector<std::string>& runs,
+                          const std::string& runs_pt,
+                          const std::string& out_pt) {
+    MakeDirectory(out_pt);
+    std::string data_pt = out_pt + "minigraph_data.bin";
+    size_t count = 0;
+    {
+      EdgeWriter writer(data_pt);
+      count = MergeRuns(runs, runs_pt, [&](vid_t src, vid_t dst) {
+        writer.Write(std::make_pair(src, dst));
+      });
     }
 
-    auto thread_pool = minigraph::utility::CPUThreadPool(cores, 1);
-
-    x_signal_bit_->clear();
-    y_signal_bit_->clear();
-
-    std::mutex mtx;
-    std::condition_variable finish_cv;
-    std::unique_lock<std::mutex> lck(mtx);
-    std::atomic<size_t> pending_packages(cores);
-    for (size_t i = 0; i < cores; i++) {
-      thread_pool.Commit(
-          [this, i, cores, &p_src, &p_dst, &pending_packages, &finish_cv]() {
-            for (size_t j = i; j < this->num_edges_; j += cores) {
-              auto xy = Falling();
-              if (x_signal_bit_->get_bit(xy.first) != 0 &&
-                  y_signal_bit_->get_bit(xy.second) != 0)
-                continue;
-              x_signal_bit_->set_bit(xy.first);
-              y_signal_bit_->set_bit(xy.second);
-              p_src[i]->push_back(xy.first);
-              p_dst[i]->push_back(xy.second);
-            }
-            if (pending_packages.fetch_sub(1) == 1) finish_cv.notify_all();
-            return;
-          });
+    std::ofstream meta_file(out_pt + "minigraph_meta.bin", std::ios::binary);
+    size_t meta_buff[2] = {this->num_vertexes_, count};
+    vid_t max_vid = this->num_vertexes_ - 1;
+    size_t flags = 0;
+    meta_file.write((char*)meta_buff, 2 * sizeof(size_t));
+    meta_file.write((char*)&max_vid, sizeof(vid_t));
+    meta_file.write((char*)&flags, sizeof(size_t));
+
+    std::ofstream vdata_file(out_pt + "minigraph_vdata.bin", std::ios::binary);
+    std::vector<vdata_t> vdata(kBufferSize / sizeof(vdata_t), 0);
+    for (size_t i = 0; i < this->num_vertexes_; i += vdata.size())
+      vdata_file.write(
+          (char*)vdata.data(),
+          sizeof(vdata_t) * std::min(vdata.size(), this->num_vertexes_ - i));
+    LOG_INFO("Save to ", out_pt, " num edges: ", count);
+    return count;
+  }
+
+ private:
+  static const size_t kEdgesPerRun = 1 << 24;
+  static const size_t kMaxMergeWays = 256;
+  static const size_t kBufferSize = 1 << 20;
+
+  // Buffered writer of a binary run of edges.
+  class EdgeWriter {
+   public:
+    EdgeWriter(const std::string& pt) : file_(pt, std::ios::binary) {
+      buf_.reserve(kBufferSize / sizeof(EDGE_T));
+    }
+    ~EdgeWriter() { Flush(); }
+
+    void Write(const EDGE_T& edge) {
+      buf_.push_back(edge);
+      if (buf_.size() == buf_.capacity()) Flush();
+    }
+
+    void Flush() {
+      file_.write((char*)buf_.data(), sizeof(EDGE_T) * buf_.size());
+      buf_.clear();
     }
 
-    finish_cv.wait(lck, [&] { return pending_packages.load() == 0; });
+   private:
+    std::ofstream file_;
+    std::vector<EDGE_T> buf_;
+  };
 
-    std::vector<size_t>* src = new std::vector<size_t>;
-    std::vector<size_t>* dst = new std::vector<size_t>;
-    src->reserve(this->num_edges_);
-    dst->reserve(this->num_edges_);
+  // Buffered reader of a binary run of edges.
+  class EdgeReader {
+   public:
+    EdgeReader(const std::string& pt) : file_(pt, std::ios::binary) {
+      buf_.resize(kBufferSize / sizeof(EDGE_T));
+    }
 
-    for (size_t i = 0; i < cores; i++) {
-      src->insert(src->end(), p_src[i]->begin(), p_src[i]->end());
-      dst->insert(dst->end(), p_dst[i]->begin(), p_dst[i]->end());
-      delete p_src[i];
-      delete p_dst[i];
+    bool Next(EDGE_T* edge) {
+      if (pos_ == size_) {
+        file_.read((char*)buf_.data(), sizeof(EDGE_T) * buf_.size());
+        size_ = file_.gcount() / sizeof(EDGE_T);
+        pos_ = 0;
+        if (size_ == 0) return false;
+      }
+      *edge = buf_[pos_++];
+      return true;
     }
-    return std::make_pair(*src, *dst);
-  }
 
-  void WriteEdgeList(
-      const std::pair<std::vector<size_t>, std::vector<size_t>>& data,
-      const std::string& out_pt) {
-    rapidcsv::Document doc("", rapidcsv::LabelParams(-1, -1),
-                           rapidcsv::SeparatorParams(',', false, false));
-    doc.SetColumnName(0, "src");
-    doc.SetColumnName(1, "dst");
-    doc.SetColumn<size_t>(0, data.first);
-    doc.SetColumn<size_t>(1, data.second);
-    doc.Save(out_pt);
-    std::cout << "Save to " << out_pt << " num edges: " << data.first.size()
-              << std::endl;
+   private:
+    std::ifstream file_;
+    std::vector<EDGE_T> buf_;
+    size_t pos_ = 0;
+    size_t size_ = 0;
   };
 
- private:
-  size_t power_ = 0;
-  float a_ = 0;
-  float b_ = 0;
-  float c_ = 0;
-  float d_ = 0;
-  float x_ = 0;
-  float y_ = 0;
-
-  bool* x_signal_ = nullptr;
-  bool* y_signal_ = nullptr;
-  Bitmap* x_signal_bit_ = nullptr;
-  Bitmap* y_signal_bit_ = nullptr;
-
-  std::pair<size_t, size_t> GetCoordinate() {
-    std::random_device rd;
-    std::default_random_engine e(rd());
-    std::srand((unsigned)time(NULL));
-    std::bernoulli_distribution X(x_);
-    std::bernoulli_distribution Y(y_);
-    auto x = X(e);
-    auto y = Y(e);
-    return std::make_pair(x, y);
+  // @brief: k-way merge of sorted runs into out(edge), without duplicates.
+  template <typename OUT_T>
+  static void Merge(const std::vector<std::string>& runs, OUT_T out) {
+    std::vector<std::unique_ptr<EdgeReader>> readers;
+    using ITEM_T = std::pair<EDGE_T, size_t>;
+    std::priority_queue<ITEM_T, std::vector<ITEM_T>, std::greater<ITEM_T>>
+        heap;
+    for (size_t i = 0; i < runs.size(); i++) {
+      readers.push_back(std::make_unique<EdgeReader>(runs[i]));
+      EDGE_T edge;
+      if (readers[i]->Next(&edge)) heap.push(std::make_pair(edge, i));
+    }
+    bool first = true;
+    EDGE_T last;
+    while (!heap.empty()) {
+      auto item = heap.top();
+      heap.pop();
+      if (first || item.first != last) out(item.first);
+      first = false;
+      last = item.first;
+      EDGE_T edge;
+      if (readers[item.second]->Next(&edge))
+        heap.push(std::make_pair(edge, item.second));
+    }
+    readers.clear();
+    for (auto& pt : runs) remove(pt.c_str());
   }
 
-  std::pair<size_t, size_t> Falling() {
-    std::pair<size_t, size_t> X_scope =
-        std::make_pair(0, std::pow(2, power_) - 1);
-    std::pair<size_t, size_t> Y_scope =
-        std::make_pair(0, std::pow(2, power_) - 1);
-    size_t scope = std::pow(2, power_);
-    for (size_t i = 0; i < power_; i++) {
-      auto coordinate = this->GetCoordinate();
-      scope = scope >> 1;
-      if (coordinate.first == 0) {
-        X_scope.second -= scope;
-      } else {
-        X_scope.first += scope;
-      }
-      if (coordinate.second == 0) {
-        Y_scope.second -= scope;
-      } else {
-        Y_scope.first += scope;
+  static uint64_t Mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // @brief: edge e, drawn from the counter-based stream of (seed, e).
+  EDGE_T Edge(const uint64_t e) const {
+    uint64_t state = Mix(seed_ ^ Mix(e));
+    uint64_t src = 0, dst = 0;
+    for (size_t level = 0; level < power_; level++) {
+      state += 0x9e3779b97f4a7c15ull;
+      double u = (Mix(state) >> 11) * 0x1.0p-53;
+      src <<= 1;
+      dst <<= 1;
+      if (u < a_) continue;
+      if (u < a_ + b_)
+        dst |= 1;
+      else if (u < a_ + b_ + c_)
+        src |= 1;
+      else {
+        src |= 1;
+        dst |= 1;
       }
     }
-    // LOG_INFO(X_scope.first, " ", Y_scope.second);
-    return std::make_pair(X_scope.first, Y_scope.second);
+    if (permute_) {
+      src = Permute(src);
+      dst = Permute(dst);
+    }
+    return std::make_pair((vid_t)src, (vid_t)dst);
+  }
+
+  // @brief: a bijection of [0, 2^power_) that scatters the hubs of low ids
+  // over the id space, like the random relabeling of Graph500 but without a
+  // table of 2^power_ ids.
+  uint64_t Permute(uint64_t v) const {
+    uint64_t mask = this->num_vertexes_ - 1;
+    size_t shift = (power_ + 1) / 2;
+    v = (v * 0x9e3779b97f4a7c15ull + seed_) & mask;
+    v ^= v >> shift;
+    v = (v * 0xbf58476d1ce4e5b9ull) & mask;
+    v ^= v >> shift;
+    return v;
   }
+
+  size_t power_ = 0;
+  double a_ = 0.25;
+  double b_ = 0.25;
+  double c_ = 0.25;
+  uint64_t seed_ = 0;
+  bool permute_ = false;
 };
 
+// @brief: partition the edgelist_bin under out_pt into a workspace at
+// out_pt with the streaming partitioner, which reads it chunk by chunk.
+bool PartitionEdgeListBin(const std::string& out_pt, const size_t cores,
+                          const size_t num_partitions) {
+  minigraph::utility::io::DataMngr<CSR_T> data_mngr;
+  for (auto dir :
+       {"minigraph_meta/", "minigraph_data/", "minigraph_vdata/",
+        "minigraph_border_vertexes/", "minigraph_message/", "minigraph_si/"})
+    data_mngr.MakeDirectory(out_pt + dir);
+  // Only the streaming partitioners read an edgelist_bin chunk by chunk.
+  std::string score =
+      minigraph::utility::partitioner::StreamingPartitioner<CSR_T>::IsValid(
+          FLAGS_partitioner)
+          ? FLAGS_partitioner
+          : "fennel";
+  minigraph::utility::partitioner::StreamingPartitioner<CSR_T> partitioner(
+      score, FLAGS_balance_slack);
+  partitioner.SetReorder(FLAGS_reorder);
+  partitioner.SetCompress(FLAGS_compress);
+  if (!partitioner.PartitionBin(out_pt + "minigraph_meta.bin",
+                                out_pt + "minigraph_data.bin", num_partitions,
+                                cores, out_pt))
+    return false;
+
+  std::string matrix_pt =
+      out_pt + "minigraph_border_vertexes/communication_matrix.bin";
+  std::string vid_map_pt = out_pt + "minigraph_message/vid_map.bin";
+  std::string border_pt =
+      out_pt + "minigraph_message/global_border_vid_map.bin";
+  remove(matrix_pt.c_str());
+  remove(vid_map_pt.c_str());
+  remove(border_pt.c_str());
+  auto pair_communication_matrix = partitioner.GetCommunicationMatrix();
+  data_mngr.WriteCommunicationMatrix(matrix_pt,
+                                     pair_communication_matrix.second,
+                                     pair_communication_matrix.first);
+  data_mngr.WriteVidMap(partitioner.GetMaxVid(), partitioner.GetVidMap(),
+                        vid_map_pt);
+  data_mngr.WriteBitmap(partitioner.GetGlobalBorderVidMap(), border_pt);
+  return true;
+}
+
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  float x = FLAGS_x;
-  float y = FLAGS_y;
+  assert(FLAGS_o != "");
+  assert(FLAGS_power > 0 && FLAGS_power <= sizeof(vid_t) * 8);
   size_t power = FLAGS_power;
-  size_t num_edges = FLAGS_edges;
+  // 16 edges per vertex as in Graph500 unless -edges is given.
+  size_t num_edges = FLAGS_edges > 0 ? FLAGS_edges : (size_t)16 << power;
   std::string output_pt = FLAGS_o;
   size_t cores = FLAGS_cores;
-  std::cout << "RmatGen: x = " << x << ", y = " << y
-            << ", num_vertexes: " << pow(2, power)
+  bool tobin = FLAGS_tobin || FLAGS_p;
+
+  double a = FLAGS_a, b = FLAGS_b, c = FLAGS_c, d = FLAGS_d;
+  if (a == 0.25 && b == 0.25 && c == 0.25 && d == 0.25 &&
+      (FLAGS_x != 0.5 || FLAGS_y != 0.5)) {
+    // -x and -y pick the bits of destination and source independently.
+    a = (1 - FLAGS_x) * (1 - FLAGS_y);
+    b = FLAGS_x * (1 - FLAGS_y);
+    c = (1 - FLAGS_x) * FLAGS_y;
+    d = FLAGS_x * FLAGS_y;
+  }
+  std::cout << "RmatGen: a = " << a << ", b = " << b << ", c = " << c
+            << ", d = " << d << ", num_vertexes: " << pow(2, power)
             << ", num_edges: " << num_edges << std::endl;
-  RMAT rmat(power, num_edges, output_pt, x, y);
-  // std::pair<std::vector<size_t>, std::vector<size_t>>&& data = rmat.Run();
-  std::pair<std::vector<size_t>, std::vector<size_t>>&& data =
-      rmat.ParallelRun(cores);
-  if (!RMAT::IsExist(output_pt)) {
-    RMAT::Touch(output_pt);
+
+  if (tobin && output_pt.back() != '/') output_pt += '/';
+  std::string runs_pt =
+      (tobin ? output_pt : output_pt + ".") + "rmat_runs/";
+  RMAT rmat(power, num_edges, output_pt, a, b, c, d, FLAGS_seed,
+            FLAGS_permute);
+  auto runs = rmat.ParallelRun(cores, runs_pt);
+  if (tobin) {
+    rmat.WriteEdgeListBin(runs, runs_pt, output_pt);
+  } else {
+    if (!RMAT::IsExist(output_pt)) {
+      RMAT::Touch(output_pt);
+    }
+    rmat.WriteEdgeListCSV(runs, runs_pt, output_pt);
+  }
+  rmdir(runs_pt.c_str());
+
+  if (FLAGS_p && !PartitionEdgeListBin(output_pt, cores, FLAGS_n)) {
+    XLOG(ERR, "Partition failed: ", output_pt);
+    return -1;
   }
-  rmat.WriteEdgeList(data, output_pt);
 
   gflags::ShutDownCommandLineFlags();
-}
\ No newline at end of file
+}
@@ -14,7 +14,9 @@
 #include "utility/paritioner/2DVC_partitioner.h"
 #include "utility/paritioner/edge_cut_partitioner.h"
 #include "utility/paritioner/hybrid_cut_partitioner.h"
+#include "utility/paritioner/multilevel_partitioner.h"
 #include "utility/paritioner/partitioner_base.h"
+#include "utility/paritioner/streaming_partitioner.h"
 #include "utility/paritioner/vertex_cut_partitioner.h"
 #include "utility/thread_pool.h"
 
@@ -23,14 +25,46 @@ using GRAPH_BASE_T = minigraph::graphs::Graph<gid_t, vid_t, vdata_t, edata_t>;
 using EDGE_LIST_T = minigraph::graphs::EdgeList<gid_t, vid_t, vdata_t, edata_t>;
 using VID_T = vid_t;
 using VertexInfo = minigraph::graphs::VertexInfo<vid_t, vdata_t, edata_t>;
+using PARTITIONER_BASE_T =
+    minigraph::utility::partitioner::PartitionerBase<CSR_T>;
+using STREAMING_PARTITIONER_T =
+    minigraph::utility::partitioner::StreamingPartitioner<CSR_T>;
 
-void GraphPartitionEdgeList2CSR(std::string src_pt, std::string dst_pt,
+// @brief: the partitioner named t_partitioner, or nullptr if there is none.
+PARTITIONER_BASE_T* NewPartitioner(const std::string& t_partitioner) {
+  if (t_partitioner == "edgecut")
+    return new minigraph::utility::partitioner::EdgeCutPartitioner<CSR_T>();
+  if (t_partitioner == "vertexcut")
+    return new minigraph::utility::partitioner::VertexCutPartitioner<CSR_T>();
+  if (t_partitioner == "hybridcut")
+    return new minigraph::utility::partitioner::HybridCutPartitioner<CSR_T>();
+  if (t_partitioner == "2dvc")
+    return new minigraph::utility::partitioner::TwoDVCPartitioner<CSR_T>();
+  if (t_partitioner == "multilevel")
+    return new minigraph::utility::partitioner::MultilevelPartitioner<CSR_T>(
+        FLAGS_balance_slack, FLAGS_seed);
+  if (STREAMING_PARTITIONER_T::IsValid(t_partitioner))
+    return new STREAMING_PARTITIONER_T(t_partitioner, FLAGS_balance_slack);
+  return nullptr;
+}
+
+bool GraphPartitionEdgeList2CSR(std::string src_pt, std::string dst_pt,
                                 std::size_t cores, std::size_t num_partitions,
                                 char separator_params = ',',
                                 const bool frombin = false,
-                                const std::string t_partitioner = "edgecut") {
-  assert(t_partitioner == "edgecut" || t_partitioner == "vertexcut" ||
-         t_partitioner == "hybridcut" || t_partitioner == "2dvc");
+                                const std::string t_partitioner = "edgecut",
+                                const std::string t_reorder = "none",
+                                const bool weighted = false) {
+  if (!minigraph::utility::partitioner::VertexReorder<CSR_T>::IsValid(
+          t_reorder)) {
+    XLOG(ERR, "Unknown reorder: ", t_reorder);
+    return false;
+  }
+  PARTITIONER_BASE_T* partitioner = NewPartitioner(t_partitioner);
+  if (partitioner == nullptr) {
+    XLOG(ERR, "Unknown partitioner: ", t_partitioner);
+    return false;
+  }
 
   minigraph::utility::io::DataMngr<CSR_T> data_mngr;
   // Clean dst path.
@@ -80,37 +114,43 @@ void GraphPartitionEdgeList2CSR(std::string src_pt, std::string dst_pt,
   minigraph::utility::io::EdgeListIOAdapter<gid_t, vid_t, vdata_t, edata_t>
       edgelist_io_adapter;
 
-  minigraph::utility::partitioner::PartitionerBase<CSR_T>* partitioner =
-      nullptr;
-  if (t_partitioner == "edgecut")
-    partitioner =
-        new minigraph::utility::partitioner::EdgeCutPartitioner<CSR_T>();
-  else if (t_partitioner == "vertexcut")
-    partitioner =
-        new minigraph::utility::partitioner::VertexCutPartitioner<CSR_T>();
-  else if (t_partitioner == "hybridcut")
-    partitioner =
-        new minigraph::utility::partitioner::HybridCutPartitioner<CSR_T>();
-  else if (t_partitioner == "2dvc")
-    partitioner =
-        new minigraph::utility::partitioner::TwoDVCPartitioner < CSR_T > ();
+  partitioner->SetReorder(t_reorder);
+  partitioner->SetCompress(FLAGS_compress);
 
   // Read Graph
   auto edgelist_graph = new EDGE_LIST_T;
-  if (frombin) {
+  auto streaming_partitioner =
+      dynamic_cast<STREAMING_PARTITIONER_T*>(partitioner);
+  if (frombin && streaming_partitioner != nullptr) {
+    // Streaming partitioners read the binary edge list chunk by chunk.
+    delete edgelist_graph;
+    edgelist_graph = nullptr;
+    if (!streaming_partitioner->PartitionBin(
+            src_pt + "minigraph_meta" + ".bin",
+            src_pt + "minigraph_data" + ".bin", num_partitions, cores,
+            dst_pt)) {
+      XLOG(ERR, "Partition failed: ", src_pt);
+      return false;
+    }
+  } else if (frombin) {
     std::string meta_pt = src_pt + "minigraph_meta" + ".bin";
     std::string data_pt = src_pt + "minigraph_data" + ".bin";
     std::string vdata_pt = src_pt + "minigraph_vdata" + ".bin";
     edgelist_io_adapter.ReadEdgeListFromBin(edgelist_graph, 0, meta_pt, data_pt,
                                             vdata_pt);
   } else {
-    edgelist_io_adapter.ParallelRead((GRAPH_BASE_T*)edgelist_graph,
-                                     edgelist_csv, separator_params, 0, cores,
-                                     src_pt);
+    edgelist_io_adapter.ParallelRead(
+        (GRAPH_BASE_T*)edgelist_graph,
+        weighted ? weight_edgelist_csv : edgelist_csv, separator_params, 0,
+        cores, src_pt);
   }
 
-  partitioner->ParallelPartition(edgelist_graph, num_partitions, cores, dst_pt,
-                                 true);
+  if (edgelist_graph != nullptr &&
+      !partitioner->ParallelPartition(edgelist_graph, num_partitions, cores,
+                                      dst_pt, true)) {
+    XLOG(ERR, "Partition failed: ", src_pt);
+    return false;
+  }
 
   LOG_INFO("WriteCommunicationMatrix.");
   auto pair_communication_matrix = partitioner->GetCommunicationMatrix();
@@ -153,7 +193,7 @@ void GraphPartitionEdgeList2CSR(std::string src_pt, std::string dst_pt,
   }
 
   LOG_INFO("End graph partition#");
-  return;
+  return true;
 }
 
 int main(int argc, char* argv[]) {
@@ -170,11 +210,14 @@ int main(int argc, char* argv[]) {
     std::cout << " #Partitioning: "
               << " input: " << FLAGS_i << " output: " << FLAGS_o
               << " init_model: " << FLAGS_init_model
-              << " cores: " << FLAGS_cores << std::endl;
-
-    GraphPartitionEdgeList2CSR(src_pt, dst_pt, cores, num_partitions,
-                               *FLAGS_sep.c_str(), FLAGS_frombin,
-                               FLAGS_partitioner);
+              << " cores: " << FLAGS_cores << " reorder: " << FLAGS_reorder
+              << std::endl;
+
+    if (!GraphPartitionEdgeList2CSR(src_pt, dst_pt, cores, num_partitions,
+                                    *FLAGS_sep.c_str(), FLAGS_frombin,
+                                    FLAGS_partitioner, FLAGS_reorder,
+                                    FLAGS_weighted))
+      return -1;
     LOG_INFO("Finished: save at ", dst_pt);
   }
 
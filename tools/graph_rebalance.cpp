@@ -0,0 +1,39 @@
+#include <iostream>
+#include <string>
+
+#include <gflags/gflags.h>
+
+#include "graphs/immutable_csr.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/logging.h"
+#include "utility/paritioner/rebalancer.h"
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+
+// Rebalance an edgecut partition in place by the per-fragment costs that the
+// last run left in minigraph_cost/.
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  assert(FLAGS_i != "");
+  assert(minigraph::utility::partitioner::VertexReorder<CSR_T>::IsValid(
+      FLAGS_reorder));
+  std::string work_space = FLAGS_i;
+  std::cout << " #Rebalancing: "
+            << " workspace: " << FLAGS_i << " cores: " << FLAGS_cores
+            << " balance_slack: " << FLAGS_balance_slack
+            << " reorder: " << FLAGS_reorder << std::endl;
+
+  minigraph::utility::partitioner::Rebalancer<CSR_T> rebalancer(
+      FLAGS_balance_slack, FLAGS_cores);
+  rebalancer.SetReorder(FLAGS_reorder);
+  rebalancer.SetCompress(FLAGS_compress);
+  if (!rebalancer.Rebalance(work_space)) {
+    XLOG(ERR, "Rebalance failed: ", work_space);
+    return -1;
+  }
+  LOG_INFO("Finished: rebalanced ", work_space);
+
+  gflags::ShutDownCommandLineFlags();
+}
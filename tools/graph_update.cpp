@@ -0,0 +1,76 @@
+#include <iostream>
+#include <string>
+
+#include <gflags/gflags.h>
+
+#include "graphs/immutable_csr.h"
+#include "portability/sys_data_structure.h"
+#include "portability/sys_types.h"
+#include "utility/io/csv_edge_parser.h"
+#include "utility/io/data_mngr.h"
+#include "utility/io/delta_store.h"
+#include "utility/logging.h"
+
+using CSR_T = minigraph::graphs::ImmutableCSR<gid_t, vid_t, vdata_t, edata_t>;
+
+// @brief: log the edges of the csv file pt as insertions, or deletions if
+// !insert, of delta_store.
+bool UpdateFromCSV(minigraph::utility::io::DeltaStore<CSR_T>* delta_store,
+                   const std::string& pt, const bool insert,
+                   const char separator, const bool weighted,
+                   const size_t cores) {
+  vid_t* edges = nullptr;
+  edata_t* edata = nullptr;
+  size_t num_edges = 0;
+  vid_t max_vid = 0;
+  minigraph::utility::io::CSVEdgeParser<vid_t, edata_t> parser(separator,
+                                                               cores);
+  if (!parser.Parse(pt, &edges, &num_edges, &max_vid,
+                    weighted && insert ? &edata : nullptr, true))
+    return false;
+  size_t accepted = delta_store->Update(edges, edata, num_edges, insert);
+  LOG_INFO(insert ? "Inserted " : "Deleted ", accepted, " / ", num_edges,
+           " edges of ", pt);
+  free(edges);
+  if (edata != nullptr) free(edata);
+  return true;
+}
+
+// Log edge insertions and deletions of an edgecut workspace, see
+// utility/io/delta_store.h, and merge them into its fragments with -compact.
+// Deletions are applied before insertions.
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  assert(FLAGS_i != "");
+  std::string work_space = FLAGS_i;
+  std::cout << " #Updating: "
+            << " workspace: " << FLAGS_i << " insertions: " << FLAGS_insertions
+            << " deletions: " << FLAGS_deletions
+            << " compact: " << FLAGS_compact << std::endl;
+
+  minigraph::utility::io::DataMngr<CSR_T> data_mngr;
+  minigraph::utility::io::DeltaStore<CSR_T> delta_store(work_space);
+  delta_store.Init(data_mngr.InitPtByGid(work_space));
+
+  char separator = FLAGS_sep.size() == 1 ? FLAGS_sep[0] : ',';
+  if (FLAGS_deletions != "" &&
+      !UpdateFromCSV(&delta_store, FLAGS_deletions, false, separator, false,
+                     FLAGS_cores)) {
+    XLOG(ERR, "Update failed: ", FLAGS_deletions);
+    return -1;
+  }
+  if (FLAGS_insertions != "" &&
+      !UpdateFromCSV(&delta_store, FLAGS_insertions, true, separator,
+                     FLAGS_weighted, FLAGS_cores)) {
+    XLOG(ERR, "Update failed: ", FLAGS_insertions);
+    return -1;
+  }
+  if (FLAGS_compact && !delta_store.CompactAll()) {
+    XLOG(ERR, "Compact failed: ", work_space);
+    return -1;
+  }
+  LOG_INFO("Finished: updated ", work_space);
+
+  gflags::ShutDownCommandLineFlags();
+}